@@ -40,6 +40,21 @@ struct berkdb_thread_stats {
     unsigned n_memp_pgs;
     uint64_t memp_pg_time_us;
 
+    /* buffer pool lookups that missed and had to read the page */
+    unsigned n_cache_misses;
+
+    /* prefaulted pages this thread used first, and the subset it had to
+       wait on because the prefault read was still in flight */
+    unsigned n_pf_hits;
+    unsigned n_pf_waits;
+
+    /* bytes written to the transaction log */
+    uint64_t log_bytes;
+
+    /* temp tables that overflowed memory and were copied to a btree */
+    unsigned n_temp_spills;
+    uint64_t temp_spill_bytes;
+
     unsigned n_shallocs;
     uint64_t shalloc_time_us;
 
@@ -75,6 +75,8 @@ const char *thrman_type2a(enum thrtype type);
 char *thrman_describe(struct thr_handle *thr, char *buf, size_t szbuf);
 void thrman_dump(void);
 int thrman_count_type(enum thrtype type);
+struct wait_state;
+void thrman_foreach_active(void (*fn)(enum thrtype, const struct wait_state *, void *), void *arg);
 struct reqlogger *thrman_get_reqlogger(struct thr_handle *thr);
 void thrman_stop_sql_connections(void);
 int thrman_wait_type_exit(enum thrtype type);
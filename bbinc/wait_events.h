@@ -0,0 +1,97 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#ifndef INCLUDED_WAIT_EVENTS_H
+#define INCLUDED_WAIT_EVENTS_H
+
+#include <string.h>
+
+/*
+ * What a thread is waiting on right now. Threads publish their state with
+ * plain stores; the wait event sampler reads it without locks, so a sample
+ * may be one transition stale.
+ */
+
+enum wait_event {
+    WAIT_EVENT_CPU = 0,
+    WAIT_EVENT_LOCK = 1,
+    WAIT_EVENT_MPOOL_READ = 2,
+    WAIT_EVENT_LOG_FLUSH = 3,
+    WAIT_EVENT_NET_SEND = 4,
+    WAIT_EVENT_MAX
+};
+
+#define WAIT_EVENT_FPSZ 16
+
+struct wait_state {
+    volatile int event;
+    volatile int active; /* 0 while the thread is idle in its pool */
+    unsigned char fingerprint[WAIT_EVENT_FPSZ];
+};
+
+/* Set by thrman_register for the calling thread */
+extern __thread struct wait_state *wait_state_self;
+
+const char *wait_event_name(int event);
+
+/* Returns the previous event, to be handed back to wait_event_end */
+static inline int wait_event_begin(int event)
+{
+    struct wait_state *w = wait_state_self;
+    if (w == NULL)
+        return -1;
+    int prev = w->event;
+    w->event = event;
+    return prev;
+}
+
+static inline void wait_event_end(int prev)
+{
+    if (prev >= 0)
+        wait_state_self->event = prev;
+}
+
+/* Bracket a request so idle pool threads are not sampled */
+static inline void wait_state_begin_work(void)
+{
+    struct wait_state *w = wait_state_self;
+    if (w == NULL)
+        return;
+    memset(w->fingerprint, 0, WAIT_EVENT_FPSZ);
+    w->event = WAIT_EVENT_CPU;
+    w->active = 1;
+}
+
+static inline void wait_state_end_work(void)
+{
+    struct wait_state *w = wait_state_self;
+    if (w)
+        w->active = 0;
+}
+
+/* NULL clears it */
+static inline void wait_state_set_fingerprint(const unsigned char *fingerprint)
+{
+    struct wait_state *w = wait_state_self;
+    if (w == NULL)
+        return;
+    if (fingerprint)
+        memcpy(w->fingerprint, fingerprint, WAIT_EVENT_FPSZ);
+    else
+        memset(w->fingerprint, 0, WAIT_EVENT_FPSZ);
+}
+
+#endif
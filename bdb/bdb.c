@@ -788,6 +788,19 @@ void bdb_print_stats(const struct berkdb_thread_stats *st, const char *prefix,
                  st->n_memp_pgs, U2M(st->memp_pg_time_us));
         printfn(s, context);
     }
+    if (st->n_cache_misses > 0) {
+        snprintf(s, sizeof(s), "%s%u bufferpool misses\n", prefix, st->n_cache_misses);
+        printfn(s, context);
+    }
+    if (st->log_bytes > 0) {
+        snprintf(s, sizeof(s), "%s%" PRIu64 " log bytes written\n", prefix, st->log_bytes);
+        printfn(s, context);
+    }
+    if (st->n_temp_spills > 0) {
+        snprintf(s, sizeof(s), "%s%u temp tables spilled %" PRIu64 " bytes to disk\n", prefix, st->n_temp_spills,
+                 st->temp_spill_bytes);
+        printfn(s, context);
+    }
     if (st->n_shallocs > 0 || st->n_shalloc_frees > 0) {
         snprintf(s, sizeof(s),
                  "%s%u shallocs took %u ms, %u shalloc_frees took %u ms\n",
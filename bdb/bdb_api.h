@@ -914,6 +914,9 @@ int bdb_queue_add(bdb_state_type *bdb_state, tran_type *tran, const void *dta,
                   size_t dtalen, int *bdberr, unsigned long long *out_genid);
 int bdb_queue_add_recno(bdb_state_type *bdb_state, tran_type *tran, uint32_t recno, const void *dta, size_t dtalen,
                         int *bdberr, unsigned long long *out_genid);
+/* add an item for a single consumer (partition) of a queuedb */
+int bdb_queue_add_partition(bdb_state_type *bdb_state, tran_type *tran, int partition, const void *dta, size_t dtalen,
+                            int *bdberr, unsigned long long *out_genid);
 
 /* add/consume dummy records to aid extent reclaimation.  winner of the
  * May 2006 "Most Absurd Hack" award. */
@@ -961,6 +964,11 @@ int bdb_queuedb_stats(bdb_state_type *bdb_state,
                       bdb_queue_stats_callback_t callback, tran_type *tran,
                       void *userptr, int *bdberr);
 
+/* invokes callback once for each non-empty partition of a partitioned queue */
+int bdb_queuedb_partition_stats(bdb_state_type *bdb_state, int npartitions,
+                                bdb_queue_stats_callback_t callback,
+                                tran_type *tran, void *userptr, int *bdberr);
+
 typedef int (*bdb_queue_walk_callback_t)(int consumern, size_t item_length,
                                          unsigned int epoch, void *userptr);
 
@@ -976,6 +984,11 @@ struct bdb_queue_found;
 int bdb_queue_consume(bdb_state_type *bdb_state, tran_type *tran, int consumer,
                       const struct bdb_queue_found *prevfnd, int *bdberr);
 
+/* consume several items by genid in one pass; all must be present */
+int bdb_queue_consume_batch(bdb_state_type *bdb_state, tran_type *tran,
+                            int consumer, const uint64_t *genids,
+                            int ngenids, int *bdberr);
+
 /* work out the best page size to use for the given average item size */
 int bdb_queue_best_pagesize(int avg_item_sz);
 
@@ -1376,8 +1389,9 @@ const struct berkdb_thread_stats *bdb_get_process_stats(void);
 #define BDB_FINGERPRINTSZ 16
 
 /* counts[] for _get()/_foreach(): (total, disk-I/O subset) pairs for
- * [0][1] SQL execution, [2][3] master write-apply, [4][5] replicant apply. */
-#define BDB_FINGERPRINT_RTSTATS_NCOUNTS 6
+ * [0][1] SQL execution, [2][3] master write-apply, [4][5] replicant apply;
+ * [6] log bytes written by master write-apply. */
+#define BDB_FINGERPRINT_RTSTATS_NCOUNTS 7
 
 void bdb_fingerprint_rtstats_set(const unsigned char *fingerprint, size_t fplen, int has_main_entry);
 void bdb_fingerprint_rtstats_set_write(const unsigned char *fingerprint, size_t fplen, int has_main_entry);
@@ -1410,6 +1424,8 @@ int bdb_find_oldest_genid(bdb_state_type *bdb_state, tran_type *tran,
 int bdb_find_newest_genid(bdb_state_type *bdb_state, tran_type *tran,
                           int stripe, void *rec, int *reclen, int maxlen,
                           unsigned long long *genid, uint8_t *ver, int *bdberr);
+int bdb_find_edge_genid(bdb_state_type *bdb_state, tran_type *tran, int newest,
+                        int stripe, unsigned long long *genid, int *bdberr);
 
 int bdb_genid_timestamp(unsigned long long genid);
 unsigned long long bdb_recno_to_genid(int recno);
@@ -1529,6 +1545,11 @@ int bdb_get_view(tran_type *t, const char *view_name, char **view_def);
 int bdb_put_view(tran_type *t, const char *view_name, char *view_def);
 int bdb_del_view(tran_type *t, const char *view_name);
 
+/* Query plan baselines, keyed by the 16 byte query fingerprint */
+int bdb_get_plan_baselines(tran_type *t, unsigned char **fingerprints, char ***baselines, int *num);
+int bdb_put_plan_baseline(tran_type *t, const unsigned char *fingerprint, const char *baseline);
+int bdb_del_plan_baseline(tran_type *t, const unsigned char *fingerprint);
+
 int bdb_append_file_version(char *str_buf, size_t buflen,
                             unsigned long long version_num, int *bdberr);
 int bdb_unappend_file_version(bdb_state_type *bdb_state, int *bdberr);
@@ -1778,6 +1799,21 @@ int bdb_newsc_del_redo_genid(tran_type *t, const char *tablename, uint64_t genid
 
 int bdb_newsc_del_all_redo_genids(tran_type *t, const char *tablename, int *bdberr);
 
+/* progress of one genid range of a schema change converting by range */
+typedef struct {
+    int stripe;
+    int range;
+    uint64_t lo;    /* exclusive */
+    uint64_t hi;    /* inclusive, 0 for the last range of a stripe */
+    uint64_t genid; /* converted up to here, -1 when done */
+    uint32_t lo_epoch;
+    uint32_t hi_epoch;
+} llmeta_sc_range_data;
+
+int bdb_set_sc_range(tran_type *t, const char *tablename, const llmeta_sc_range_data *range, int *bdberr);
+int bdb_get_sc_ranges(tran_type *t, const char *tablename, llmeta_sc_range_data **ranges_out, int *num, int *bdberr);
+int bdb_del_sc_ranges(tran_type *t, const char *tablename, int *bdberr);
+
 int bdb_set_high_genid(tran_type *input_trans, const char *tablename, unsigned long long genid, int *bdberr,
                        const char *f, int l);
 int bdb_set_high_genid_stripe(tran_type *input_trans, const char *db_name, int stripe, unsigned long long genid,
@@ -1956,6 +1992,8 @@ int bdb_user_get_all_tran(tran_type *tran, char ***users, int *num);
 void bdb_set_instant_schema_change(bdb_state_type *bdb_state, int isc);
 void bdb_set_inplace_updates(bdb_state_type *bdb_state, int ipu);
 void bdb_set_csc2_version(bdb_state_type *bdb_state, uint8_t version);
+/* set the record length of a table; stored rows may not exceed it */
+void bdb_set_lrl(bdb_state_type *bdb_state, int lrl);
 
 int bdb_get_active_stripe(bdb_state_type *bdb_state);
 
@@ -2106,6 +2144,24 @@ int bdb_get_lock_counters(bdb_state_type *bdb_state, int64_t *deadlocks,
 
 int bdb_get_bpool_counters(bdb_state_type *bdb_state, int64_t *bpool_hits, int64_t *bpool_misses, int64_t *bpool_lhits,
                            int64_t *bpool_lmisses, int64_t *page_reads, int64_t *page_writes, int64_t *rw_evicts);
+int bdb_get_prefault_counters(bdb_state_type *bdb_state, int64_t *pf_pages, int64_t *pf_useful, int64_t *pf_wasted);
+
+/* Buffer pool residency of one table file, see bdb_cache_residency() */
+enum bdb_cache_file_type { BDB_CACHE_FILE_DATA, BDB_CACHE_FILE_BLOB, BDB_CACHE_FILE_INDEX };
+struct bdb_cache_file_stats {
+    enum bdb_cache_file_type type;
+    int filenum; /* blob number or index number; 0 for data */
+    int stripe;
+    int64_t pages;
+    int64_t dirty_pages;
+    int64_t hits;
+    int64_t misses;
+    int64_t evictions;
+};
+typedef void (*bdb_cache_residency_fn)(const struct bdb_cache_file_stats *, void *arg);
+
+/* Calls fn for each data stripe, blob and index file of a table */
+void bdb_cache_residency(bdb_state_type *bdb_state, bdb_cache_residency_fn fn, void *arg);
 
 int bdb_master_should_reject(bdb_state_type *bdb_state);
 
@@ -14,9 +14,10 @@ int bdb_queuedb_consumer(bdb_state_type *bdb_state, int consumer, int active,
 /* need, but different */
 int bdb_queuedb_best_pagesize(int avg_item_sz);
 
-/* add to queue */
-int bdb_queuedb_add(bdb_state_type *bdb_state, tran_type *tran, const void *dta,
-                    size_t dtalen, int *bdberr, unsigned long long *out_genid);
+/* add to queue; partition >= 0 adds for that consumer only */
+int bdb_queuedb_add(bdb_state_type *bdb_state, tran_type *tran, int partition,
+                    const void *dta, size_t dtalen, int *bdberr,
+                    unsigned long long *out_genid);
 
 /* no-op */
 int bdb_queuedb_add_goose(bdb_state_type *bdb_state, tran_type *tran,
@@ -46,6 +47,10 @@ int bdb_queuedb_consume(bdb_state_type *bdb_state, tran_type *tran,
                         int consumer, const struct bdb_queue_found *prevfnd,
                         int *bdberr);
 
+int bdb_queuedb_consume_batch(bdb_state_type *bdb_state, tran_type *tran,
+                              int consumer, const uint64_t *genids,
+                              int ngenids, int *bdberr);
+
 const struct bdb_queue_stats *bdb_queuedb_get_stats(bdb_state_type *bdb_state);
 
 
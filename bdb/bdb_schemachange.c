@@ -88,6 +88,7 @@ static const char *const bdb_scdone_type_names[] = {
     "alias_table",             // 24
     "alias",                   // 25
     "default_cons",            // 26
+    "plan_baseline",           // 27
 };
 
 const char *bdb_get_scdone_str(scdone_t type)
@@ -114,7 +115,7 @@ int32_t bdb_get_dbopen_gen(void)
 }
 
 int sc_type_requires_dbopen_gen_bump(scdone_t type) {
-    if (type == add_queue_file || type == del_queue_file || type == sc_analyze)
+    if (type == add_queue_file || type == del_queue_file || type == sc_analyze || type == plan_baseline)
         return 0;
     return 1;
 }
@@ -264,8 +265,8 @@ retry:
     if (sctype == alter || sctype == fastinit || sctype == bulkimport || sctype == drop) {
         bdb_lock_tablename_write(bdb_state, tbl, tran);
     }
-    /* analyze does NOT need schema_lk */
-    if (sctype == sc_analyze)
+    /* analyze and plan baselines do NOT need schema_lk */
+    if (sctype == sc_analyze || sctype == plan_baseline)
         ltran->get_schema_lock = 0;
 
     ltran->no_distributed_commit = 1;
@@ -53,6 +53,7 @@ typedef enum scdone {
     alias_table,             // 24
     alias,                   // 25
     default_cons,            // 26
+    plan_baseline,           // 27
 } scdone_t;
 
 #define BDB_BUMP_DBOPEN_GEN(type, msg) \
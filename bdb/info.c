@@ -251,6 +251,66 @@ int bdb_get_bpool_counters(bdb_state_type *bdb_state, int64_t *bpool_hits, int64
     return 0;
 }
 
+/* Pages read by prefault, those later used, and those evicted unused */
+int bdb_get_prefault_counters(bdb_state_type *bdb_state, int64_t *pf_pages, int64_t *pf_useful, int64_t *pf_wasted)
+{
+    int rc;
+    DB_MPOOL_STAT *mpool_stats;
+
+    rc = bdb_state->dbenv->memp_stat(bdb_state->dbenv, &mpool_stats, NULL, DB_STAT_MINIMAL);
+    if (rc)
+        return rc;
+
+    if (pf_pages)
+        *pf_pages = mpool_stats->st_page_pf_in;
+    if (pf_useful)
+        *pf_useful = mpool_stats->st_page_pf_hit;
+    if (pf_wasted)
+        *pf_wasted = mpool_stats->st_pf_evict;
+
+    free(mpool_stats);
+    return 0;
+}
+
+static void cache_file_residency(DB *dbp, struct bdb_cache_file_stats *st, bdb_cache_residency_fn fn, void *arg)
+{
+    DB_MPOOL_FSTAT fst;
+
+    if (dbp == NULL || dbp->mpf == NULL || dbp->mpf->get_stat == NULL)
+        return;
+    if (dbp->mpf->get_stat(dbp->mpf, &fst) != 0)
+        return;
+
+    st->pages = fst.st_pages;
+    st->dirty_pages = fst.st_page_dirty;
+    st->hits = fst.st_cache_hit;
+    st->misses = fst.st_cache_miss;
+    st->evictions = fst.st_evict;
+    fn(st, arg);
+}
+
+void bdb_cache_residency(bdb_state_type *bdb_state, bdb_cache_residency_fn fn, void *arg)
+{
+    struct bdb_cache_file_stats st = {0};
+
+    for (int dtanum = 0; dtanum < bdb_state->numdtafiles; dtanum++) {
+        int nstripes = bdb_get_datafile_num_files(bdb_state, dtanum);
+        st.type = dtanum == 0 ? BDB_CACHE_FILE_DATA : BDB_CACHE_FILE_BLOB;
+        st.filenum = dtanum == 0 ? 0 : dtanum - 1;
+        for (int stripe = 0; stripe < nstripes; stripe++) {
+            st.stripe = stripe;
+            cache_file_residency(bdb_state->dbp_data[dtanum][stripe], &st, fn, arg);
+        }
+    }
+
+    st.type = BDB_CACHE_FILE_INDEX;
+    st.stripe = 0;
+    for (int ixnum = 0; ixnum < bdb_state->numix; ixnum++) {
+        st.filenum = ixnum;
+        cache_file_residency(bdb_state->dbp_ix[ixnum], &st, fn, arg);
+    }
+}
+
 const char *deadlock_policy_str(u_int32_t policy)
 {
     switch (policy) {
@@ -559,6 +619,7 @@ static void cache_stats(FILE *out, bdb_state_type *bdb_state, int extra)
     prn_lstat(st_cache_lmiss);
     prn_lstat(st_page_pf_in);
     prn_lstat(st_page_pf_in_late);
+    prn_lstat(st_page_pf_hit);
     prn_lstat(st_page_in);
     prn_lstat(st_page_out);
     prn_lstat(st_ro_merges);
@@ -590,6 +651,14 @@ static void cache_stats(FILE *out, bdb_state_type *bdb_state, int extra)
     prn_lstat(st_ckp_pages_sync);
     prn_lstat(st_ckp_pages_skip);
 
+    btpf_counters pf;
+    btpf_get_counters(&pf);
+    logmsgf(LOGMSG_USER, out, "btpf_windows: %" PRIu64 "\n", pf.windows);
+    logmsgf(LOGMSG_USER, out, "btpf_pages: %" PRIu64 "\n", pf.pages);
+    logmsgf(LOGMSG_USER, out, "btpf_ovfl_pages: %" PRIu64 "\n", pf.ovfl_pages);
+    logmsgf(LOGMSG_USER, out, "btpf_grows: %" PRIu64 "\n", pf.grows);
+    logmsgf(LOGMSG_USER, out, "btpf_shrinks: %" PRIu64 "\n", pf.shrinks);
+
     if (extra) {
         bdb_state->dbenv->memp_dump_region(bdb_state->dbenv, "A", out);
 
@@ -180,6 +180,8 @@ typedef enum {
     LLMETA_SCHEMACHANGE_LIST = 57,            /* list of all sc-s in a uuid txh */
     LLMETA_SCHEMACHANGE_STATUS_PROTOBUF = 58, /* Indicate protobuf sc */
     LLMETA_MAX_SEQNO = 59,
+    LLMETA_PLAN_BASELINE = 60, /* 60 + FINGERPRINT[16] -> plan baseline */
+    LLMETA_SC_RANGE = 61,      /* 61 + TABLENAME + STRIPE + RANGE -> progress */
 } llmetakey_t;
 
 struct llmeta_file_type_key {
@@ -4322,6 +4324,171 @@ int bdb_newsc_set_redo_genid(tran_type *t, const char *tablename, uint64_t genid
     return rc;
 }
 
+/* Progress of one genid range of a schema change converting by range */
+typedef struct {
+    int file_type;
+    char tablename[LLMETA_TBLLEN + 1];
+    char padding[3];
+    int stripe;
+    int range;
+} llmeta_sc_range_key;
+
+enum { LLMETA_SC_RANGE_KEY_LEN = 4 + 32 + 1 + 3 + 4 + 4, LLMETA_SC_RANGE_DATA_LEN = 8 + 8 + 8 + 4 + 4 };
+BB_COMPILE_TIME_ASSERT(llmeta_sc_range_key_len, sizeof(llmeta_sc_range_key) == LLMETA_SC_RANGE_KEY_LEN);
+
+static uint8_t *llmeta_sc_range_key_put(const llmeta_sc_range_key *p_key, uint8_t *p_buf, const uint8_t *p_buf_end)
+{
+    p_buf = buf_put(&(p_key->file_type), sizeof(p_key->file_type), p_buf, p_buf_end);
+    p_buf = buf_no_net_put(&(p_key->tablename), sizeof(p_key->tablename), p_buf, p_buf_end);
+    p_buf = buf_no_net_put(&(p_key->padding), sizeof(p_key->padding), p_buf, p_buf_end);
+    p_buf = buf_put(&(p_key->stripe), sizeof(p_key->stripe), p_buf, p_buf_end);
+    p_buf = buf_put(&(p_key->range), sizeof(p_key->range), p_buf, p_buf_end);
+    return p_buf;
+}
+
+static const uint8_t *llmeta_sc_range_key_get(llmeta_sc_range_key *p_key, const uint8_t *p_buf,
+                                              const uint8_t *p_buf_end)
+{
+    p_buf = buf_get(&(p_key->file_type), sizeof(p_key->file_type), p_buf, p_buf_end);
+    p_buf = buf_no_net_get(&(p_key->tablename), sizeof(p_key->tablename), p_buf, p_buf_end);
+    p_buf = buf_no_net_get(&(p_key->padding), sizeof(p_key->padding), p_buf, p_buf_end);
+    p_buf = buf_get(&(p_key->stripe), sizeof(p_key->stripe), p_buf, p_buf_end);
+    p_buf = buf_get(&(p_key->range), sizeof(p_key->range), p_buf, p_buf_end);
+    return p_buf;
+}
+
+static uint8_t *llmeta_sc_range_data_put(const llmeta_sc_range_data *p_range, uint8_t *p_buf,
+                                         const uint8_t *p_buf_end)
+{
+    p_buf = buf_no_net_put(&(p_range->lo), sizeof(p_range->lo), p_buf, p_buf_end);
+    p_buf = buf_no_net_put(&(p_range->hi), sizeof(p_range->hi), p_buf, p_buf_end);
+    p_buf = buf_no_net_put(&(p_range->genid), sizeof(p_range->genid), p_buf, p_buf_end);
+    p_buf = buf_put(&(p_range->lo_epoch), sizeof(p_range->lo_epoch), p_buf, p_buf_end);
+    p_buf = buf_put(&(p_range->hi_epoch), sizeof(p_range->hi_epoch), p_buf, p_buf_end);
+    return p_buf;
+}
+
+static const uint8_t *llmeta_sc_range_data_get(llmeta_sc_range_data *p_range, const uint8_t *p_buf,
+                                               const uint8_t *p_buf_end)
+{
+    p_buf = buf_no_net_get(&(p_range->lo), sizeof(p_range->lo), p_buf, p_buf_end);
+    p_buf = buf_no_net_get(&(p_range->hi), sizeof(p_range->hi), p_buf, p_buf_end);
+    p_buf = buf_no_net_get(&(p_range->genid), sizeof(p_range->genid), p_buf, p_buf_end);
+    p_buf = buf_get(&(p_range->lo_epoch), sizeof(p_range->lo_epoch), p_buf, p_buf_end);
+    p_buf = buf_get(&(p_range->hi_epoch), sizeof(p_range->hi_epoch), p_buf, p_buf_end);
+    return p_buf;
+}
+
+int bdb_set_sc_range(tran_type *t, const char *tablename, const llmeta_sc_range_data *range, int *bdberr)
+{
+    union {
+        llmeta_sc_range_key key;
+        uint8_t buf[LLMETA_IXLEN];
+    } u = {{0}};
+    llmeta_sc_range_key k = {0};
+    uint8_t data[LLMETA_SC_RANGE_DATA_LEN];
+
+    k.file_type = LLMETA_SC_RANGE;
+    strncpy0(k.tablename, tablename, sizeof(k.tablename));
+    k.stripe = range->stripe;
+    k.range = range->range;
+    llmeta_sc_range_key_put(&k, u.buf, u.buf + sizeof(u.buf));
+    llmeta_sc_range_data_put(range, data, data + sizeof(data));
+
+    *bdberr = BDBERR_NOERROR;
+    return kv_put(t, &u, data, sizeof(data), bdberr);
+}
+
+/* Saved ranges of the table, ordered by stripe and range */
+int bdb_get_sc_ranges(tran_type *t, const char *tablename, llmeta_sc_range_data **ranges_out, int *num, int *bdberr)
+{
+    union {
+        llmeta_sc_range_key key;
+        uint8_t buf[LLMETA_IXLEN];
+    } u = {{0}};
+    void **keys = NULL;
+    void **data = NULL;
+    int *datalens = NULL;
+    int nkey = 0, rc;
+    llmeta_sc_range_data *ranges = NULL;
+
+    *num = 0;
+    *ranges_out = NULL;
+
+    u.key.file_type = htonl(LLMETA_SC_RANGE);
+    strncpy0(u.key.tablename, tablename, sizeof(u.key.tablename));
+
+    rc = kv_get_kv(t, &u, offsetof(llmeta_sc_range_key, padding), &keys, &data, &datalens, &nkey, bdberr);
+    if (rc == 0 && nkey > 0 && (ranges = calloc(nkey, sizeof(llmeta_sc_range_data))) == NULL) {
+        *bdberr = BDBERR_MALLOC;
+        rc = -1;
+    }
+    for (int i = 0; i < nkey; i++) {
+        if (rc == 0) {
+            llmeta_sc_range_key k = {0};
+            if (datalens[i] < LLMETA_SC_RANGE_DATA_LEN) {
+                logmsg(LOGMSG_ERROR, "%s: bad range entry for %s\n", __func__, tablename);
+                *bdberr = BDBERR_MISC;
+                rc = -1;
+            } else {
+                llmeta_sc_range_key_get(&k, keys[i], (uint8_t *)keys[i] + LLMETA_IXLEN);
+                llmeta_sc_range_data_get(&ranges[i], data[i], (uint8_t *)data[i] + datalens[i]);
+                ranges[i].stripe = k.stripe;
+                ranges[i].range = k.range;
+            }
+        }
+        free(keys[i]);
+        free(data[i]);
+    }
+    free(keys);
+    free(data);
+    free(datalens);
+
+    if (rc) {
+        logmsg(LOGMSG_ERROR, "%s: failed to read ranges of %s rc %d bdberr %d\n", __func__, tablename, rc, *bdberr);
+        free(ranges);
+        return -1;
+    }
+    *num = nkey;
+    *ranges_out = ranges;
+    return 0;
+}
+
+int bdb_del_sc_ranges(tran_type *input_trans, const char *tablename, int *bdberr)
+{
+    union {
+        llmeta_sc_range_key key;
+        uint8_t buf[LLMETA_IXLEN];
+    } u = {{0}};
+    int klen = offsetof(llmeta_sc_range_key, padding);
+    uint8_t out[LLMETA_IXLEN];
+    int fnd, rc;
+    tran_type *trans = input_trans;
+
+    u.key.file_type = htonl(LLMETA_SC_RANGE);
+    strncpy0(u.key.tablename, tablename, sizeof(u.key.tablename));
+
+    if (!input_trans) {
+        trans = bdb_tran_begin(llmeta_bdb_state, NULL, bdberr);
+        if (!trans)
+            return -1;
+    }
+    while ((rc = bdb_lite_fetch_partial_tran(llmeta_bdb_state, trans, &u, klen, out, &fnd, bdberr)) == 0 &&
+           fnd == 1 && memcmp(&u, out, klen) == 0) {
+        if ((rc = bdb_lite_exact_del(llmeta_bdb_state, trans, out, bdberr)) != 0)
+            break;
+    }
+    if (!input_trans) {
+        int arc, abdberr;
+        if (rc == 0)
+            return bdb_tran_commit(llmeta_bdb_state, trans, bdberr);
+        arc = bdb_tran_abort(llmeta_bdb_state, trans, &abdberr);
+        if (arc)
+            logmsg(LOGMSG_ERROR, "%s failed to abort txn rc %d bdberr %d\n", __func__, arc, abdberr);
+    }
+    return rc;
+}
+
 static uint8_t *llmeta_sc_hist_data_put(const llmeta_sc_hist_data *p_sc_hist,
                                         uint8_t *p_buf,
                                         const uint8_t *p_buf_end)
@@ -7274,6 +7441,23 @@ int bdb_llmeta_print_record(bdb_state_type *bdb_state, void *key, int keylen,
                k.genid, newsc_lsn.lsn.file, newsc_lsn.lsn.offset);
     } break;
 
+    case LLMETA_SC_RANGE: {
+        if (keylen < sizeof(llmeta_sc_range_key) || datalen < LLMETA_SC_RANGE_DATA_LEN) {
+            logmsg(LOGMSG_USER, "%s:%d: wrong LLMETA_SC_RANGE entry\n", __FILE__, __LINE__);
+            *bdberr = BDBERR_MISC;
+            return -1;
+        }
+        llmeta_sc_range_key k = {0};
+        llmeta_sc_range_data r = {0};
+        llmeta_sc_range_key_get(&k, p_buf_key, p_buf_end_key);
+        llmeta_sc_range_data_get(&r, p_buf_data, p_buf_end_data);
+
+        logmsg(LOGMSG_USER,
+               "LLMETA_SC_RANGE: table=\"%s\" stripe=%d range=%d lo=%0#16" PRIx64 " hi=%0#16" PRIx64
+               " genid=%0#16" PRIx64 "\n",
+               k.tablename, k.stripe, k.range, r.lo, r.hi, r.genid);
+    } break;
+
     case LLMETA_SCHEMACHANGE_HISTORY: {
         sc_hist_row sc_hist = {0};
 
@@ -7492,6 +7676,9 @@ int bdb_llmeta_print_record(bdb_state_type *bdb_state, void *key, int keylen,
     case LLMETA_MAX_SEQNO:
         logmsg(LOGMSG_USER, "LLMETA_MAX_SEQNO: %"PRIu64"\n", flibc_ntohll(*(int64_t *)p_buf_data));
         break;
+    case LLMETA_PLAN_BASELINE:
+        logmsg(LOGMSG_USER, "LLMETA_PLAN_BASELINE: %.*s\n", datalen, (char *)p_buf_data);
+        break;
     default:
          logmsg(LOGMSG_USER, "Todo (type=%d)\n", type);
          break;
@@ -11481,6 +11668,82 @@ int bdb_del_view(tran_type *t, const char *view_name)
     return rc;
 }
 
+enum { LLMETA_FINGERPRINTSZ = 16 };
+
+/* Plan baseline key */
+struct llmeta_plan_baseline_key {
+    int file_type;
+    unsigned char fingerprint[LLMETA_FINGERPRINTSZ]; /* md5 of the normalized sql */
+};
+
+/* Fetch all plan baselines; fingerprints is a packed array of num digests */
+int bdb_get_plan_baselines(tran_type *t, unsigned char **fingerprints, char ***baselines, int *num)
+{
+    union {
+        struct llmeta_plan_baseline_key key;
+        uint8_t buf[LLMETA_IXLEN];
+    } * *keys;
+    char **vals;
+    int rc, n, bdberr;
+    llmetakey_t k;
+
+    *fingerprints = NULL;
+    *baselines = NULL;
+    *num = 0;
+
+    k = htonl(LLMETA_PLAN_BASELINE);
+    rc = kv_get_kv(t, &k, sizeof(k), (void ***)&keys, (void ***)&vals, NULL, &n, &bdberr);
+    if (rc || (n == 0)) {
+        for (int i = 0; i < n; ++i) {
+            free(keys[i]);
+            free(vals[i]);
+        }
+        free(keys);
+        free(vals);
+        return rc;
+    }
+
+    *fingerprints = malloc(n * LLMETA_FINGERPRINTSZ);
+    for (int i = 0; i < n; ++i) {
+        memcpy(*fingerprints + i * LLMETA_FINGERPRINTSZ, keys[i]->key.fingerprint, LLMETA_FINGERPRINTSZ);
+        free(keys[i]);
+    }
+    free(keys);
+    *baselines = vals;
+    *num = n;
+    return rc;
+}
+
+/* Add or replace the baseline of the given fingerprint */
+int bdb_put_plan_baseline(tran_type *t, const unsigned char *fingerprint, const char *baseline)
+{
+    union {
+        struct llmeta_plan_baseline_key key;
+        uint8_t buf[LLMETA_IXLEN];
+    } u = {{0}};
+    int bdberr;
+
+    u.key.file_type = htonl(LLMETA_PLAN_BASELINE);
+    memcpy(u.key.fingerprint, fingerprint, LLMETA_FINGERPRINTSZ);
+
+    return kv_put(t, &u, (void *)baseline, strlen(baseline) + 1, &bdberr);
+}
+
+/* Delete the baseline of the given fingerprint */
+int bdb_del_plan_baseline(tran_type *t, const unsigned char *fingerprint)
+{
+    union {
+        struct llmeta_plan_baseline_key key;
+        uint8_t buf[LLMETA_IXLEN];
+    } u = {{0}};
+    int bdberr;
+
+    u.key.file_type = htonl(LLMETA_PLAN_BASELINE);
+    memcpy(u.key.fingerprint, fingerprint, LLMETA_FINGERPRINTSZ);
+
+    return kv_del(t, &u, &bdberr);
+}
+
 #include "schemachange.h"
 
 /*
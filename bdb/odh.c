@@ -1342,6 +1342,15 @@ inline void bdb_set_csc2_version(bdb_state_type *bdb_state, uint8_t version)
     bdb_state->version = version;
 }
 
+void bdb_set_lrl(bdb_state_type *bdb_state, int lrl)
+{
+    if (bdb_state == NULL) {
+        logmsg(LOGMSG_ERROR, "%s(NULL)!!\n", __func__);
+        return;
+    }
+    bdb_state->lrl = lrl;
+}
+
 inline void bdb_set_instant_schema_change(bdb_state_type *bdb_state, int isc)
 {
     if (bdb_state == NULL) {
@@ -590,7 +590,7 @@ int bdb_queue_add_recno(bdb_state_type *bdb_state, tran_type *tran, uint32_t rec
 
     BDB_READLOCK("bdb_queue_add");
     if (bdb_state->bdbtype == BDBTYPE_QUEUEDB) {
-        rc = bdb_queuedb_add(bdb_state, tran, dta, dtalen, bdberr, out_genid);
+        rc = bdb_queuedb_add(bdb_state, tran, -1, dta, dtalen, bdberr, out_genid);
     } else {
         bdb_lock_table_read(bdb_state, tran);
         rc = bdb_queue_add_int(bdb_state, tran, recno, dta, dtalen, bdberr, out_genid);
@@ -600,6 +600,25 @@ int bdb_queue_add_recno(bdb_state_type *bdb_state, tran_type *tran, uint32_t rec
     return rc;
 }
 
+/* add an item to the queue for one consumer only; legacy queues have no
+ * partitions and take it at the end as usual */
+int bdb_queue_add_partition(bdb_state_type *bdb_state, tran_type *tran, int partition, const void *dta, size_t dtalen,
+                            int *bdberr, unsigned long long *out_genid)
+{
+    int rc = 0;
+
+    BDB_READLOCK("bdb_queue_add");
+    if (bdb_state->bdbtype == BDBTYPE_QUEUEDB) {
+        rc = bdb_queuedb_add(bdb_state, tran, partition, dta, dtalen, bdberr, out_genid);
+    } else {
+        bdb_lock_table_read(bdb_state, tran);
+        rc = bdb_queue_add_int(bdb_state, tran, 0, dta, dtalen, bdberr, out_genid);
+    }
+    BDB_RELLOCK();
+
+    return rc;
+}
+
 /* add an item to the end of the queue. */
 int bdb_queue_add(bdb_state_type *bdb_state, tran_type *tran, const void *dta,
                   size_t dtalen, int *bdberr, unsigned long long *out_genid)
@@ -608,7 +627,7 @@ int bdb_queue_add(bdb_state_type *bdb_state, tran_type *tran, const void *dta,
 
     BDB_READLOCK("bdb_queue_add");
     if (bdb_state->bdbtype == BDBTYPE_QUEUEDB) {
-        rc = bdb_queuedb_add(bdb_state, tran, dta, dtalen, bdberr, out_genid);
+        rc = bdb_queuedb_add(bdb_state, tran, -1, dta, dtalen, bdberr, out_genid);
     } else {
         bdb_lock_table_read(bdb_state, tran);
         rc = bdb_queue_add_int(bdb_state, tran, 0, dta, dtalen, bdberr, out_genid);
@@ -2129,6 +2148,27 @@ int bdb_queue_consume(bdb_state_type *bdb_state, tran_type *tran, int consumer,
     return rc;
 }
 
+int bdb_queue_consume_batch(bdb_state_type *bdb_state, tran_type *tran,
+                            int consumer, const uint64_t *genids,
+                            int ngenids, int *bdberr)
+{
+    int rc = 0;
+    *bdberr = BDBERR_NOERROR;
+
+    BDB_READLOCK("bdb_queue_consume_batch");
+    if (bdb_state->bdbtype == BDBTYPE_QUEUEDB) {
+        rc = bdb_queuedb_consume_batch(bdb_state, tran, consumer, genids,
+                                       ngenids, bdberr);
+    } else {
+        /* legacy queues need the whole found item, not just its genid */
+        *bdberr = BDBERR_BADARGS;
+        rc = -1;
+    }
+    BDB_RELLOCK();
+
+    return rc;
+}
+
 void bdb_queue_get_found_info(const void *fnd, size_t *dtaoff, size_t *dtalen)
 {
     struct bdb_queue_found found;
@@ -92,6 +92,48 @@ static uint8_t *queuedb_key_put(struct queuedb_key *p_queuedb_key,
     return p_buf;
 }
 
+/* Position on the last item of a partition (consumer slot), or of the whole
+ * file if partition < 0. */
+static int queuedb_cget_last(bdb_state_type *bdb_state, DBC *dbcp,
+                             int partition, DBT *dbt_key, DBT *dbt_data,
+                             uint8_t *ver, u_int32_t flags)
+{
+    if (partition < 0)
+        return bdb_cget_unpack(bdb_state, dbcp, dbt_key, dbt_data, ver,
+                               DB_LAST | flags);
+
+    struct queuedb_key k = {.consumer = partition + 1, .genid = 0};
+    uint8_t *p_buf = dbt_key->data;
+    queuedb_key_put(&k, p_buf, p_buf + QUEUEDB_KEY_LEN);
+    dbt_key->size = QUEUEDB_KEY_LEN;
+
+    int rc = bdb_cget_unpack(bdb_state, dbcp, dbt_key, dbt_data, ver,
+                             DB_SET_RANGE | flags);
+    if (rc == 0) {
+        if (dbt_data->flags & DB_DBT_MALLOC) {
+            free(dbt_data->data);
+            dbt_data->data = NULL;
+        }
+        rc = bdb_cget_unpack(bdb_state, dbcp, dbt_key, dbt_data, ver,
+                             DB_PREV | flags);
+    } else if (rc == DB_NOTFOUND) {
+        rc = bdb_cget_unpack(bdb_state, dbcp, dbt_key, dbt_data, ver,
+                             DB_LAST | flags);
+    }
+    if (rc == 0) {
+        p_buf = dbt_key->data;
+        queuedb_key_get(&k, p_buf, p_buf + QUEUEDB_KEY_LEN);
+        if (k.consumer != partition) {
+            if (dbt_data->flags & DB_DBT_MALLOC) {
+                free(dbt_data->data);
+                dbt_data->data = NULL;
+            }
+            rc = DB_NOTFOUND;
+        }
+    }
+    return rc;
+}
+
 static int bdb_queuedb_is_db_empty(DB *db, tran_type *tran)
 {
     int rc;
@@ -318,9 +360,12 @@ int bdb_queuedb_best_pagesize(int avg_item_sz)
     return calc_pagesize(4096, avg_item_sz);
 }
 
-/* add to queue */
-int bdb_queuedb_add(bdb_state_type *bdb_state, tran_type *tran, const void *dta,
-                    size_t dtalen, int *bdberr, unsigned long long *out_genid)
+/* add to queue.  A partitioned queue keeps each partition under its own
+ * consumer slot, so an item goes to one slot and its sequence follows the
+ * last item of that partition. */
+int bdb_queuedb_add(bdb_state_type *bdb_state, tran_type *tran, int partition,
+                    const void *dta, size_t dtalen, int *bdberr,
+                    unsigned long long *out_genid)
 {
     struct bdb_queue_priv *qstate = (struct bdb_queue_priv *)bdb_state->qpriv;
 
@@ -383,9 +428,9 @@ int bdb_queuedb_add(bdb_state_type *bdb_state, tran_type *tran, const void *dta,
     dbt_data.data = NULL;
     dbt_data.flags = DB_DBT_MALLOC;
 
-    /* Lock last page */
-    rc = bdb_cget_unpack(bdb_state, dbcp1, &dbt_key, &dbt_data, &ver,
-                         DB_LAST | DB_RMW);
+    /* Lock last page (of the partition) */
+    rc = queuedb_cget_last(bdb_state, dbcp1, partition, &dbt_key, &dbt_data,
+                           &ver, DB_RMW);
 
     if (rc == 0) {
         freeme1 = dbt_data.data;
@@ -444,8 +489,8 @@ int bdb_queuedb_add(bdb_state_type *bdb_state, tran_type *tran, const void *dta,
             dbt_data.data = NULL;
             dbt_data.flags = DB_DBT_MALLOC;
 
-            rc2 = bdb_cget_unpack(bdb_state, dbcp2, &dbt_key, &dbt_data, &ver,
-                                  DB_LAST);
+            rc2 = queuedb_cget_last(bdb_state, dbcp2, partition, &dbt_key,
+                                    &dbt_data, &ver, 0);
 
             if (rc2 == 0) {
                 freeme2 = dbt_data.data;
@@ -518,7 +563,8 @@ int bdb_queuedb_add(bdb_state_type *bdb_state, tran_type *tran, const void *dta,
 
     *bdberr = BDBERR_NOERROR;
     for (int i = 0; i < MAXCONSUMERS; i++) {
-        if (btst(&bdb_state->active_consumers, i)) {
+        if (partition >= 0 ? i == partition
+                           : btst(&bdb_state->active_consumers, i)) {
             uint8_t key[QUEUEDB_KEY_LEN];
             uint8_t *p_buf, *p_buf_end;
             p_buf = key;
@@ -770,6 +816,145 @@ done:
     return rc;
 }
 
+/* Find the first item of a partition.  Returns DB_NOTFOUND if the partition
+ * is empty in this file. */
+static int queuedb_cget_first(bdb_state_type *bdb_state, DBC *dbcp,
+                              int partition, DBT *dbt_key, DBT *dbt_data,
+                              uint8_t *ver)
+{
+    struct queuedb_key k = {.consumer = partition, .genid = 0};
+    uint8_t *p_buf = dbt_key->data;
+    queuedb_key_put(&k, p_buf, p_buf + QUEUEDB_KEY_LEN);
+    dbt_key->size = QUEUEDB_KEY_LEN;
+
+    int rc = bdb_cget_unpack(bdb_state, dbcp, dbt_key, dbt_data, ver,
+                             DB_SET_RANGE);
+    if (rc == 0) {
+        queuedb_key_get(&k, p_buf, p_buf + QUEUEDB_KEY_LEN);
+        if (k.consumer != partition)
+            rc = DB_NOTFOUND;
+    }
+    return rc;
+}
+
+/* Per-partition version of bdb_queuedb_stats.  Sequence numbers are assigned
+ * per partition, so depth comes from the head and tail of each partition
+ * without walking the items. */
+int bdb_queuedb_partition_stats(bdb_state_type *bdb_state, int npartitions,
+                                bdb_queue_stats_callback_t callback,
+                                tran_type *tran, void *userptr, int *bdberr)
+{
+    int rc = bdb_lock_table_read(bdb_state, tran);
+    if (rc == DB_LOCK_DEADLOCK) {
+        *bdberr = BDBERR_DEADLOCK;
+        return -1;
+    } else if (rc != 0) {
+        logmsg(LOGMSG_ERROR, "%s: queuedb %s error getting tablelock %d\n",
+               __func__, bdb_state->name, rc);
+        *bdberr = BDBERR_MISC;
+        return -1;
+    }
+
+    uint8_t key[QUEUEDB_KEY_LEN];
+    DBT dbt_key = {0}, dbt_data = {0};
+    DBC *dbcs[2] = {NULL, NULL};
+    uint8_t ver = 0;
+    struct bdb_queue_found_seq qfnd_odh;
+    uint8_t *p_buf, *p_buf_end;
+
+    assert(bdb_state->ondisk_header);
+    dbt_key.data = key;
+    dbt_key.ulen = QUEUEDB_KEY_LEN;
+    dbt_key.flags = DB_DBT_USERMEM;
+    dbt_data.flags = DB_DBT_REALLOC;
+
+    DB *dbs[2] = {BDB_QUEUEDB_GET_DBP_ZERO(bdb_state),
+                  BDB_QUEUEDB_GET_DBP_ONE(bdb_state)};
+    int ndbs = dbs[1] ? 2 : 1;
+    for (int i = 0; i < ndbs; i++) {
+        if ((rc = dbs[i]->cursor(dbs[i], tran ? tran->tid : NULL, &dbcs[i], 0)) != 0) {
+            *bdberr = BDBERR_MISC;
+            goto done;
+        }
+    }
+
+    for (int partition = 0; partition < npartitions; partition++) {
+        unsigned int epoch = 0;
+        size_t item_length = 0;
+        long long first_seq = 0, last_seq = 0;
+        int i;
+
+        /* head is in the older file if it has any items */
+        for (i = 0; i < ndbs; i++) {
+            rc = queuedb_cget_first(bdb_state, dbcs[i], partition, &dbt_key,
+                                    &dbt_data, &ver);
+            if (rc != DB_NOTFOUND)
+                break;
+        }
+        if (rc == DB_NOTFOUND) {
+            rc = 0;
+            continue;
+        }
+        if (rc)
+            goto err;
+        p_buf = dbt_data.data;
+        p_buf_end = p_buf + dbt_data.size;
+        queue_found_seq_get(&qfnd_odh, p_buf, p_buf_end);
+        first_seq = qfnd_odh.seq;
+        epoch = qfnd_odh.epoch;
+        item_length = dbt_data.size;
+
+        /* tail is in the newer file if it has any items */
+        for (i = ndbs - 1; i >= 0; i--) {
+            rc = queuedb_cget_last(bdb_state, dbcs[i], partition, &dbt_key,
+                                   &dbt_data, &ver, 0);
+            if (rc != DB_NOTFOUND)
+                break;
+        }
+        if (rc)
+            goto err;
+        p_buf = dbt_data.data;
+        p_buf_end = p_buf + dbt_data.size;
+        queue_found_seq_get(&qfnd_odh, p_buf, p_buf_end);
+        last_seq = qfnd_odh.seq;
+
+        if (last_seq >= first_seq)
+            callback(partition, item_length, epoch, (last_seq - first_seq) + 1,
+                     userptr);
+    }
+    goto done;
+
+err:
+    if (rc == DB_LOCK_DEADLOCK) {
+        *bdberr = BDBERR_DEADLOCK;
+    } else {
+        logmsg(LOGMSG_ERROR, "%s %s berk rc %d\n", __func__, bdb_state->name,
+               rc);
+        *bdberr = BDBERR_MISC;
+    }
+    rc = -1;
+
+done:
+    for (int i = 0; i < 2; i++) {
+        if (dbcs[i] == NULL)
+            continue;
+        int crc = dbcs[i]->c_close(dbcs[i]);
+        if (crc == DB_LOCK_DEADLOCK) {
+            logmsg(LOGMSG_ERROR, "%s: c_close berk rc %d\n", __func__, crc);
+            *bdberr = BDBERR_DEADLOCK;
+            rc = -1;
+        } else if (crc) {
+            logmsg(LOGMSG_ERROR, "%s: c_close berk rc %d\n", __func__, crc);
+            *bdberr = BDBERR_MISC;
+            rc = -1;
+        }
+    }
+    if (dbt_data.data)
+        free(dbt_data.data);
+
+    return rc;
+}
+
 int bdb_queuedb_walk(bdb_state_type *bdb_state, int flags, void *lastitem,
                      bdb_queue_walk_callback_t callback, tran_type *tran,
                      void *userptr, int *bdberr)
@@ -1430,6 +1615,189 @@ int bdb_queuedb_consume(bdb_state_type *bdb_state, tran_type *tran,
     return rc;
 }
 
+static int queuedb_key_cmp(const void *a, const void *b)
+{
+    return memcmp(a, b, QUEUEDB_KEY_LEN);
+}
+
+/* Walk one file from the lowest wanted key forward, deleting the wanted keys
+ * as the cursor passes them.  Keys must be sorted; anything in between that
+ * was not asked for (e.g. a late commit with an older genid) is stepped over,
+ * not deleted.  Sets done[i] for every key deleted here. */
+static int bdb_queuedb_consume_range_int(bdb_state_type *bdb_state, DB *db,
+                                         tran_type *tran, uint8_t *keys,
+                                         int nkeys, uint8_t *done,
+                                         int *ndeleted, long long *maxseq,
+                                         int *bdberr)
+{
+    uint8_t ver = 0;
+    uint8_t found[QUEUEDB_KEY_LEN];
+    int i = 0;
+
+    while (i < nkeys && done[i])
+        ++i;
+    if (i == nkeys)
+        return 0;
+
+    DBC *dbcp = NULL;
+    int rc = db->cursor(db, tran->tid, &dbcp, 0);
+    if (rc != 0) {
+        *bdberr = BDBERR_MISC;
+        return -1;
+    }
+
+    DBT key = {0};
+    key.flags = DB_DBT_USERMEM;
+    key.data = found;
+    key.ulen = key.size = QUEUEDB_KEY_LEN;
+    memcpy(found, keys + i * QUEUEDB_KEY_LEN, QUEUEDB_KEY_LEN);
+
+    DBT val = {0};
+    val.flags = bdb_state->persistent_seq ? DB_DBT_MALLOC : DB_DBT_PARTIAL;
+
+    u_int32_t flag = DB_SET_RANGE;
+    while (i < nkeys) {
+        if (val.data) {
+            free(val.data);
+            val.data = NULL;
+        }
+        if (bdb_state->persistent_seq)
+            rc = bdb_cget_unpack(bdb_state, dbcp, &key, &val, &ver, flag);
+        else
+            rc = dbcp->c_get(dbcp, &key, &val, flag);
+        if (rc == DB_NOTFOUND) {
+            rc = 0;
+            break;
+        } else if (rc) {
+            goto berkerr;
+        }
+        flag = DB_NEXT;
+
+        int cmp = queuedb_key_cmp(found, keys + i * QUEUEDB_KEY_LEN);
+        while (cmp > 0) {
+            /* wanted key is not in this file; try the next one */
+            while (++i < nkeys && done[i])
+                ;
+            if (i == nkeys)
+                break;
+            cmp = queuedb_key_cmp(found, keys + i * QUEUEDB_KEY_LEN);
+        }
+        if (cmp != 0)
+            continue;
+
+        if ((rc = dbcp->c_del(dbcp, 0)) != 0)
+            goto berkerr;
+        if (bdb_state->persistent_seq) {
+            struct bdb_queue_found_seq qfnd;
+            uint8_t *p_buf = (uint8_t *)val.data;
+            uint8_t *p_buf_end = p_buf + sizeof(struct bdb_queue_found_seq);
+            if (queue_found_seq_get(&qfnd, p_buf, p_buf_end) &&
+                qfnd.seq > *maxseq)
+                *maxseq = qfnd.seq;
+        }
+        done[i] = 1;
+        ++(*ndeleted);
+        while (++i < nkeys && done[i])
+            ;
+    }
+    goto done;
+
+berkerr:
+    if (rc == DB_LOCK_DEADLOCK) {
+        *bdberr = BDBERR_DEADLOCK;
+        struct bdb_queue_priv *qstate = bdb_state->qpriv;
+        qstate->stats.n_consume_deadlocks++;
+    } else {
+        logmsg(LOGMSG_ERROR, "%s: queue %s berk rc %d\n", __func__,
+               bdb_state->name, rc);
+        *bdberr = BDBERR_MISC;
+    }
+    rc = -1;
+
+done:
+    if (val.data)
+        free(val.data);
+    int crc = dbcp->c_close(dbcp);
+    if (crc) {
+        logmsg(LOGMSG_ERROR, "%s: c_close berk rc %d\n", __func__, crc);
+        *bdberr = (crc == DB_LOCK_DEADLOCK) ? BDBERR_DEADLOCK : BDBERR_MISC;
+        rc = -1;
+    }
+    return rc;
+}
+
+/* Consume a batch of items for one consumer in a single pass per file,
+ * instead of a cursor search per item.  Fails with BDBERR_DELNOTFOUND unless
+ * every genid was found. */
+int bdb_queuedb_consume_batch(bdb_state_type *bdb_state, tran_type *tran,
+                              int consumer, const uint64_t *genids,
+                              int ngenids, int *bdberr)
+{
+    *bdberr = 0;
+    if (ngenids <= 0)
+        return 0;
+
+    int rc = bdb_lock_table_read(bdb_state, tran);
+    if (rc == DB_LOCK_DEADLOCK) {
+        *bdberr = BDBERR_DEADLOCK;
+        struct bdb_queue_priv *qstate = bdb_state->qpriv;
+        qstate->stats.n_consume_deadlocks++;
+        return -1;
+    } else if (rc != 0) {
+        logmsg(LOGMSG_ERROR, "%s: queuedb %s error getting tablelock %d\n",
+               __func__, bdb_state->name, rc);
+        *bdberr = BDBERR_MISC;
+        return -1;
+    }
+
+    uint8_t *keys = malloc(ngenids * QUEUEDB_KEY_LEN);
+    uint8_t *done = calloc(ngenids, 1);
+    if (keys == NULL || done == NULL) {
+        free(keys);
+        free(done);
+        *bdberr = BDBERR_MALLOC;
+        return -1;
+    }
+    for (int i = 0; i < ngenids; ++i) {
+        struct queuedb_key k = {.consumer = consumer, .genid = genids[i]};
+        uint8_t *p_buf = keys + i * QUEUEDB_KEY_LEN;
+        queuedb_key_put(&k, p_buf, p_buf + QUEUEDB_KEY_LEN);
+    }
+    qsort(keys, ngenids, QUEUEDB_KEY_LEN, queuedb_key_cmp);
+
+    DB *db1 = BDB_QUEUEDB_GET_DBP_ZERO(bdb_state);
+    DB *db2 = BDB_QUEUEDB_GET_DBP_ONE(bdb_state);
+    long long maxseq = -1;
+    int ndeleted = 0;
+
+    rc = bdb_queuedb_consume_range_int(bdb_state, db1, tran, keys, ngenids,
+                                       done, &ndeleted, &maxseq, bdberr);
+    if (rc == 0 && ndeleted < ngenids && db2 != NULL)
+        rc = bdb_queuedb_consume_range_int(bdb_state, db2, tran, keys, ngenids,
+                                           done, &ndeleted, &maxseq, bdberr);
+    if (rc == 0 && ndeleted < ngenids) {
+        *bdberr = BDBERR_DELNOTFOUND;
+        rc = -1;
+    }
+
+    /* Same as the single-item consume: remember the sequence once the queue
+     * drains so that it carries on from there. */
+    if (rc == 0 && maxseq >= 0 && bdb_queuedb_is_db_empty(db1, tran) &&
+        (db2 == NULL || bdb_queuedb_is_db_empty(db2, tran))) {
+        rc = put_queue_sequence(bdb_state->name, tran, maxseq);
+        if (rc) {
+            *bdberr = (rc == DB_LOCK_DEADLOCK) ? BDBERR_DEADLOCK : BDBERR_MISC;
+            rc = -1;
+        }
+    }
+    if (rc == 0)
+        bdb_state->qdb_cons += ndeleted;
+
+    free(keys);
+    free(done);
+    return rc;
+}
+
 const struct bdb_queue_stats *bdb_queuedb_get_stats(bdb_state_type *bdb_state)
 {
     struct bdb_queue_priv *qstate = bdb_state->qpriv;
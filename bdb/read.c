@@ -196,6 +196,45 @@ static int bdb_find_edge_genid_int(bdb_state_type *bdb_state, tran_type *tran,
     }
 }
 
+/* as above, but only reads the genid, without the record */
+int bdb_find_edge_genid(bdb_state_type *bdb_state, tran_type *tran, int newest,
+                        int stripe, unsigned long long *genid, int *bdberr)
+{
+    DBT dbt_key = {0}, dbt_data = {0};
+    DBC *cur;
+    int rc, ixrc;
+
+    BDB_READLOCK("bdb_find_edge_genid");
+    *bdberr = BDBERR_NOERROR;
+    rc = bdb_state->dbp_data[0][stripe]->cursor(
+        bdb_state->dbp_data[0][stripe], tran ? tran->tid : NULL, &cur, 0);
+    if (rc) {
+        *bdberr = (rc == DB_LOCK_DEADLOCK) ? BDBERR_DEADLOCK : rc;
+        BDB_RELLOCK();
+        return -1;
+    }
+    dbt_key.data = genid;
+    dbt_key.ulen = sizeof(unsigned long long);
+    dbt_key.flags = DB_DBT_USERMEM;
+    dbt_data.flags = DB_DBT_USERMEM | DB_DBT_PARTIAL;
+
+    ixrc = cur->c_get(cur, &dbt_key, &dbt_data, newest ? DB_LAST : DB_FIRST);
+
+    rc = cur->c_close(cur);
+    BDB_RELLOCK();
+    if (rc) {
+        *bdberr = (rc == DB_LOCK_DEADLOCK) ? BDBERR_DEADLOCK : rc;
+        return -1;
+    }
+
+    if (ixrc == 0)
+        return 0;
+    else if (ixrc == DB_NOTFOUND)
+        return 1;
+    *bdberr = (ixrc == DB_LOCK_DEADLOCK) ? BDBERR_DEADLOCK : ixrc;
+    return -1;
+}
+
 int bdb_find_oldest_genid(bdb_state_type *bdb_state, tran_type *tran,
                           int stripe, void *rec, int *reclen, int maxlen,
                           unsigned long long *genid, uint8_t *ver, int *bdberr)
@@ -50,6 +50,7 @@
 #include "str0.h"
 #include <thrman.h>
 #include <comdb2_atomic.h>
+#include <perf.h>
 #ifdef _LINUX_SOURCE
 #include <sys/syscall.h>
 #endif
@@ -3174,7 +3175,8 @@ int gbl_replicant_retry_on_not_durable = 0;
 int gbl_debug_force_non_durable = 0;
 int gbl_assert_no_schemalk_in_distributed_commit = 0;
 
-int bdb_wait_for_seqnum_from_all_int(bdb_state_type *bdb_state, seqnum_type *seqnum, int *timeoutms, int is_final)
+static int wait_for_seqnum_from_all_int(bdb_state_type *bdb_state, seqnum_type *seqnum, int *timeoutms,
+                                       int is_final)
 {
     int i, now, cntbytes;
     struct interned_string *nodelist[REPMAX];
@@ -3565,6 +3567,14 @@ done_wait:
     return outrc;
 }
 
+int bdb_wait_for_seqnum_from_all_int(bdb_state_type *bdb_state, seqnum_type *seqnum, int *timeoutms, int is_final)
+{
+    uint64_t start = comdb2_time_epochus();
+    int rc = wait_for_seqnum_from_all_int(bdb_state, seqnum, timeoutms, is_final);
+    latency_hist_add(LATENCY_REPL_WAIT, comdb2_time_epochus() - start);
+    return rc;
+}
+
 int bdb_wait_for_seqnum_from_all(bdb_state_type *bdb_state, seqnum_type *seqnum)
 {
     int timeoutms = bdb_state->attr->reptimeout * MILLISEC;
@@ -5110,6 +5120,8 @@ int enqueue_touch_page(DB_MPOOLFILE *mpf, db_pgno_t pgno)
     work->pgno = pgno;
     rc =
         thdpool_enqueue(gbl_udppfault_thdpool, touch_page_pp, work, 0, NULL, 0);
+    if (rc)
+        free(work);
     return rc;
 }
 
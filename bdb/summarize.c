@@ -22,7 +22,9 @@
    reasonable
    value of N will give the relative frequency/selectivity data as the entire
    table, and this
-   method of scanning will be faster than a plain walk of the table. */
+   method of scanning will be faster than a plain walk of the table.
+   Indexes too large to read in full are instead sampled by random descents
+   from the root, which read only the leaves that are sampled. */
 #include <errno.h>
 #include <fcntl.h>
 #include <limits.h>
@@ -41,6 +43,8 @@
 #include <unistd.h>
 #include <stddef.h>
 #include <pthread.h>
+#include <poll.h>
+#include <inttypes.h>
 #include <comdb2buf.h>
 #include <fcntl.h>
 
@@ -270,13 +274,277 @@ int sampler_close(sampler_t *sampler)
 }
 
 int gbl_debug_sleep_in_summarize = 0;
+
+/* Sample at most this many leaf pages per index; larger samples are taken by
+   random descent instead of a scan of the whole file.  0 always scans. */
+int gbl_analyze_sample_leaf_pages = 65536;
+
+/* Page reads per second allowed to each sampling thread; 0 is unlimited. */
+int gbl_analyze_sample_max_iops = 0;
+
+static void throttle_reads(int64_t start_ms, int64_t nreads)
+{
+    int iops = gbl_analyze_sample_max_iops;
+    if (iops <= 0)
+        return;
+    int64_t due = start_ms + nreads * 1000 / iops;
+    int64_t now = comdb2_time_epochms();
+    if (due > now)
+        poll(NULL, 0, due - now);
+}
+
+/* Check disk space every 10 seconds, and schema changes, analyze abort
+   requests and exit on every call. */
+static int summarize_should_stop(bdb_state_type *bdb_state, int *last, int *bdberr)
+{
+    int now = comdb2_time_epoch();
+    if (now - *last >= 10) {
+        *last = now;
+        int rc = check_free_space(bdb_state->dir);
+        if (rc != BDBERR_NOERROR) {
+            *bdberr = rc;
+            return 1;
+        }
+    }
+
+    int inprogress;
+    if ((inprogress = get_schema_change_in_progress(__func__, __LINE__)) || get_analyze_abort_requested() ||
+        db_is_exiting()) {
+        if (inprogress)
+            logmsg(LOGMSG_ERROR,
+                   "%s: Aborting Analyze because "
+                   "schema_change_in_progress\n",
+                   __func__);
+        if (get_analyze_abort_requested())
+            logmsg(LOGMSG_ERROR,
+                   "%s: Aborting Analyze because "
+                   "of send analyze abort\n",
+                   __func__);
+        if (db_is_exiting())
+            logmsg(LOGMSG_ERROR,
+                   "%s: Aborting Analyze because "
+                   "db is exiting\n",
+                   __func__);
+        return 1;
+    }
+    return 0;
+}
+
+/* Verify the checksum of a page read from disk, decrypt it and put it in
+   cpu order.  Returns non-zero if the page should be skipped. */
+static int summarize_verify_page(DB_ENV *dbenv, DB *dbp, PAGE *page)
+{
+    int is_hmac = CRYPTO_ON(dbenv);
+    int pgsz = dbp->pgsize;
+    int ret;
+    uint8_t *chksum = NULL;
+    /* If we have checksums, use them to verify we don't have
+       a partial page. If the checksum doesn't match,
+       just skip the page. This should be rare
+       (only happen for pagesizes larger than default). */
+    size_t sumlen = 0;
+    if (F_ISSET(dbp, DB_AM_CHKSUM)) {
+        chksum_t algo = IS_CRC32C(page) ? algo_crc32c : algo_hash4;
+        switch (TYPE(page)) {
+        case P_HASHMETA:
+        case P_BTREEMETA:
+        case P_QAMMETA:
+            chksum = ((BTMETA *)page)->chksum;
+            sumlen = DBMETASIZE;
+            break;
+        default:
+            chksum = P_CHKSUM(dbp, page);
+            sumlen = pgsz;
+            break;
+        }
+        if (F_ISSET(dbp, DB_AM_SWAP))
+            P_32_SWAP(chksum);
+        if ((ret = __db_check_chksum_algo(dbenv, dbenv->crypto_handle,
+                                          (void *)chksum, page, sumlen,
+                                          is_hmac, algo)) != 0) {
+            logmsg(LOGMSG_ERROR, "pgno %u invalid checksum\n",
+                   F_ISSET(dbp, DB_AM_SWAP) ? flibc_intflip(page->pgno)
+                                            : page->pgno);
+            return -1;
+        }
+    }
+
+    if (is_hmac) {
+        DB_CIPHER *db_cipher = dbenv->crypto_handle;
+        void *iv = P_IV(dbp, page);
+        size_t skip = P_OVERHEAD(dbp);
+        uint8_t *ciphertext = (uint8_t *)page + skip;
+        if ((ret = db_cipher->decrypt(dbenv, db_cipher->data, iv,
+                                      ciphertext, sumlen - skip)) != 0) {
+            logmsg(LOGMSG_ERROR, "pgno %u decryption failed\n", page->pgno);
+            return -1;
+        }
+    }
+
+    if (IS_PREFIX(page) && F_ISSET(dbp, DB_AM_SWAP))
+        prefix_tocpu(dbp, page);
+
+    return 0;
+}
+
+/* Save a sampled leaf page with n entries to the sampler's temptable. */
+static int summarize_save_leaf(bdb_state_type *bdb_state, sampler_t *sampler, DB *dbp, PAGE *page, db_indx_t n,
+                               int *bdberr)
+{
+    uint8_t pfxbuf[KEYBUF];
+#ifndef NDEBUG
+    uint8_t *max = (uint8_t *)page + dbp->pgsize;
+#endif
+    NUM_ENT(page) = n;
+
+    db_indx_t *inp = P_INP(dbp, page);
+    /* Remember the value before byteswap.
+       We need to reset inp[0] before
+       saving the page to the temptable. */
+    db_indx_t originp = inp[0];
+    if (F_ISSET(dbp, DB_AM_SWAP))
+        inp[0] = flibc_shortflip(inp[0]);
+    BKEYDATA *data = GET_BKEYDATA(dbp, page, 0);
+    assert((uint8_t *)data < max);
+    /* skip deleted */
+    if (B_DISSET(data))
+        return 0;
+    if (B_TYPE(data) != B_KEYDATA)
+        return 0;
+
+    /* Remember the values before byteswap.
+       We need to reset 1st entry before
+       saving the page to the temptable. */
+    BKEYDATA *origdta = data;
+    db_indx_t origdlen = data->len;
+    if (F_ISSET(dbp, DB_AM_SWAP))
+        data->len = flibc_shortflip(data->len);
+    db_indx_t len;
+    ASSIGN_ALIGN(db_indx_t, len, data->len);
+    assert(((uint8_t *)data + len) < max);
+    if (bk_decompress(dbp, page, &data, pfxbuf, sizeof(pfxbuf)) != 0) {
+        logmsg(LOGMSG_ERROR,
+               "\ndecompress failed page:%d indx:0 total:%d\n", page->pgno,
+               n);
+        return 0;
+    }
+    ASSIGN_ALIGN(db_indx_t, len, data->len);
+
+    /* Reset the 1st index and entry. */
+    inp[0] = originp;
+    origdta->len = origdlen;
+
+    /* Save the entire page:
+       key is the 1st key on the page;
+       data is the page itself. */
+    return bdb_temp_table_put(bdb_state->parent, sampler->tmptbl, data->data,
+                              len, page, dbp->pgsize, NULL, bdberr);
+}
+
+#define SUMMARIZE_MAX_DEPTH 64
+
+/* Sample npages leaves by descending from the root, choosing a child
+   uniformly at random on every internal page.  A leaf is reached with
+   probability p, the product of 1/fanout along its path, so the average of
+   entries/p over all descents estimates the size of the index.  A leaf
+   reached twice is only saved once. */
+static int summarize_by_descent(bdb_state_type *bdb_state, sampler_t *sampler, int fd, DB *dbp, db_pgno_t root,
+                                PAGE *page, int npages, unsigned long long *nrecs, unsigned long long *estrecs,
+                                int *bdberr)
+{
+    DB_ENV *dbenv = bdb_state->dbenv;
+    int pgsz = dbp->pgsize;
+    int swap = F_ISSET(dbp, DB_AM_SWAP);
+    unsigned int seed = (unsigned int)(time(NULL) ^ (uintptr_t)pthread_self());
+    int64_t start = comdb2_time_epochms(), nreads = 0;
+    int last = comdb2_time_epoch();
+    int ndescents = 0, attempts = 0;
+    double est = 0;
+    int rc = 0;
+
+    /* leaves already saved */
+    struct stat st;
+    size_t maxpgno = 0;
+    uint8_t *seen = NULL;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        maxpgno = st.st_size / pgsz;
+        seen = calloc(maxpgno / 8 + 1, 1);
+    }
+
+    /* Pages freed since the file was last synced can send a descent
+       astray; such descents are retried. */
+    while (ndescents < npages && attempts < 2 * npages + 16) {
+        attempts++;
+        if (summarize_should_stop(bdb_state, &last, bdberr)) {
+            rc = -1;
+            goto done;
+        }
+
+        db_pgno_t pgno = root;
+        double p = 1;
+        int depth, ok = 0;
+        for (depth = 0; depth < SUMMARIZE_MAX_DEPTH; depth++) {
+            throttle_reads(start, nreads++);
+            if (pread(fd, page, pgsz, (off_t)pgno * pgsz) != pgsz || summarize_verify_page(dbenv, dbp, page))
+                break;
+            if (ISLEAF(page)) {
+                ok = 1;
+                break;
+            }
+            if (TYPE(page) != P_IBTREE)
+                break;
+            db_indx_t n = NUM_ENT(page);
+            if (swap)
+                n = flibc_shortflip(n);
+            if (n == 0)
+                break;
+            db_indx_t *inp = P_INP(dbp, page);
+            int i = rand_r(&seed) % n;
+            if (swap)
+                inp[i] = flibc_shortflip(inp[i]);
+            BINTERNAL *bi = GET_BINTERNAL(dbp, page, i);
+            if ((uint8_t *)bi + sizeof(BINTERNAL) > (uint8_t *)page + pgsz)
+                break;
+            memcpy(&pgno, &bi->pgno, sizeof(pgno));
+            if (swap)
+                pgno = flibc_intflip(pgno);
+            p /= n;
+        }
+        if (!ok)
+            continue;
+
+        db_indx_t n = NUM_ENT(page);
+        if (swap)
+            n = flibc_shortflip(n);
+        ndescents++;
+        est += (n >> 1) / p;
+        if (n == 0)
+            continue;
+
+        if (seen && pgno < maxpgno) {
+            if (seen[pgno / 8] & (1 << (pgno % 8)))
+                continue;
+            seen[pgno / 8] |= 1 << (pgno % 8);
+        }
+        *nrecs += (n >> 1);
+        rc = summarize_save_leaf(bdb_state, sampler, dbp, page, n, bdberr);
+        if (rc)
+            goto done;
+    }
+
+    *estrecs = ndescents ? (unsigned long long)(est / ndescents) : 0;
+    logmsg(LOGMSG_INFO, "summarize descended to %d leaves (%d attempts, %" PRId64 " page reads)\n", ndescents,
+           attempts, nreads);
+done:
+    free(seen);
+    return rc;
+}
+
 int bdb_summarize_table(bdb_state_type *bdb_state, int ixnum, int comp_pct,
                         sampler_t **samplerp, unsigned long long *outrecs,
                         unsigned long long *cmprecs, int *bdberr)
 {
     DB_ENV *dbenv = bdb_state->dbenv;
-    int is_hmac = CRYPTO_ON(dbenv);
-    uint8_t pfxbuf[KEYBUF];
     char tmpname[PATH_MAX];
     char tran_tmpname[PATH_MAX];
     int rc = 0;
@@ -288,7 +556,9 @@ int bdb_summarize_table(bdb_state_type *bdb_state, int ixnum, int comp_pct,
     unsigned long long nrecs = 0;
     unsigned long long recs_looked_at = 0;
     int fd = -1;
-    int last, now;
+    int last;
+    int64_t start, npread = 0;
+    struct stat st;
 #ifdef POSIX_FADV_SEQUENTIAL
     /* Release page cache every FADVISE_THRESH many pages. We could make it
        a tunable, but for now, leave it hardcoded. */
@@ -364,9 +634,23 @@ int bdb_summarize_table(bdb_state_type *bdb_state, int ixnum, int comp_pct,
     }
     pgsz = dbp->pgsize;
     page = malloc(pgsz);
-#ifndef NDEBUG
-    uint8_t *max = (uint8_t *)page + pgsz;
+
+    /* Descend to a fixed number of leaves rather than read every page of an
+       index whose sampled share of leaves would be larger. */
+    if (gbl_analyze_sample_leaf_pages > 0 && fstat(fd, &st) == 0 &&
+        (st.st_size / pgsz) * comp_pct / 100 > gbl_analyze_sample_leaf_pages) {
+        BTMETA *meta = (BTMETA *)metabuf;
+        db_pgno_t root = F_ISSET(dbp, DB_AM_SWAP) ? flibc_intflip(meta->root) : meta->root;
+#ifdef POSIX_FADV_RANDOM
+        (void)posix_fadvise(fd, 0, 0, POSIX_FADV_RANDOM);
 #endif
+        rc = summarize_by_descent(bdb_state, sampler, fd, dbp, root, page, gbl_analyze_sample_leaf_pages, &nrecs,
+                                  &recs_looked_at, bdberr);
+        if (rc == 0)
+            logmsg(LOGMSG_INFO, "summarize added %llu records, estimated %llu\n", nrecs, recs_looked_at);
+        goto done;
+    }
+
     rc = lseek(fd, 0, SEEK_SET);
     if (rc) {
         logmsg(LOGMSG_ERROR, "can't rewind to start of file\n");
@@ -379,6 +663,7 @@ int bdb_summarize_table(bdb_state_type *bdb_state, int ixnum, int comp_pct,
 #endif
 
     last = comdb2_time_epoch();
+    start = comdb2_time_epochms();
     for (rc = read(fd, page, pgsz); rc == pgsz; rc = read(fd, page, pgsz)) {
 #ifdef POSIX_FADV_SEQUENTIAL
         /* Periodically hint the OS to release pages we've read. Only do so
@@ -387,37 +672,11 @@ int bdb_summarize_table(bdb_state_type *bdb_state, int ixnum, int comp_pct,
         if (usedio && ((++nread) % FADVISE_THRESH) == 0)
             (void)posix_fadvise(fd, (nread - FADVISE_THRESH) * pgsz, FADVISE_THRESH * pgsz, POSIX_FADV_DONTNEED);
 #endif
+        throttle_reads(start, npread++);
+
         /* Check disk space, schema changes, analyze abort request etc.
            Every page: unsampled and non-leaf pages have to abort too. */
-        now = comdb2_time_epoch();
-        if (now - last >= 10) {
-            last = now;
-            rc = check_free_space(bdb_state->dir);
-            if (rc != BDBERR_NOERROR) {
-                *bdberr = rc;
-                rc = -1;
-                goto done;
-            }
-        }
-
-        int inprogress;
-        if ((inprogress = get_schema_change_in_progress(__func__, __LINE__)) || get_analyze_abort_requested() ||
-            db_is_exiting()) {
-            if (inprogress)
-                logmsg(LOGMSG_ERROR,
-                       "%s: Aborting Analyze because "
-                       "schema_change_in_progress\n",
-                       __func__);
-            if (get_analyze_abort_requested())
-                logmsg(LOGMSG_ERROR,
-                       "%s: Aborting Analyze because "
-                       "of send analyze abort\n",
-                       __func__);
-            if (db_is_exiting())
-                logmsg(LOGMSG_ERROR,
-                       "%s: Aborting Analyze because "
-                       "db is exiting\n",
-                       __func__);
+        if (summarize_should_stop(bdb_state, &last, bdberr)) {
             rc = -1;
             goto done;
         }
@@ -430,53 +689,8 @@ int bdb_summarize_table(bdb_state_type *bdb_state, int ixnum, int comp_pct,
             sleep(1);
         }
 
-        int ret;
-        uint8_t *chksum = NULL;
-        /* If we have checksums, use them to verify we don't have
-           a partial page. If the checksum doesn't match,
-           just skip the page. This should be rare
-           (only happen for pagesizes larger than default). */
-        size_t sumlen = 0;
-        if (F_ISSET(dbp, DB_AM_CHKSUM)) {
-            chksum_t algo = IS_CRC32C(page) ? algo_crc32c : algo_hash4;
-            switch (TYPE(page)) {
-            case P_HASHMETA:
-            case P_BTREEMETA:
-            case P_QAMMETA:
-                chksum = ((BTMETA *)page)->chksum;
-                sumlen = DBMETASIZE;
-                break;
-            default:
-                chksum = P_CHKSUM(dbp, page);
-                sumlen = pgsz;
-                break;
-            }
-            if (F_ISSET(dbp, DB_AM_SWAP))
-                P_32_SWAP(chksum);
-            if ((ret = __db_check_chksum_algo(dbenv, dbenv->crypto_handle,
-                                              (void *)chksum, page, sumlen,
-                                              is_hmac, algo)) != 0) {
-                logmsg(LOGMSG_ERROR, "pgno %u invalid checksum\n",
-                       F_ISSET(dbp, DB_AM_SWAP) ? flibc_intflip(page->pgno)
-                                                : page->pgno);
-                continue;
-            }
-        }
-
-        if (is_hmac) {
-            DB_CIPHER *db_cipher = dbenv->crypto_handle;
-            void *iv = P_IV(dbp, page);
-            size_t skip = P_OVERHEAD(dbp);
-            uint8_t *ciphertext = (uint8_t *)page + skip;
-            if ((ret = db_cipher->decrypt(dbenv, db_cipher->data, iv,
-                                          ciphertext, sumlen - skip)) != 0) {
-                logmsg(LOGMSG_ERROR, "pgno %u decryption failed\n", page->pgno);
-                continue;
-            }
-        }
-
-        if (IS_PREFIX(page) && F_ISSET(dbp, DB_AM_SWAP))
-            prefix_tocpu(dbp, page);
+        if (summarize_verify_page(dbenv, dbp, page))
+            continue;
 
         db_indx_t n = NUM_ENT(page);
         if (F_ISSET(dbp, DB_AM_SWAP))
@@ -496,51 +710,8 @@ int bdb_summarize_table(bdb_state_type *bdb_state, int ixnum, int comp_pct,
         recs_looked_at += (n >> 1);
         if (rand() % 100 >= comp_pct)
             continue;
-        NUM_ENT(page) = n;
         nrecs += (n >> 1);
-
-        db_indx_t *inp = P_INP(dbp, page);
-        /* Remember the value before byteswap.
-           We need to reset inp[0] before
-           saving the page to the temptable. */
-        db_indx_t originp = inp[0];
-        if (F_ISSET(dbp, DB_AM_SWAP))
-            inp[0] = flibc_shortflip(inp[0]);
-        BKEYDATA *data = GET_BKEYDATA(dbp, page, 0);
-        assert((uint8_t *)data < max);
-        /* skip deleted */
-        if (B_DISSET(data))
-            continue;
-        if (B_TYPE(data) != B_KEYDATA)
-            continue;
-
-        /* Remember the values before byteswap.
-           We need to reset 1st entry before
-           saving the page to the temptable. */
-        BKEYDATA *origdta = data;
-        db_indx_t origdlen = data->len;
-        if (F_ISSET(dbp, DB_AM_SWAP))
-            data->len = flibc_shortflip(data->len);
-        db_indx_t len;
-        ASSIGN_ALIGN(db_indx_t, len, data->len);
-        assert(((uint8_t *)data + len) < max);
-        if (bk_decompress(dbp, page, &data, pfxbuf, sizeof(pfxbuf)) != 0) {
-            logmsg(LOGMSG_ERROR,
-                   "\ndecompress failed page:%d indx:0 total:%d\n", page->pgno,
-                   n);
-            continue;
-        }
-        ASSIGN_ALIGN(db_indx_t, len, data->len);
-
-        /* Reset the 1st index and entry. */
-        inp[0] = originp;
-        origdta->len = origdlen;
-
-        /* Save the entire page:
-           key is the 1st key on the page;
-           data is the page itself. */
-        rc = bdb_temp_table_put(bdb_state->parent, sampler->tmptbl, data->data,
-                                len, page, pgsz, NULL, bdberr);
+        rc = summarize_save_leaf(bdb_state, sampler, dbp, page, n, bdberr);
         if (rc)
             goto done;
     }
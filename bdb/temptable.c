@@ -51,6 +51,7 @@
 #include "sys_wrap.h"
 #include "bdb_int.h"
 #include "strbuf.h"
+#include "thread_stats.h"
 
 extern int recover_deadlock_simple(bdb_state_type *bdb_state);
 
@@ -325,6 +326,16 @@ error:
     return rc;
 }
 
+/* Charge a spill of an in-memory temp table to the current request */
+static void temp_table_spill_stats(uint64_t bytes)
+{
+    if (!gbl_bb_berkdb_enable_thread_stats)
+        return;
+    struct berkdb_thread_stats *t = bb_berkdb_get_thread_stats();
+    t->n_temp_spills++;
+    t->temp_spill_bytes += bytes;
+}
+
 static int bdb_array_copy_to_temp_db(bdb_state_type *bdb_state,
                                      struct temp_table *tbl, int *bdberr)
 {
@@ -362,6 +373,7 @@ static int bdb_array_copy_to_temp_db(bdb_state_type *bdb_state,
         elem = &tbl->elements[ii];
         free(elem->key);
     }
+    temp_table_spill_stats(tbl->inmemsz);
     tbl->inmemsz = 0;
     tbl->num_mem_entries = nents;
 
@@ -401,6 +413,7 @@ static int bdb_hash_table_copy_to_temp_db(bdb_state_type *bdb_state,
     void *hash_cur;
     unsigned int hash_cur_buk;
     char *data;
+    uint64_t spilled = 0;
 
     if (tbl->dbenv_temp == NULL &&
         create_temp_db_env(bdb_state, tbl, bdberr) != 0) {
@@ -431,8 +444,10 @@ static int bdb_hash_table_copy_to_temp_db(bdb_state_type *bdb_state,
             logmsg(LOGMSG_ERROR, "%s:%d put rc %d\n", __FILE__, __LINE__, rc);
             return rc;
         }
+        spilled += keylen + datalen;
         data = hash_next(tbl->temp_hash_tbl, &hash_cur, &hash_cur_buk);
     }
+    temp_table_spill_stats(spilled);
 
     /* get rid of the hash */
     data = hash_first(tbl->temp_hash_tbl, &hash_cur, &hash_cur_buk);
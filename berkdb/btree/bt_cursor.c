@@ -3629,6 +3629,9 @@ __bam_c_next(dbc, initial_move, deleted_okay)
 				ACQUIRE_CUR(dbc, lock_mode, pgno, ret);
 				if (ret != 0)
 					return (ret);
+#if USE_BTPF
+				crsr_pf_fb(dbc);
+#endif
 			}
 			cp->indx = 0;
 
@@ -3702,8 +3705,6 @@ __bam_c_prev(dbc)
 	for (;;) {
 		/* If at the beginning of the page, move to a previous one. */
 		if (cp->indx == 0) {
-
-			crsr_pf_prv(dbc);
 			/* See comments in __bam_c_next. */
 			if (F_ISSET(dbc, DBC_PAGE_ORDER)) {
 				do {
@@ -3745,6 +3746,9 @@ __bam_c_prev(dbc)
 				ACQUIRE_CUR(dbc, lock_mode, pgno, ret);
 				if (ret != 0)
 					return (ret);
+#if USE_BTPF
+				crsr_pf_fb(dbc);
+#endif
 			}
 
 			if ((cp->indx = NUM_ENT(cp->page)) == 0)
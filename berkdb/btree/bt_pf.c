@@ -18,9 +18,13 @@
 
 #include "dbinc/btree.h"
 #include "logmsg.h"
+#include "comdb2_atomic.h"
+#include "thread_stats.h"
 
 extern struct thdpool *gbl_udppfault_thdpool;
 
+static btpf_counters counters;
+
 static inline int chk_forward(DBC *dbc);
 static inline int chk_backward(DBC *dbc);
 static inline int adj_wndw(DBC *dbc, btpf * f);
@@ -47,6 +51,11 @@ static inline int advance_on_tree(DBC *dbc);
 #define BTPF_DEBUG 0
 #define BTPF_SAME_THREAD 0
 
+#define QUEUE_FULL 3
+
+#define BTPF_OVFL_ITEMS 64	/* overflow items read ahead per leaf */
+#define BTPF_OVFL_CHAIN 64	/* pages read ahead per overflow item */
+
 #define TEST_STOP(dbc) {                                                             \
     if (!BTPF_ENABLED(dbc) || PFX(dbc)->curlf[MIN_TH(dbc)] == PGNO_INVALID)           \
     {                                                                                \
@@ -112,6 +121,7 @@ btpf_free_job(btpf_job ** x)
 			free((*x)->rkey->data);
 		free((*x)->rkey);
 	}
+	btpf_free(&(*x)->pf);
 	free(*x);
 	*x = NULL;
 }
@@ -149,11 +159,58 @@ btpf_rst(btpf * x)
 	x->rdr_rec_cnt = 0;
 	x->rdr_pg_cnt = 0;
 	x->wndw = 0;
+	x->ahead = 0;
+	x->behind = x->useful = x->resident = 0;
 	x->tr_page = PGNO_INVALID;
 	x->on = PF_ON;
 	// TODO update stats
 }
 
+void
+btpf_get_counters(btpf_counters *c)
+{
+	c->windows = counters.windows;
+	c->pages = counters.pages;
+	c->ovfl_pages = counters.ovfl_pages;
+	c->grows = counters.grows;
+	c->shrinks = counters.shrinks;
+}
+
+/* Snapshot the thread's buffer pool counters before a leaf step */
+static inline void
+fb_mark(btpf * f)
+{
+	struct berkdb_thread_stats *t = bb_berkdb_get_thread_stats();
+
+	f->fb_misses = t->n_cache_misses;
+	f->fb_waits = t->n_pf_waits;
+	f->fb_hits = t->n_pf_hits;
+}
+
+/*
+ * crsr_pf_fb --
+ *	Called once the cursor holds the next leaf: classify how it got it,
+ *	for adj_wndw().  A read from disk, or a wait on a prefault still in
+ *	flight, means the window is too short; a prefaulted page means it
+ *	helped; a page that was cached anyway means it was not needed.
+ */
+void
+crsr_pf_fb(DBC *dbc)
+{
+	btpf *f = PFX(dbc);
+	struct berkdb_thread_stats *t;
+
+	if (!f || f->status != PF || !ADAPTIVE(dbc))
+		return;
+	t = bb_berkdb_get_thread_stats();
+	if (t->n_cache_misses != f->fb_misses || t->n_pf_waits != f->fb_waits)
+		f->behind++;
+	else if (t->n_pf_hits != f->fb_hits)
+		f->useful++;
+	else
+		f->resident++;
+}
+
 static inline void
 btpf_cnt_rst(btpf * pf)
 {
@@ -236,6 +293,7 @@ crsr_pf_nxt(DBC *dbc)
 		PFX(dbc)->rdr_rec_cnt++;
 		ret = chk_forward(dbc);
 	}
+	fb_mark(PFX(dbc));
 #if BTPF_DEBUG 
 	fprintf(stderr, "Moving to next page ");
 	btpf_fprintf(stderr, PFX(dbc));
@@ -268,6 +326,7 @@ crsr_pf_prv(DBC *dbc)
 		PFX(dbc)->rdr_rec_cnt++;
 		ret = chk_backward(dbc);
 	}
+	fb_mark(PFX(dbc));
 #if BTPF_DEBUG 
 	fprintf(stderr, "Moving to previous page");
 	btpf_fprintf(stderr, PFX(dbc));
@@ -278,10 +337,23 @@ crsr_pf_prv(DBC *dbc)
 int
 crsr_jump(DBC *dbc)
 {
-	if (!PFX(dbc))
+	btpf *f = PFX(dbc);
+
+	if (!f)
 		return 0;
+	/*
+	 * The cursor left a window it read less than half of: the rest was
+	 * wasted, so the next scan starts from a narrower one.
+	 */
+	if (ADAPTIVE(dbc) && f->status == PF && f->rdr_pg_cnt * 2 < f->wndw &&
+	    f->wndw_hint > WNDW_MIN(dbc)) {
+		f->wndw_hint /= WNDW_INC(dbc) > 1 ? WNDW_INC(dbc) : 2;
+		if (f->wndw_hint < WNDW_MIN(dbc))
+			f->wndw_hint = WNDW_MIN(dbc);
+		ATOMIC_ADD64(counters.shrinks, 1);
+	}
 	TEST_STOP(dbc)
-	    btpf_rst(PFX(dbc));
+	    btpf_rst(f);
 
 	return (0);
 }
@@ -309,6 +381,8 @@ chk_forward(DBC *dbc)
 		fetch |= ((NUM_ENT(cp->page) - cp->indx) / P_INDX)
 			< PG_GAP(dbc);
 	if (fetch) {  
+		f->ahead = (f->status == PF && f->wndw > f->rdr_pg_cnt) ?
+		    f->wndw - f->rdr_pg_cnt : 0;
 		adj_wndw(dbc, f);
 		start_loading(dbc);
 		f->status = PF;
@@ -340,6 +414,8 @@ chk_backward(DBC *dbc)
 		fetch |= (cp->indx / P_INDX) < PG_GAP(dbc);
 	if (fetch)
 	{   
+		f->ahead = (f->status == PF && f->wndw > f->rdr_pg_cnt) ?
+		    f->wndw - f->rdr_pg_cnt : 0;
 		adj_wndw(dbc,f);
 		start_loading(dbc);
 		f->status = PF;
@@ -348,15 +424,39 @@ chk_backward(DBC *dbc)
 	return rst;
 }
 
+/*
+ * adj_wndw --
+ *	Size the next window.  Without btpf_adaptive, or with thread stats
+ *	off, it starts at btpf_wndw_min and grows by btpf_wndw_inc every
+ *	time.  Otherwise the window starts where the cursor's last scan left
+ *	it and follows the leaf steps counted by crsr_pf_fb() since the
+ *	previous window.
+ */
 static inline int
 adj_wndw(DBC *dbc, btpf * f)
 {
+	u_int32_t inc = WNDW_INC(dbc) > 1 ? WNDW_INC(dbc) : 2;
+	u_int32_t old = f->wndw;
+
 	if (f->wndw == 0) {
-		f->wndw = WNDW_MIN(dbc);
-	} else {
+		f->wndw = (ADAPTIVE(dbc) && f->wndw_hint) ? f->wndw_hint : WNDW_MIN(dbc);
+	} else if (!ADAPTIVE(dbc)) {
 		f->wndw *=  WNDW_INC(dbc);
-		f->wndw = f->wndw > WNDW_MAX(dbc) ? WNDW_MAX(dbc) : f->wndw;
+	} else if (f->behind > f->useful) {
+		f->wndw *= inc;
+	} else if (f->resident > f->useful + f->behind) {
+		f->wndw /= inc;
 	}
+	f->wndw = f->wndw > WNDW_MAX(dbc) ? WNDW_MAX(dbc) : f->wndw;
+	f->wndw = f->wndw < WNDW_MIN(dbc) ? WNDW_MIN(dbc) : f->wndw;
+
+	if (old && f->wndw > old)
+		ATOMIC_ADD64(counters.grows, 1);
+	else if (old && f->wndw < old)
+		ATOMIC_ADD64(counters.shrinks, 1);
+	if (ADAPTIVE(dbc))
+		f->wndw_hint = f->wndw;
+	f->behind = f->useful = f->resident = 0;
 #if BTPF_DEBUG 
 	fprintf(stderr, "Adapting window to %d\n", f->wndw);
 #endif
@@ -423,6 +523,7 @@ start_loading(DBC *dbc)
 	btpf_copy(PFX(dbc), PFX(job));
 	read_key(dbc, job);
 	job->npages = PFX(dbc)->wndw;
+	job->skip = PFX(dbc)->ahead;
 	job->mpf = dbc->dbp->mpf;
 	job->db = dbc->dbp;
 	job->dirty = PFX(dbc)->status == PF || PFX(dbc)->status == LOADED_ALL;	// TODO it cannot be on LOADED_ALL when it runs asynchronously
@@ -433,7 +534,11 @@ start_loading(DBC *dbc)
 #else
 	rc = thdpool_enqueue(gbl_udppfault_thdpool, start_loading_async_pp, job,
 	    0, NULL, 0);
+	if (rc)
+		btpf_free_job(&job);
 #endif
+	if (!rc)
+		ATOMIC_ADD64(counters.windows, 1);
 	return rc;
 }
 
@@ -471,14 +576,17 @@ start_loading_async_cb(btpf_job * job)
 
 	dbc->rkey = job->rkey;
 	if (job->dirty) {
-		if ((rc = tree_walk(dbc, SRCH_CUR, 1, RMBR_LVL)) != 0)
+		if ((rc = tree_walk(dbc, SRCH_CUR, 1, RMBR_LVL)) != 0) {
+			(void)__db_c_close(dbc);
 			return;
+		}
 	} else {
 		btpf_copy(PFX(job), PFX(dbc));
 	}
 
 	PFX(dbc)->direction = job->pf->direction;
 	PFX(dbc)->wndw = job->npages;
+	PFX(dbc)->ahead = job->skip;
 
 #if BTPF_DEBUG 
 	fprintf(stderr, "Found rec in page: %d \n", PFX(dbc)->curlf[0]);
@@ -620,6 +728,109 @@ end:
 }
 
 
+typedef struct {
+	DB *db;
+	db_pgno_t pgno;
+} btpf_leaf;
+
+static void
+touch_ovfl(DB_MPOOLFILE *mpf, db_pgno_t pgno)
+{
+	PAGE *h;
+	int n;
+
+	for (n = 0; n < BTPF_OVFL_CHAIN && pgno != PGNO_INVALID; n++) {
+		if (__memp_fget(mpf, &pgno, DB_MPOOL_PFGET, &h) != 0)
+			return;
+		if (TYPE(h) != P_OVERFLOW) {
+			(void)__memp_fput(mpf, h, DB_MPOOL_PFPUT);
+			return;
+		}
+		pgno = NEXT_PGNO(h);
+		(void)__memp_fput(mpf, h, DB_MPOOL_PFPUT);
+		ATOMIC_ADD64(counters.ovfl_pages, 1);
+	}
+}
+
+/*
+ * touch_leaf --
+ *	Prefault a leaf, then the overflow chains of its items.  The leaf
+ *	is not locked, so what is read off it is only a hint: offsets are
+ *	bounds checked here and page types checked as the chains are read.
+ */
+static void
+touch_leaf(DB *dbp, db_pgno_t pgno)
+{
+	DB_MPOOLFILE *mpf = dbp->mpf;
+	db_pgno_t chains[BTPF_OVFL_ITEMS];
+	BOVERFLOW *bo;
+	db_indx_t *inp;
+	PAGE *h;
+	u_int32_t i, n = 0;
+
+	if (__memp_fget(mpf, &pgno, DB_MPOOL_PFGET, &h) != 0)
+		return;
+	if (TYPE(h) == P_LBTREE) {
+		inp = P_INP(dbp, h);
+		for (i = 0; i < NUM_ENT(h) && n < BTPF_OVFL_ITEMS &&
+		    (u_int8_t *)&inp[i + 1] <= (u_int8_t *)h + dbp->pgsize; i++) {
+			if (inp[i] < HOFFSET(h) ||
+			    inp[i] > dbp->pgsize - BOVERFLOW_SIZE)
+				continue;
+			bo = (BOVERFLOW *)((u_int8_t *)h + inp[i]);
+			if (B_TYPE(bo) == B_OVERFLOW)
+				chains[n++] = bo->pgno;
+		}
+	}
+	(void)__memp_fput(mpf, h, DB_MPOOL_PFPUT);
+
+	for (i = 0; i < n; i++)
+		touch_ovfl(mpf, chains[i]);
+}
+
+static void
+touch_leaf_pp(struct thdpool *pool, void *work, void *thddata, int op)
+{
+	btpf_leaf *leaf = (btpf_leaf *) work;
+
+	switch (op) {
+	case THD_RUN:
+		touch_leaf(leaf->db, leaf->pgno);
+		break;
+	}
+	free(leaf);
+}
+
+static inline int
+load_leaf(DBC *dbc, db_pgno_t pgno)
+{
+	btpf_leaf *leaf;
+	int rc;
+
+	if (!PF_OVFL(dbc)) {
+		rc = LOAD(dbc->dbp->mpf, pgno);
+	} else if ((leaf = malloc(sizeof(btpf_leaf))) == NULL) {
+		rc = ENOMEM;
+	} else {
+		leaf->db = dbc->dbp;
+		leaf->pgno = pgno;
+		rc = thdpool_enqueue(gbl_udppfault_thdpool, touch_leaf_pp, leaf,
+		    0, NULL, 0);
+		if (rc)
+			free(leaf);
+	}
+	if (rc)
+		return QUEUE_FULL;
+	ATOMIC_ADD64(counters.pages, 1);
+	return 0;
+}
+
+/*
+ * page_load_f / page_load_b --
+ *	Walk the leaves past the cursor through their parents and prefault
+ *	the pf->wndw that follow the pf->ahead already requested by the
+ *	previous window.
+ */
 static inline int
 page_load_f(btpf * pf, DBC *dbc)
 {
@@ -632,9 +843,10 @@ page_load_f(btpf * pf, DBC *dbc)
 	db_pgno_t t_pgno;
 	db_lockmode_t lock_mode = DB_LOCK_READ;
 	int ret = 0;
-	db_indx_t p_cnt = 0;
-	db_indx_t c = 0;
-	db_indx_t i;
+	u_int32_t target = pf->wndw + pf->ahead;
+	u_int32_t p_cnt = 0;
+	u_int32_t c = 0;
+	u_int32_t i;
 
 	while (1) {
 		if ((ret = advance_on_tree(dbc)) != 0)
@@ -654,16 +866,18 @@ page_load_f(btpf * pf, DBC *dbc)
 		}
         
 		p_cnt = pf->maxindx[1] - pf->curindx[1];
-		p_cnt = p_cnt > pf->wndw - c ? pf->wndw - c : p_cnt;
+		p_cnt = p_cnt > target - c ? target - c : p_cnt;
 
 		for (i = 0; i < p_cnt; i++)
 		{
+			if (c + i < pf->ahead)
+				continue;
 			t_pgno = GET_BINTERNAL(dbp, h, pf->curindx[1] + i)->pgno;
 #if BTPF_DEBUG  
 			fprintf(stderr, "LOADING: %u from:%u indx:%d of:%d real:%d\n", t_pgno, pgno, pf->curindx[1] + i, pf->maxindx[1], h->entries );
 #endif
-			LOAD(mpf, t_pgno);
-
+			if ((ret = load_leaf(dbc, t_pgno)) != 0)
+				break;
 		}
 
 		c += p_cnt;
@@ -671,11 +885,14 @@ page_load_f(btpf * pf, DBC *dbc)
 		PAGEPUT(dbc, mpf, h, 0);
 		(void)__LPUT(dbc, lock);
 
-		if (c >= pf->wndw)
+		if (ret != 0)
+			goto end;
+		if (c >= target)
 			break;
 	}
 end:
-	if (ret > 0 && ret != END_OF_TREE && ret != DIFF_LSN)
+	if (ret > 0 && ret != END_OF_TREE && ret != DIFF_LSN &&
+	    ret != QUEUE_FULL)
 		logmsg(LOGMSG_ERROR, "%s return code: %d \n", __func__, ret);
 #if BTPF_DEBUG
 	if (ret == DIFF_LSN)
@@ -714,8 +931,9 @@ page_load_b(btpf * pf, DBC *dbc)
 
 
 	int ret = 0;
+	u_int32_t target = pf->wndw + pf->ahead;
 	db_indx_t p_cnt = 0;
-	db_indx_t c = 0;
+	u_int32_t c = 0;
 	db_indx_t i;
 
 	while (1) {
@@ -735,7 +953,7 @@ page_load_b(btpf * pf, DBC *dbc)
 			goto end;
 		}
 
-		p_cnt = pf->curindx[1] > pf->wndw - c ? pf->curindx[1] - pf->wndw - c : 0;
+		p_cnt = pf->curindx[1] > target - c ? pf->curindx[1] - (target - c) : 0;
 		for (i = pf->curindx[1] ; i >= p_cnt ; i--) {
 			if (pf->maxindx[1] == 0)
 				break;
@@ -745,7 +963,9 @@ page_load_b(btpf * pf, DBC *dbc)
 #if BTPF_DEBUG  
 			fprintf(stderr, "LOADING: %u from:%u indx:%d of:%d real:%d\n", t_pgno, pgno, i, pf->maxindx[1], h->entries );
 #endif            
-			LOAD(mpf,t_pgno);
+			if (c + (pf->curindx[1] - i) >= pf->ahead &&
+			    (ret = load_leaf(dbc, t_pgno)) != 0)
+				break;
 
 			if (i == 0)
 				break; // it's an unsigned type it overflows and loop forever otherwise
@@ -757,11 +977,14 @@ page_load_b(btpf * pf, DBC *dbc)
 		PAGEPUT(dbc, mpf, h, 0);
 		(void)__LPUT(dbc, lock);  // release lock
 
-		if (c >= pf->wndw)
+		if (ret != 0)
+			goto end;
+		if (c >= target)
 			break;
 	}
 end:
-	if (ret > 0 && ret != END_OF_TREE && ret != DIFF_LSN)
+	if (ret > 0 && ret != END_OF_TREE && ret != DIFF_LSN &&
+	    ret != QUEUE_FULL)
 		logmsg(LOGMSG_ERROR, "%s return code: %d \n", __func__, ret);
 #if BTPF_DEBUG
 	if (ret == DIFF_LSN)
@@ -17,6 +17,9 @@
 #define WNDW_INC(dbc) dbc->dbp->dbenv->attr.btpf_wndw_inc
 #define WNDW_MAX(dbc) dbc->dbp->dbenv->attr.btpf_wndw_max
 #define MIN_TH(dbc)   dbc->dbp->dbenv->attr.btpf_min_th
+/* the feedback comes from the per thread buffer pool counters */
+#define ADAPTIVE(dbc) (dbc->dbp->dbenv->attr.btpf_adaptive && gbl_bb_berkdb_enable_thread_stats)
+#define PF_OVFL(dbc)  dbc->dbp->dbenv->attr.btpf_ovfl
 
 typedef enum {
 	INIT,
@@ -55,7 +58,18 @@ typedef struct {
 	u_int32_t   rdr_rec_cnt; // records read in the same direction
 	u_int32_t   rdr_pg_cnt; // pages read by the cursor to catch up
 	u_int32_t   wndw;
+	u_int32_t   wndw_hint; // window to start from, kept across resets
+	u_int32_t   ahead; // leaves already requested past the cursor
 	u_int32_t   on; // pre-faulting is on/off
+
+	// leaf steps since the last window: read from disk or waited on a
+	// prefault (behind), served by a prefault (useful), already cached
+	u_int32_t   behind;
+	u_int32_t   useful;
+	u_int32_t   resident;
+	u_int32_t   fb_misses; // thread counters before the current leaf step
+	u_int32_t   fb_waits;
+	u_int32_t   fb_hits;
    
 	db_pgno_t curlf[RMBR_LVL];	// the chain of pages to reach the cursor 
 	db_indx_t curindx[RMBR_LVL];	// current entry per level
@@ -72,6 +86,7 @@ typedef struct {
 	DB *db;
 	DB_MPOOLFILE *mpf;
 	u_int32_t npages;
+	u_int32_t skip; // leaves past the cursor requested by the last window
 	u_int8_t dirty;
 	btpf *pf;
 	u_int32_t lid;
@@ -90,5 +105,6 @@ int crsr_nxt(DBC *dbc);
 int crsr_prv(DBC *dbc);
 int crsr_pf_nxt(DBC *dbc);
 int crsr_pf_prv(DBC *dbc);
+void crsr_pf_fb(DBC *dbc);
 int crsr_jump(DBC *dbc);
 #endif
@@ -877,6 +877,7 @@ struct __db_mpoolfile {
 	int (*get_priority) __P((DB_MPOOLFILE *, DB_CACHE_PRIORITY *));
 	int (*set_priority) __P((DB_MPOOLFILE *, DB_CACHE_PRIORITY));
 	int (*sync) __P((DB_MPOOLFILE *));
+	int (*get_stat) __P((DB_MPOOLFILE *, DB_MPOOL_FSTAT *));
 
 	/*
 	 * MP_FILEID_SET, MP_OPEN_CALLED and MP_READONLY do not need to be
@@ -913,6 +914,7 @@ struct __db_mpool_stat {
 	u_int64_t st_page_create;	/* Pages created in the cache. */
 	u_int64_t st_page_pf_in;	/* Pages read in by prefault */
 	u_int64_t st_page_pf_in_late;/* Unaffective prefault requests */
+	u_int64_t st_page_pf_hit;	/* Prefaulted pages later used */
 	u_int64_t st_page_in;		/* Pages read in. */
 	u_int64_t st_page_out;		/* Pages written out. */
 	u_int64_t st_ro_merges;		/* Read merges performed. */
@@ -921,7 +923,7 @@ struct __db_mpool_stat {
 	u_int64_t st_rw_evict;		/* Dirty pages forced from the cache. */
 	u_int64_t st_ro_levict;		/* Clean leaf pages forced from cache.*/
 	u_int64_t st_rw_levict;		/* Dirty leaf pages forced from cache.*/
-	u_int64_t st_pf_evict;		/* Prefault pages forced from  cache. */
+	u_int64_t st_pf_evict;		/* Prefault pages evicted unused. */
 	u_int64_t st_rw_evict_skip;	/* Dirty pages skipped during evict. */
 	u_int64_t st_page_trickle;	/* Pages written by memp_trickle. */
 	u_int64_t st_pages;		/* Total number of pages. */
@@ -961,6 +963,9 @@ struct __db_mpool_fstat {
 	u_int64_t st_page_out;		/* Pages written out. */
 	u_int64_t st_ro_merges;		/* Read merges performed. */
 	u_int64_t st_rw_merges;		/* Write merges performed. */
+	u_int64_t st_evict;		/* Pages forced from the cache. */
+	u_int32_t st_page_dirty;	/* Dirty pages in the cache. */
+	u_int32_t st_pages;		/* Pages in the cache (filled by get_stat). */
 };
 
 /*******************************************************
@@ -3129,8 +3134,9 @@ void bb_berkdb_thread_stats_init(void);
 void bb_berkdb_thread_stats_reset(void);
 
 /* counts[] for _get()/_foreach(): (total, disk-I/O subset) pairs for
- * [0][1] SQL execution, [2][3] master write-apply, [4][5] replicant apply. */
-#define BB_BERKDB_FP_RTSTATS_NCOUNTS 6
+ * [0][1] SQL execution, [2][3] master write-apply, [4][5] replicant apply;
+ * [6] log bytes written by master write-apply. */
+#define BB_BERKDB_FP_RTSTATS_NCOUNTS 7
 
 void bb_berkdb_fingerprint_rtstats_init(void);
 void bb_berkdb_fingerprint_rtstats_set(const unsigned char *fingerprint, size_t fplen, int has_main_entry);
@@ -3138,6 +3144,7 @@ void bb_berkdb_fingerprint_rtstats_set_write(const unsigned char *fingerprint, s
 void bb_berkdb_fingerprint_rtstats_set_apply(const unsigned char *fingerprint, size_t fplen, int has_main_entry);
 void bb_berkdb_fingerprint_rtstats_clear(void);
 void bb_berkdb_fingerprint_rtstats_bump_pagein(int did_io);
+void bb_berkdb_fingerprint_rtstats_bump_logbytes(uint64_t bytes);
 int bb_berkdb_fingerprint_rtstats_get(const unsigned char *fingerprint, size_t fplen,
     uint64_t counts[BB_BERKDB_FP_RTSTATS_NCOUNTS]);
 typedef void (*bb_berkdb_fingerprint_rtstats_enum_fn)(const unsigned char *fingerprint,
@@ -3343,6 +3350,17 @@ typedef struct {
 int enqueue_touch_page(DB_MPOOLFILE *mpf, db_pgno_t pgno);
 void touch_page(DB_MPOOLFILE *mpf, db_pgno_t pgno);
 
+/* Btree cursor read ahead (bt_pf.c) */
+typedef struct {
+	u_int64_t windows;	/* read ahead windows issued */
+	u_int64_t pages;	/* leaf pages requested */
+	u_int64_t ovfl_pages;	/* overflow pages requested */
+	u_int64_t grows;	/* windows widened: the cursor caught up */
+	u_int64_t shrinks;	/* windows narrowed: pages already cached */
+} btpf_counters;
+
+void btpf_get_counters(btpf_counters *c);
+
 //#############################################
 #if defined(__cplusplus)
 }
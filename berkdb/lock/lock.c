@@ -42,6 +42,7 @@ static const char revid[] = "$Id: lock.c,v 11.134 2003/11/18 21:30:38 ubell Exp
 #include "util.h"
 #include "sys_wrap.h"
 #include "thread_stats.h"
+#include "wait_events.h"
 #include "tohex.h"
 #include "txn_properties.h"
 
@@ -2190,7 +2191,7 @@ __lock_get_internal_int(lt, locker, in_locker, flags, obj, lock_mode, timeout,
 	u_int32_t holder, obj_ndx, ihold, *holdarr = NULL, holdix, holdsz;
 	extern int gbl_lock_get_verbose_waiter;
 	int verbose_waiter = gbl_lock_get_verbose_waiter;;
-	int grant_dirty, no_dd, ret, t_ret;
+	int grant_dirty, no_dd, ret, t_ret, wait_prev;
 	extern int gbl_locks_check_waiters;
 
 	/*
@@ -2941,7 +2942,9 @@ upgrade:
 		if (gbl_bb_berkdb_enable_lock_timing) {
 			x1 = bb_berkdb_fasttime();
 		}
+		wait_prev = wait_event_begin(WAIT_EVENT_LOCK);
 		MUTEX_LOCK(dbenv, &newl->mutex);
+		wait_event_end(wait_prev);
 
 		if (gbl_bb_berkdb_enable_thread_stats) {
 			struct berkdb_thread_stats *t;
@@ -44,7 +44,9 @@ static const char revid[] = "$Id: log_put.c,v 11.145 2003/09/13 19:20:39 bostic
 #include <netinet/in.h>
 
 #include "logmsg.h"
+#include "thread_stats.h"
 #include <sys_wrap.h>
+#include <wait_events.h>
 #include <poll.h>
 
 extern unsigned long long get_commit_context(const void *, uint32_t generation);
@@ -502,9 +504,14 @@ __log_put_int(dbenv, lsnp, contextp, udbt, flags, off_context, usr_ptr)
 logput:
 	rc = __log_put_int_int(dbenv, lsnp, contextp, udbt, flags,
 		off_context, usr_ptr);
-	if (rc == 0 && txn_logbytes != NULL) {
+	if (rc == 0) {
 		total_written += udbt->size;
-		*txn_logbytes += total_written;
+		if (gbl_bb_berkdb_enable_thread_stats) {
+			bb_berkdb_get_thread_stats()->log_bytes += total_written;
+			bb_berkdb_fingerprint_rtstats_bump_logbytes(total_written);
+		}
+		if (txn_logbytes != NULL)
+			*txn_logbytes += total_written;
 	}
 	return rc;
 }
@@ -1358,7 +1365,7 @@ __log_flush_int(dblp, lsnp, release)
 	DB_MUTEX *flush_mutexp;
 	LOG *lp;
 	u_int32_t ncommit, w_off, listcnt;
-	int do_flush, first, ret, wrote_inmem;
+	int do_flush, first, ret, wrote_inmem, wait_prev;
 
 	dbenv = dblp->dbenv;
 	lp = dblp->reginfo.primary;
@@ -1585,7 +1592,10 @@ flush:	MUTEX_LOCK(dbenv, flush_mutexp);
 		R_UNLOCK(dbenv, &dblp->reginfo);
 
 	/* Sync all writes to disk. */
-	if ((ret = __os_fsync(dbenv, dblp->lfhp)) != 0) {
+	wait_prev = wait_event_begin(WAIT_EVENT_LOG_FLUSH);
+	ret = __os_fsync(dbenv, dblp->lfhp);
+	wait_event_end(wait_prev);
+	if (ret != 0) {
 		MUTEX_UNLOCK(dbenv, flush_mutexp);
 		if (release)
 			R_LOCK(dbenv, &dblp->reginfo);
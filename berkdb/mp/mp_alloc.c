@@ -527,10 +527,12 @@ found:		if (offsetp != NULL)
 			--bhp->ref;
 			if (ret == 0) {
 				++c_mp->stat.st_rw_evict;
+				++bh_mfp->stat.st_evict;
 				if(ISLEAF(bhp->buf)) ++c_mp->stat.st_rw_levict;
 			}
 		} else {
 			++c_mp->stat.st_ro_evict;
+			++bh_mfp->stat.st_evict;
 			if(ISLEAF(bhp->buf)) ++c_mp->stat.st_ro_levict;
 		}
 
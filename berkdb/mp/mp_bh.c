@@ -381,6 +381,7 @@ __memp_recover_page(dbmfp, hp, bhp, pgno)
 
 	ATOMIC_ADD32(hp->hash_page_dirty, 1);
 	ATOMIC_ADD32(c_mp->stat.st_page_dirty, 1);
+	ATOMIC_ADD32(bhp->mpf->stat.st_page_dirty, 1);
 	F_SET(bhp, BH_DIRTY);
 	F_CLR(bhp, BH_TRASH);
 
@@ -1037,6 +1038,7 @@ file_dead:
 			c_mp = dbmp->reginfo[n_cache].primary;
 			ATOMIC_ADD32(hp->hash_page_dirty, -1);
 			ATOMIC_ADD32(c_mp->stat.st_page_dirty, -1);
+			ATOMIC_ADD32(bhp->mpf->stat.st_page_dirty, -1);
 
 			if (dbenv->tx_perfect_ckp) {
 				/* Clear first_dirty_lsn. */
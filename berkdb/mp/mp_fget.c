@@ -44,6 +44,8 @@ static const char revid[] = "$Id: mp_fget.c,v 11.81 2003/09/25 02:15:16 sue Exp
 #include "thrman.h"
 #include "thread_util.h"
 #include "thread_stats.h"
+#include "wait_events.h"
+#include "perf.h"
 
 
 struct bdb_state_tag;
@@ -411,6 +413,20 @@ retry:	st_hsearch = 0;
 
         if (LF_ISSET(DB_MPOOL_PFGET))
             ++c_mp->stat.st_page_pf_in_late;
+		else if (F_ISSET(bhp, BH_PREFAULT)) {
+			/*
+			 * First real use of a prefaulted page: it is no longer
+			 * a prefault, and evicting it later is not a waste.
+			 * first is clear if we waited on the prefault read.
+			 */
+			F_CLR(bhp, BH_PREFAULT);
+			++c_mp->stat.st_page_pf_hit;
+			if (gbl_bb_berkdb_enable_thread_stats) {
+				bb_berkdb_get_thread_stats()->n_pf_hits++;
+				if (!first)
+					bb_berkdb_get_thread_stats()->n_pf_waits++;
+			}
+		}
 
 		break;
 	}
@@ -677,6 +693,7 @@ alloc:		/*
 		if (extending) {
 			ATOMIC_ADD32(hp->hash_page_dirty, 1);
 			ATOMIC_ADD32(c_mp->stat.st_page_dirty, 1);
+			ATOMIC_ADD32(bhp->mpf->stat.st_page_dirty, 1);
 			F_SET(bhp, BH_DIRTY | BH_DIRTY_CREATE);
 			if (dbenv->tx_perfect_ckp) {
 				/* Set page first-dirty-LSN to not logged */
@@ -731,6 +748,8 @@ alloc:		/*
 
 			F_SET(bhp, BH_TRASH);
 			++mfp->stat.st_cache_miss;
+			if (gbl_bb_berkdb_enable_thread_stats)
+				bb_berkdb_get_thread_stats()->n_cache_misses++;
 			if (LF_ISSET(DB_MPOOL_PFGET)) {
 				++c_mp->stat.st_page_pf_in;
                 
@@ -808,10 +827,14 @@ alloc:		/*
 
 
 	if (F_ISSET(bhp, BH_TRASH)) {
-		if ((ret = __memp_pgread(dbmfp,
-				hp, bhp,
-			    LF_ISSET(DB_MPOOL_CREATE) ? 1 : 0,
-			    is_recovery_page)) != 0)
+		int wait_prev = wait_event_begin(WAIT_EVENT_MPOOL_READ);
+		uint64_t read_start = bb_berkdb_fasttime();
+		ret = __memp_pgread(dbmfp, hp, bhp,
+		    LF_ISSET(DB_MPOOL_CREATE) ? 1 : 0, is_recovery_page);
+		latency_hist_add(LATENCY_PAGE_READ,
+		    bb_berkdb_fasttime() - read_start);
+		wait_event_end(wait_prev);
+		if (ret != 0)
 			 goto err;
 
 		if (state == SECOND_MISS) {
@@ -48,6 +48,8 @@ struct fingerprint_rtstats {
 	uint64_t n_apply_pagein_read;    /* same, on a replicant redoing this
 				    * fingerprint's writes from the log */
 	uint64_t n_apply_pagein_read_io; /* subset that required a disk read */
+	uint64_t n_write_log_bytes;      /* log bytes written while the master
+				    * applies this fingerprint's writes */
 	int has_main_entry;        /* did gbl_fingerprint_hash have this
 				    * fingerprint when the entry was created?
 				    * Diagnostic only, and never refreshed --
@@ -217,6 +219,26 @@ bb_berkdb_fingerprint_rtstats_bump_pagein(int did_io)
 	}
 }
 
+/*
+ * Called from __log_put_int() for every record written. Only write-apply on
+ * the master is attributed; SQL threads charge their own log writes through
+ * the per-thread berkdb stats instead.
+ */
+void
+bb_berkdb_fingerprint_rtstats_bump_logbytes(uint64_t bytes)
+{
+	struct fingerprint_rtstats *t;
+
+	if (!fingerprint_rtstats_inited)
+		return;
+	/* most threads have no entry armed; check that first */
+	if ((t = pthread_getspecific(fingerprint_rtstats_key)) == NULL)
+		return;
+	if ((int)(intptr_t)pthread_getspecific(fingerprint_rtstats_mode_key) != FP_RTSTATS_MODE_WRITE)
+		return;
+	ATOMIC_ADD64(t->n_write_log_bytes, bytes);
+}
+
 /* Writers bump these locklessly with ATOMIC_ADD64, so load them the same way. */
 static void
 fingerprint_rtstats_load_counts(const struct fingerprint_rtstats *t,
@@ -228,6 +250,7 @@ fingerprint_rtstats_load_counts(const struct fingerprint_rtstats *t,
 	counts[3] = ATOMIC_LOAD64(t->n_write_pagein_read_io);
 	counts[4] = ATOMIC_LOAD64(t->n_apply_pagein_read);
 	counts[5] = ATOMIC_LOAD64(t->n_apply_pagein_read_io);
+	counts[6] = ATOMIC_LOAD64(t->n_write_log_bytes);
 }
 
 /*
@@ -163,6 +163,7 @@ __memp_fcreate(dbenv, retp)
 		dbmfp->put = __memp_fput_pp;
 		dbmfp->set = __memp_fset_pp;
 		dbmfp->sync = __memp_fsync_pp;
+		dbmfp->get_stat = __memp_get_stat;
 	}
 	dbmfp->close = __memp_fclose_pp;
 
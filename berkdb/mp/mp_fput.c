@@ -160,11 +160,13 @@ __memp_fput_internal(dbmfp, pgaddr, flags, pgorder)
 		DB_ASSERT(hp->hash_page_dirty != 0);
 		ATOMIC_ADD32(hp->hash_page_dirty, -1);
 		ATOMIC_ADD32(c_mp->stat.st_page_dirty, -1);
+		ATOMIC_ADD32(bhp->mpf->stat.st_page_dirty, -1);
 		F_CLR(bhp, BH_DIRTY);
 	}
 	if (LF_ISSET(DB_MPOOL_DIRTY) && !F_ISSET(bhp, BH_DIRTY)) {
 		ATOMIC_ADD32(hp->hash_page_dirty, 1);
 		ATOMIC_ADD32(c_mp->stat.st_page_dirty, 1);
+		ATOMIC_ADD32(bhp->mpf->stat.st_page_dirty, 1);
 		F_SET(bhp, BH_DIRTY);
 		/* Update first_dirty_lsn when flag goes from CLEAN to DIRTY. */
 		if (dbenv->tx_perfect_ckp)
@@ -66,6 +66,49 @@ __memp_stat_pp(dbenv, gspp, fspp, flags)
 	return (ret);
 }
 
+/*
+ * __memp_fstat_clear --
+ *	Reset a file's counters, keeping the fields that describe the
+ *	current state of the cache rather than a count of events.
+ */
+static void
+__memp_fstat_clear(mfp)
+	MPOOLFILE *mfp;
+{
+	size_t pagesize;
+	u_int32_t dirty;
+
+	pagesize = mfp->stat.st_pagesize;
+	dirty = mfp->stat.st_page_dirty;
+	memset(&mfp->stat, 0, sizeof(mfp->stat));
+	mfp->stat.st_pagesize = pagesize;
+	mfp->stat.st_page_dirty = dirty;
+}
+
+/*
+ * __memp_get_stat --
+ *	DB_MPOOLFILE->get_stat.  Copy out the counters for a single file
+ *	without walking the file list or the buffer pool.  Like the
+ *	region-wide stats, the counters are read without locking.
+ *
+ * PUBLIC: int __memp_get_stat __P((DB_MPOOLFILE *, DB_MPOOL_FSTAT *));
+ */
+int
+__memp_get_stat(dbmfp, fsp)
+	DB_MPOOLFILE *dbmfp;
+	DB_MPOOL_FSTAT *fsp;
+{
+	MPOOLFILE *mfp;
+
+	if ((mfp = dbmfp->mfp) == NULL)
+		return (EINVAL);
+
+	*fsp = mfp->stat;
+	fsp->file_name = NULL;
+	fsp->st_pages = mfp->block_cnt;
+	return (0);
+}
+
 /*
  * __memp_stat --
  *	DB_ENV->memp_stat.
@@ -82,7 +125,7 @@ __memp_stat(dbenv, gspp, fspp, flags)
 	DB_MPOOL_STAT *sp;
 	MPOOL *c_mp, *mp;
 	MPOOLFILE *mfp;
-	size_t len, nlen, pagesize;
+	size_t len, nlen;
 	u_int32_t pages, dtmp, i;
 	int ret;
 	char *name, *tname;
@@ -125,6 +168,8 @@ __memp_stat(dbenv, gspp, fspp, flags)
 			sp->st_page_create += c_mp->stat.st_page_create;
 			sp->st_page_pf_in += c_mp->stat.st_page_pf_in;
             sp->st_page_pf_in_late += c_mp->stat.st_page_pf_in_late;
+			sp->st_page_pf_hit += c_mp->stat.st_page_pf_hit;
+			sp->st_pf_evict += c_mp->stat.st_pf_evict;
             sp->st_page_in += c_mp->stat.st_page_in;
 			sp->st_page_out += c_mp->stat.st_page_out;
 			sp->st_ro_merges += c_mp->stat.st_ro_merges;
@@ -135,7 +180,6 @@ __memp_stat(dbenv, gspp, fspp, flags)
 			sp->st_rw_evict += c_mp->stat.st_rw_evict;
 			sp->st_ro_levict += c_mp->stat.st_ro_levict;
 			sp->st_rw_levict += c_mp->stat.st_rw_levict;
-			sp->st_pf_evict += c_mp->stat.st_pf_evict;
 			sp->st_rw_evict_skip += c_mp->stat.st_rw_evict_skip;
 			sp->st_page_trickle += c_mp->stat.st_page_trickle;
 			sp->st_pages += c_mp->stat.st_pages;
@@ -209,11 +253,8 @@ __memp_stat(dbenv, gspp, fspp, flags)
 			sp->st_page_out += mfp->stat.st_page_out;
 			sp->st_ro_merges += mfp->stat.st_ro_merges;
 			sp->st_rw_merges += mfp->stat.st_rw_merges;
-			if (fspp == NULL && LF_ISSET(DB_STAT_CLEAR)) {
-				pagesize = mfp->stat.st_pagesize;
-				memset(&mfp->stat, 0, sizeof(mfp->stat));
-				mfp->stat.st_pagesize = pagesize;
-			}
+			if (fspp == NULL && LF_ISSET(DB_STAT_CLEAR))
+				__memp_fstat_clear(mfp);
 		}
 		R_UNLOCK(dbenv, dbmp->reginfo);
 	}
@@ -271,11 +312,8 @@ __memp_stat(dbenv, gspp, fspp, flags)
 			nlen = strlen(name) + 1;
 			*tfsp = tstruct;
 			*tstruct = mfp->stat;
-			if (LF_ISSET(DB_STAT_CLEAR)) {
-				pagesize = mfp->stat.st_pagesize;
-				memset(&mfp->stat, 0, sizeof(mfp->stat));
-				mfp->stat.st_pagesize = pagesize;
-			}
+			if (LF_ISSET(DB_STAT_CLEAR))
+				__memp_fstat_clear(mfp);
 			tstruct->file_name = tname;
 			memcpy(tname, name, nlen);
 		}
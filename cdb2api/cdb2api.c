@@ -8793,6 +8793,11 @@ int cdb2_is_ssl_encrypted(cdb2_hndl_tp *hndl)
     return hndl->sb == NULL ? 0 : sslio_has_ssl(hndl->sb);
 }
 
+int cdb2_in_transaction(cdb2_hndl_tp *hndl)
+{
+    return hndl->in_trans;
+}
+
 #ifdef CDB2API_SERVER
 void cdb2_setIdentityBlob(cdb2_hndl_tp *hndl, void *id)
 {
@@ -328,6 +328,8 @@ void cdb2_identity_destroy(int is_task_exit);
 int cdb2_identity_valid();
 int cdb2_init_ssl(int init_libssl, int init_libcrypto);
 int cdb2_is_ssl_encrypted(cdb2_hndl_tp *hndl);
+/* 1 between a successful begin and the commit or rollback that ends it */
+int cdb2_in_transaction(cdb2_hndl_tp *hndl);
 
 char *cdb2_string_escape(cdb2_hndl_tp *hndl, const char *str);
 
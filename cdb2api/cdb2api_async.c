@@ -0,0 +1,649 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/*
+ * Logical handles are multiplexed onto a bounded set of physical handles
+ * ("conns") per pool.  Each conn is owned by one lane thread which is the
+ * only thread that ever performs I/O on it, so a pool of N conns costs N fds
+ * and N threads regardless of how many logical handles are open.
+ *
+ * A logical handle is bound to a conn from the first statement until its
+ * result set is drained, or until the enclosing transaction ends; a
+ * statement without a result set returns the conn right away.  A handle
+ * that issued a SET statement keeps its conn for good since cdb2 replays
+ * set commands per physical handle; such conns are closed, not pooled, when
+ * the logical handle is closed.
+ *
+ * All conn and logical handle state is guarded by loop->lk.  A lane thread
+ * drops the lock only around the cdb2 calls on its own physical handle.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <stdio.h>
+#include <pthread.h>
+
+#include <event2/event.h>
+#include <event2/thread.h>
+
+#include "cdb2api_async.h"
+
+enum { ASYNC_RUN = 1, ASYNC_NEXT = 2 };
+
+struct async_op {
+    int type;
+    char *sql;
+    cdb2_async_callback cb;
+    void *arg;
+    int rc;
+    int done;
+    cdb2_async_hndl_tp *ahndl;
+    pthread_cond_t cond;
+    struct async_op *next;
+};
+
+struct async_pool;
+
+struct async_conn {
+    struct async_pool *pool;
+    cdb2_hndl_tp *hndl;
+    pthread_t tid;
+    pthread_cond_t cond;
+    struct async_op *op; /* assigned, not yet executed */
+    cdb2_async_hndl_tp *owner;
+    int in_trans;
+    int exiting;
+    struct async_conn *next;
+};
+
+struct async_pool {
+    cdb2_async_loop *loop;
+    char *dbname;
+    char *type;
+    int flags;
+    int nconns;
+    struct async_conn *conns;
+    struct async_op *wait_head; /* ops waiting for a free conn */
+    struct async_op *wait_tail;
+    struct async_pool *next;
+};
+
+struct cdb2_async_loop {
+    struct event_base *base;
+    int own_base;
+    pthread_t loop_tid;
+    struct event *done_ev;
+    pthread_mutex_t lk;
+    int max_conns;
+    struct async_pool *pools;
+    struct async_op *done_head; /* completed ops with callbacks */
+    struct async_op *done_tail;
+    pthread_cond_t lanes_cond;
+    int nlanes; /* live lane threads */
+    int nlogical;
+    int nbusy;
+    int nqueued;
+};
+
+struct cdb2_async_hndl {
+    cdb2_async_loop *loop;
+    struct async_pool *pool;
+    struct async_conn *conn;
+    struct async_op *op;
+    int pinned;
+    char errstr[256];
+};
+
+static int sql_starts_with(const char *sql, const char *word)
+{
+    size_t len = strlen(word);
+    while (isspace((unsigned char)*sql))
+        ++sql;
+    if (strncasecmp(sql, word, len) != 0)
+        return 0;
+    return sql[len] == '\0' || isspace((unsigned char)sql[len]) || sql[len] == ';';
+}
+
+static void *conn_thd(void *arg);
+
+static void op_free(struct async_op *op)
+{
+    pthread_cond_destroy(&op->cond);
+    free(op->sql);
+    free(op);
+}
+
+/* Call with loop->lk held. */
+static void conn_assign(struct async_conn *conn, struct async_op *op)
+{
+    cdb2_async_loop *loop = op->ahndl->loop;
+    if (conn->owner == NULL)
+        ++loop->nbusy;
+    conn->owner = op->ahndl;
+    op->ahndl->conn = conn;
+    conn->op = op;
+    pthread_cond_signal(&conn->cond);
+}
+
+/* Call with loop->lk held.  Returns NULL if the pool is saturated, or
+ * with *err set if a new conn could not be started. */
+static struct async_conn *pool_get_conn(struct async_pool *pool, int *err)
+{
+    struct async_conn *conn;
+
+    *err = 0;
+    for (conn = pool->conns; conn; conn = conn->next) {
+        if (conn->owner == NULL && !conn->exiting)
+            return conn;
+    }
+    if (pool->nconns >= pool->loop->max_conns)
+        return NULL;
+    conn = calloc(1, sizeof(*conn));
+    if (conn == NULL) {
+        *err = 1;
+        return NULL;
+    }
+    conn->pool = pool;
+    pthread_cond_init(&conn->cond, NULL);
+    if (pthread_create(&conn->tid, NULL, conn_thd, conn) != 0) {
+        pthread_cond_destroy(&conn->cond);
+        free(conn);
+        *err = 1;
+        return NULL;
+    }
+    conn->next = pool->conns;
+    pool->conns = conn;
+    ++pool->nconns;
+    ++pool->loop->nlanes;
+    return conn;
+}
+
+static void op_complete(cdb2_async_loop *loop, struct async_op *op);
+
+/* Call with loop->lk held.  Hand the oldest waiting op to a free conn; if
+ * no conn can be started, fail it rather than leave it queued for good. */
+static void pool_dispatch_waiting(struct async_pool *pool)
+{
+    struct async_conn *conn;
+    struct async_op *op;
+    int err;
+
+    if ((op = pool->wait_head) == NULL)
+        return;
+    if ((conn = pool_get_conn(pool, &err)) == NULL && !err)
+        return;
+    pool->wait_head = op->next;
+    if (pool->wait_head == NULL)
+        pool->wait_tail = NULL;
+    op->next = NULL;
+    --pool->loop->nqueued;
+    if (conn) {
+        conn_assign(conn, op);
+        return;
+    }
+    snprintf(op->ahndl->errstr, sizeof(op->ahndl->errstr), "can't start a connection");
+    op->rc = CDB2ERR_MALLOC;
+    op->ahndl->op = NULL;
+    op_complete(pool->loop, op);
+}
+
+/* Call with loop->lk held. */
+static void conn_release(cdb2_async_loop *loop, struct async_conn *conn)
+{
+    conn->owner->conn = NULL;
+    conn->owner = NULL;
+    --loop->nbusy;
+    pool_dispatch_waiting(conn->pool);
+}
+
+/* Call with loop->lk held.  The conn is unlinked here and reaped by its own
+ * lane thread, which closes the physical handle. */
+static void conn_retire(cdb2_async_loop *loop, struct async_conn *conn)
+{
+    struct async_pool *pool = conn->pool;
+    struct async_conn **pp;
+
+    for (pp = &pool->conns; *pp; pp = &(*pp)->next) {
+        if (*pp == conn) {
+            *pp = conn->next;
+            break;
+        }
+    }
+    --pool->nconns;
+    if (conn->owner) {
+        conn->owner->conn = NULL;
+        conn->owner = NULL;
+        --loop->nbusy;
+    }
+    conn->exiting = 1;
+    pthread_cond_signal(&conn->cond);
+    pool_dispatch_waiting(pool);
+}
+
+static void op_complete(cdb2_async_loop *loop, struct async_op *op)
+{
+    op->done = 1;
+    if (op->cb == NULL) {
+        pthread_cond_signal(&op->cond);
+        return;
+    }
+    if (loop->done_tail)
+        loop->done_tail->next = op;
+    else
+        loop->done_head = op;
+    loop->done_tail = op;
+    event_active(loop->done_ev, EV_READ, 0);
+}
+
+static void *conn_thd(void *arg)
+{
+    struct async_conn *conn = arg;
+    struct async_pool *pool = conn->pool;
+    cdb2_async_loop *loop = pool->loop;
+    cdb2_async_hndl_tp *ahndl;
+    struct async_op *op;
+    char errstr[sizeof(ahndl->errstr)];
+    int rc, release, has_rows, in_trans, pinned;
+
+    pthread_detach(pthread_self());
+
+    pthread_mutex_lock(&loop->lk);
+    for (;;) {
+        while (conn->op == NULL && !conn->exiting)
+            pthread_cond_wait(&conn->cond, &loop->lk);
+        if (conn->op == NULL)
+            break;
+        op = conn->op;
+        conn->op = NULL;
+        ahndl = op->ahndl;
+        in_trans = conn->in_trans;
+        pinned = ahndl->pinned;
+        pthread_mutex_unlock(&loop->lk);
+
+        rc = 0;
+        has_rows = 0;
+        errstr[0] = '\0';
+        if (conn->hndl == NULL) {
+            rc = cdb2_open(&conn->hndl, pool->dbname, pool->type, pool->flags);
+            if (rc) {
+                snprintf(errstr, sizeof(errstr), "%s",
+                         conn->hndl ? cdb2_errstr(conn->hndl) : "cdb2_open failed");
+                cdb2_close(conn->hndl);
+                conn->hndl = NULL;
+            }
+        }
+
+        if (rc == 0 && op->type == ASYNC_RUN) {
+            rc = cdb2_run_statement(conn->hndl, op->sql);
+            if (rc == CDB2_OK) {
+                if (sql_starts_with(op->sql, "set"))
+                    pinned = 1;
+                /* only statements with a result set describe columns */
+                has_rows = cdb2_numcolumns(conn->hndl) > 0;
+            }
+            /* the handle knows whether begin took, or commit ended it */
+            in_trans = cdb2_in_transaction(conn->hndl);
+        } else if (rc == 0) {
+            rc = cdb2_next_record(conn->hndl);
+            has_rows = (rc == CDB2_OK);
+        }
+        if (rc != CDB2_OK && rc != CDB2_OK_DONE && conn->hndl)
+            snprintf(errstr, sizeof(errstr), "%s", cdb2_errstr(conn->hndl));
+
+        pthread_mutex_lock(&loop->lk);
+        op->rc = rc;
+        conn->in_trans = in_trans;
+        ahndl->pinned = pinned;
+        if (errstr[0])
+            memcpy(ahndl->errstr, errstr, sizeof(errstr));
+        /* Keep the conn while rows remain or a transaction is open */
+        release = !has_rows && !in_trans && !pinned;
+        if (conn->hndl == NULL)
+            conn_retire(loop, conn);
+        else if (release)
+            conn_release(loop, conn);
+        ahndl->op = NULL;
+        op_complete(loop, op);
+    }
+    if (--loop->nlanes == 0)
+        pthread_cond_broadcast(&loop->lanes_cond);
+    pthread_mutex_unlock(&loop->lk);
+
+    cdb2_close(conn->hndl);
+    pthread_cond_destroy(&conn->cond);
+    free(conn);
+    return NULL;
+}
+
+static void done_cb(evutil_socket_t fd, short what, void *arg)
+{
+    cdb2_async_loop *loop = arg;
+    struct async_op *op, *next;
+
+    pthread_mutex_lock(&loop->lk);
+    op = loop->done_head;
+    loop->done_head = loop->done_tail = NULL;
+    pthread_mutex_unlock(&loop->lk);
+
+    for (; op; op = next) {
+        next = op->next;
+        op->cb(op->ahndl, op->rc, op->arg);
+        op_free(op);
+    }
+}
+
+static void *loop_thd(void *arg)
+{
+    cdb2_async_loop *loop = arg;
+    event_base_loop(loop->base, EVLOOP_NO_EXIT_ON_EMPTY);
+    return NULL;
+}
+
+cdb2_async_loop *cdb2_async_loop_create(struct event_base *base, int max_conns)
+{
+    cdb2_async_loop *loop = calloc(1, sizeof(*loop));
+    if (loop == NULL)
+        return NULL;
+    loop->max_conns = max_conns > 0 ? max_conns : 1;
+    pthread_mutex_init(&loop->lk, NULL);
+    pthread_cond_init(&loop->lanes_cond, NULL);
+    /* lane threads activate done_ev from outside the base's thread */
+    evthread_use_pthreads();
+    if (base == NULL) {
+        if ((base = event_base_new()) == NULL)
+            goto err;
+        loop->own_base = 1;
+    }
+    loop->base = base;
+    evthread_make_base_notifiable(base);
+    if ((loop->done_ev = event_new(base, -1, 0, done_cb, loop)) == NULL)
+        goto err;
+    if (loop->own_base && pthread_create(&loop->loop_tid, NULL, loop_thd, loop) != 0)
+        goto err;
+    return loop;
+
+err:
+    if (loop->done_ev)
+        event_free(loop->done_ev);
+    if (loop->own_base && base)
+        event_base_free(base);
+    pthread_cond_destroy(&loop->lanes_cond);
+    pthread_mutex_destroy(&loop->lk);
+    free(loop);
+    return NULL;
+}
+
+/* Logical handles must all be closed before the loop is destroyed.  Requests
+ * still queued fail with CDB2ERR_BADSTATE; their callbacks are not run. */
+void cdb2_async_loop_destroy(cdb2_async_loop *loop)
+{
+    struct async_pool *pool, *next;
+    struct async_op *op, *op_next;
+
+    if (loop == NULL)
+        return;
+    if (loop->own_base) {
+        event_base_loopbreak(loop->base);
+        pthread_join(loop->loop_tid, NULL);
+    }
+    pthread_mutex_lock(&loop->lk);
+    for (pool = loop->pools; pool; pool = next) {
+        next = pool->next;
+        for (op = pool->wait_head; op; op = op_next) {
+            op_next = op->next;
+            op->ahndl->op = NULL;
+            op->rc = CDB2ERR_BADSTATE;
+            op->done = 1;
+            if (op->cb == NULL)
+                pthread_cond_signal(&op->cond); /* the waiter frees it */
+            else
+                op_free(op);
+        }
+        pool->wait_head = pool->wait_tail = NULL;
+        loop->nqueued = 0;
+        while (pool->conns)
+            conn_retire(loop, pool->conns);
+        free(pool->dbname);
+        free(pool->type);
+        free(pool);
+    }
+    loop->pools = NULL;
+    while (loop->nlanes > 0)
+        pthread_cond_wait(&loop->lanes_cond, &loop->lk);
+    /* completions the base did not get to deliver */
+    for (op = loop->done_head; op; op = op_next) {
+        op_next = op->next;
+        op_free(op);
+    }
+    loop->done_head = loop->done_tail = NULL;
+    pthread_mutex_unlock(&loop->lk);
+    event_free(loop->done_ev);
+    if (loop->own_base)
+        event_base_free(loop->base);
+    pthread_cond_destroy(&loop->lanes_cond);
+    pthread_mutex_destroy(&loop->lk);
+    free(loop);
+}
+
+int cdb2_async_open(cdb2_async_loop *loop, cdb2_async_hndl_tp **ahndl,
+                    const char *dbname, const char *type, int flags)
+{
+    struct async_pool *pool;
+    cdb2_async_hndl_tp *h;
+
+    *ahndl = NULL;
+    if ((h = calloc(1, sizeof(*h))) == NULL)
+        return CDB2ERR_MALLOC;
+    pthread_mutex_lock(&loop->lk);
+    for (pool = loop->pools; pool; pool = pool->next) {
+        if (pool->flags == flags && strcmp(pool->dbname, dbname) == 0 &&
+            strcmp(pool->type, type) == 0)
+            break;
+    }
+    if (pool == NULL) {
+        pool = calloc(1, sizeof(*pool));
+        if (pool == NULL || (pool->dbname = strdup(dbname)) == NULL ||
+            (pool->type = strdup(type)) == NULL) {
+            pthread_mutex_unlock(&loop->lk);
+            if (pool)
+                free(pool->dbname);
+            free(pool);
+            free(h);
+            return CDB2ERR_MALLOC;
+        }
+        pool->loop = loop;
+        pool->flags = flags;
+        pool->next = loop->pools;
+        loop->pools = pool;
+    }
+    ++loop->nlogical;
+    pthread_mutex_unlock(&loop->lk);
+
+    h->loop = loop;
+    h->pool = pool;
+    *ahndl = h;
+    return CDB2_OK;
+}
+
+int cdb2_async_close(cdb2_async_hndl_tp *ahndl)
+{
+    cdb2_async_loop *loop;
+    struct async_conn *conn;
+
+    if (ahndl == NULL)
+        return 0;
+    loop = ahndl->loop;
+    pthread_mutex_lock(&loop->lk);
+    if (ahndl->op) {
+        pthread_mutex_unlock(&loop->lk);
+        return CDB2ERR_BADSTATE;
+    }
+    /* Unread rows are consumed by the conn's next statement, so such a
+     * conn goes back to the pool.  One with an open transaction or session
+     * state can't be handed to another logical handle. */
+    if ((conn = ahndl->conn) != NULL) {
+        if (conn->in_trans || ahndl->pinned)
+            conn_retire(loop, conn);
+        else
+            conn_release(loop, conn);
+    }
+    --loop->nlogical;
+    pthread_mutex_unlock(&loop->lk);
+    free(ahndl);
+    return 0;
+}
+
+static int async_submit(cdb2_async_hndl_tp *ahndl, int type, const char *sql,
+                        cdb2_async_callback cb, void *arg, struct async_op **pop)
+{
+    cdb2_async_loop *loop = ahndl->loop;
+    struct async_pool *pool = ahndl->pool;
+    struct async_conn *conn;
+    struct async_op *op;
+    int err;
+
+    if ((op = calloc(1, sizeof(*op))) == NULL)
+        return CDB2ERR_MALLOC;
+    if (sql && (op->sql = strdup(sql)) == NULL) {
+        free(op);
+        return CDB2ERR_MALLOC;
+    }
+    op->type = type;
+    op->cb = cb;
+    op->arg = arg;
+    op->ahndl = ahndl;
+    pthread_cond_init(&op->cond, NULL);
+
+    pthread_mutex_lock(&loop->lk);
+    if (ahndl->op) {
+        pthread_mutex_unlock(&loop->lk);
+        snprintf(ahndl->errstr, sizeof(ahndl->errstr), "request already in flight");
+        pthread_cond_destroy(&op->cond);
+        free(op->sql);
+        free(op);
+        return CDB2ERR_BADSTATE;
+    }
+    if (type == ASYNC_NEXT && ahndl->conn == NULL) {
+        pthread_mutex_unlock(&loop->lk);
+        snprintf(ahndl->errstr, sizeof(ahndl->errstr), "no statement");
+        pthread_cond_destroy(&op->cond);
+        free(op);
+        return CDB2ERR_NOSTATEMENT;
+    }
+    if ((conn = ahndl->conn) == NULL && (conn = pool_get_conn(pool, &err)) == NULL && err) {
+        pthread_mutex_unlock(&loop->lk);
+        snprintf(ahndl->errstr, sizeof(ahndl->errstr), "can't start a connection");
+        pthread_cond_destroy(&op->cond);
+        free(op->sql);
+        free(op);
+        return CDB2ERR_MALLOC;
+    }
+    ahndl->op = op;
+    ahndl->errstr[0] = '\0';
+    if (conn) {
+        conn_assign(conn, op);
+    } else {
+        if (pool->wait_tail)
+            pool->wait_tail->next = op;
+        else
+            pool->wait_head = op;
+        pool->wait_tail = op;
+        ++loop->nqueued;
+    }
+    if (pop)
+        *pop = op;
+    else
+        pthread_mutex_unlock(&loop->lk);
+    return CDB2_OK;
+}
+
+int cdb2_async_run_statement(cdb2_async_hndl_tp *ahndl, const char *sql,
+                             cdb2_async_callback cb, void *arg)
+{
+    if (cb == NULL)
+        return CDB2ERR_BADREQ;
+    return async_submit(ahndl, ASYNC_RUN, sql, cb, arg, NULL);
+}
+
+int cdb2_async_next_record(cdb2_async_hndl_tp *ahndl, cdb2_async_callback cb,
+                           void *arg)
+{
+    if (cb == NULL)
+        return CDB2ERR_BADREQ;
+    return async_submit(ahndl, ASYNC_NEXT, NULL, cb, arg, NULL);
+}
+
+static int async_wait(cdb2_async_hndl_tp *ahndl, int type, const char *sql)
+{
+    cdb2_async_loop *loop = ahndl->loop;
+    struct async_op *op;
+    int rc;
+
+    /* returns with loop->lk held on success */
+    if ((rc = async_submit(ahndl, type, sql, NULL, NULL, &op)) != CDB2_OK)
+        return rc;
+    while (!op->done)
+        pthread_cond_wait(&op->cond, &loop->lk);
+    rc = op->rc;
+    pthread_mutex_unlock(&loop->lk);
+    op_free(op);
+    return rc;
+}
+
+int cdb2_async_run_statement_sync(cdb2_async_hndl_tp *ahndl, const char *sql)
+{
+    return async_wait(ahndl, ASYNC_RUN, sql);
+}
+
+int cdb2_async_next_record_sync(cdb2_async_hndl_tp *ahndl)
+{
+    return async_wait(ahndl, ASYNC_NEXT, NULL);
+}
+
+cdb2_hndl_tp *cdb2_async_hndl(cdb2_async_hndl_tp *ahndl)
+{
+    cdb2_hndl_tp *hndl;
+
+    pthread_mutex_lock(&ahndl->loop->lk);
+    hndl = ahndl->conn ? ahndl->conn->hndl : NULL;
+    pthread_mutex_unlock(&ahndl->loop->lk);
+    return hndl;
+}
+
+const char *cdb2_async_errstr(cdb2_async_hndl_tp *ahndl)
+{
+    pthread_mutex_lock(&ahndl->loop->lk);
+    if (ahndl->errstr[0] == '\0' && ahndl->conn && ahndl->conn->hndl)
+        snprintf(ahndl->errstr, sizeof(ahndl->errstr), "%s", cdb2_errstr(ahndl->conn->hndl));
+    pthread_mutex_unlock(&ahndl->loop->lk);
+    return ahndl->errstr;
+}
+
+void cdb2_async_get_stats(cdb2_async_loop *loop, struct cdb2_async_stats *st)
+{
+    struct async_pool *pool;
+
+    memset(st, 0, sizeof(*st));
+    pthread_mutex_lock(&loop->lk);
+    for (pool = loop->pools; pool; pool = pool->next)
+        st->physical_conns += pool->nconns;
+    st->busy_conns = loop->nbusy;
+    st->logical_hndls = loop->nlogical;
+    st->queued = loop->nqueued;
+    pthread_mutex_unlock(&loop->lk);
+}
@@ -0,0 +1,87 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/*
+ * CDB2 ASYNC API
+ *
+ * Event-driven front end to cdb2api.  Many logical handles share a small,
+ * bounded set of physical cdb2 handles (connections) per database.  A
+ * logical handle borrows a physical connection for the lifetime of a
+ * result set, or of a transaction, and returns it to the pool afterwards.
+ * Completions are delivered as callbacks on the caller's libevent base.
+ *
+ * Callbacks run on the event base thread.  Inside a completion callback the
+ * row may be read with the usual cdb2_column_* accessors on the handle
+ * returned by cdb2_async_hndl().
+ */
+
+#ifndef INCLUDED_CDB2API_ASYNC_H
+#define INCLUDED_CDB2API_ASYNC_H
+
+#include <cdb2api.h>
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+struct event_base;
+
+typedef struct cdb2_async_loop cdb2_async_loop;
+typedef struct cdb2_async_hndl cdb2_async_hndl_tp;
+
+typedef void (*cdb2_async_callback)(cdb2_async_hndl_tp *ahndl, int rc, void *arg);
+
+/* Create a loop on 'base' (or on a private base driven by an internal thread
+ * when 'base' is NULL).  'max_conns' bounds the number of physical
+ * connections opened per dbname/type/flags.  Completions are signalled to
+ * 'base' from other threads, so a caller-supplied base must be created after
+ * evthread_use_pthreads(). */
+cdb2_async_loop *cdb2_async_loop_create(struct event_base *base, int max_conns);
+void cdb2_async_loop_destroy(cdb2_async_loop *loop);
+
+int cdb2_async_open(cdb2_async_loop *loop, cdb2_async_hndl_tp **ahndl,
+                    const char *dbname, const char *type, int flags);
+int cdb2_async_close(cdb2_async_hndl_tp *ahndl);
+
+/* Non-blocking: return 0 once queued; 'cb' is invoked with the cdb2 return
+ * code when the statement (or the next row) is ready. */
+int cdb2_async_run_statement(cdb2_async_hndl_tp *ahndl, const char *sql,
+                             cdb2_async_callback cb, void *arg);
+int cdb2_async_next_record(cdb2_async_hndl_tp *ahndl, cdb2_async_callback cb,
+                           void *arg);
+
+/* Blocking wrappers with cdb2_run_statement/cdb2_next_record semantics. */
+int cdb2_async_run_statement_sync(cdb2_async_hndl_tp *ahndl, const char *sql);
+int cdb2_async_next_record_sync(cdb2_async_hndl_tp *ahndl);
+
+/* Physical handle currently bound to 'ahndl', or NULL if none.  Valid until
+ * the result set is drained or the transaction ends. */
+cdb2_hndl_tp *cdb2_async_hndl(cdb2_async_hndl_tp *ahndl);
+const char *cdb2_async_errstr(cdb2_async_hndl_tp *ahndl);
+
+struct cdb2_async_stats {
+    int physical_conns; /* open physical connections, all pools */
+    int busy_conns;     /* connections bound to a logical handle */
+    int logical_hndls;  /* open logical handles */
+    int queued;         /* requests waiting for a connection */
+};
+void cdb2_async_get_stats(cdb2_async_loop *loop, struct cdb2_async_stats *st);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* INCLUDED_CDB2API_ASYNC_H */
@@ -73,6 +73,12 @@ int analyze_table(char *table, COMDB2BUF *sb, int scale, int override_llmeta,
  */
 int analyze_database(COMDB2BUF *sb, int scale, int override_llmeta);
 
+/**
+ * Refresh this table's sqlite_stat1 and sqlite_stat4 rows from the index
+ * sketches kept by the write path, without scanning it.
+ */
+int analyze_table_from_sketch(char *table, COMDB2BUF *sb);
+
 /**
  * Backout to the previous analysis for table(s), or to no-analysis if there
  * is none.
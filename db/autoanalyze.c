@@ -33,6 +33,7 @@
 #include <sqlstat1.h>
 #include "sc_util.h"
 #include "comdb2_atomic.h"
+#include "ixsketch.h"
 
 const char *aa_counter_str = "autoanalyze_counter";
 const char *aa_lastepoch_str = "autoanalyze_lastepoch";
@@ -68,6 +69,7 @@ void reset_aa_counter(char *tblname)
     XCHANGE64(tbl->aa_saved_counter, 0);
     XCHANGE64(tbl->aa_lastepoch, (int64_t)time(NULL));
     XCHANGE64(tbl->aa_needs_analyze_time, 0);
+    ixsketch_reset(tbl);
 
     if (save_freq > 0 && thedb->master == gbl_myhostname) {
         // save updated counter
@@ -142,6 +144,28 @@ void *auto_analyze_table(void *arg)
     return NULL;
 }
 
+/* auto_analyze_refresh() folds a table's index sketches into its stats,
+ * and like auto_analyze_table() frees the table name it is passed.
+ */
+static void *auto_analyze_refresh(void *arg)
+{
+    char *tblname = (char *)arg;
+    COMDB2BUF *sb = cdb2buf_open(fileno(stdout), 0);
+    bdb_thread_event(thedb->bdb_env, BDBTHR_EVENT_START);
+    sql_mem_init(NULL);
+
+    int rc = analyze_table_from_sketch(tblname, sb);
+    if (rc)
+        logmsg(LOGMSG_ERROR, "%s: analyze_table_from_sketch %s failed rc:%d\n", __func__, tblname, rc);
+
+    sql_mem_shutdown(NULL);
+    bdb_thread_event(thedb->bdb_env, BDBTHR_EVENT_DONE);
+    cdb2buf_free(sb);
+    free(tblname);
+    auto_analyze_running = 0;
+    return NULL;
+}
+
 static void get_saved_counter_epochs(tran_type *trans, char *tblname, int64_t *aa_counter, int64_t *aa_lastepoch,
                                      int64_t *aa_needs_analyze_time)
 {
@@ -488,6 +512,21 @@ void *auto_analyze_main(void *unused)
                 bdb_set_table_parameter(NULL, tbl->tablename, aa_counter_str, str);
             }
         }
+
+        /* between full analyzes, refresh the stats from the index sketches
+         * once enough of the table has changed */
+        if (gbl_ixsketch && gbl_ixsketch_refresh_pct > 0 && !auto_analyze_running && !analyze_is_running()) {
+            int64_t changes = ixsketch_changes(tbl);
+            if (changes >= gbl_ixsketch_refresh_min_ops &&
+                changes * 100 >= (int64_t)gbl_ixsketch_refresh_pct * get_num_rows_from_stat1(tbl)) {
+                ctrace("AUTOANALYZE: Refreshing Table %s from index sketches, %"PRId64" changes\n", tbl->tablename,
+                       changes);
+                auto_analyze_running = 1; // will be reset by auto_analyze_refresh()
+                pthread_t refresh;
+                char *tblname = strdup(tbl->tablename);
+                Pthread_create(&refresh, &gbl_pthread_attr_detached, auto_analyze_refresh, tblname);
+            }
+        }
     }
     unlock_schema_lk();
 
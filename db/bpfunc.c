@@ -511,6 +511,28 @@ int success_timepart_retention(void *tran, bpfunc_t *func, struct errstat *err)
      return rc;
 }
 
+static int exec_timepart_period(void *tran, bpfunc_t *func,
+                                struct errstat *err)
+{
+    BpfuncTimepartPeriod *per_f = func->arg->tp_period;
+
+    return timepart_update_period(tran, per_f->timepartname, per_f->period,
+                                  err);
+}
+
+static int success_timepart_period(void *tran, bpfunc_t *func, struct errstat *err)
+{
+    int rc = 0;
+    int bdberr = 0;
+
+    rc = bdb_llog_views(thedb->bdb_env, func->arg->tp_period->timepartname, 1,
+                        &bdberr);
+    if (rc)
+        errstat_set_rcstrf(err, rc, "%s -- bdb_llog_views rc:%d bdberr:%d",
+                           __func__, rc, bdberr);
+    return rc;
+}
+
 static int prepare_timepart_retention(bpfunc_t *tp)
 {
     tp->exec = exec_timepart_retention;
@@ -662,6 +684,11 @@ static int prepare_methods(bpfunc_t *func, bpfunc_info *info)
         func->exec = exec_delete_from_sc_history;
         break;
 
+    case BPFUNC_TIMEPART_PERIOD:
+        func->exec = exec_timepart_period;
+        func->success = success_timepart_period;
+        break;
+
     default:
         logmsg(LOGMSG_ERROR, "Unknown function_id in bplog function\n");
         return -1;
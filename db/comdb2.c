@@ -148,6 +148,8 @@ void berk_memp_sync_alarm_ms(int);
 #include "str_util.h" /* QUOTE */
 #include "machcache.h"
 #include "gen_shard.h"
+#include "wait_sampler.h"
+#include "query_plan_baseline.h"
 
 #define tokdup strndup
 
@@ -356,6 +358,7 @@ int gbl_loghist_verbose = 0;
 int gbl_repdebug = -1;
 int gbl_elect_time_secs = 0;
 char *gbl_pmblock = NULL;
+char *gbl_malloc_tcache = "sqlite,protobuf"; /* allocators with thread caches */
 int gbl_rtcpu_debug = 0;
 int gbl_longblk_trans_purge_interval = 30; /* initially, set this to 30 seconds */
 int gbl_sbuftimeout = 0;
@@ -5148,6 +5151,7 @@ void *statthd(void *p)
         time_metric_purge_old(thedb->concurrent_queries);
         time_metric_purge_old(thedb->connections);
         time_metric_purge_old(thedb->watchdog_time);
+        latency_hist_tick();
 
         ++count;
         sleep(1);
@@ -5786,6 +5790,7 @@ int main(int argc, char **argv)
 
     /* allocate initializer first */
     comdb2ma_init(0, 0);
+    comdb2ma_tcache_set(gbl_malloc_tcache);
 
 #   ifdef COMDB2_BBCMAKE
     hash_set_global_event_callback(hash_no_op_callback);
@@ -5917,6 +5922,7 @@ int main(int argc, char **argv)
     create_watchdog_thread(thedb);
     create_old_blkseq_thread(thedb);
     create_stat_thread(thedb);
+    create_wait_sampler_thread();
 
     /* create the offloadsql repository */
     if (!gbl_create_mode && thedb->nsiblings > 0) {
@@ -6502,6 +6508,10 @@ retry_tran:
         abort();
     }
 
+    if (query_plan_baseline_load()) {
+        logmsg(LOGMSG_ERROR, "could not load query plan baselines from llmeta\n");
+    }
+
     if ((rc = db_finalize_and_sanity_checks(thedb)) != 0) {
         logmsg(LOGMSG_FATAL, "%s: db_finalize_and_sanity_checks returns %d\n",
                __func__, rc);
@@ -677,6 +677,7 @@ typedef struct dbtable {
     int64_t aa_needs_analyze_time; // time when analyze is needed for table in request mode, otherwise 0
     int64_t read_count; // counter for reads to this table
     int64_t index_used_count;   // counter for number of times a table index was used
+    struct ixsketch **ixsketch; /* per-index write-path statistics, see ixsketch.c */
 
     /* Foreign key constraints */
     constraint_t *constraints;
@@ -697,6 +698,9 @@ typedef struct dbtable {
 
     struct consumer *consumers[MAXCONSUMERS];
 
+    /* Queue items are hashed into this many consumer slots (0: fan out) */
+    int queue_partitions;
+
     /* Expected average size of a queue item in bytes. */
     int avgitemsz;
     int queue_pagesize_override;
@@ -743,6 +747,7 @@ typedef struct dbtable {
 
     int sc_live_logical;
     unsigned long long *sc_genids; /* schemachange stripe pointers */
+    struct sc_ranges *sc_ranges;   /* finer pointers when converting by range */
 
     /* All writer threads have to grab the lock in read/write mode.  If a live
      * schema change is in progress then they have to do extra stuff. */
@@ -804,6 +809,10 @@ typedef struct dbtable {
 
     /* name of the timepartition, if this is a shard */
     const char *timepartition_name;
+    /* row time limits of a shard, see timepart_shard_timelimit */
+    int shard_limit[2];
+    int shard_limit_valid[2];
+    unsigned long long shard_limit_ctx[2];
 
     /* generic sharding metadata */
     uint32_t numdbs;
@@ -1437,6 +1446,9 @@ struct ireq {
     /* osql prefault step index */
     int *osql_step_ix;
 
+    /* index sketch updates waiting for this transaction to commit */
+    struct ixsketch_txn *ixsketch_txn;
+
     tran_type *sc_logical_tran;
     tran_type *sc_tran;
     tran_type *sc_close_tran;
@@ -2675,9 +2687,11 @@ struct bdb_queue_found;
 struct bdb_queue_cursor;
 int dbq_add(struct ireq *iq, void *trans, const void *dta, size_t dtalen);
 int dbq_add_recno(struct ireq *iq, void *trans, uint32_t recno, const void *dta, size_t dtalen);
+int dbq_add_partition(struct ireq *iq, void *trans, int partition, const void *dta, size_t dtalen);
 int dbq_consume(struct ireq *iq, void *trans, int consumer,
                 const struct bdb_queue_found *fnd);
 int dbq_consume_genid(struct ireq *, void *trans, int consumer, const genid_t);
+int dbq_consume_batch(struct ireq *, void *trans, int consumer, const genid_t *, int ngenids);
 int dbq_get(struct ireq *iq, int consumer, const struct bdb_queue_cursor *prev, struct bdb_queue_found **fnddta,
             size_t *fnddtalen, size_t *fnddtaoff, struct bdb_queue_cursor *fnd, long long *seq, uint32_t lockid);
 void dbq_get_item_info(const struct bdb_queue_found *fnd, size_t *dtaoff, size_t *dtalen);
@@ -27,6 +27,7 @@
 #include "util.h"
 #include "tohex.h"
 #include "string_ref.h"
+#include "thread_stats.h"
 #include <ctrace.h>
 
 extern int gbl_old_column_names;
@@ -210,9 +211,25 @@ static void do_type_checks(struct sqlclntstate *clnt, sqlite3_stmt *stmt,
     strbuf_free(newtypes);
 }
 
+/* Charge the resources used by the request to its fingerprint. The stats are
+ * NULL for statements run inside a stored procedure; those are charged to the
+ * procedure's own fingerprint instead. */
+static void add_resource_usage(struct fingerprint_track *t, const struct berkdb_thread_stats *usage)
+{
+    if (usage == NULL)
+        return;
+    t->cache_misses += usage->n_cache_misses;
+    t->lock_waits += usage->n_lock_waits;
+    t->lock_wait_us += usage->lock_wait_time_us;
+    t->log_bytes += usage->log_bytes;
+    t->temp_spills += usage->n_temp_spills;
+    t->temp_spill_bytes += usage->temp_spill_bytes;
+}
+
 void add_fingerprint(struct sqlclntstate *clnt, sqlite3_stmt *stmt, struct string_ref *zSql_ref, const char *zNormSql,
-                     int64_t cost, int64_t time, int64_t prepTime, int64_t nrows, struct reqlogger *logger,
-                     unsigned char *fingerprint_out, int is_lua)
+                     int64_t cost, int64_t time, int64_t prepTime, int64_t nrows,
+                     const struct berkdb_thread_stats *usage, struct reqlogger *logger, unsigned char *fingerprint_out,
+                     int is_lua)
 {
     size_t nNormSql = 0;
     size_t temp;
@@ -272,6 +289,7 @@ void add_fingerprint(struct sqlclntstate *clnt, sqlite3_stmt *stmt, struct strin
         t->time = time;
         t->prepTime = prepTime;
         t->rows = nrows;
+        add_resource_usage(t, usage);
         t->curr_analyze_gen = gbl_analyze_gen;
         t->zNormSql = strdup(zNormSql);
         t->nNormSql = nNormSql;
@@ -280,7 +298,7 @@ void add_fingerprint(struct sqlclntstate *clnt, sqlite3_stmt *stmt, struct strin
             t->query_plan_hash = hash_init(FINGERPRINTSZ);
             t->alert_once_query_plan = 1;
             t->alert_once_query_plan_max = 1;
-            add_query_plan(cost, nrows, t, zSql_ref, query_plan_ref, plan_fingerprint, params);
+            add_query_plan(stmt, cost, nrows, t, zSql_ref, query_plan_ref, plan_fingerprint, params);
         } else {
             t->query_plan_hash = NULL;
         }
@@ -325,13 +343,14 @@ void add_fingerprint(struct sqlclntstate *clnt, sqlite3_stmt *stmt, struct strin
         t->time += time;
         t->prepTime += prepTime;
         t->rows += nrows;
+        add_resource_usage(t, usage);
         if (calc_query_plan) {
             if (!t->query_plan_hash) {
                 t->query_plan_hash = hash_init(FINGERPRINTSZ);
                 t->alert_once_query_plan = 1;
                 t->alert_once_query_plan_max = 1;
             }
-            add_query_plan(cost, nrows, t, zSql_ref, query_plan_ref, plan_fingerprint, params);
+            add_query_plan(stmt, cost, nrows, t, zSql_ref, query_plan_ref, plan_fingerprint, params);
         }
 
         /* Do a check after an interval */
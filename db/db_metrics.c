@@ -28,6 +28,7 @@
 #include <request_stats.h>
 #include <net_appsock.h>
 #include <sqllogfill.h>
+#include <perf.h>
 
 #include <sys/time.h>
 #include <sys/resource.h>
@@ -99,6 +100,9 @@ struct comdb2_metrics_store {
     int64_t net_queue_size;
     int64_t rep_deadlocks;
     int64_t rw_evicts;
+    int64_t prefetch_pages;
+    int64_t prefetch_useful;
+    int64_t prefetch_wasted;
     int64_t standing_queue_time;
     int64_t minimum_truncation_file;
     int64_t minimum_truncation_offset;
@@ -161,7 +165,18 @@ struct comdb2_metrics_store {
     int64_t fastsql_set_datetime_precision;
     int64_t fastsql_sslconn;
     int64_t fastsql_execute_stop;
+    struct {
+        int64_t p50;
+        int64_t p99;
+        int64_t p999;
+    } latency[LATENCY_MAX];
     int64_t legacy_requests;
+    int64_t lua_bytecode_hits;
+    int64_t lua_bytecode_misses;
+    int64_t lua_sp_setups;
+    int64_t lua_sp_setup_time_us;
+    int64_t lua_vm_pool_hits;
+    int64_t lua_vm_pool_misses;
 };
 
 static struct comdb2_metrics_store stats;
@@ -220,6 +235,12 @@ comdb2_metric gbl_metrics[] = {
      &stats.memory_ulimit, NULL},
     {"memory_usage", "Address space size", STATISTIC_INTEGER, STATISTIC_COLLECTION_TYPE_LATEST, &stats.memory_usage,
      NULL},
+    {"prefetch_pages", "Pages read into the buffer pool by prefault", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_CUMULATIVE, &stats.prefetch_pages, NULL},
+    {"prefetch_useful", "Prefaulted pages later used", STATISTIC_INTEGER, STATISTIC_COLLECTION_TYPE_CUMULATIVE,
+     &stats.prefetch_useful, NULL},
+    {"prefetch_wasted", "Prefaulted pages evicted unused", STATISTIC_INTEGER, STATISTIC_COLLECTION_TYPE_CUMULATIVE,
+     &stats.prefetch_wasted, NULL},
     {"preads", "Number of pread()'s", STATISTIC_INTEGER, STATISTIC_COLLECTION_TYPE_CUMULATIVE, &stats.preads, NULL},
     {"pwrites", "Number of pwrite()'s", STATISTIC_INTEGER, STATISTIC_COLLECTION_TYPE_CUMULATIVE, &stats.pwrites, NULL},
     {"queue_depth", "Request queue depth", STATISTIC_DOUBLE, STATISTIC_COLLECTION_TYPE_LATEST, &stats.queue_depth,
@@ -412,8 +433,56 @@ comdb2_metric gbl_metrics[] = {
      &stats.fastsql_sslconn, NULL},
     {"fastsql_execute_stop", "Number of fastsql 'execute stop' requests", STATISTIC_INTEGER,
      STATISTIC_COLLECTION_TYPE_CUMULATIVE, &stats.fastsql_execute_stop, NULL},
+    {"latency_commit_p50_us", "Median commit latency over the last minute (microseconds)", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_LATEST, &stats.latency[LATENCY_COMMIT].p50, NULL},
+    {"latency_commit_p99_us", "99th percentile commit latency over the last minute (microseconds)", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_LATEST, &stats.latency[LATENCY_COMMIT].p99, NULL},
+    {"latency_commit_p999_us", "99.9th percentile commit latency over the last minute (microseconds)", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_LATEST, &stats.latency[LATENCY_COMMIT].p999, NULL},
+    {"latency_repl_wait_p50_us", "Median replication ack wait latency over the last minute (microseconds)", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_LATEST, &stats.latency[LATENCY_REPL_WAIT].p50, NULL},
+    {"latency_repl_wait_p99_us", "99th percentile replication ack wait latency over the last minute (microseconds)", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_LATEST, &stats.latency[LATENCY_REPL_WAIT].p99, NULL},
+    {"latency_repl_wait_p999_us", "99.9th percentile replication ack wait latency over the last minute (microseconds)", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_LATEST, &stats.latency[LATENCY_REPL_WAIT].p999, NULL},
+    {"latency_osql_send_p50_us", "Median osql send latency over the last minute (microseconds)", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_LATEST, &stats.latency[LATENCY_OSQL_SEND].p50, NULL},
+    {"latency_osql_send_p99_us", "99th percentile osql send latency over the last minute (microseconds)", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_LATEST, &stats.latency[LATENCY_OSQL_SEND].p99, NULL},
+    {"latency_osql_send_p999_us", "99.9th percentile osql send latency over the last minute (microseconds)", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_LATEST, &stats.latency[LATENCY_OSQL_SEND].p999, NULL},
+    {"latency_sql_prepare_p50_us", "Median sql prepare latency over the last minute (microseconds)", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_LATEST, &stats.latency[LATENCY_SQL_PREPARE].p50, NULL},
+    {"latency_sql_prepare_p99_us", "99th percentile sql prepare latency over the last minute (microseconds)", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_LATEST, &stats.latency[LATENCY_SQL_PREPARE].p99, NULL},
+    {"latency_sql_prepare_p999_us", "99.9th percentile sql prepare latency over the last minute (microseconds)", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_LATEST, &stats.latency[LATENCY_SQL_PREPARE].p999, NULL},
+    {"latency_sql_step_p50_us", "Median sql step latency over the last minute (microseconds)", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_LATEST, &stats.latency[LATENCY_SQL_STEP].p50, NULL},
+    {"latency_sql_step_p99_us", "99th percentile sql step latency over the last minute (microseconds)", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_LATEST, &stats.latency[LATENCY_SQL_STEP].p99, NULL},
+    {"latency_sql_step_p999_us", "99.9th percentile sql step latency over the last minute (microseconds)", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_LATEST, &stats.latency[LATENCY_SQL_STEP].p999, NULL},
+    {"latency_page_read_p50_us", "Median page read latency over the last minute (microseconds)", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_LATEST, &stats.latency[LATENCY_PAGE_READ].p50, NULL},
+    {"latency_page_read_p99_us", "99th percentile page read latency over the last minute (microseconds)", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_LATEST, &stats.latency[LATENCY_PAGE_READ].p99, NULL},
+    {"latency_page_read_p999_us", "99.9th percentile page read latency over the last minute (microseconds)", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_LATEST, &stats.latency[LATENCY_PAGE_READ].p999, NULL},
     {"legacy_requests", "Number of non-cdb2api requests", STATISTIC_INTEGER, STATISTIC_COLLECTION_TYPE_CUMULATIVE,
      &stats.legacy_requests, NULL},
+    {"lua_bytecode_hits", "Stored procedure runs that reused a compiled chunk", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_CUMULATIVE, &stats.lua_bytecode_hits, NULL},
+    {"lua_bytecode_misses", "Stored procedure runs that compiled their source", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_CUMULATIVE, &stats.lua_bytecode_misses, NULL},
+    {"lua_sp_setups", "Number of stored procedure setups", STATISTIC_INTEGER, STATISTIC_COLLECTION_TYPE_CUMULATIVE,
+     &stats.lua_sp_setups, NULL},
+    {"lua_sp_setup_time_us", "Time spent getting a vm and compiling stored procedures, not running their code (microseconds)",
+     STATISTIC_INTEGER, STATISTIC_COLLECTION_TYPE_CUMULATIVE, &stats.lua_sp_setup_time_us, NULL},
+    {"lua_vm_pool_hits", "Stored procedure runs that took a pooled Lua vm", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_CUMULATIVE, &stats.lua_vm_pool_hits, NULL},
+    {"lua_vm_pool_misses", "Stored procedure runs that found no pooled Lua vm", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_CUMULATIVE, &stats.lua_vm_pool_misses, NULL},
     {"max_current_connections", "Max current connections for sampled interval", STATISTIC_INTEGER,
      STATISTIC_COLLECTION_TYPE_LATEST, &stats.max_current_connections, NULL},
 };
@@ -463,6 +532,12 @@ extern int64_t gbl_incoherent_slow_skips;
 extern int64_t gbl_inmem_repdb_memory;
 extern int64_t gbl_physrep_metadb_sql_count;
 extern int gbl_physrep_no_viable_source;
+extern int64_t gbl_lua_bytecode_hits;
+extern int64_t gbl_lua_bytecode_misses;
+extern int64_t gbl_lua_sp_setups;
+extern int64_t gbl_lua_sp_setup_us;
+extern int64_t gbl_lua_vm_pool_hits;
+extern int64_t gbl_lua_vm_pool_misses;
 
 static void update_sqllogfill_metrics()
 {
@@ -471,6 +546,18 @@ static void update_sqllogfill_metrics()
                         &stats.sql_logfill_queue_blocks);
 }
 
+static void update_latency_metrics()
+{
+    struct latency_summary sum;
+    for (int i = 0; i < LATENCY_MAX; i++) {
+        if (latency_hist_summary(i, 60, &sum) != 0)
+            continue;
+        stats.latency[i].p50 = sum.p50;
+        stats.latency[i].p99 = sum.p99;
+        stats.latency[i].p999 = sum.p999;
+    }
+}
+
 static void update_fastsql_metrics()
 {
     stats.fastsql_execute_inline_params = gbl_fastsql_execute_inline_params;
@@ -605,6 +692,14 @@ int refresh_metrics(void)
         return 1;
     }
 
+    rc = bdb_get_prefault_counters(thedb->bdb_env, &stats.prefetch_pages, &stats.prefetch_useful,
+                                   &stats.prefetch_wasted);
+    if (rc) {
+        logmsg(LOGMSG_ERROR, "failed to refresh statistics (%s:%d)\n", __FILE__,
+               __LINE__);
+        return 1;
+    }
+
     pstats = bdb_get_process_stats();
     stats.preads = pstats->n_preads;
     stats.pwrites = pstats->n_pwrites;
@@ -763,10 +858,17 @@ int refresh_metrics(void)
     stats.auth_allowed = gbl_num_auth_allowed;
     stats.auth_denied = gbl_num_auth_denied;
     stats.legacy_requests = gbl_legacy_requests;
+    stats.lua_bytecode_hits = gbl_lua_bytecode_hits;
+    stats.lua_bytecode_misses = gbl_lua_bytecode_misses;
+    stats.lua_sp_setups = gbl_lua_sp_setups;
+    stats.lua_sp_setup_time_us = gbl_lua_sp_setup_us;
+    stats.lua_vm_pool_hits = gbl_lua_vm_pool_hits;
+    stats.lua_vm_pool_misses = gbl_lua_vm_pool_misses;
     curtran_puttran(trans);
 
     update_sqllogfill_metrics();
     update_fastsql_metrics();
+    update_latency_metrics();
     stats.max_current_connections = time_metric_max(thedb->connections);
 
     return 0;
@@ -17,6 +17,7 @@
 #include "sql.h"
 #include "tohex.h"
 #include "string_ref.h"
+#include "query_plan_baseline.h"
 
 #include <math.h>
 #include <ctrace.h>
@@ -71,8 +72,9 @@ struct string_ref *form_query_plan(struct sqlclntstate *clnt, sqlite3_stmt *stmt
 
 // assumed to have fingerprint lock
 // assume t->query_plan_hash is not NULL
-void add_query_plan(int64_t cost, int64_t nrows, struct fingerprint_track *t, struct string_ref *zSql_ref,
-                    struct string_ref *query_plan_ref, unsigned char *plan_fingerprint, char *params)
+void add_query_plan(sqlite3_stmt *stmt, int64_t cost, int64_t nrows, struct fingerprint_track *t,
+                    struct string_ref *zSql_ref, struct string_ref *query_plan_ref, unsigned char *plan_fingerprint,
+                    char *params)
 {
     if (nrows < 0) {
         return;
@@ -101,6 +103,7 @@ void add_query_plan(int64_t cost, int64_t nrows, struct fingerprint_track *t, st
             q = calloc(1, sizeof(struct query_plan_item));
             memcpy(q->plan_fingerprint, plan_fingerprint, FINGERPRINTSZ);
             q->plan_ref = query_plan_ref ? get_ref(query_plan_ref) : NULL;
+            q->hints = query_plan_ref ? form_query_plan_hints(stmt) : NULL;
             q->total_cost_per_row = current_cost_per_row;
             q->nexecutions = 1;
             q->alert_once_cost = 1;
@@ -117,6 +120,8 @@ void add_query_plan(int64_t cost, int64_t nrows, struct fingerprint_track *t, st
         }
     }
 
+    query_plan_baseline_check(t, q);
+
     // add to queries sample if there exists a plan
     if (gbl_sample_queries && q->plan_ref)
         add_query_to_samples_queries(t->fingerprint, q->plan_fingerprint, zSql_ref, q->plan_ref, params);
@@ -181,6 +186,7 @@ int free_query_plan_hash(hash_t *query_plan_hash)
          q = (struct query_plan_item *)hash_next(query_plan_hash, &ent, &bkt)) {
         if (q->plan_ref)
             put_ref(&q->plan_ref);
+        free(q->hints);
         free(q);
     }
     hash_clear(query_plan_hash);
@@ -35,6 +35,8 @@
 #include "sc_rename_table.h"
 #include <disttxn.h>
 #include "views.h"
+#include "query_plan_baseline.h"
+#include "comdb2_atomic.h"
 
 /* Maximum allowable size of the value of tunable. */
 #define MAX_TUNABLE_VALUE_SIZE 512
@@ -113,6 +115,7 @@ extern int gbl_fdb_watchdog_latency_secs;
 extern int gbl_fdb_watchdog_debug;
 extern int gbl_fdb_add_stat_delay_ms;
 extern int gbl_fdb_watchdog_alerts;
+extern int gbl_fdb_schema_refresh;
 extern int gbl_forbid_ulonglong;
 extern int gbl_force_highslot;
 extern int gbl_fdb_resolve_local;
@@ -137,9 +140,14 @@ extern int gbl_master_swing_sock_restart_sleep;
 extern int gbl_max_key_size_new;
 extern int gbl_max_lua_instructions;
 extern int gbl_max_lua_source_len;
+extern int gbl_lua_bytecode_cache_size;
+extern int gbl_lua_vm_pool_size;
+extern int gbl_wait_event_sample_ms;
+extern int gbl_wait_event_window_secs;
 extern int gbl_max_sqlcache;
 extern int __gbl_max_mpalloc_sleeptime;
 extern int gbl_mem_nice;
+extern char *gbl_malloc_tcache;
 extern int gbl_notimeouts;
 extern int gbl_watchdog_disable_at_start;
 extern int gbl_osql_verify_retries_max;
@@ -309,6 +317,7 @@ extern int gbl_rand_elect_max_ms;
 extern int gbl_handle_buf_add_latency_ms;
 extern int gbl_osql_send_startgen;
 extern int gbl_osql_send_fingerprint;
+extern int gbl_osql_send_dbq_consume_batch;
 extern int gbl_log_fingerprint;
 extern int gbl_create_default_user;
 extern int gbl_allow_neg_column_size;
@@ -359,6 +368,12 @@ extern int gbl_client_abort_on_slow;
 extern int gbl_max_trigger_threads;
 extern int gbl_alternate_normalize;
 extern int gbl_sc_logbytes_per_second;
+extern int gbl_sc_sorted_index_build;
+extern int gbl_sc_sorted_index_batch;
+extern int gbl_sc_range_threads;
+extern int gbl_sc_ranges_per_thread;
+extern int gbl_instant_sc_drop_column;
+extern int gbl_instant_sc_upgrade_delay;
 extern int gbl_fingerprint_max_queries;
 extern int gbl_query_plan_max_plans;
 extern double gbl_query_plan_percentage;
@@ -462,6 +477,12 @@ extern int gbl_queuedb_file_interval;
 extern int gbl_queuedb_timeout_sec;
 
 extern int gbl_timeseries_metrics;
+extern int gbl_latency_histograms;
+extern int gbl_latency_step_sample;
+extern int gbl_ixsketch;
+extern int gbl_ixsketch_samples;
+extern int gbl_ixsketch_refresh_pct;
+extern int gbl_ixsketch_refresh_min_ops;
 extern int gbl_metric_maxpoints;
 extern int gbl_metric_maxage;
 extern int gbl_abort_irregular_set_durable_lsn;
@@ -503,6 +524,8 @@ extern int gbl_permit_small_sequences;
 extern int gbl_debug_sleep_in_sql_tick;
 extern int gbl_debug_sleep_in_analyze;
 extern int gbl_debug_sleep_in_summarize;
+extern int gbl_analyze_sample_leaf_pages;
+extern int gbl_analyze_sample_max_iops;
 extern int gbl_debug_sleep_in_trigger_info;
 extern int gbl_replicant_retry_on_not_durable;
 extern int gbl_debug_force_non_durable;
@@ -602,6 +625,8 @@ int gbl_sqlite_sorterpenalty = 5;
 int gbl_file_permissions = 0660;
 
 extern int gbl_net_maxconn;
+extern int gbl_net_batch_usec;
+extern int gbl_net_batch_bytes;
 extern int gbl_force_direct_io;
 extern int gbl_seekscan_maxsteps;
 extern int gbl_wal_osync;
@@ -627,6 +652,7 @@ extern int gbl_retro_tpt_verbose;
 extern int gbl_retro_tpt_start;
 extern int gbl_legacy_tpt;
 extern int gbl_dohsql_joins;
+extern int gbl_timepart_prune_shards;
 extern int gbl_altersc_latency;
 extern int gbl_altersc_delay_usec;
 extern int gbl_altersc_latency_thr;
@@ -641,6 +667,7 @@ extern int gbl_legacy_requests_verbose;
 extern int gbl_long_request_ms;
 extern int gbl_nonodh_queue_scan_limit;
 extern int gbl_sql_row_delay_msecs;
+extern int gbl_sql_query_arena;
 extern int gbl_thread_wait_sec;
 
 int64_t gbl_driver_ulimit = 0;
@@ -937,6 +964,15 @@ static int memnice_update(void *context, void *value)
     return 0;
 }
 
+static int malloc_tcache_update(void *context, void *value)
+{
+    comdb2_tunable *tunable = (comdb2_tunable *)context;
+    if (comdb2ma_tcache_set((char *)value) != 0)
+        return 1;
+    *(char **)tunable->var = intern((char *)value);
+    return 0;
+}
+
 int dtastripe_verify(void *context, void *stripes)
 {
     int iStripes = *(int *)stripes;
@@ -1228,6 +1264,15 @@ static int pbkdf2_iterations_update(void *context, void *value)
     return set_pbkdf2_iterations(*(int *)value);
 }
 
+static int query_plan_baseline_pin_update(void *context, void *value)
+{
+    comdb2_tunable *tunable = (comdb2_tunable *)context;
+    *(int *)tunable->var = *(int *)value;
+    /* cached statements were planned under the old setting */
+    ATOMIC_ADD32(gbl_plan_baseline_gen, 1);
+    return 0;
+}
+
 static int page_order_table_scan_update(void *context, void *value)
 {
     if ((*(int *)value) == 0) {
@@ -79,6 +79,15 @@ REGISTER_TUNABLE("analyze_tbl_threads",
                  "generating index statistics. (Default: 5)",
                  TUNABLE_INTEGER, &analyze_max_table_threads, READONLY, NULL,
                  NULL, analyze_set_max_table_threads, NULL);
+REGISTER_TUNABLE("analyze_sample_leaf_pages",
+                 "Indexes whose sampled share of leaf pages exceeds this are "
+                 "sampled by random descent to this many leaves; 0 always "
+                 "scans the index file. (Default: 65536)",
+                 TUNABLE_INTEGER, &gbl_analyze_sample_leaf_pages, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("analyze_sample_max_iops",
+                 "Page reads per second allowed to each analyze sampling "
+                 "thread; 0 is unlimited. (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_analyze_sample_max_iops, 0, NULL, NULL, NULL, NULL);
 REGISTER_TUNABLE("always_reload_analyze", "Reload analyze data on every query. (Default: off)", TUNABLE_BOOLEAN,
                  &gbl_always_reload_analyze, 0, NULL, NULL, NULL, NULL);
 REGISTER_TUNABLE("archive_on_init",
@@ -584,6 +593,9 @@ REGISTER_TUNABLE("fdb_add_stat_delay_ms",
                  "Testing only: sleep this many ms in the fdb schema/stats retrieval window to widen the "
                  "stat-collection race. (Default: 0)",
                  TUNABLE_INTEGER, &gbl_fdb_add_stat_delay_ms, INTERNAL, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("fdb_schema_refresh",
+                 "Fdb watchdog checks cached remote tables for new versions and refreshes their schema (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_fdb_schema_refresh, 0, NULL, NULL, NULL, NULL);
 REGISTER_TUNABLE("fdb_watchdog_alerts", "Output only, reports how many fdb watchdog alerts were reported",
                  TUNABLE_INTEGER, &gbl_fdb_watchdog_alerts, READONLY, NULL, NULL, NULL, NULL);
 REGISTER_TUNABLE("forbid_ulonglong", "Disallow u_longlong. (Default: on)", TUNABLE_BOOLEAN, &gbl_forbid_ulonglong,
@@ -694,6 +706,14 @@ REGISTER_TUNABLE("instant_schema_change",
                  "will not rebuild the underlying tables. (Default: on)",
                  TUNABLE_BOOLEAN, &gbl_init_with_instant_sc, READONLY | NOARG,
                  NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("instant_sc_drop_column",
+                 "Let instant schema change drop columns.  "
+                 "(Default: on)",
+                 TUNABLE_BOOLEAN, &gbl_instant_sc_drop_column, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("instant_sc_upgrade_delay",
+                 "If set, upgrade all rows to the new version this many seconds after an instant schema change.  "
+                 "(Default: 0)",
+                 TUNABLE_INTEGER, &gbl_instant_sc_upgrade_delay, 0, NULL, NULL, NULL, NULL);
 REGISTER_TUNABLE("ioqueue",
                  "Maximum depth of the I/O prefaulting queue. (Default: 0)",
                  TUNABLE_INTEGER, &gbl_ioqueue, READONLY, NULL, NULL, NULL,
@@ -702,6 +722,23 @@ REGISTER_TUNABLE("iothreads",
                  "Number of threads to use for I/O prefaulting. (Default: 0)",
                  TUNABLE_INTEGER, &gbl_iothreads, READONLY, NULL, NULL, NULL,
                  NULL);
+REGISTER_TUNABLE("ixsketch",
+                 "Keep per-index distinct-count and sample sketches from the "
+                 "write path. (Default: on)",
+                 TUNABLE_BOOLEAN, &gbl_ixsketch, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("ixsketch_samples",
+                 "Keys sampled per index sketch; applies to sketches created "
+                 "after the change. (Default: 128)",
+                 TUNABLE_INTEGER, &gbl_ixsketch_samples, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("ixsketch_refresh_pct",
+                 "Under autoanalyze, refresh a table's stats from its index "
+                 "sketches once this percent of it has changed; 0 disables. "
+                 "(Default: 10)",
+                 TUNABLE_INTEGER, &gbl_ixsketch_refresh_pct, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("ixsketch_refresh_min_ops",
+                 "Minimum changes to a table before its stats are refreshed "
+                 "from its index sketches. (Default: 1000)",
+                 TUNABLE_INTEGER, &gbl_ixsketch_refresh_min_ops, 0, NULL, NULL, NULL, NULL);
 REGISTER_TUNABLE("keycompr",
                  "Enable index compression (applies to newly allocated index "
                  "pages, rebuild table to force for all pages.",
@@ -815,6 +852,15 @@ REGISTER_TUNABLE("max_lua_source_len",
                  "Procedures exceeding this limit will be rejected. "
                  "(Default: 1048576)",
                  TUNABLE_INTEGER, &gbl_max_lua_source_len, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("lua_bytecode_cache_size",
+                 "Number of compiled stored procedure chunks kept for reuse "
+                 "across connections. 0 disables the cache. (Default: 256)",
+                 TUNABLE_INTEGER, &gbl_lua_bytecode_cache_size, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("lua_vm_pool_size",
+                 "Number of idle Lua vms kept from closed connections for the "
+                 "next run of the same stored procedure by the same user. "
+                 "0 disables the pool. (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_lua_vm_pool_size, 0, NULL, NULL, NULL, NULL);
 REGISTER_TUNABLE("max_key_size_new", "Use new logic for checking max key size (Default: on)", TUNABLE_INTEGER,
                  &gbl_max_key_size_new, 0, NULL, NULL, NULL, NULL);
 REGISTER_TUNABLE("max_num_compact_pages_per_txn", NULL, TUNABLE_INTEGER,
@@ -850,6 +896,11 @@ REGISTER_TUNABLE("max_query_fingerprints",
                  NULL, NULL, NULL);
 REGISTER_TUNABLE("memnice", NULL, TUNABLE_INTEGER, &gbl_mem_nice,
                  READONLY | NOARG, NULL, NULL, memnice_update, NULL);
+REGISTER_TUNABLE("malloc_tcache",
+                 "Allocators that serve small chunks from per-thread caches. "
+                 "(Default: sqlite,protobuf)",
+                 TUNABLE_STRING, &gbl_malloc_tcache, 0, NULL, NULL,
+                 malloc_tcache_update, NULL);
 REGISTER_TUNABLE("mempget_timeout", NULL, TUNABLE_INTEGER,
                  &__gbl_max_mpalloc_sleeptime, READONLY, NULL, NULL, NULL,
                  NULL);
@@ -1414,6 +1465,19 @@ REGISTER_TUNABLE("max_plan_query_plans",
                  "Maximum number of plans to be placed into the query plan "
                  "hash for each fingerprint (Default: 20)",
                  TUNABLE_INTEGER, &gbl_query_plan_max_plans, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("query_plan_baseline_percentage",
+                 "Flag a plan regression if a query's current plan costs n percent more per row than its "
+                 "baseline plan. (Default: 50)",
+                 TUNABLE_DOUBLE, &gbl_query_plan_baseline_percentage, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("query_plan_baseline_min_executions",
+                 "Executions of a plan before it can be captured as a baseline or flagged as a "
+                 "regression. (Default: 10)",
+                 TUNABLE_INTEGER, &gbl_query_plan_baseline_min_executions, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("query_plan_baseline_pin",
+                 "Re-prepare queries whose plan regressed against their baseline using only the "
+                 "baseline's indexes. (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_query_plan_baseline_pin, 0, NULL, NULL, query_plan_baseline_pin_update,
+                 NULL);
 REGISTER_TUNABLE("bdboslog", NULL, TUNABLE_INTEGER, &gbl_namemangle_loglevel,
                  READONLY, NULL, NULL, NULL, NULL);
 REGISTER_TUNABLE("deadlock_rep_retry_max", NULL, TUNABLE_INTEGER,
@@ -1740,6 +1804,15 @@ REGISTER_TUNABLE("timeseries_metrics",
                  "Keep time series data for some metrics",
                  TUNABLE_BOOLEAN, &gbl_timeseries_metrics, 0, NULL, NULL, NULL, NULL);
 
+REGISTER_TUNABLE("latency_histograms",
+                 "Record commit, replication, osql, sql and page read latencies "
+                 "into histograms (Default: on)",
+                 TUNABLE_BOOLEAN, &gbl_latency_histograms, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("latency_step_sample",
+                 "Time the first step of each sql statement and every Nth step after it for the sql_step "
+                 "histogram; 0 disables step timing (Default: 64)",
+                 TUNABLE_INTEGER, &gbl_latency_step_sample, 0, NULL, NULL, NULL, NULL);
+
 REGISTER_TUNABLE("handle_buf_latency_ms",
                  "Add up to this much artificial latency to handle-buf.  "
                  "(Default: 0)",
@@ -1765,6 +1838,13 @@ REGISTER_TUNABLE("osql_send_fingerprint",
                  "whole cluster is upgraded. (Default: off)",
                  TUNABLE_BOOLEAN, &gbl_osql_send_fingerprint, EXPERIMENTAL | INTERNAL, NULL, NULL, NULL, NULL);
 
+REGISTER_TUNABLE("osql_send_dbq_consume_batch",
+                 "Send a Lua consumer's consume_batch() as a single osql op "
+                 "that the master applies in one pass over the queue. Keep "
+                 "off until the whole cluster is upgraded. (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_osql_send_dbq_consume_batch, EXPERIMENTAL | INTERNAL, NULL, NULL, NULL,
+                 NULL);
+
 REGISTER_TUNABLE("log_fingerprint",
                  "Master logs the SQL fingerprint it received in the osql "
                  "stream, so replicants can attribute the page-in I/O they do "
@@ -2463,10 +2543,37 @@ REGISTER_TUNABLE("sc_logbytes_per_second",
                  "Throttle schema-changes to this many logbytes per second.  (Default: 10000000)",
                  TUNABLE_INTEGER, &gbl_sc_logbytes_per_second, EXPERIMENTAL | INTERNAL, NULL, NULL, NULL, NULL);
 
+REGISTER_TUNABLE("sc_sorted_index_build",
+                 "When a schema change only builds indexes, add rows in batches sorted on the first new index.  "
+                 "(Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_sc_sorted_index_build, 0, NULL, NULL, NULL, NULL);
+
+REGISTER_TUNABLE("sc_sorted_index_batch",
+                 "Rows per transaction for sc_sorted_index_build.  (Default: 256)",
+                 TUNABLE_INTEGER, &gbl_sc_sorted_index_batch, NOZERO, NULL, NULL, NULL, NULL);
+
+REGISTER_TUNABLE("sc_range_threads",
+                 "If set, index rebuilds split each stripe into genid ranges and convert them with this many "
+                 "threads.  (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_sc_range_threads, 0, NULL, NULL, NULL, NULL);
+
+REGISTER_TUNABLE("sc_ranges_per_thread",
+                 "Genid ranges to create per sc_range_threads thread.  (Default: 8)",
+                 TUNABLE_INTEGER, &gbl_sc_ranges_per_thread, NOZERO, NULL, NULL, NULL, NULL);
+
 REGISTER_TUNABLE("net_somaxconn",
                  "listen() backlog setting.  (Default: 0, implies system default)",
                  TUNABLE_INTEGER, &gbl_net_maxconn, READONLY, NULL, NULL, NULL, NULL);
 
+REGISTER_TUNABLE("net_batch_usec",
+                 "Write messages which are not nodelay within this long, sharing one write per node. "
+                 "0 leaves them queued until the next flush.  (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_net_batch_usec, 0, NULL, NULL, NULL, NULL);
+
+REGISTER_TUNABLE("net_batch_bytes",
+                 "Write a held-back batch as soon as this many bytes are queued.  (Default: 65536)",
+                 TUNABLE_INTEGER, &gbl_net_batch_bytes, NOZERO, NULL, NULL, NULL, NULL);
+
 REGISTER_TUNABLE("throttle_txn_chunks_msec", "Wait that many milliseconds before starting a new chunk  (Default: 0)",
                  TUNABLE_INTEGER, &gbl_throttle_txn_chunks_msec, 0, NULL, NULL, NULL, NULL);
 
@@ -2666,6 +2773,11 @@ REGISTER_TUNABLE(
 REGISTER_TUNABLE("dohsql_joins", "Enable to support joins in parallel sql execution (default: on)", TUNABLE_BOOLEAN,
                  &gbl_dohsql_joins, 0, NULL, NULL, NULL, NULL);
 
+REGISTER_TUNABLE("timepart_prune_shards",
+                 "Skip time partition shards whose row timestamps cannot match a comdb2_rowtimestamp predicate "
+                 "(default: on)",
+                 TUNABLE_BOOLEAN, &gbl_timepart_prune_shards, 0, NULL, NULL, NULL, NULL);
+
 REGISTER_TUNABLE("altersc_latency", "Enable tracking master queue latency and delay alter schema changes if too high",
                  TUNABLE_BOOLEAN, &gbl_altersc_latency, 0, NULL, NULL, NULL, NULL);
 
@@ -2722,6 +2834,9 @@ REGISTER_TUNABLE("nudge_replication_when_idle",
 
 REGISTER_TUNABLE("sql_row_delay_msecs", "Add this delay before sending back a row, for every row (default: 0)",
                  TUNABLE_INTEGER, &gbl_sql_row_delay_msecs, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("sql_query_arena",
+                 "Serve small sqlite allocations of a statement from a per-connection arena (default: on)",
+                 TUNABLE_BOOLEAN, &gbl_sql_query_arena, 0, NULL, NULL, NULL, NULL);
 REGISTER_TUNABLE("thread_wait_sec", "Wait that many seconds for each thread to exit during a clean exit (default: 5)",
                  TUNABLE_INTEGER, &gbl_thread_wait_sec, 0, NULL, NULL, NULL, NULL);
 
@@ -2755,4 +2870,13 @@ REGISTER_TUNABLE("rep_verify_peer_hostname",
                  "only in environments without reliable reverse DNS. "
                  "(Default: off)",
                  TUNABLE_BOOLEAN, &gbl_rep_verify_peer_hostname, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("wait_event_sample_ms",
+                 "Sample what each busy sql and request thread is waiting on "
+                 "this often, for comdb2_wait_events. 0 stops sampling. "
+                 "(Default: 100)",
+                 TUNABLE_INTEGER, &gbl_wait_event_sample_ms, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("wait_event_window_secs",
+                 "Length of each comdb2_wait_events time window. The last 60 "
+                 "windows are kept. (Default: 60)",
+                 TUNABLE_INTEGER, &gbl_wait_event_window_secs, 0, NULL, NULL, NULL, NULL);
 #endif /* _DB_TUNABLES_H */
@@ -384,6 +384,8 @@ void eventlog_perfdata(cson_object *obj, const struct reqlogger *logger)
                     cson_new_int(logger->durationus - logger->queuetimeus));
     if (logger->netwaitus)
         cson_object_set(perfobj, "netwaitus", cson_new_int(logger->netwaitus));
+    if (logger->arenabytes)
+        cson_object_set(perfobj, "arenabytes", cson_new_int(logger->arenabytes));
     if (logger->queuetimeus)
         cson_object_set(perfobj, "qtime", cson_new_int(logger->queuetimeus));
 
@@ -410,6 +412,18 @@ void eventlog_perfdata(cson_object *obj, const struct reqlogger *logger)
                             cson_new_int(thread_stats->pwrite_time_us));
         }
     }
+    if (thread_stats->n_cache_misses)
+        cson_object_set(perfobj, "cachemisses",
+                        cson_new_int(thread_stats->n_cache_misses));
+    if (thread_stats->log_bytes)
+        cson_object_set(perfobj, "logbytes",
+                        cson_new_int(thread_stats->log_bytes));
+    if (thread_stats->n_temp_spills) {
+        cson_object_set(perfobj, "tempspills",
+                        cson_new_int(thread_stats->n_temp_spills));
+        cson_object_set(perfobj, "tempspillbytes",
+                        cson_new_int(thread_stats->temp_spill_bytes));
+    }
     cson_object_set(obj, "perf", perfval);
 }
 
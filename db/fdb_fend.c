@@ -95,6 +95,7 @@ int gbl_fdb_add_stat_delay_ms = 0;      /* testing only: sleep this many ms in t
 int gbl_fdb_watchdog_alerts = 0;        /* keep count of how many alerts were generated */
 int gbl_fdb_watchdog_secs = 60;         /* run watched every this number of seconds */
 int gbl_fdb_watchdog_latency_secs = 59; /* alert if ping takes longer */
+int gbl_fdb_schema_refresh = 0;         /* watchdog polls and refreshes stale remote schemas */
 
 struct fdb_tbl;
 struct fdb;
@@ -6845,6 +6846,18 @@ static int _run_ping(char *query)
     return rc;
 }
 
+/* name to use for this fdb in sql, including class or local prefix */
+static void _fdb_sql_dbname(fdb_t *fdb, char *dbname, size_t len)
+{
+    if (fdb->local) {
+        snprintf(dbname, len, "LOCAL_%s", fdb->dbname);
+    } else if (fdb->class != get_my_mach_class()) {
+        snprintf(dbname, len, "%s_%s", mach_class_class2tier(fdb->class), fdb->dbname);
+    } else {
+        snprintf(dbname, len, "%s", fdb->dbname);
+    }
+}
+
 /* we have read livelock on this fdb */
 int _ping_fdb(fdb_t *fdb)
 {
@@ -6852,13 +6865,7 @@ int _ping_fdb(fdb_t *fdb)
     char dbname[256];
     int rc;
 
-    if (fdb->local) {
-        snprintf(dbname, sizeof(dbname), "LOCAL_%s", fdb->dbname);
-    } else if (fdb->class != get_my_mach_class()) {
-        snprintf(dbname, sizeof(dbname), "%s_%s", mach_class_class2tier(fdb->class), fdb->dbname);
-    } else {
-        snprintf(dbname, sizeof(dbname), "%s", fdb->dbname);
-    }
+    _fdb_sql_dbname(fdb, dbname, sizeof(dbname));
     query = sqlite3_mprintf("select 1 from \"%w\".sqlite_master limit 1", dbname);
 
     rc = _run_ping(query);
@@ -6871,6 +6878,94 @@ int _ping_fdb(fdb_t *fdb)
     return rc;
 }
 
+/**
+ * Check the cached tables of this fdb against the remote table versions.
+ * A table that changed remotely is marked stale and its new schema is
+ * pulled in here, by preparing a query against it, so sql threads find a
+ * current cache instead of fetching the schema on their query path.
+ *
+ * This costs one version rpc per cached table on every watchdog run, so it
+ * only runs with fdb_schema_refresh on.  It does not help the first query
+ * that touches a remote table, nor the sqlite_stat fetch that comes with
+ * it; those still run on the query thread.
+ *
+ * we have read livelock on this fdb
+ */
+static void _refresh_fdb_schemas(fdb_t *fdb)
+{
+    struct errstat err;
+    unsigned long long remote_version;
+    unsigned long long *versions;
+    char **names;
+    char dbname[256];
+    char *query;
+    fdb_tbl_t *tbl;
+    int ntbls;
+    int i;
+    int rc;
+
+    Pthread_mutex_lock(&fdb->tables_mtx);
+    ntbls = listc_size(&fdb->tables);
+    names = calloc(ntbls + 1, sizeof(char *));
+    versions = calloc(ntbls + 1, sizeof(unsigned long long));
+    if (!names || !versions) {
+        Pthread_mutex_unlock(&fdb->tables_mtx);
+        free(names);
+        free(versions);
+        return;
+    }
+    i = 0;
+    LISTC_FOR_EACH(&fdb->tables, tbl, lnk)
+    {
+        /* stats are collected together with their first table */
+        if (strncasecmp(tbl->name, "sqlite_stat", strlen("sqlite_stat")) == 0)
+            continue;
+        names[i] = strdup(tbl->name);
+        versions[i] = tbl->version;
+        if (names[i])
+            i++;
+    }
+    ntbls = i;
+    Pthread_mutex_unlock(&fdb->tables_mtx);
+
+    _fdb_sql_dbname(fdb, dbname, sizeof(dbname));
+
+    for (i = 0; i < ntbls && !db_is_exiting(); i++) {
+        bzero(&err, sizeof(err));
+        rc = fdb_get_remote_version(fdb->dbname, names[i], fdb->class, fdb->loc == NULL, &remote_version, &err);
+        if (rc != FDB_NOERR || remote_version == versions[i])
+            continue;
+
+        if (gbl_fdb_track)
+            logmsg(LOGMSG_USER, "Refreshing remote table \"%s.%s\" version %llu -> %llu\n", fdb->dbname, names[i],
+                   versions[i], remote_version);
+
+        /* same hint a stale remote reply leaves behind */
+        Pthread_mutex_lock(&fdb->tables_mtx);
+        tbl = hash_find_readonly(fdb->h_tbls_name, &names[i]);
+        if (tbl) {
+            Pthread_mutex_lock(&tbl->need_version_mtx);
+            tbl->need_version = remote_version + 1;
+            Pthread_mutex_unlock(&tbl->need_version_mtx);
+        }
+        Pthread_mutex_unlock(&fdb->tables_mtx);
+
+        /* preparing this replaces the stale table in the fdb cache */
+        query = sqlite3_mprintf("select 1 from \"%w\".\"%w\" limit 0", dbname, names[i]);
+        if (query) {
+            rc = _run_ping(query);
+            if (rc)
+                logmsg(LOGMSG_ERROR, "Failed to refresh remote table %s.%s rc %d\n", fdb->dbname, names[i], rc);
+            sqlite3_free(query);
+        }
+    }
+
+    for (i = 0; i < ntbls; i++)
+        free(names[i]);
+    free(names);
+    free(versions);
+}
+
 void _alert_maybe(const char *dbname, unsigned long long start_rpc, unsigned long long end_rpc)
 {
     if (end_rpc - start_rpc > gbl_fdb_watchdog_latency_secs * 1000) {
@@ -6912,6 +7007,9 @@ void fdb_watchdog(void)
 
         _alert_maybe(fdb->dbname, start_rpc, end_rpc);
 
+        if (gbl_fdb_schema_refresh)
+            _refresh_fdb_schemas(fdb);
+
         start_rpc = osql_log_time();
         Pthread_mutex_lock(&fdbs.arr_mtx);
         end_rpc = osql_log_time();
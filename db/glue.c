@@ -97,6 +97,7 @@
 #include <comdb2_atomic.h>
 #include <bbhrtime.h>
 #include <sqllogfill.h>
+#include "ixsketch.h"
 
 int (*comdb2_ipc_master_set)(char *host) = 0;
 
@@ -1094,6 +1095,8 @@ int ix_addk(struct ireq *iq, void *trans, void *key, int ixnum,
     ACCUMULATE_TIMING(CHR_IXADDK,
                       rc = ix_addk_auxdb(AUXDB_NONE, iq, trans, key, ixnum,
                                          genid, rrn, dta, dtalen, isnull););
+    if (rc == 0)
+        ixsketch_addkey(iq, ixnum, key, genid);
     return rc;
 }
 
@@ -1164,7 +1167,10 @@ int ix_delk_auxdb(int auxdb, struct ireq *iq, void *trans, void *key, int ixnum,
 int ix_delk(struct ireq *iq, void *trans, void *key, int ixnum, int rrn,
             unsigned long long genid, int isnull)
 {
-    return ix_delk_auxdb(AUXDB_NONE, iq, trans, key, ixnum, rrn, genid, isnull);
+    int rc = ix_delk_auxdb(AUXDB_NONE, iq, trans, key, ixnum, rrn, genid, isnull);
+    if (rc == 0)
+        ixsketch_delkey(iq, ixnum, key, genid);
+    return rc;
 }
 
 inline int dat_upv(struct ireq *iq, void *trans, int vptr, void *vdta, int vlen,
@@ -5257,7 +5263,7 @@ int lite_del_auxdb(int auxdb, struct ireq *iq, void *trans, void *key)
 /*         QUEUE DATABASES           */
 /*~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
 
-int dbq_add_recno(struct ireq *iq, void *trans, uint32_t recno, const void *dta, size_t dtalen)
+static int dbq_add_int(struct ireq *iq, void *trans, uint32_t recno, int partition, const void *dta, size_t dtalen)
 {
     int bdberr;
     void *bdb_handle;
@@ -5266,7 +5272,10 @@ int dbq_add_recno(struct ireq *iq, void *trans, uint32_t recno, const void *dta,
     if (!bdb_handle)
         return ERR_NO_AUXDB;
     iq->gluewhere = "bdb_queue_add";
-    bdb_queue_add_recno(bdb_handle, trans, recno, dta, dtalen, &bdberr, &genid);
+    if (partition >= 0)
+        bdb_queue_add_partition(bdb_handle, trans, partition, dta, dtalen, &bdberr, &genid);
+    else
+        bdb_queue_add_recno(bdb_handle, trans, recno, dta, dtalen, &bdberr, &genid);
     iq->gluewhere = "bdb_queue_add done";
 
     if (bdberr == 0) {
@@ -5302,6 +5311,18 @@ int dbq_add_recno(struct ireq *iq, void *trans, uint32_t recno, const void *dta,
     return map_unhandled_bdb_wr_rcode("bdb_queue_add", bdberr);
 }
 
+int dbq_add_recno(struct ireq *iq, void *trans, uint32_t recno, const void *dta, size_t dtalen)
+{
+    return dbq_add_int(iq, trans, recno, -1, dta, dtalen);
+}
+
+/* add to a single consumer slot of a partitioned queue; -1 adds for every
+ * active consumer like dbq_add */
+int dbq_add_partition(struct ireq *iq, void *trans, int partition, const void *dta, size_t dtalen)
+{
+    return dbq_add_int(iq, trans, 0, partition, dta, dtalen);
+}
+
 int dbq_add(struct ireq *iq, void *trans, const void *dta, size_t dtalen)
 {
     return dbq_add_recno(iq, trans, 0, dta, dtalen);
@@ -5334,7 +5355,38 @@ int dbq_consume_genid(struct ireq *iq, void *trans, int consumer,
     struct bdb_queue_found qfnd = {0};
     qfnd.genid = genid;
     // TODO XXX FIXME: take care of locking in case gbl_block_qconsume_lock
-    return dbq_consume(iq, trans, consumer, &qfnd);
+    int rc = dbq_consume(iq, trans, consumer, &qfnd);
+
+    /* consume requests carry only the genid; in a partitioned queue the item
+     * lives under the consumer slot of its partition */
+    int npartitions = iq->usedb ? iq->usedb->queue_partitions : 0;
+    for (int i = 0; rc == ERR_UNCOMMITTABLE_TXN && i < npartitions; ++i) {
+        if (i != consumer)
+            rc = dbq_consume(iq, trans, i, &qfnd);
+    }
+    return rc;
+}
+
+int dbq_consume_batch(struct ireq *iq, void *trans, int consumer,
+                      const genid_t *genids, int ngenids)
+{
+    int bdberr;
+    bdb_state_type *bdb_handle = get_bdb_handle_ireq(iq, AUXDB_NONE);
+    if (!bdb_handle)
+        return ERR_NO_AUXDB;
+    iq->gluewhere = "bdb_queue_consume_batch";
+    bdb_queue_consume_batch(bdb_handle, trans, consumer, genids, ngenids, &bdberr);
+    iq->gluewhere = "bdb_queue_consume_batch done";
+
+    if (bdberr == 0)
+        return 0;
+    if (bdberr == BDBERR_DEADLOCK)
+        return RC_INTERNAL_RETRY;
+    if (bdberr == BDBERR_READONLY)
+        return ERR_NOMASTER;
+    if (bdberr == BDBERR_DELNOTFOUND)
+        return ERR_UNCOMMITTABLE_TXN;
+    return map_unhandled_bdb_wr_rcode("bdb_queue_consume_batch", bdberr);
 }
 
 int dbq_check_goose(struct ireq *iq, void *trans)
@@ -5551,7 +5603,10 @@ int dbq_odh_stats(struct ireq *iq, dbq_stats_callback_t callback,
 
 retry:
     iq->gluewhere = "bdb_queuedb_stats";
-    rc = bdb_queuedb_stats(bdb_handle, callback, tran, userptr, &bdberr);
+    if (iq->usedb && iq->usedb->queue_partitions)
+        rc = bdb_queuedb_partition_stats(bdb_handle, iq->usedb->queue_partitions, callback, tran, userptr, &bdberr);
+    else
+        rc = bdb_queuedb_stats(bdb_handle, callback, tran, userptr, &bdberr);
     iq->gluewhere = "bdb_queuedb_stats done";
     if (rc != 0) {
         if (bdberr == BDBERR_DEADLOCK) {
@@ -42,6 +42,7 @@
 #include "intern_strings.h"
 #include "logmsg.h"
 #include "transactionstate_systable.h"
+#include "wait_events.h"
 
 #ifdef MONITOR_STACK
 #include "comdb2_pthread_create.h"
@@ -576,7 +577,9 @@ void *thd_req(void *vthd)
         thrman_where(thr_self, req2a(thd->iq->opcode));
         thrman_origin(thr_self, getorigin(thd->iq));
         user_request_begin(REQUEST_TYPE_QTRAP, FLAG_REQUEST_TRACK_EVERYTHING);
+        wait_state_begin_work();
         handle_ireq(thd->iq);
+        wait_state_end_work();
         if (debug_this_request(gbl_debug_until) ||
             (gbl_who > 0 && !gbl_sdebug)) {
             struct per_request_stats *st;
@@ -0,0 +1,586 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/*
+ * Index statistics sketches.
+ *
+ * For every index we keep, since the last ANALYZE:
+ *   - committed key inserts and deletes,
+ *   - one HyperLogLog per key prefix (first column, first two columns, ...)
+ *     counting distinct values among inserted keys,
+ *   - a bottom-k sample of inserted keys: each row gets a priority hashed
+ *     from its genid and the sample keeps the k lowest, which is a uniform
+ *     sample of the inserted rows.  Deleted rows leave the sample.
+ *
+ * Counts and samples are staged on the ireq and applied when the
+ * transaction commits.  HyperLogLog registers are updated as keys are added:
+ * they can't be rolled back, and an aborted insert can only nudge a distinct
+ * count up, which is harmless next to the error the sketch already has.
+ *
+ * The sample check on the write path reads the sketch without its lock; it
+ * only decides whether a key is worth copying, and the commit rechecks.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <math.h>
+#include <pthread.h>
+
+#include <comdb2.h>
+#include <epochlib.h>
+#include <logmsg.h>
+#include <sys_wrap.h>
+#include "ixsketch.h"
+
+int gbl_ixsketch = 1;
+int gbl_ixsketch_samples = 128;
+int gbl_ixsketch_refresh_pct = 10;
+int gbl_ixsketch_refresh_min_ops = 1000;
+
+/* 1024 registers: ~3% standard error */
+#define HLL_BITS 10
+#define HLL_REGS (1 << HLL_BITS)
+
+struct ixsketch {
+    pthread_mutex_t lk;
+    int ncols;
+    int keylen;
+    int *prefixlen;
+    int64_t nins;
+    int64_t ndel;
+    int64_t start;
+    unsigned gen; /* bumped on every reset and consume */
+
+    int maxsamples;
+    int nsamples;
+    uint64_t maxprio; /* largest priority in a full sample */
+    uint64_t *prio;
+    unsigned long long *genid;
+    uint8_t *keys;
+
+    uint8_t *hll; /* ncols * HLL_REGS */
+};
+
+struct ixsketch_count {
+    struct dbtable *db;
+    int ixnum;
+    int64_t nins;
+    int64_t ndel;
+};
+
+struct ixsketch_op {
+    struct dbtable *db;
+    int ixnum;
+    int isdel;
+    uint64_t prio;
+    unsigned long long genid;
+    uint8_t *key;
+};
+
+struct ixsketch_txn {
+    int ncounts;
+    int maxcounts;
+    int last;
+    struct ixsketch_count *counts;
+    int nops;
+    int maxops;
+    struct ixsketch_op *ops;
+};
+
+static pthread_mutex_t ixsketch_create_lk = PTHREAD_MUTEX_INITIALIZER;
+
+static inline uint64_t mix64(uint64_t x)
+{
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+static struct ixsketch *ixsketch_create(struct dbtable *db, int ixnum)
+{
+    struct schema *s = db->ixschema[ixnum];
+    struct ixsketch *sk = calloc(1, sizeof(struct ixsketch));
+    if (sk == NULL)
+        return NULL;
+    sk->ncols = s->nmembers;
+    sk->keylen = db->ix_keylen[ixnum];
+    sk->maxsamples = gbl_ixsketch_samples > 0 ? gbl_ixsketch_samples : 1;
+    sk->start = comdb2_time_epoch();
+    sk->prefixlen = calloc(sk->ncols, sizeof(int));
+    sk->prio = calloc(sk->maxsamples, sizeof(uint64_t));
+    sk->genid = calloc(sk->maxsamples, sizeof(unsigned long long));
+    sk->keys = calloc(sk->maxsamples, sk->keylen);
+    sk->hll = calloc(sk->ncols, HLL_REGS);
+    if (!sk->prefixlen || !sk->prio || !sk->genid || !sk->keys || !sk->hll) {
+        free(sk->prefixlen);
+        free(sk->prio);
+        free(sk->genid);
+        free(sk->keys);
+        free(sk->hll);
+        free(sk);
+        return NULL;
+    }
+    for (int i = 0; i < sk->ncols; i++) {
+        int end = s->member[i].offset + s->member[i].len;
+        sk->prefixlen[i] = end < sk->keylen ? end : sk->keylen;
+    }
+    Pthread_mutex_init(&sk->lk, NULL);
+    return sk;
+}
+
+static void ixsketch_destroy(struct ixsketch *sk)
+{
+    if (sk == NULL)
+        return;
+    Pthread_mutex_destroy(&sk->lk);
+    free(sk->prefixlen);
+    free(sk->prio);
+    free(sk->genid);
+    free(sk->keys);
+    free(sk->hll);
+    free(sk);
+}
+
+/* Sketches are created the first time a table is written */
+static struct ixsketch *get_sketch(struct dbtable *db, int ixnum)
+{
+    if (ixnum < 0 || ixnum >= db->nix)
+        return NULL;
+    if (db->ixsketch == NULL) {
+        Pthread_mutex_lock(&ixsketch_create_lk);
+        if (db->ixsketch == NULL) {
+            struct ixsketch **sketches = calloc(db->nix, sizeof(struct ixsketch *));
+            for (int i = 0; sketches && i < db->nix; i++)
+                sketches[i] = ixsketch_create(db, i);
+            db->ixsketch = sketches;
+        }
+        Pthread_mutex_unlock(&ixsketch_create_lk);
+        if (db->ixsketch == NULL)
+            return NULL;
+    }
+    return db->ixsketch[ixnum];
+}
+
+static void hll_add(struct ixsketch *sk, const uint8_t *key)
+{
+    uint64_t h = 0xcbf29ce484222325ULL;
+    int pos = 0;
+    for (int i = 0; i < sk->ncols; i++) {
+        for (; pos < sk->prefixlen[i]; pos++)
+            h = (h ^ key[pos]) * 0x100000001b3ULL;
+        uint64_t x = mix64(h);
+        uint64_t w = x << HLL_BITS;
+        uint8_t rank = w ? __builtin_clzll(w) + 1 : 64 - HLL_BITS + 1;
+        uint8_t *reg = &sk->hll[i * HLL_REGS + (x >> (64 - HLL_BITS))];
+        if (rank > *reg)
+            *reg = rank;
+    }
+}
+
+static double hll_estimate(const uint8_t *regs)
+{
+    double m = HLL_REGS, sum = 0;
+    int zeros = 0;
+    for (int i = 0; i < HLL_REGS; i++) {
+        sum += ldexp(1.0, -regs[i]);
+        if (regs[i] == 0)
+            zeros++;
+    }
+    double e = (0.7213 / (1 + 1.079 / m)) * m * m / sum;
+    /* linear counting while most registers are still empty */
+    if (e <= 2.5 * m && zeros)
+        e = m * log(m / zeros);
+    return e;
+}
+
+static void sample_fix_maxprio(struct ixsketch *sk)
+{
+    sk->maxprio = 0;
+    if (sk->nsamples < sk->maxsamples)
+        return;
+    for (int i = 0; i < sk->nsamples; i++)
+        if (sk->prio[i] > sk->maxprio)
+            sk->maxprio = sk->prio[i];
+}
+
+static void sample_add(struct ixsketch *sk, uint64_t prio, unsigned long long genid, const uint8_t *key)
+{
+    int slot;
+    if (sk->nsamples < sk->maxsamples) {
+        slot = sk->nsamples++;
+    } else if (prio < sk->maxprio) {
+        for (slot = 0; sk->prio[slot] != sk->maxprio; slot++)
+            ;
+    } else {
+        return;
+    }
+    sk->prio[slot] = prio;
+    sk->genid[slot] = genid;
+    memcpy(sk->keys + (size_t)slot * sk->keylen, key, sk->keylen);
+    sample_fix_maxprio(sk);
+}
+
+static void sample_del(struct ixsketch *sk, unsigned long long genid)
+{
+    for (int i = 0; i < sk->nsamples; i++) {
+        if (sk->genid[i] != genid)
+            continue;
+        int last = --sk->nsamples;
+        sk->prio[i] = sk->prio[last];
+        sk->genid[i] = sk->genid[last];
+        memcpy(sk->keys + (size_t)i * sk->keylen, sk->keys + (size_t)last * sk->keylen, sk->keylen);
+        sample_fix_maxprio(sk);
+        return;
+    }
+}
+
+void ixsketch_txn_begin(struct ireq *iq)
+{
+    struct ixsketch_txn *t = iq->ixsketch_txn;
+    if (t) {
+        /* retry of the same request: drop what the last attempt staged */
+        for (int i = 0; i < t->nops; i++)
+            free(t->ops[i].key);
+        t->nops = t->ncounts = t->last = 0;
+        return;
+    }
+    if (gbl_ixsketch)
+        iq->ixsketch_txn = calloc(1, sizeof(struct ixsketch_txn));
+}
+
+static struct ixsketch_count *txn_count(struct ixsketch_txn *t, struct dbtable *db, int ixnum)
+{
+    if (t->last < t->ncounts && t->counts[t->last].db == db && t->counts[t->last].ixnum == ixnum)
+        return &t->counts[t->last];
+    for (int i = 0; i < t->ncounts; i++) {
+        if (t->counts[i].db == db && t->counts[i].ixnum == ixnum) {
+            t->last = i;
+            return &t->counts[i];
+        }
+    }
+    if (t->ncounts == t->maxcounts) {
+        int n = t->maxcounts ? t->maxcounts * 2 : 8;
+        void *p = realloc(t->counts, n * sizeof(struct ixsketch_count));
+        if (p == NULL)
+            return NULL;
+        t->counts = p;
+        t->maxcounts = n;
+    }
+    t->last = t->ncounts++;
+    t->counts[t->last] = (struct ixsketch_count){.db = db, .ixnum = ixnum};
+    return &t->counts[t->last];
+}
+
+static void txn_op(struct ixsketch_txn *t, struct dbtable *db, int ixnum, int isdel, uint64_t prio,
+                   unsigned long long genid, const void *key, int keylen)
+{
+    if (t->nops == t->maxops) {
+        int n = t->maxops ? t->maxops * 2 : 8;
+        void *p = realloc(t->ops, n * sizeof(struct ixsketch_op));
+        if (p == NULL)
+            return;
+        t->ops = p;
+        t->maxops = n;
+    }
+    struct ixsketch_op *op = &t->ops[t->nops];
+    *op = (struct ixsketch_op){.db = db, .ixnum = ixnum, .isdel = isdel, .prio = prio, .genid = genid};
+    if (!isdel && (op->key = malloc(keylen)) == NULL)
+        return;
+    if (op->key)
+        memcpy(op->key, key, keylen);
+    t->nops++;
+}
+
+void ixsketch_addkey(struct ireq *iq, int ixnum, const void *key, unsigned long long genid)
+{
+    struct ixsketch_txn *t = iq->ixsketch_txn;
+    if (t == NULL || !gbl_ixsketch || iq->usedb == NULL)
+        return;
+    struct ixsketch *sk = get_sketch(iq->usedb, ixnum);
+    if (sk == NULL)
+        return;
+
+    hll_add(sk, key);
+
+    struct ixsketch_count *c = txn_count(t, iq->usedb, ixnum);
+    if (c)
+        c->nins++;
+
+    uint64_t prio = mix64(genid);
+    if (sk->nsamples < sk->maxsamples || prio < sk->maxprio)
+        txn_op(t, iq->usedb, ixnum, 0, prio, genid, key, sk->keylen);
+}
+
+void ixsketch_delkey(struct ireq *iq, int ixnum, const void *key, unsigned long long genid)
+{
+    struct ixsketch_txn *t = iq->ixsketch_txn;
+    if (t == NULL || !gbl_ixsketch || iq->usedb == NULL)
+        return;
+    struct ixsketch *sk = get_sketch(iq->usedb, ixnum);
+    if (sk == NULL)
+        return;
+
+    struct ixsketch_count *c = txn_count(t, iq->usedb, ixnum);
+    if (c)
+        c->ndel++;
+
+    /* only rows whose priority could have got them sampled */
+    uint64_t prio = mix64(genid);
+    if (sk->nsamples > 0 && (sk->nsamples < sk->maxsamples || prio <= sk->maxprio))
+        txn_op(t, iq->usedb, ixnum, 1, prio, genid, NULL, 0);
+}
+
+static void txn_free(struct ireq *iq)
+{
+    struct ixsketch_txn *t = iq->ixsketch_txn;
+    if (t == NULL)
+        return;
+    for (int i = 0; i < t->nops; i++)
+        free(t->ops[i].key);
+    free(t->ops);
+    free(t->counts);
+    free(t);
+    iq->ixsketch_txn = NULL;
+}
+
+static struct ixsketch *committed_sketch(struct dbtable *db, int ixnum)
+{
+    /* the table may have been rebuilt under us; its sketches start over */
+    if (db->ixsketch == NULL || ixnum >= db->nix)
+        return NULL;
+    return db->ixsketch[ixnum];
+}
+
+void ixsketch_txn_commit(struct ireq *iq)
+{
+    struct ixsketch_txn *t = iq->ixsketch_txn;
+    if (t == NULL)
+        return;
+    for (int i = 0; i < t->ncounts; i++) {
+        struct ixsketch *sk = committed_sketch(t->counts[i].db, t->counts[i].ixnum);
+        if (sk == NULL)
+            continue;
+        Pthread_mutex_lock(&sk->lk);
+        sk->nins += t->counts[i].nins;
+        sk->ndel += t->counts[i].ndel;
+        Pthread_mutex_unlock(&sk->lk);
+    }
+    for (int i = 0; i < t->nops; i++) {
+        struct ixsketch_op *op = &t->ops[i];
+        struct ixsketch *sk = committed_sketch(op->db, op->ixnum);
+        if (sk == NULL)
+            continue;
+        Pthread_mutex_lock(&sk->lk);
+        if (op->isdel)
+            sample_del(sk, op->genid);
+        else
+            sample_add(sk, op->prio, op->genid, op->key);
+        Pthread_mutex_unlock(&sk->lk);
+    }
+    txn_free(iq);
+}
+
+void ixsketch_txn_abort(struct ireq *iq)
+{
+    txn_free(iq);
+}
+
+static void ixsketch_reset_int(struct ixsketch *sk)
+{
+    sk->nins = sk->ndel = 0;
+    sk->nsamples = 0;
+    sk->maxprio = 0;
+    sk->start = comdb2_time_epoch();
+    sk->gen++;
+    memset(sk->hll, 0, (size_t)sk->ncols * HLL_REGS);
+}
+
+void ixsketch_reset(struct dbtable *db)
+{
+    for (int i = 0; db->ixsketch && i < db->nix; i++) {
+        struct ixsketch *sk = db->ixsketch[i];
+        if (sk == NULL)
+            continue;
+        Pthread_mutex_lock(&sk->lk);
+        ixsketch_reset_int(sk);
+        Pthread_mutex_unlock(&sk->lk);
+    }
+}
+
+void ixsketch_free(struct dbtable *db)
+{
+    if (db->ixsketch == NULL)
+        return;
+    for (int i = 0; i < db->nix; i++)
+        ixsketch_destroy(db->ixsketch[i]);
+    free(db->ixsketch);
+    db->ixsketch = NULL;
+}
+
+int64_t ixsketch_changes(struct dbtable *db)
+{
+    int64_t changes = 0;
+    struct ixsketch *sk = committed_sketch(db, 0);
+    if (sk) {
+        Pthread_mutex_lock(&sk->lk);
+        changes = sk->nins + sk->ndel;
+        Pthread_mutex_unlock(&sk->lk);
+    }
+    return changes;
+}
+
+struct sample_ref {
+    const uint8_t *key;
+    unsigned long long genid;
+    int keylen;
+};
+
+static int sample_ref_cmp(const void *a, const void *b)
+{
+    const struct sample_ref *x = a, *y = b;
+    int cmp = memcmp(x->key, y->key, x->keylen);
+    if (cmp)
+        return cmp;
+    return x->genid < y->genid ? -1 : x->genid > y->genid;
+}
+
+int ixsketch_view(struct dbtable *db, int ixnum, struct ixsketch_view *v)
+{
+    memset(v, 0, sizeof(*v));
+    struct ixsketch *sk = committed_sketch(db, ixnum);
+    if (sk == NULL)
+        return -1;
+
+    Pthread_mutex_lock(&sk->lk);
+    v->ncols = sk->ncols;
+    v->keylen = sk->keylen;
+    v->nins = sk->nins;
+    v->ndel = sk->ndel;
+    v->start = sk->start;
+    v->gen = sk->gen;
+    v->nsamples = sk->nsamples;
+    v->prefixlen = malloc(sk->ncols * sizeof(int));
+    v->distinct = malloc(sk->ncols * sizeof(double));
+    v->samples = malloc((size_t)sk->nsamples * sk->keylen + 1);
+    v->genids = malloc(sk->nsamples * sizeof(unsigned long long) + 1);
+    struct sample_ref *refs = malloc(sk->nsamples * sizeof(struct sample_ref) + 1);
+    uint8_t *keys = malloc((size_t)sk->nsamples * sk->keylen + 1);
+    if (!v->prefixlen || !v->distinct || !v->samples || !v->genids || !refs || !keys) {
+        Pthread_mutex_unlock(&sk->lk);
+        free(refs);
+        free(keys);
+        ixsketch_view_free(v);
+        return -1;
+    }
+    memcpy(v->prefixlen, sk->prefixlen, sk->ncols * sizeof(int));
+    for (int i = 0; i < sk->ncols; i++)
+        v->distinct[i] = hll_estimate(sk->hll + i * HLL_REGS);
+    memcpy(keys, sk->keys, (size_t)sk->nsamples * sk->keylen);
+    for (int i = 0; i < sk->nsamples; i++)
+        refs[i] = (struct sample_ref){.key = keys + (size_t)i * sk->keylen, .genid = sk->genid[i],
+                                      .keylen = sk->keylen};
+    Pthread_mutex_unlock(&sk->lk);
+
+    qsort(refs, v->nsamples, sizeof(struct sample_ref), sample_ref_cmp);
+    for (int i = 0; i < v->nsamples; i++) {
+        memcpy(v->samples + (size_t)i * v->keylen, refs[i].key, v->keylen);
+        v->genids[i] = refs[i].genid;
+    }
+    free(refs);
+    free(keys);
+    return 0;
+}
+
+static int genid_cmp(const void *a, const void *b)
+{
+    unsigned long long x = *(const unsigned long long *)a, y = *(const unsigned long long *)b;
+    return x < y ? -1 : x > y;
+}
+
+void ixsketch_consume(struct dbtable *db, int ixnum, const struct ixsketch_view *v)
+{
+    struct ixsketch *sk = committed_sketch(db, ixnum);
+    if (sk == NULL)
+        return;
+    unsigned long long *genids = malloc(v->nsamples * sizeof(unsigned long long) + 1);
+    if (genids) {
+        memcpy(genids, v->genids, v->nsamples * sizeof(unsigned long long));
+        qsort(genids, v->nsamples, sizeof(unsigned long long), genid_cmp);
+    }
+
+    Pthread_mutex_lock(&sk->lk);
+    if (sk->gen != v->gen) {
+        /* reset since the view was taken; nothing of it is left */
+        Pthread_mutex_unlock(&sk->lk);
+        free(genids);
+        return;
+    }
+    sk->nins = sk->nins > v->nins ? sk->nins - v->nins : 0;
+    sk->ndel = sk->ndel > v->ndel ? sk->ndel - v->ndel : 0;
+    if (sk->nins == 0 && sk->ndel == 0) {
+        ixsketch_reset_int(sk);
+    } else {
+        /* keep the samples of keys committed after the view.  The HLL
+         * can't be split, so those keys add rows but no distinct values
+         * at the next refresh. */
+        int n = 0;
+        for (int i = 0; i < sk->nsamples; i++) {
+            if (genids == NULL ||
+                bsearch(&sk->genid[i], genids, v->nsamples, sizeof(unsigned long long), genid_cmp))
+                continue;
+            sk->prio[n] = sk->prio[i];
+            sk->genid[n] = sk->genid[i];
+            memmove(sk->keys + (size_t)n * sk->keylen, sk->keys + (size_t)i * sk->keylen, sk->keylen);
+            n++;
+        }
+        sk->nsamples = n;
+        sample_fix_maxprio(sk);
+        sk->gen++;
+        memset(sk->hll, 0, (size_t)sk->ncols * HLL_REGS);
+    }
+    Pthread_mutex_unlock(&sk->lk);
+    free(genids);
+}
+
+void ixsketch_view_free(struct ixsketch_view *v)
+{
+    free(v->prefixlen);
+    free(v->distinct);
+    free(v->samples);
+    free(v->genids);
+    memset(v, 0, sizeof(*v));
+}
+
+void ixsketch_dump(struct dbtable *db)
+{
+    for (int i = 0; i < db->nix; i++) {
+        struct ixsketch_view v;
+        if (ixsketch_view(db, i, &v))
+            continue;
+        logmsg(LOGMSG_USER, "%s ix %d (%s): inserts %" PRId64 " deletes %" PRId64 " samples %d since %" PRId64
+                            " distinct [",
+               db->tablename, i, db->ixschema[i]->sqlitetag ? db->ixschema[i]->sqlitetag : "-", v.nins, v.ndel,
+               v.nsamples, v.start);
+        for (int c = 0; c < v.ncols; c++)
+            logmsg(LOGMSG_USER, "%s%.0f", c ? " " : "", v.distinct[c]);
+        logmsg(LOGMSG_USER, "]\n");
+        ixsketch_view_free(&v);
+    }
+}
@@ -0,0 +1,74 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#ifndef INCLUDED_IXSKETCH_H
+#define INCLUDED_IXSKETCH_H
+
+#include <stdint.h>
+
+/* Per-index statistics sketches maintained from the write path.  Each index
+ * keeps committed insert/delete counts, a HyperLogLog distinct count for
+ * every key prefix, and a bottom-k sample of inserted keys, all since the
+ * last ANALYZE.  analyze_table_from_sketch() folds them into sqlite_stat1
+ * and sqlite_stat4 without scanning the table. */
+
+struct ireq;
+struct dbtable;
+
+extern int gbl_ixsketch;
+extern int gbl_ixsketch_samples;
+extern int gbl_ixsketch_refresh_pct;
+extern int gbl_ixsketch_refresh_min_ops;
+
+/* Write path: keys are recorded against the transaction and only reach
+ * the sketches if it commits. */
+void ixsketch_txn_begin(struct ireq *iq);
+void ixsketch_addkey(struct ireq *iq, int ixnum, const void *key, unsigned long long genid);
+void ixsketch_delkey(struct ireq *iq, int ixnum, const void *key, unsigned long long genid);
+void ixsketch_txn_commit(struct ireq *iq);
+void ixsketch_txn_abort(struct ireq *iq);
+
+/* Forget everything seen so far; called once ANALYZE has captured it */
+void ixsketch_reset(struct dbtable *db);
+void ixsketch_free(struct dbtable *db);
+
+/* Committed inserts + deletes on the table since the last reset */
+int64_t ixsketch_changes(struct dbtable *db);
+
+struct ixsketch_view {
+    int ncols;
+    int keylen;
+    int *prefixlen;     /* key bytes covered by the first i+1 columns */
+    int64_t nins;       /* committed key inserts since the last reset */
+    int64_t ndel;       /* committed key deletes since the last reset */
+    int64_t start;      /* epoch of the last reset */
+    unsigned gen;
+    double *distinct;   /* distinct values of each prefix among inserts */
+    int nsamples;
+    uint8_t *samples;   /* nsamples inserted keys in key order */
+    unsigned long long *genids;
+};
+
+/* Copy index ixnum's sketch */
+int ixsketch_view(struct dbtable *db, int ixnum, struct ixsketch_view *v);
+/* Drop what v saw from the sketch once it is written to the stat tables;
+ * what was committed since v was taken stays */
+void ixsketch_consume(struct dbtable *db, int ixnum, const struct ixsketch_view *v);
+void ixsketch_view_free(struct ixsketch_view *v);
+
+void ixsketch_dump(struct dbtable *db);
+
+#endif
@@ -0,0 +1,685 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/*
+** Microbenchmarks for storage-engine hot paths.
+**
+** send test microbench [name|all] [iterations] [reps]
+**
+** Every benchmark does identical work on every repetition: inputs come from
+** a fixed-seed generator that is reset before each run, and setup (loading a
+** btree, filling a temp table) happens outside the timed region.  One
+** untimed warmup pass precedes the timed repetitions, and the median
+** repetition is reported so a single noisy run doesn't move the result.
+** Output is a single JSON object so runs can be diffed across releases.
+**
+** btree and log benchmarks use a private environment in the temp directory;
+** lock benchmarks use the database's lock manager with objects nobody else
+** can hold, as "send test bdb_lock" does.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <sched.h>
+#include <time.h>
+#include <arpa/inet.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include <comdb2.h>
+#include <bdb_api.h>
+#include <bdb_int.h>
+#include <types.h>
+#include <thdpool.h>
+#include <comdb2rle.h>
+#include <lz4.h>
+#include <logmsg.h>
+#include <comdb2_atomic.h>
+#include <sys_wrap.h>
+
+#if LZ4_VERSION_NUMBER < 10701
+#define LZ4_compress_default LZ4_compress_limitedOutput
+#endif
+
+#define MB_NKEYS 100000
+#define MB_DATASZ 64
+#define MB_SCANLEN 100
+#define MB_RECSZ 256
+#define MB_LOCK_THREADS 4
+#define MB_POOL_THREADS 4
+
+struct microbench;
+
+struct mb_ctx {
+    const struct microbench *bench;
+    int iterations;
+    uint32_t seed;
+    int64_t bytes; /* payload bytes processed per run, if meaningful */
+
+    DB_ENV *dbenv;
+    DB *dbp;
+    char dir[PATH_MAX];
+    struct temp_table *tmptbl;
+    struct temp_cursor *tmpcur;
+    struct thdpool *pool;
+    uint8_t in[MB_RECSZ];
+    uint8_t out[MB_RECSZ * 2];
+};
+
+struct microbench {
+    const char *name;
+    const char *desc;
+    int (*setup)(struct mb_ctx *);
+    /* returns operations performed, or -1 */
+    int64_t (*run)(struct mb_ctx *);
+    void (*teardown)(struct mb_ctx *);
+};
+
+/* xorshift32: deterministic and cheap enough not to show up in results */
+static inline uint32_t mb_rand(struct mb_ctx *c)
+{
+    uint32_t x = c->seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return c->seed = x;
+}
+
+static uint64_t mb_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void mb_key(uint8_t *key, uint32_t k)
+{
+    /* big-endian so memcmp order is numeric order */
+    key[0] = k >> 24;
+    key[1] = k >> 16;
+    key[2] = k >> 8;
+    key[3] = k;
+}
+
+/* Record with runs of zeros and repeated bytes, roughly like an ondisk row
+ * with small integers and padded strings */
+static void mb_fill_record(struct mb_ctx *c)
+{
+    c->seed = 1;
+    for (int i = 0; i < MB_RECSZ;) {
+        uint32_t r = mb_rand(c);
+        int run = 1 + (r >> 8) % 12;
+        uint8_t v = (r & 3) == 0 ? (uint8_t)(r >> 16) : 0;
+        for (; run > 0 && i < MB_RECSZ; run--, i++)
+            c->in[i] = (r & 1) ? v : (uint8_t)(mb_rand(c) >> 24);
+    }
+}
+
+static int mb_scratch_dir(struct mb_ctx *c, const char *what)
+{
+    snprintf(c->dir, sizeof(c->dir), "%s/microbench.%s.%d", thedb->bdb_env->tmpdir, what, (int)getpid());
+    if (mkdir(c->dir, 0755) && errno != EEXIST) {
+        logmsg(LOGMSG_ERROR, "%s: mkdir %s: %s\n", __func__, c->dir, strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+static void mb_remove_scratch_dir(struct mb_ctx *c)
+{
+    DIR *d;
+    struct dirent *ent;
+    char path[PATH_MAX];
+
+    if (c->dir[0] == 0 || (d = opendir(c->dir)) == NULL)
+        return;
+    while ((ent = readdir(d)) != NULL) {
+        if (strcmp(ent->d_name, ".") == 0 || strcmp(ent->d_name, "..") == 0)
+            continue;
+        snprintf(path, sizeof(path), "%s/%s", c->dir, ent->d_name);
+        unlink(path);
+    }
+    closedir(d);
+    rmdir(c->dir);
+    c->dir[0] = 0;
+}
+
+static void mb_env_close(struct mb_ctx *c)
+{
+    if (c->dbp) {
+        c->dbp->close(c->dbp, 0);
+        c->dbp = NULL;
+    }
+    if (c->dbenv) {
+        c->dbenv->close(c->dbenv, 0);
+        c->dbenv = NULL;
+    }
+    mb_remove_scratch_dir(c);
+}
+
+static int mb_env_open(struct mb_ctx *c, const char *what, u_int32_t flags)
+{
+    int rc;
+
+    if (mb_scratch_dir(c, what))
+        return -1;
+    if ((rc = db_env_create(&c->dbenv, 0)) != 0) {
+        logmsg(LOGMSG_ERROR, "%s: db_env_create rc %d\n", __func__, rc);
+        c->dbenv = NULL;
+        goto err;
+    }
+    /* large enough that lookups never touch disk */
+    c->dbenv->set_cachesize(c->dbenv, 0, 64 * 1024 * 1024, 1);
+    if (flags & DB_INIT_LOG)
+        c->dbenv->set_lg_bsize(c->dbenv, 4 * 1024 * 1024);
+    else
+        c->dbenv->set_is_tmp_tbl(c->dbenv, 1);
+    rc = c->dbenv->open(c->dbenv, c->dir, flags | DB_INIT_MPOOL | DB_CREATE | DB_PRIVATE, 0666);
+    if (rc) {
+        logmsg(LOGMSG_ERROR, "%s: env open %s rc %d\n", __func__, c->dir, rc);
+        goto err;
+    }
+    return 0;
+err:
+    mb_env_close(c);
+    return -1;
+}
+
+/* btree: private environment, one in-memory btree of MB_NKEYS records */
+static int btree_setup(struct mb_ctx *c)
+{
+    uint8_t key[4], data[MB_DATASZ] = {0};
+    DBT k = {0}, d = {0};
+    int rc;
+
+    if (mb_env_open(c, "btree", 0))
+        return -1;
+    if ((rc = db_create(&c->dbp, c->dbenv, 0)) != 0) {
+        logmsg(LOGMSG_ERROR, "%s: db_create rc %d\n", __func__, rc);
+        c->dbp = NULL;
+        goto err;
+    }
+    c->dbp->set_pagesize(c->dbp, 4096);
+    if ((rc = c->dbp->open(c->dbp, NULL, NULL, NULL, DB_BTREE, DB_CREATE, 0666)) != 0) {
+        logmsg(LOGMSG_ERROR, "%s: db open rc %d\n", __func__, rc);
+        goto err;
+    }
+
+    k.data = key;
+    k.size = sizeof(key);
+    d.data = data;
+    d.size = sizeof(data);
+    for (uint32_t i = 0; i < MB_NKEYS; i++) {
+        mb_key(key, i);
+        memcpy(data, key, sizeof(key));
+        if ((rc = c->dbp->put(c->dbp, NULL, &k, &d, 0)) != 0) {
+            logmsg(LOGMSG_ERROR, "%s: put rc %d\n", __func__, rc);
+            goto err;
+        }
+    }
+    return 0;
+err:
+    mb_env_close(c);
+    return -1;
+}
+
+static int64_t btree_lookup_run(struct mb_ctx *c)
+{
+    uint8_t key[4], data[MB_DATASZ];
+    DBT k = {0}, d = {0};
+    int rc;
+
+    k.data = key;
+    k.size = sizeof(key);
+    d.data = data;
+    d.ulen = sizeof(data);
+    d.flags = DB_DBT_USERMEM;
+    for (int i = 0; i < c->iterations; i++) {
+        mb_key(key, mb_rand(c) % MB_NKEYS);
+        if ((rc = c->dbp->get(c->dbp, NULL, &k, &d, 0)) != 0) {
+            logmsg(LOGMSG_ERROR, "%s: get rc %d\n", __func__, rc);
+            return -1;
+        }
+    }
+    return c->iterations;
+}
+
+static int64_t btree_scan_run(struct mb_ctx *c)
+{
+    uint8_t key[4], data[MB_DATASZ];
+    DBT k = {0}, d = {0};
+    DBC *dbc;
+    int64_t rows = 0;
+    int rc;
+
+    if ((rc = c->dbp->cursor(c->dbp, NULL, &dbc, 0)) != 0) {
+        logmsg(LOGMSG_ERROR, "%s: cursor rc %d\n", __func__, rc);
+        return -1;
+    }
+    k.data = key;
+    k.ulen = sizeof(key);
+    k.flags = DB_DBT_USERMEM;
+    d.data = data;
+    d.ulen = sizeof(data);
+    d.flags = DB_DBT_USERMEM;
+    while (rows < c->iterations) {
+        mb_key(key, mb_rand(c) % (MB_NKEYS - MB_SCANLEN));
+        k.size = sizeof(key);
+        rc = dbc->c_get(dbc, &k, &d, DB_SET_RANGE);
+        for (int n = 0; rc == 0 && n < MB_SCANLEN; n++) {
+            rows++;
+            rc = dbc->c_get(dbc, &k, &d, DB_NEXT);
+        }
+        if (rc != 0 && rc != DB_NOTFOUND) {
+            logmsg(LOGMSG_ERROR, "%s: c_get rc %d\n", __func__, rc);
+            dbc->c_close(dbc);
+            return -1;
+        }
+    }
+    dbc->c_close(dbc);
+    return rows;
+}
+
+/* temp tables: the same path sorters and sql temp tables take */
+static int64_t temptable_put_run(struct mb_ctx *c)
+{
+    uint8_t key[4], data[MB_DATASZ] = {0};
+    int bdberr = 0, rc;
+    struct temp_table *tbl = bdb_temp_table_create(thedb->bdb_env, &bdberr);
+    if (tbl == NULL) {
+        logmsg(LOGMSG_ERROR, "%s: bdb_temp_table_create bdberr %d\n", __func__, bdberr);
+        return -1;
+    }
+    for (int i = 0; i < c->iterations; i++) {
+        mb_key(key, mb_rand(c));
+        rc = bdb_temp_table_put(thedb->bdb_env, tbl, key, sizeof(key), data, sizeof(data), NULL, &bdberr);
+        if (rc) {
+            logmsg(LOGMSG_ERROR, "%s: put rc %d bdberr %d\n", __func__, rc, bdberr);
+            bdb_temp_table_close(thedb->bdb_env, tbl, &bdberr);
+            return -1;
+        }
+    }
+    bdb_temp_table_close(thedb->bdb_env, tbl, &bdberr);
+    return c->iterations;
+}
+
+static int temptable_find_setup(struct mb_ctx *c)
+{
+    uint8_t key[4], data[MB_DATASZ] = {0};
+    int bdberr = 0;
+
+    if ((c->tmptbl = bdb_temp_table_create(thedb->bdb_env, &bdberr)) == NULL) {
+        logmsg(LOGMSG_ERROR, "%s: bdb_temp_table_create bdberr %d\n", __func__, bdberr);
+        return -1;
+    }
+    for (uint32_t i = 0; i < MB_NKEYS; i++) {
+        mb_key(key, i);
+        if (bdb_temp_table_put(thedb->bdb_env, c->tmptbl, key, sizeof(key), data, sizeof(data), NULL, &bdberr)) {
+            logmsg(LOGMSG_ERROR, "%s: put bdberr %d\n", __func__, bdberr);
+            return -1;
+        }
+    }
+    if ((c->tmpcur = bdb_temp_table_cursor(thedb->bdb_env, c->tmptbl, NULL, &bdberr)) == NULL) {
+        logmsg(LOGMSG_ERROR, "%s: cursor bdberr %d\n", __func__, bdberr);
+        return -1;
+    }
+    return 0;
+}
+
+static int64_t temptable_find_run(struct mb_ctx *c)
+{
+    uint8_t key[4];
+    int bdberr = 0;
+
+    for (int i = 0; i < c->iterations; i++) {
+        mb_key(key, mb_rand(c) % MB_NKEYS);
+        if (bdb_temp_table_find_exact(thedb->bdb_env, c->tmpcur, key, sizeof(key), &bdberr) < 0) {
+            logmsg(LOGMSG_ERROR, "%s: find bdberr %d\n", __func__, bdberr);
+            return -1;
+        }
+    }
+    return c->iterations;
+}
+
+static void temptable_teardown(struct mb_ctx *c)
+{
+    int bdberr;
+    if (c->tmpcur)
+        bdb_temp_table_close_cursor(thedb->bdb_env, c->tmpcur, &bdberr);
+    if (c->tmptbl)
+        bdb_temp_table_close(thedb->bdb_env, c->tmptbl, &bdberr);
+    c->tmpcur = NULL;
+    c->tmptbl = NULL;
+}
+
+/* locks: MB_LOCK_THREADS lockers cycling through private write locks */
+struct mb_lock_arg {
+    struct mb_ctx *c;
+    int tid;
+    int n;
+    int rc;
+};
+
+static void *mb_lock_thd(void *p)
+{
+    struct mb_lock_arg *a = p;
+    DB_ENV *dbenv = thedb->bdb_env->dbenv;
+    uint8_t objbuf[28] = "microbench";
+    DBT obj = {.data = objbuf, .size = sizeof(objbuf)};
+    DB_LOCK lock;
+    u_int32_t locker;
+
+    if ((a->rc = dbenv->lock_id(dbenv, &locker)) != 0)
+        return NULL;
+    objbuf[12] = a->tid;
+    for (int i = 0; i < a->n; i++) {
+        objbuf[13] = i & 63;
+        if ((a->rc = dbenv->lock_get(dbenv, locker, 0, &obj, DB_LOCK_WRITE, &lock)) != 0)
+            break;
+        if ((a->rc = dbenv->lock_put(dbenv, &lock)) != 0)
+            break;
+    }
+    dbenv->lock_id_free(dbenv, locker);
+    return NULL;
+}
+
+static int64_t lock_run(struct mb_ctx *c)
+{
+    pthread_t thds[MB_LOCK_THREADS];
+    struct mb_lock_arg args[MB_LOCK_THREADS];
+    int64_t ops = 0;
+
+    for (int i = 0; i < MB_LOCK_THREADS; i++) {
+        args[i] = (struct mb_lock_arg){.c = c, .tid = i, .n = c->iterations / MB_LOCK_THREADS};
+        Pthread_create(&thds[i], NULL, mb_lock_thd, &args[i]);
+    }
+    for (int i = 0; i < MB_LOCK_THREADS; i++) {
+        Pthread_join(thds[i], NULL);
+        if (args[i].rc) {
+            logmsg(LOGMSG_ERROR, "%s: thread %d rc %d\n", __func__, i, args[i].rc);
+            ops = -1;
+        } else if (ops >= 0) {
+            ops += args[i].n;
+        }
+    }
+    return ops;
+}
+
+/* log: private environment with its own log directory */
+static int log_setup(struct mb_ctx *c)
+{
+    mb_fill_record(c);
+    c->bytes = (int64_t)c->iterations * MB_RECSZ;
+    return mb_env_open(c, "log", DB_INIT_LOG);
+}
+
+static int64_t log_run(struct mb_ctx *c)
+{
+    DBT rec = {.data = c->in, .size = MB_RECSZ};
+    DB_LSN lsn;
+    int rc;
+
+    for (int i = 0; i < c->iterations; i++) {
+        if ((rc = c->dbenv->log_put(c->dbenv, &lsn, &rec, 0)) != 0) {
+            logmsg(LOGMSG_ERROR, "%s: log_put rc %d\n", __func__, rc);
+            return -1;
+        }
+    }
+    return c->iterations;
+}
+
+/* compression of one ondisk-sized record */
+static int record_setup(struct mb_ctx *c)
+{
+    mb_fill_record(c);
+    c->bytes = (int64_t)c->iterations * MB_RECSZ;
+    return 0;
+}
+
+static int64_t rle_run(struct mb_ctx *c)
+{
+    for (int i = 0; i < c->iterations; i++) {
+        Comdb2RLE rle = {.in = c->in, .insz = MB_RECSZ, .out = c->out, .outsz = sizeof(c->out)};
+        if (compressComdb2RLE(&rle) != 0) {
+            logmsg(LOGMSG_ERROR, "%s: compressComdb2RLE failed\n", __func__);
+            return -1;
+        }
+    }
+    return c->iterations;
+}
+
+static int64_t lz4_run(struct mb_ctx *c)
+{
+    for (int i = 0; i < c->iterations; i++) {
+        if (LZ4_compress_default((const char *)c->in, (char *)c->out, MB_RECSZ, sizeof(c->out)) <= 0) {
+            logmsg(LOGMSG_ERROR, "%s: LZ4_compress_default failed\n", __func__);
+            return -1;
+        }
+    }
+    return c->iterations;
+}
+
+/* type conversion: an (int, double, cstring[16]) row each way */
+static int64_t client_to_ondisk_run(struct mb_ctx *c)
+{
+    char str[16] = "microbench";
+    uint8_t out[5 + 9 + 17];
+    int outdtsz;
+
+    for (int i = 0; i < c->iterations; i++) {
+        int32_t ival = htonl((int32_t)mb_rand(c));
+        double dval = (double)i;
+        if (CLIENT_to_SERVER(&ival, sizeof(ival), CLIENT_INT, 0, NULL, NULL, out, 5, SERVER_BINT, 0, &outdtsz,
+                             NULL, NULL) ||
+            CLIENT_to_SERVER(&dval, sizeof(dval), CLIENT_REAL, 0, NULL, NULL, out + 5, 9, SERVER_BREAL, 0,
+                             &outdtsz, NULL, NULL) ||
+            CLIENT_to_SERVER(str, sizeof(str), CLIENT_CSTR, 0, NULL, NULL, out + 14, 17, SERVER_BCSTR, 0,
+                             &outdtsz, NULL, NULL)) {
+            logmsg(LOGMSG_ERROR, "%s: conversion failed\n", __func__);
+            return -1;
+        }
+    }
+    return c->iterations;
+}
+
+static int type_setup(struct mb_ctx *c)
+{
+    char str[16] = "microbench";
+    int32_t ival = htonl(12345);
+    double dval = 1.5;
+    int outdtsz;
+
+    /* ondisk row for client_from_ondisk */
+    if (CLIENT_to_SERVER(&ival, sizeof(ival), CLIENT_INT, 0, NULL, NULL, c->in, 5, SERVER_BINT, 0, &outdtsz, NULL,
+                         NULL) ||
+        CLIENT_to_SERVER(&dval, sizeof(dval), CLIENT_REAL, 0, NULL, NULL, c->in + 5, 9, SERVER_BREAL, 0, &outdtsz,
+                         NULL, NULL) ||
+        CLIENT_to_SERVER(str, sizeof(str), CLIENT_CSTR, 0, NULL, NULL, c->in + 14, 17, SERVER_BCSTR, 0, &outdtsz,
+                         NULL, NULL)) {
+        logmsg(LOGMSG_ERROR, "%s: conversion failed\n", __func__);
+        return -1;
+    }
+    return 0;
+}
+
+static int64_t ondisk_to_client_run(struct mb_ctx *c)
+{
+    int32_t ival;
+    double dval;
+    char str[16];
+    int isnull, outdtsz;
+
+    for (int i = 0; i < c->iterations; i++) {
+        if (SERVER_to_CLIENT(c->in, 5, SERVER_BINT, NULL, NULL, 0, &ival, sizeof(ival), CLIENT_INT, &isnull,
+                             &outdtsz, NULL, NULL) ||
+            SERVER_to_CLIENT(c->in + 5, 9, SERVER_BREAL, NULL, NULL, 0, &dval, sizeof(dval), CLIENT_REAL, &isnull,
+                             &outdtsz, NULL, NULL) ||
+            SERVER_to_CLIENT(c->in + 14, 17, SERVER_BCSTR, NULL, NULL, 0, str, sizeof(str), CLIENT_CSTR, &isnull,
+                             &outdtsz, NULL, NULL)) {
+            logmsg(LOGMSG_ERROR, "%s: conversion failed\n", __func__);
+            return -1;
+        }
+    }
+    return c->iterations;
+}
+
+/* thdpool: enqueue trivial work items and wait for them to drain */
+static int pool_done;
+
+static void mb_pool_work(struct thdpool *pool, void *work, void *thddata, int op)
+{
+    ATOMIC_ADD32(pool_done, 1);
+}
+
+static int thdpool_setup(struct mb_ctx *c)
+{
+    if ((c->pool = thdpool_create("microbench", 0)) == NULL)
+        return -1;
+    thdpool_set_minthds(c->pool, MB_POOL_THREADS);
+    thdpool_set_maxthds(c->pool, MB_POOL_THREADS);
+    thdpool_set_linger(c->pool, 60);
+    thdpool_set_maxqueue(c->pool, c->iterations);
+    return 0;
+}
+
+static int64_t thdpool_run(struct mb_ctx *c)
+{
+    int rc;
+
+    pool_done = 0;
+    for (int i = 0; i < c->iterations; i++) {
+        if ((rc = thdpool_enqueue(c->pool, mb_pool_work, NULL, 0, NULL, THDPOOL_FORCE_QUEUE)) != 0) {
+            logmsg(LOGMSG_ERROR, "%s: thdpool_enqueue rc %d\n", __func__, rc);
+            return -1;
+        }
+    }
+    while (ATOMIC_LOAD32(pool_done) < c->iterations)
+        sched_yield();
+    return c->iterations;
+}
+
+static void thdpool_teardown(struct mb_ctx *c)
+{
+    if (c->pool)
+        thdpool_destroy(&c->pool, 5000000);
+}
+
+static const struct microbench benchmarks[] = {
+    {"btree_point_lookup", "random DB->get on a 100k record btree", btree_setup, btree_lookup_run, mb_env_close},
+    {"btree_range_scan", "100 record cursor scans from random keys", btree_setup, btree_scan_run, mb_env_close},
+    {"temptable_put", "bdb_temp_table_put of random keys", NULL, temptable_put_run, NULL},
+    {"temptable_find", "bdb_temp_table_find_exact on a 100k record temp table", temptable_find_setup,
+     temptable_find_run, temptable_teardown},
+    {"lock_get_put", "write lock get/put pairs from 4 threads", NULL, lock_run, NULL},
+    {"log_put", "256 byte log_put records", log_setup, log_run, mb_env_close},
+    {"compress_crle", "compressComdb2RLE of a 256 byte record", record_setup, rle_run, NULL},
+    {"compress_lz4", "LZ4 compression of a 256 byte record", record_setup, lz4_run, NULL},
+    {"convert_client_to_ondisk", "int, double, cstring[16] row to ondisk", NULL, client_to_ondisk_run, NULL},
+    {"convert_ondisk_to_client", "ondisk int, double, cstring[16] row to client", type_setup, ondisk_to_client_run,
+     NULL},
+    {"thdpool_enqueue", "enqueue and run empty work items on 4 threads", thdpool_setup, thdpool_run,
+     thdpool_teardown},
+};
+
+static int cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static int run_benchmark(const struct microbench *b, int iterations, int reps, int first)
+{
+    struct mb_ctx *c = calloc(1, sizeof(struct mb_ctx));
+    uint64_t *ns = calloc(reps, sizeof(uint64_t));
+    int64_t ops = 0;
+    int rc = -1;
+
+    if (c == NULL || ns == NULL)
+        goto done;
+    c->bench = b;
+    c->iterations = iterations;
+    /* teardowns cope with a partial setup */
+    if (b->setup && b->setup(c) != 0)
+        goto out;
+
+    /* warmup */
+    c->seed = 0x9e3779b9;
+    if (b->run(c) < 0)
+        goto out;
+
+    for (int r = 0; r < reps; r++) {
+        c->seed = 0x9e3779b9;
+        uint64_t start = mb_now_ns();
+        ops = b->run(c);
+        ns[r] = mb_now_ns() - start;
+        if (ops <= 0)
+            goto out;
+    }
+    qsort(ns, reps, sizeof(uint64_t), cmp_u64);
+
+    double median = (double)ns[reps / 2] / ops;
+    logmsg(LOGMSG_USER,
+           "%s    {\"name\": \"%s\", \"description\": \"%s\", \"ops\": %" PRId64 ", \"ns_per_op\": %.2f, "
+           "\"ns_per_op_min\": %.2f, \"ns_per_op_max\": %.2f, \"ops_per_sec\": %.0f",
+           first ? "" : ",\n", b->name, b->desc, ops, median, (double)ns[0] / ops, (double)ns[reps - 1] / ops,
+           1e9 / median);
+    if (c->bytes)
+        logmsg(LOGMSG_USER, ", \"mb_per_sec\": %.2f", c->bytes / (ns[reps / 2] / 1e9) / (1024 * 1024));
+    logmsg(LOGMSG_USER, "}");
+    rc = 0;
+
+out:
+    if (b->teardown)
+        b->teardown(c);
+done:
+    if (rc)
+        logmsg(LOGMSG_ERROR, "microbench %s failed\n", b->name);
+    free(ns);
+    free(c);
+    return rc;
+}
+
+void microbench(const char *name, int iterations, int reps)
+{
+    int nbench = sizeof(benchmarks) / sizeof(benchmarks[0]);
+    int found = 0, first = 1;
+
+    if (iterations <= 0)
+        iterations = 100000;
+    if (reps <= 0)
+        reps = 5;
+
+    logmsg(LOGMSG_USER, "{\"iterations\": %d, \"reps\": %d, \"results\": [\n", iterations, reps);
+    for (int i = 0; i < nbench; i++) {
+        if (name && strcmp(name, "all") != 0 && strcmp(name, benchmarks[i].name) != 0)
+            continue;
+        found = 1;
+        if (run_benchmark(&benchmarks[i], iterations, reps, first) == 0)
+            first = 0;
+    }
+    logmsg(LOGMSG_USER, "\n]}\n");
+
+    if (!found) {
+        logmsg(LOGMSG_ERROR, "unknown benchmark %s, choose from:\n", name);
+        for (int i = 0; i < nbench; i++)
+            logmsg(LOGMSG_ERROR, "  %-26s %s\n", benchmarks[i].name, benchmarks[i].desc);
+    }
+}
@@ -55,6 +55,7 @@
 #include "sc_logic.h"
 #include "gettimeofday_ms.h"
 #include "eventlog.h"
+#include "wait_events.h"
 #include <disttxn.h>
 
 extern int gbl_reorder_idx_writes;
@@ -1213,6 +1214,7 @@ static int apply_changes(struct ireq *iq, blocksql_tran_t *tran, void *iq_tran,
     /* Disarm: this pooled thread must not bill later work to the session's
      * fingerprint. */
     bdb_fingerprint_rtstats_clear();
+    wait_state_set_fingerprint(NULL);
 
     Pthread_mutex_unlock(&tran->store_mtx);
 
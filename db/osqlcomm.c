@@ -59,6 +59,7 @@
 #include "eventlog.h"
 #include <disttxn.h>
 #include "fingerprint.h"
+#include "wait_events.h"
 
 #define MAX_CLUSTER REPMAX
 
@@ -568,6 +569,19 @@ typedef struct {
     genid_t genid;
 } osql_dbq_consume_t;
 
+/* followed by ngenids genids */
+typedef struct {
+    osql_uuid_rpl_t hd;
+    int consumer;
+    int ngenids;
+} osql_dbq_consume_batch_uuid_t;
+
+typedef struct {
+    osql_rpl_t hd;
+    int consumer;
+    int ngenids;
+} osql_dbq_consume_batch_t;
+
 typedef struct osql_del_rpl {
     osql_rpl_t hd;
     osql_del_t dt;
@@ -4847,6 +4861,40 @@ int osql_send_dbq_consume(osql_target_t *target, unsigned long long rqid,
     return target->send(target, type, &rpl, sz, 0, NULL, 0);
 }
 
+int osql_send_dbq_consume_batch(osql_target_t *target, unsigned long long rqid,
+                                uuid_t uuid, int consumer,
+                                const genid_t *genids, int ngenids, int type)
+{
+    union {
+        osql_dbq_consume_batch_uuid_t uuid;
+        osql_dbq_consume_batch_t rqid;
+    } rpl = {{{0}}};
+    if (check_master(target))
+        return OSQL_SEND_ERROR_WRONGMASTER;
+    if (gbl_enable_osql_logging) {
+        uuidstr_t us;
+        logmsg(LOGMSG_DEBUG, "[%llx %s] send OSQL_DBQ_CONSUME_BATCH consumer %d n %d\n",
+               rqid, comdb2uuidstr(uuid, us), consumer, ngenids);
+    }
+    size_t sz;
+    if (rqid == OSQL_RQID_USE_UUID) {
+        rpl.uuid.hd.type = htonl(OSQL_DBQ_CONSUME_BATCH);
+        comdb2uuidcpy(rpl.uuid.hd.uuid, uuid);
+        rpl.uuid.consumer = htonl(consumer);
+        rpl.uuid.ngenids = htonl(ngenids);
+        sz = sizeof(rpl.uuid);
+        type = osql_net_type_to_net_uuid_type(type);
+    } else {
+        rpl.rqid.hd.type = htonl(OSQL_DBQ_CONSUME_BATCH);
+        rpl.rqid.hd.sid = flibc_htonll(rqid);
+        rpl.rqid.consumer = htonl(consumer);
+        rpl.rqid.ngenids = htonl(ngenids);
+        sz = sizeof(rpl.rqid);
+    }
+    return target->send(target, type, &rpl, sz, 0, (void *)genids,
+                        ngenids * sizeof(genid_t));
+}
+
 
 /**
  * Send DELREC op
@@ -6143,6 +6191,7 @@ static inline int is_write_request(int type)
 {
     switch (type) {
     case OSQL_DBQ_CONSUME:
+    case OSQL_DBQ_CONSUME_BATCH:
     case OSQL_DELREC:
     case OSQL_DELETE:
     case OSQL_UPDSTAT:
@@ -7295,6 +7344,35 @@ int osql_process_packet(struct ireq *iq, uuid_t uuid, void *trans, char **pmsg,
         }
         break;
     }
+    case OSQL_DBQ_CONSUME_BATCH: {
+        int consumer, ngenids;
+        p_buf_end = (const uint8_t *)msg + msglen;
+        p_buf = buf_get(&consumer, sizeof(consumer), p_buf, p_buf_end);
+        p_buf = buf_get(&ngenids, sizeof(ngenids), p_buf, p_buf_end);
+        if (p_buf == NULL || ngenids <= 0 || (p_buf_end - p_buf) < ngenids * sizeof(genid_t)) {
+            logmsg(LOGMSG_ERROR, "%s: bad OSQL_DBQ_CONSUME_BATCH\n", __func__);
+            return ERR_BADREQ;
+        }
+        /* genids travel as-is, like OSQL_DBQ_CONSUME; copy for alignment */
+        genid_t *genids = malloc(ngenids * sizeof(genid_t));
+        if (genids == NULL)
+            return ERR_INTERNAL;
+        memcpy(genids, p_buf, ngenids * sizeof(genid_t));
+
+        rc = dbq_consume_batch(iq, trans, consumer, genids, ngenids);
+        free(genids);
+        EVENTLOG_DEBUG(
+            uuidstr_t ustr;
+            comdb2uuidstr(uuid, ustr);
+            eventlog_debug("%s:%d uuid %s dbq_consume_batch n %d rc %d", __func__, __LINE__, ustr, ngenids, rc);
+        );
+
+        if (rc != 0) {
+            if (rc != RC_INTERNAL_RETRY) logmsg(LOGMSG_ERROR, "%s: dbq_consume_batch rc:%d\n", __func__, rc);
+            return rc;
+        }
+        break;
+    }
     case OSQL_DELREC:
     case OSQL_DELETE: {
         osql_del_t dt;
@@ -7569,6 +7647,7 @@ done_delete:
         }
         /* Arm this thread; cleared once the session finishes applying. */
         bdb_fingerprint_rtstats_set_write(dt.fingerprint, FINGERPRINTSZ, fingerprint_has_main_entry(dt.fingerprint));
+        wait_state_set_fingerprint(dt.fingerprint);
 
         /* Relay to the replicants, which redo this work from the log. Purely
          * diagnostic, so a failure here must not fail the transaction. */
@@ -8997,7 +9076,9 @@ int need_views_lock(char *msg, int msglen, int use_uuid)
     if (!n_p_buf || !rpl)
         return -1;
 
-    return bpfunc_check(rpl->data, rpl->data_len, BPFUNC_TIMEPART_RETENTION);
+    if (bpfunc_check(rpl->data, rpl->data_len, BPFUNC_TIMEPART_RETENTION) == 1)
+        return 1;
+    return bpfunc_check(rpl->data, rpl->data_len, BPFUNC_TIMEPART_PERIOD);
 }
 
 #define GETI(field) \
@@ -193,6 +193,9 @@ int osql_send_participant(osql_target_t *target, unsigned long long rqid, uuid_t
  */
 int osql_send_dbq_consume(osql_target_t *target, unsigned long long rqid,
                           uuid_t, genid_t, int type);
+int osql_send_dbq_consume_batch(osql_target_t *target, unsigned long long rqid,
+                                uuid_t uuid, int consumer,
+                                const genid_t *genids, int ngenids, int type);
 
 /**
  * Request that a remote sql engine start recording it's query stats to a
@@ -26,6 +26,7 @@
 #include "sql.h"
 #include "osqlcheckboard.h"
 #include "osqlcomm.h"
+#include "perf.h"
 
 static int _send(osql_target_t *target, int usertype, void *data, int datalen,
                  int nodelay, void *tail, int tailen);
@@ -90,6 +91,9 @@ int osql_end_net(struct sqlclntstate *clnt)
 static int _send(osql_target_t *target, int usertype, void *data, int datalen,
                  int nodelay, void *tail, int tailen)
 {
-    return offload_net_send(target->host, usertype, data, datalen, nodelay,
-                            tail, tailen);
+    uint64_t start = comdb2_time_epochus();
+    int rc = offload_net_send(target->host, usertype, data, datalen, nodelay,
+                              tail, tailen);
+    latency_hist_add(LATENCY_OSQL_SEND, comdb2_time_epochus() - start);
+    return rc;
 }
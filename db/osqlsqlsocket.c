@@ -32,6 +32,7 @@
 #include "osqlsqlsocket.h"
 #include "osqlblockproc.h"
 #include "osqlcomm.h"
+#include "perf.h"
 
 #define BPLOG_PROTO "icdb2"
 #define BPLOG_APPSOCK "sockbplog"
@@ -135,8 +136,8 @@ static int osql_end_socket(struct sqlclntstate *clnt)
     return 0;
 }
 
-static int _socket_send(osql_target_t *target, int usertype, void *data,
-                        int datalen, int nodelay, void *tail, int tailen)
+static int _socket_send_int(osql_target_t *target, int usertype, void *data,
+                            int datalen, int nodelay, void *tail, int tailen)
 {
     COMDB2BUF *sb = target->sb;
     int totallen = datalen + tailen;
@@ -183,6 +184,16 @@ static int _socket_send(osql_target_t *target, int usertype, void *data,
     return 0;
 }
 
+static int _socket_send(osql_target_t *target, int usertype, void *data,
+                        int datalen, int nodelay, void *tail, int tailen)
+{
+    uint64_t start = comdb2_time_epochus();
+    int rc = _socket_send_int(target, usertype, data, datalen, nodelay, tail,
+                              tailen);
+    latency_hist_add(LATENCY_OSQL_SEND, comdb2_time_epochus() - start);
+    return rc;
+}
+
 static int osql_wait_socket(struct sqlclntstate *clnt, int timeout,
                             struct errstat *err)
 {
@@ -1024,6 +1024,10 @@ int gbl_osql_send_startgen = 1;
  * the transaction on an unknown op, so keep it off until the cluster is up. */
 int gbl_osql_send_fingerprint = 0;
 
+/* Send consume_batch() as one OSQL_DBQ_CONSUME_BATCH rather than a delete per
+ * item. Default OFF for the same reason as above. */
+int gbl_osql_send_dbq_consume_batch = 0;
+
 static inline int sock_restart_retryable_rcode(int restart_rc)
 {
     switch (restart_rc) {
@@ -2103,3 +2107,43 @@ int osql_delrec_qdb(struct sqlclntstate *clnt, char *qname, genid_t id)
     }
     return osql_save_delrec_qdb(clnt, qname, id);
 }
+
+/* Consume several items of one queue in the current transaction. Each genid
+ * is also saved for replay, where it goes out as a plain queue delete. */
+int osql_dbq_consume_batch_logic(struct sqlclntstate *clnt, const char *spname,
+                                 int consumer, const genid_t *genids,
+                                 int ngenids)
+{
+    Q4SP(qname, spname);
+    osqlstate_t *osql = &clnt->osql;
+    int rc = 0;
+    if (!gbl_osql_send_dbq_consume_batch ||
+        clnt->dbtran.mode != TRANLEVEL_SOSQL || osql->is_reorder_on) {
+        for (int i = 0; rc == 0 && i < ngenids; ++i)
+            rc = osql_delrec_qdb(clnt, qname, genids[i]);
+        return rc;
+    }
+    if ((rc = check_osql_capacity_int(clnt)) != 0)
+        return rc;
+    START_SOCKSQL;
+    int restarted;
+    do {
+        rc = osql_send_usedb_logic_int(qname, clnt, NET_OSQL_SOCK_RPL);
+        if (rc == 0)
+            rc = osql_send_dbq_consume_batch(&osql->target, osql->rqid,
+                                             osql->uuid, consumer, genids,
+                                             ngenids, NET_OSQL_SOCK_RPL);
+        RESTART_SOCKSQL;
+    } while (restarted);
+    if (rc) {
+        logmsg(LOGMSG_ERROR,
+               "%s:%d %s - failed to send socksql dbq_consume_batch rc=%d\n",
+               __FILE__, __LINE__, __func__, rc);
+        return rc;
+    }
+    osql->replicant_numops++;
+    DEBUG_PRINT_NUMOPS();
+    for (int i = 0; rc == 0 && i < ngenids; ++i)
+        rc = osql_save_delrec_qdb(clnt, qname, genids[i]);
+    return rc;
+}
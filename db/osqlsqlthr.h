@@ -192,5 +192,7 @@ int osql_bpfunc_logic(struct sql_thread *thd, BpfuncArg *arg);
 
 int osql_dbq_consume_logic(struct sqlclntstate *, const char *spname, genid_t);
 int osql_dbq_consume(struct sqlclntstate *, const char *spname, genid_t);
+int osql_dbq_consume_batch_logic(struct sqlclntstate *, const char *spname, int consumer, const genid_t *,
+                                 int ngenids);
 
 #endif
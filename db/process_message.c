@@ -70,6 +70,8 @@ extern int __berkdb_read_alarm_ms;
 #include "rtcpu.h"
 #include "machcache.h"
 #include "machclass.h"
+#include "ixsketch.h"
+#include "query_plan_baseline.h"
 
 extern struct ruleset *gbl_ruleset;
 extern int gbl_exit_alarm_sec;
@@ -123,6 +125,7 @@ void bdb_berktest_commit_delay(uint32_t);
 void rowlocks_clear_stats(void);
 void rowlocks_print_stats(FILE *f);
 void rowlocks_bench(void *, int, int);
+void microbench(const char *name, int iterations, int reps);
 void rowlocks_lock1_bench(void *, int, int);
 void rowlocks_lock2_bench(void *, int, int);
 void commit_bench(void *, int, int);
@@ -241,6 +244,10 @@ static const char *HELP_SQL[] = {
     "ucancel queued        - cancel all queued statement (leaves running statements intact)",
     "ucancel all           - cancel all queued and running statements",
     "wrtimeout N           - set write timeout in ms",
+    "baseline capture [fp] - save the best plan of every (or one) fingerprint as its baseline (master only)",
+    "baseline drop [fp]    - drop every (or one) plan baseline (master only)",
+    "baseline reload       - reload plan baselines from llmeta",
+    "baseline stat         - show plan baselines and regressions",
     "help                  - this information",
     NULL,
 };
@@ -292,6 +299,8 @@ static const char *HELP_ANALYZE[] = {
     "tblthd <numthds>   - set maximum concurrent tbl-threads",
     "headroom <n%>      - fail if freespace falls below n%",
     "abort              - abort currently running analyze on this node",
+    "sketch <table>     - refresh table stats from its index sketches",
+    "sketchstat [table] - print index sketches [optionally for table]",
     NULL};
 
 static const char *HELP_MEMDEBUG[] = {
@@ -3231,6 +3240,25 @@ clipper_usage:
                         &gbl_debug_sql_opcodes);
         } else if (tokcmp(tok, ltok, "dumphints") == 0) {
             sql_dump_hints();
+        } else if (tokcmp(tok, ltok, "baseline") == 0) {
+            char *fp = NULL;
+            tok = segtok(line, lline, &st, &ltok);
+            if (tokcmp(tok, ltok, "capture") == 0 || tokcmp(tok, ltok, "drop") == 0) {
+                int capture = tokcmp(tok, ltok, "capture") == 0;
+                tok = segtok(line, lline, &st, &ltok);
+                if (ltok)
+                    fp = tokdup(tok, ltok);
+                int rc = capture ? query_plan_baseline_capture(fp) : query_plan_baseline_drop(fp);
+                free(fp);
+                if (rc < 0)
+                    return -1;
+            } else if (tokcmp(tok, ltok, "reload") == 0) {
+                query_plan_baseline_load();
+            } else if (tokcmp(tok, ltok, "stat") == 0) {
+                query_plan_baseline_dump();
+            } else {
+                logmsg(LOGMSG_ERROR, "Usage: sql baseline [capture [fp]|drop [fp]|reload|stat]\n");
+            }
         }
     } else if (tokcmp(tok, ltok, "ixstat") == 0) {
         ixstats(dbenv);
@@ -3313,6 +3341,27 @@ clipper_usage:
             COMDB2BUF *sb = cdb2buf_open(fileno(stdout), 0);
             handle_backout(sb, table);
             if(table) free(table);
+        } else if (tokcmp(tok, ltok, "sketch") == 0) {
+            tok = segtok(line, lline, &st, &ltok);
+            if (ltok <= 0) {
+                logmsg(LOGMSG_ERROR, "Analyze sketch command requires a table name\n");
+                return 0;
+            }
+            char *table = tokdup(tok, ltok);
+            COMDB2BUF *sb = cdb2buf_open(fileno(stdout), 0);
+            analyze_table_from_sketch(table, sb);
+            cdb2buf_free(sb);
+            free(table);
+        } else if (tokcmp(tok, ltok, "sketchstat") == 0) {
+            tok = segtok(line, lline, &st, &ltok);
+            char *table = ltok > 0 ? tokdup(tok, ltok) : NULL;
+            rdlock_schema_lk();
+            for (int i = 0; i < thedb->num_dbs; i++) {
+                if (table == NULL || strcasecmp(table, thedb->dbs[i]->tablename) == 0)
+                    ixsketch_dump(thedb->dbs[i]);
+            }
+            unlock_schema_lk();
+            free(table);
         } else if(tokcmp(tok,ltok,"abort") == 0) {
             if(!analyze_is_running()) {
                 logmsg(LOGMSG_ERROR, "Analyze is not running [or not running on this node].\n");
@@ -3682,6 +3731,8 @@ clipper_usage:
                            written, waits, reorders);
             }
         }
+    } else if (tokcmp(tok, ltok, "netbatch") == 0) {
+        net_batch_stats_evbuffer(thedb->handle_sibling);
     } else if (tokcmp(tok, ltok, "sc_del_unused_files_threshold") == 0) {
         tok = segtok(line, lline, &st, &ltok);
         if (ltok == 0) {
@@ -5129,6 +5180,23 @@ clipper_usage:
             Pthread_mutex_lock(&testguard);
             bdb_locktest(thedb->bdb_env);
             Pthread_mutex_unlock(&testguard);
+        } else if (tokcmp(tok, ltok, "microbench") == 0) {
+            char *name = NULL;
+            int iterations = 0, reps = 0;
+
+            tok = segtok(line, lline, &st, &ltok);
+            if (ltok > 0)
+                name = tokdup(tok, ltok);
+            tok = segtok(line, lline, &st, &ltok);
+            if (ltok > 0)
+                iterations = toknum(tok, ltok);
+            tok = segtok(line, lline, &st, &ltok);
+            if (ltok > 0)
+                reps = toknum(tok, ltok);
+            Pthread_mutex_lock(&testguard);
+            microbench(name, iterations, reps);
+            Pthread_mutex_unlock(&testguard);
+            free(name);
         } else if (tokcmp(tok, ltok, "bad_osql") == 0) {
             osql_send_test();
         } else if (tokcmp(tok, ltok, "reversesql") == 0) {
@@ -0,0 +1,542 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#include "sql.h"
+#include "tohex.h"
+#include "string_ref.h"
+#include "query_plan_baseline.h"
+
+#include <inttypes.h>
+#include <bdb_schemachange.h>
+#include <comdb2_atomic.h>
+#include <sqlexplain.h>
+#include <vdbeInt.h>
+
+double gbl_query_plan_baseline_percentage = 50;
+int gbl_query_plan_baseline_min_executions = 10;
+int gbl_query_plan_baseline_pin = 0;
+volatile int gbl_plan_baseline_gen = 0;
+
+extern int gbl_query_plans;
+extern hash_t *gbl_fingerprint_hash;
+extern pthread_mutex_t gbl_fingerprint_hash_mu;
+
+struct plan_baseline {
+    unsigned char fingerprint[FINGERPRINTSZ];
+    unsigned char plan_fingerprint[FINGERPRINTSZ];
+    double cost_per_row;
+    char *plan;
+    char *hints;
+    /* Local to this node */
+    int regressed;
+    unsigned char regressed_plan[FINGERPRINTSZ];
+    double regressed_cost_per_row;
+    int64_t npinned;
+};
+
+/* Guarded by gbl_fingerprint_hash_mu */
+static hash_t *baselines;
+static volatile int nbaselines;
+
+/* One entry per table read by the plan: the index it was read through, -1
+ * for the table itself, -2 if different cursors used different indexes */
+struct plan_hint {
+    struct dbtable *db;
+    int ix;
+};
+
+char *form_query_plan_hints(sqlite3_stmt *stmt)
+{
+    Vdbe *v = (Vdbe *)stmt;
+    struct cursor_info c;
+    struct plan_hint *h = NULL;
+    int n = 0;
+
+    if (!v)
+        return NULL;
+
+    for (int pc = 0; pc < v->nOp; pc++) {
+        Op *op = &v->aOp[pc];
+        if (op->opcode != OP_OpenRead && op->opcode != OP_ReopenIdx && op->opcode != OP_OpenRead_Record)
+            continue;
+        describe_cursor(v, pc, &c);
+        if (c.remote || c.istemp || c.rootpage <= 1 || c.tbl < 0)
+            continue;
+        struct dbtable *db = thedb->dbs[c.tbl];
+        if (c.ix >= db->nix)
+            continue;
+
+        int i;
+        for (i = 0; i < n && h[i].db != db; i++)
+            ;
+        if (i == n) {
+            h = realloc(h, (n + 1) * sizeof(struct plan_hint));
+            h[n].db = db;
+            h[n].ix = c.ix;
+            n++;
+        } else if (c.ix >= 0 && h[i].ix != c.ix) {
+            h[i].ix = (h[i].ix == -1) ? c.ix : -2;
+        }
+    }
+
+    struct strbuf *b = strbuf_new();
+    for (int i = 0; i < n; i++) {
+        const char *ixname = "";
+        if (h[i].ix == -2)
+            continue;
+        if (h[i].ix >= 0) {
+            ixname = h[i].db->ixschema[h[i].ix]->sqlitetag;
+            if (!ixname)
+                continue;
+        }
+        strbuf_appendf(b, "%s%s=%s", strbuf_len(b) ? " " : "", h[i].db->tablename, ixname);
+    }
+    free(h);
+
+    char *hints = strbuf_len(b) ? strdup(strbuf_buf(b)) : NULL;
+    strbuf_free(b);
+    return hints;
+}
+
+/* Find the index pinned for table in hints; an empty index means the
+ * baseline scanned the table */
+int query_plan_hint_find(const char *hints, const char *table, char *index, int len)
+{
+    size_t ltable = strlen(table);
+    const char *p = hints;
+
+    while (p && *p) {
+        const char *end = strchr(p, ' ');
+        const char *eq = strchr(p, '=');
+        if (!end)
+            end = p + strlen(p);
+        if (eq && eq < end && (eq - p) == ltable && strncasecmp(p, table, ltable) == 0) {
+            int lindex = end - eq - 1;
+            if (lindex >= len)
+                return 0;
+            memcpy(index, eq + 1, lindex);
+            index[lindex] = '\0';
+            return 1;
+        }
+        p = *end ? end + 1 : end;
+    }
+    return 0;
+}
+
+static void free_baseline(struct plan_baseline *b)
+{
+    free(b->plan);
+    free(b->hints);
+    free(b);
+}
+
+static int free_baseline_cb(void *obj, void *arg)
+{
+    free_baseline(obj);
+    return 0;
+}
+
+static void free_baselines(hash_t *h)
+{
+    if (!h)
+        return;
+    hash_for(h, free_baseline_cb, NULL);
+    hash_clear(h);
+    hash_free(h);
+}
+
+/* llmeta payload: "<plan fingerprint> <cost per row>\n<hints>\n<plan>" */
+static char *format_baseline(const unsigned char *plan_fingerprint, double cost_per_row, const char *hints,
+                             const char *plan)
+{
+    char fp[FINGERPRINTSZ * 2 + 1];
+    util_tohex(fp, (char *)plan_fingerprint, FINGERPRINTSZ);
+
+    struct strbuf *b = strbuf_new();
+    strbuf_appendf(b, "%s %.17g\n%s\n%s", fp, cost_per_row, hints ? hints : "", plan ? plan : "");
+    char *out = strdup(strbuf_buf(b));
+    strbuf_free(b);
+    return out;
+}
+
+static struct plan_baseline *parse_baseline(const unsigned char *fingerprint, const char *str)
+{
+    char fp[FINGERPRINTSZ * 2 + 1];
+    double cost;
+    const char *hints, *plan;
+
+    if (sscanf(str, "%32s %lf", fp, &cost) != 2 || strlen(fp) != FINGERPRINTSZ * 2)
+        return NULL;
+    if ((hints = strchr(str, '\n')) == NULL)
+        return NULL;
+    hints++;
+    if ((plan = strchr(hints, '\n')) == NULL)
+        return NULL;
+
+    struct plan_baseline *b = calloc(1, sizeof(struct plan_baseline));
+    if (util_tobytes((char *)b->plan_fingerprint, fp, FINGERPRINTSZ)) {
+        free(b);
+        return NULL;
+    }
+    memcpy(b->fingerprint, fingerprint, FINGERPRINTSZ);
+    b->cost_per_row = cost;
+    b->hints = plan > hints ? strndup(hints, plan - hints) : NULL;
+    b->plan = strdup(plan + 1);
+    return b;
+}
+
+int query_plan_baseline_load(void)
+{
+    unsigned char *fingerprints;
+    char **values;
+    int n;
+
+    int rc = bdb_get_plan_baselines(NULL, &fingerprints, &values, &n);
+    if (rc) {
+        logmsg(LOGMSG_ERROR, "%s: failed to read plan baselines rc %d\n", __func__, rc);
+        return rc;
+    }
+
+    hash_t *h = hash_init(FINGERPRINTSZ);
+    for (int i = 0; i < n; i++) {
+        struct plan_baseline *b = parse_baseline(fingerprints + i * FINGERPRINTSZ, values[i]);
+        if (b == NULL) {
+            char fp[FINGERPRINTSZ * 2 + 1];
+            util_tohex(fp, (char *)fingerprints + i * FINGERPRINTSZ, FINGERPRINTSZ);
+            logmsg(LOGMSG_ERROR, "%s: ignoring malformed plan baseline for fingerprint %s\n", __func__, fp);
+        } else {
+            hash_add(h, b);
+        }
+        free(values[i]);
+    }
+    free(values);
+    free(fingerprints);
+
+    Pthread_mutex_lock(&gbl_fingerprint_hash_mu);
+    /* A regression seen against an unchanged baseline still stands */
+    if (baselines) {
+        void *ent;
+        unsigned int bkt;
+        for (struct plan_baseline *b = hash_first(h, &ent, &bkt); b; b = hash_next(h, &ent, &bkt)) {
+            struct plan_baseline *old = hash_find(baselines, b->fingerprint);
+            if (old && memcmp(old->plan_fingerprint, b->plan_fingerprint, FINGERPRINTSZ) == 0) {
+                b->regressed = old->regressed;
+                memcpy(b->regressed_plan, old->regressed_plan, FINGERPRINTSZ);
+                b->regressed_cost_per_row = old->regressed_cost_per_row;
+                b->npinned = old->npinned;
+            }
+        }
+    }
+    hash_t *old = baselines;
+    baselines = h;
+    nbaselines = hash_get_num_entries(h);
+    Pthread_mutex_unlock(&gbl_fingerprint_hash_mu);
+
+    free_baselines(old);
+    ATOMIC_ADD32(gbl_plan_baseline_gen, 1);
+    logmsg(LOGMSG_INFO, "Loaded %d query plan baselines\n", n);
+    return 0;
+}
+
+struct baseline_update {
+    unsigned char fingerprint[FINGERPRINTSZ];
+    char *value; /* NULL to delete */
+};
+
+/* Write the updates to llmeta and have every node reload them */
+static int apply_baseline_updates(struct baseline_update *u, int n)
+{
+    int rc = 0, bdberr;
+
+    for (int i = 0; i < n && rc == 0; i++) {
+        if (u[i].value)
+            rc = bdb_put_plan_baseline(NULL, u[i].fingerprint, u[i].value);
+        else
+            rc = bdb_del_plan_baseline(NULL, u[i].fingerprint);
+    }
+    if (rc) {
+        logmsg(LOGMSG_ERROR, "%s: failed to write plan baselines rc %d\n", __func__, rc);
+    } else if ((rc = bdb_llog_scdone(thedb->bdb_env, plan_baseline, NULL, 0, 1, &bdberr)) != 0) {
+        logmsg(LOGMSG_ERROR, "%s: bdb_llog_scdone rc %d bdberr %d\n", __func__, rc, bdberr);
+    }
+    query_plan_baseline_load();
+    return rc;
+}
+
+static int parse_fingerprint(const char *hex, unsigned char *fingerprint)
+{
+    if (strlen(hex) != FINGERPRINTSZ * 2 || util_tobytes((char *)fingerprint, hex, FINGERPRINTSZ)) {
+        logmsg(LOGMSG_ERROR, "Invalid fingerprint '%s'\n", hex);
+        return -1;
+    }
+    return 0;
+}
+
+/* The cheapest plan per row which ran often enough to be trusted */
+static struct query_plan_item *best_plan(struct fingerprint_track *t)
+{
+    struct query_plan_item *best = NULL, *q;
+    void *ent;
+    unsigned int bkt;
+
+    if (!t->query_plan_hash)
+        return NULL;
+    for (q = hash_first(t->query_plan_hash, &ent, &bkt); q; q = hash_next(t->query_plan_hash, &ent, &bkt)) {
+        if (!q->plan_ref || q->nexecutions < gbl_query_plan_baseline_min_executions)
+            continue;
+        if (!best || q->avg_cost_per_row < best->avg_cost_per_row)
+            best = q;
+    }
+    return best;
+}
+
+int query_plan_baseline_capture(const char *fingerprint)
+{
+    unsigned char fp[FINGERPRINTSZ];
+    struct baseline_update *u = NULL;
+    int n = 0;
+
+    if (thedb->master != gbl_myhostname) {
+        logmsg(LOGMSG_ERROR, "Plan baselines can only be captured on the master\n");
+        return -1;
+    }
+    if (fingerprint && parse_fingerprint(fingerprint, fp))
+        return -1;
+
+    Pthread_mutex_lock(&gbl_fingerprint_hash_mu);
+    if (gbl_fingerprint_hash) {
+        void *ent;
+        unsigned int bkt;
+        struct fingerprint_track *t;
+        for (t = hash_first(gbl_fingerprint_hash, &ent, &bkt); t; t = hash_next(gbl_fingerprint_hash, &ent, &bkt)) {
+            if (fingerprint && memcmp(t->fingerprint, fp, FINGERPRINTSZ) != 0)
+                continue;
+            struct query_plan_item *q = best_plan(t);
+            if (!q)
+                continue;
+            u = realloc(u, (n + 1) * sizeof(struct baseline_update));
+            memcpy(u[n].fingerprint, t->fingerprint, FINGERPRINTSZ);
+            u[n].value = format_baseline(q->plan_fingerprint, q->avg_cost_per_row, q->hints,
+                                         string_ref_cstr(q->plan_ref));
+            n++;
+        }
+    }
+    Pthread_mutex_unlock(&gbl_fingerprint_hash_mu);
+
+    if (n == 0) {
+        logmsg(LOGMSG_USER, "No plan with at least %d executions to capture\n",
+               gbl_query_plan_baseline_min_executions);
+        return 0;
+    }
+
+    int rc = apply_baseline_updates(u, n);
+    for (int i = 0; i < n; i++)
+        free(u[i].value);
+    free(u);
+    if (rc == 0)
+        logmsg(LOGMSG_USER, "Captured %d query plan baselines\n", n);
+    return rc ? -1 : n;
+}
+
+int query_plan_baseline_drop(const char *fingerprint)
+{
+    unsigned char fp[FINGERPRINTSZ];
+    struct baseline_update *u = NULL;
+    int n = 0;
+
+    if (thedb->master != gbl_myhostname) {
+        logmsg(LOGMSG_ERROR, "Plan baselines can only be dropped on the master\n");
+        return -1;
+    }
+    if (fingerprint && parse_fingerprint(fingerprint, fp))
+        return -1;
+
+    Pthread_mutex_lock(&gbl_fingerprint_hash_mu);
+    if (baselines) {
+        void *ent;
+        unsigned int bkt;
+        struct plan_baseline *b;
+        for (b = hash_first(baselines, &ent, &bkt); b; b = hash_next(baselines, &ent, &bkt)) {
+            if (fingerprint && memcmp(b->fingerprint, fp, FINGERPRINTSZ) != 0)
+                continue;
+            u = realloc(u, (n + 1) * sizeof(struct baseline_update));
+            memcpy(u[n].fingerprint, b->fingerprint, FINGERPRINTSZ);
+            u[n].value = NULL;
+            n++;
+        }
+    }
+    Pthread_mutex_unlock(&gbl_fingerprint_hash_mu);
+
+    if (n == 0) {
+        logmsg(LOGMSG_USER, "No matching query plan baseline\n");
+        return 0;
+    }
+
+    int rc = apply_baseline_updates(u, n);
+    free(u);
+    if (rc == 0)
+        logmsg(LOGMSG_USER, "Dropped %d query plan baselines\n", n);
+    return rc ? -1 : n;
+}
+
+void query_plan_baseline_check(struct fingerprint_track *t, struct query_plan_item *q)
+{
+    struct plan_baseline *b;
+
+    if (!baselines || !q->plan_ref || (b = hash_find(baselines, t->fingerprint)) == NULL)
+        return;
+    if (memcmp(q->plan_fingerprint, b->plan_fingerprint, FINGERPRINTSZ) == 0)
+        return;
+    if (q->nexecutions < gbl_query_plan_baseline_min_executions)
+        return;
+    if (q->avg_cost_per_row <= b->cost_per_row * (1 + gbl_query_plan_baseline_percentage / 100))
+        return;
+    if (b->regressed && memcmp(q->plan_fingerprint, b->regressed_plan, FINGERPRINTSZ) == 0) {
+        b->regressed_cost_per_row = q->avg_cost_per_row;
+        return;
+    }
+
+    b->regressed = 1;
+    memcpy(b->regressed_plan, q->plan_fingerprint, FINGERPRINTSZ);
+    b->regressed_cost_per_row = q->avg_cost_per_row;
+
+    char fp[FINGERPRINTSZ * 2 + 1];
+    util_tohex(fp, (char *)t->fingerprint, FINGERPRINTSZ);
+    int pin = gbl_query_plan_baseline_pin && b->hints;
+    logmsg(LOGMSG_WARN,
+           "Plan regression for fingerprint %s: plan {%s} costs %f per row after %d executions, "
+           "baseline plan {%s} cost %f%s\n",
+           fp, string_ref_cstr(q->plan_ref), q->avg_cost_per_row, q->nexecutions, b->plan, b->cost_per_row,
+           pin ? ", pinning baseline" : "");
+    if (pin)
+        ATOMIC_ADD32(gbl_plan_baseline_gen, 1);
+}
+
+int query_plan_baseline_pin(struct sqlclntstate *clnt, sqlite3_stmt *stmt, const unsigned char *fingerprint,
+                            char **hints)
+{
+    unsigned char plan_fingerprint[FINGERPRINTSZ];
+    unsigned char fp[FINGERPRINTSZ];
+    char *h = NULL;
+    size_t unused;
+
+    if (!gbl_query_plan_baseline_pin || !gbl_query_plans || nbaselines == 0)
+        return 0;
+
+    Pthread_mutex_lock(&gbl_fingerprint_hash_mu);
+    struct plan_baseline *b = baselines ? hash_find(baselines, fingerprint) : NULL;
+    if (b && b->regressed && b->hints) {
+        h = strdup(b->hints);
+        memcpy(plan_fingerprint, b->plan_fingerprint, FINGERPRINTSZ);
+    }
+    Pthread_mutex_unlock(&gbl_fingerprint_hash_mu);
+
+    if (!h)
+        return 0;
+
+    /* Nothing to do if the planner already picked the baseline plan */
+    struct string_ref *plan = form_query_plan(clnt, stmt);
+    calc_fingerprint(plan ? string_ref_cstr(plan) : NULL, &unused, fp);
+    if (plan)
+        put_ref(&plan);
+    if (memcmp(fp, plan_fingerprint, FINGERPRINTSZ) == 0) {
+        free(h);
+        return 0;
+    }
+
+    Pthread_mutex_lock(&gbl_fingerprint_hash_mu);
+    if (baselines && (b = hash_find(baselines, fingerprint)) != NULL)
+        b->npinned++;
+    Pthread_mutex_unlock(&gbl_fingerprint_hash_mu);
+
+    *hints = h;
+    return 1;
+}
+
+void query_plan_baseline_dump(void)
+{
+    char fp[FINGERPRINTSZ * 2 + 1];
+    char pfp[FINGERPRINTSZ * 2 + 1];
+    void *ent;
+    unsigned int bkt;
+    struct plan_baseline *b;
+
+    logmsg(LOGMSG_USER, "query_plan_baseline_percentage %f min_executions %d pin %d\n",
+           gbl_query_plan_baseline_percentage, gbl_query_plan_baseline_min_executions, gbl_query_plan_baseline_pin);
+
+    Pthread_mutex_lock(&gbl_fingerprint_hash_mu);
+    if (baselines) {
+        for (b = hash_first(baselines, &ent, &bkt); b; b = hash_next(baselines, &ent, &bkt)) {
+            util_tohex(fp, (char *)b->fingerprint, FINGERPRINTSZ);
+            util_tohex(pfp, (char *)b->plan_fingerprint, FINGERPRINTSZ);
+            logmsg(LOGMSG_USER, "%s plan %s cost/row %f hints {%s} regressed %d pinned %" PRId64 "\n", fp, pfp,
+                   b->cost_per_row, b->hints ? b->hints : "", b->regressed, b->npinned);
+        }
+    }
+    Pthread_mutex_unlock(&gbl_fingerprint_hash_mu);
+}
+
+int query_plan_baseline_collect(void **data, int *nrecords)
+{
+    char fp[FINGERPRINTSZ * 2 + 1];
+    void *ent;
+    unsigned int bkt;
+    struct plan_baseline *b;
+    int n = 0;
+
+    *data = NULL;
+    *nrecords = 0;
+
+    Pthread_mutex_lock(&gbl_fingerprint_hash_mu);
+    if (!baselines) {
+        Pthread_mutex_unlock(&gbl_fingerprint_hash_mu);
+        return 0;
+    }
+    struct query_plan_baseline_info *arr = calloc(hash_get_num_entries(baselines), sizeof(*arr));
+    for (b = hash_first(baselines, &ent, &bkt); b; b = hash_next(baselines, &ent, &bkt), n++) {
+        util_tohex(fp, (char *)b->fingerprint, FINGERPRINTSZ);
+        arr[n].fingerprint = strdup(fp);
+        util_tohex(fp, (char *)b->plan_fingerprint, FINGERPRINTSZ);
+        arr[n].plan_fingerprint = strdup(fp);
+        arr[n].plan = b->plan ? strdup(b->plan) : NULL;
+        arr[n].hints = b->hints ? strdup(b->hints) : NULL;
+        arr[n].cost_per_row = b->cost_per_row;
+        if (b->regressed) {
+            util_tohex(fp, (char *)b->regressed_plan, FINGERPRINTSZ);
+            arr[n].regressed_plan_fingerprint = strdup(fp);
+            arr[n].regressed_cost_per_row = b->regressed_cost_per_row;
+        }
+        arr[n].npinned = b->npinned;
+    }
+    Pthread_mutex_unlock(&gbl_fingerprint_hash_mu);
+
+    *data = arr;
+    *nrecords = n;
+    return 0;
+}
+
+void query_plan_baseline_collect_free(void *data, int nrecords)
+{
+    struct query_plan_baseline_info *arr = data;
+    for (int i = 0; i < nrecords; i++) {
+        free(arr[i].fingerprint);
+        free(arr[i].plan_fingerprint);
+        free(arr[i].plan);
+        free(arr[i].hints);
+        free(arr[i].regressed_plan_fingerprint);
+    }
+    free(data);
+}
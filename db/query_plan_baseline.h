@@ -0,0 +1,79 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#ifndef INCLUDED_QUERY_PLAN_BASELINE_H
+#define INCLUDED_QUERY_PLAN_BASELINE_H
+
+#include <stdint.h>
+#include "fingerprint.h"
+
+/* Query plan baselines: the known-good plan of a fingerprint, its average
+ * cost per row and the index it used for every table.  Baselines are
+ * captured on the master from the plans tracked in db_query_plan.c, kept in
+ * llmeta and loaded by every node.  A node flags a fingerprint as regressed
+ * once a different plan costs more than the baseline by
+ * query_plan_baseline_percentage; with query_plan_baseline_pin on, the
+ * query is then re-prepared with the planner restricted to the baseline's
+ * indexes. */
+
+struct sqlclntstate;
+struct sqlite3_stmt;
+struct fingerprint_track;
+struct query_plan_item;
+
+extern double gbl_query_plan_baseline_percentage;
+extern int gbl_query_plan_baseline_min_executions;
+extern int gbl_query_plan_baseline_pin;
+
+/* Bumped whenever a pin may change; sql threads drop cached statements */
+extern volatile int gbl_plan_baseline_gen;
+
+/* Index hints of a prepared statement, "table=index ..." */
+char *form_query_plan_hints(struct sqlite3_stmt *stmt);
+int query_plan_hint_find(const char *hints, const char *table, char *index, int len);
+
+/* (Re)read all baselines from llmeta */
+int query_plan_baseline_load(void);
+
+/* Master only; fingerprint is hex, NULL for every tracked fingerprint */
+int query_plan_baseline_capture(const char *fingerprint);
+int query_plan_baseline_drop(const char *fingerprint);
+
+/* Called from add_query_plan() with gbl_fingerprint_hash_mu held */
+void query_plan_baseline_check(struct fingerprint_track *t, struct query_plan_item *q);
+
+/* Prepare time: if the statement should be re-prepared against its
+ * baseline, return 1 and the hints to pin in *hints */
+int query_plan_baseline_pin(struct sqlclntstate *clnt, struct sqlite3_stmt *stmt, const unsigned char *fingerprint,
+                            char **hints);
+
+void query_plan_baseline_dump(void);
+
+struct query_plan_baseline_info {
+    char *fingerprint;
+    char *plan_fingerprint;
+    char *plan;
+    char *hints;
+    double cost_per_row;
+    char *regressed_plan_fingerprint; /* NULL unless regressed */
+    double regressed_cost_per_row;
+    int64_t npinned;
+};
+
+int query_plan_baseline_collect(void **data, int *nrecords);
+void query_plan_baseline_collect_free(void *data, int nrecords);
+
+#endif
@@ -423,6 +423,10 @@ int add_record(struct ireq *iq, void *trans, const uint8_t *p_buf_tag_name,
         }
 
         ondisktagsc = get_schema(iq->usedb, -1);
+        /* the record length stays at the widest version after an instant
+           DROP COLUMN; keep the unused tail clear */
+        if (od_len > (size_t)ondisktagsc->recsize)
+            memset((char *)od_dta + ondisktagsc->recsize, 0, od_len - ondisktagsc->recsize);
     }
 
     rc = set_master_columns(iq, trans, od_dta, od_len);
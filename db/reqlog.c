@@ -2169,6 +2169,9 @@ void reqlog_end_request(struct reqlogger *logger, int rc, const char *callfunc,
         goto out;
 
     reqlog_logf(logger, REQL_INFO, "netwait=%dms", (int)logger->netwaitus / 1000);
+    if (logger->arenabytes > 0) {
+        reqlog_logf(logger, REQL_INFO, "arena=%lldbytes", (long long)logger->arenabytes);
+    }
 
     if (logger->sqlrows > 0) {
         reqlog_logf(logger, REQL_INFO, "rowcount=%d", logger->sqlrows);
@@ -3260,6 +3263,11 @@ void reqlog_set_netwaitus(struct reqlogger *logger, int64_t timeus)
     logger->netwaitus = timeus;
 }
 
+void reqlog_set_arenabytes(struct reqlogger *logger, int64_t bytes)
+{
+    logger->arenabytes = bytes;
+}
+
 void reqlog_set_fingerprint(struct reqlogger *logger, const char *fingerprint,
                             size_t n)
 {
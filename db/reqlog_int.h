@@ -118,6 +118,7 @@ struct reqlogger {
     int have_id;
     evtype_t event_type;
     int64_t netwaitus;
+    int64_t arenabytes; /* sqlite memory carved from the query arena */
 
     int ntables;
     int alloctables;
@@ -61,6 +61,12 @@ struct fingerprint_track {
     int64_t max_cost; /* Max cost of any query */
     int64_t prepTime; /* Cumulative preparation time only */
     int64_t rows;     /* Cumulative number of rows selected */
+    int64_t cache_misses;     /* Cumulative buffer pool misses */
+    int64_t lock_waits;       /* Cumulative number of lock waits */
+    int64_t lock_wait_us;     /* Cumulative time spent waiting on locks */
+    int64_t log_bytes;        /* Cumulative bytes written to the log */
+    int64_t temp_spills;      /* Cumulative temp tables spilled to disk */
+    int64_t temp_spill_bytes; /* Cumulative bytes spilled by temp tables */
     int64_t curr_analyze_gen; /* If the analyze gen number is different */
     int     check_next_queries; /* Check cost of next these many queries */
     int     cost_increased; /* queries with cost greater than avg cost */
@@ -103,6 +109,7 @@ struct sqlthdstate {
     int dbopen_gen;
     int analyze_gen;
     int views_gen;
+    int plan_baseline_gen;
 
     /* A flag to tell us whether we are inside the query preparer plugin. This
      * is especially needed to differentiate between fdb cursors opened by core
@@ -634,6 +641,7 @@ struct sqlworkstate {
     char *zOrigNormSql;   /* Normalized version of original SQL query. */
     struct sql_state rec; /* Prepared statement for original SQL query. */
     unsigned char aFingerprint[FINGERPRINTSZ]; /* MD5 of normalized SQL. */
+    char *zPlanPin;       /* Baseline index hints while re-preparing. */
     char zRuleRes[300];   /* Ruleset match result, if any. */
 };
 
@@ -807,6 +815,7 @@ struct sqlclntstate {
     unsigned int bdb_osql_trak; /* 32 debug bits interpreted by bdb for your
                                    "set debug bdb"*/
     struct client_query_stats *query_stats;
+    comdb2ma_arena arena; /* per-query arena for sqlite memory */
 
     COMDB2BUF *dbglog;
     int queryid;
@@ -1442,6 +1451,9 @@ void reset_query_effects(struct sqlclntstate *, int, int);
 int sqlite_to_ondisk(struct schema *s, const void *inp, int len, void *outp,
                      const char *tzname, blob_buffer_t *outblob, int maxblobs,
                      struct convert_failure *fail_reason, BtCursor *pCur);
+int ondisk_key_to_sqlite_record(struct dbtable *db, int ixnum, const void *key, unsigned long long genid, void **rec,
+                                int *reclen);
+int sqlite_record_to_ondisk_key(struct dbtable *db, int ixnum, const void *rec, int reclen, void *key);
 
 int has_sqlcache_hint(const char *sql, const char **start, const char **end);
 
@@ -1621,11 +1633,13 @@ int fingerprint_is_zero(const unsigned char fingerprint[FINGERPRINTSZ]);
 void calc_fingerprint(const char *zNormSql, size_t *pnNormSql,
                       unsigned char fingerprint[FINGERPRINTSZ]);
 void add_fingerprint(struct sqlclntstate *, sqlite3_stmt *, struct string_ref *, const char *, int64_t, int64_t,
-                     int64_t, int64_t, struct reqlogger *, unsigned char *, int);
+                     int64_t, int64_t, const struct berkdb_thread_stats *, struct reqlogger *, unsigned char *, int);
 
 long long run_sql_return_ll(const char *query, struct errstat *err);
 long long run_sql_thd_return_ll(const char *query, struct sql_thread *thd,
                                 struct errstat *err);
+int run_sql_select(const char *query, int (*callback)(void *, int, char **, char **), void *arg,
+                   struct errstat *err);
 
 struct query_plan_item {
     unsigned char plan_fingerprint[FINGERPRINTSZ]; /* md5 digest hex string */
@@ -1634,12 +1648,14 @@ struct query_plan_item {
     double total_cost_per_row;
     int nexecutions;
     int alert_once_cost; /* Only log query plan cost differences once per query plan in trace, but reset if the avg cost changes. Init to 1 */
+    char *hints;         /* Index used for each table, see form_query_plan_hints() */
 };
 int free_query_plan_hash(hash_t *query_plan_hash);
 int clear_query_plans();
 struct string_ref *form_query_plan(struct sqlclntstate *clnt, sqlite3_stmt *stmt);
-void add_query_plan(int64_t cost, int64_t nrows, struct fingerprint_track *t, struct string_ref *zSql_ref,
-                    struct string_ref *query_plan_ref, unsigned char *plan_fingerprint, char *params);
+void add_query_plan(sqlite3_stmt *stmt, int64_t cost, int64_t nrows, struct fingerprint_track *t,
+                    struct string_ref *zSql_ref, struct string_ref *query_plan_ref, unsigned char *plan_fingerprint,
+                    char *params);
 
 struct query_field {
     unsigned char fingerprint[FINGERPRINTSZ];
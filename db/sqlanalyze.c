@@ -15,6 +15,8 @@
  */
 
 #include <comdb2.h>
+#include <ctype.h>
+#include <math.h>
 #include <strings.h>
 #include <assert.h>
 #include <limits.h>
@@ -38,6 +40,9 @@
 #include "str0.h"
 #include "sc_util.h"
 #include "debug_switches.h"
+#include "tohex.h"
+#include "ixsketch.h"
+#include <strbuf.h>
 
 #include "views.h"
 #include "sqlanalyze.h"
@@ -1425,6 +1430,436 @@ void add_idx_stats(const char *tbl, const char *oldname, const char *newname)
     }
 }
 
+/* Rows read back from sqlite_stat1/sqlite_stat4 by sketch_collect() */
+struct sketch_rows {
+    int n;
+    int alloc;
+    int ncols;
+    char **vals;
+};
+
+#define SKETCH_VAL(r, i, c) ((r)->vals[(i) * (r)->ncols + (c)])
+
+static int sketch_collect(void *arg, int ncols, char **vals, char **names)
+{
+    struct sketch_rows *r = arg;
+    if (r->n == r->alloc) {
+        int alloc = r->alloc ? r->alloc * 2 : 16;
+        char **space = realloc(r->vals, (size_t)alloc * r->ncols * sizeof(char *));
+        if (space == NULL)
+            return 1;
+        r->vals = space;
+        r->alloc = alloc;
+    }
+    for (int i = 0; i < r->ncols; i++)
+        SKETCH_VAL(r, r->n, i) = strdup((i < ncols && vals[i]) ? vals[i] : "");
+    r->n++;
+    return 0;
+}
+
+static void sketch_rows_free(struct sketch_rows *r)
+{
+    for (int i = 0; i < r->n * r->ncols; i++)
+        free(r->vals[i]);
+    free(r->vals);
+}
+
+/* Statements produced by the refresh, run in order inside one transaction */
+struct sketch_stmts {
+    int n;
+    int alloc;
+    char **sql;
+};
+
+static void sketch_stmt_add(struct sketch_stmts *s, char *sql)
+{
+    if (sql == NULL)
+        return;
+    if (s->n == s->alloc) {
+        int alloc = s->alloc ? s->alloc * 2 : 16;
+        char **space = realloc(s->sql, alloc * sizeof(char *));
+        if (space == NULL) {
+            sqlite3_free(sql);
+            return;
+        }
+        s->sql = space;
+        s->alloc = alloc;
+    }
+    s->sql[s->n++] = sql;
+}
+
+static void sketch_stmts_free(struct sketch_stmts *s)
+{
+    for (int i = 0; i < s->n; i++)
+        sqlite3_free(s->sql[i]);
+    free(s->sql);
+}
+
+/* Parse up to max leading integers of a stat string; *rest is what follows */
+static int sketch_parse_list(const char *s, double *out, int max, const char **rest)
+{
+    int n = 0;
+    while (n < max) {
+        while (*s == ' ')
+            s++;
+        if (!isdigit((unsigned char)*s))
+            break;
+        char *end;
+        out[n++] = strtoll(s, &end, 10);
+        s = end;
+    }
+    while (*s == ' ')
+        s++;
+    if (rest)
+        *rest = s;
+    return n;
+}
+
+static char *sketch_format_list(const double *vals, int n)
+{
+    strbuf *s = strbuf_new();
+    for (int i = 0; i < n; i++)
+        strbuf_appendf(s, "%s%lld", i ? " " : "", (long long)(vals[i] + 0.5));
+    return strbuf_disown(s);
+}
+
+/* Fractions of the sketch samples whose first pl key bytes sort below and
+ * equal to key's */
+static void sketch_fractions(const struct ixsketch_view *v, const uint8_t *key, int pl, double *lt, double *eq)
+{
+    int nlt = 0, neq = 0;
+    for (int i = 0; i < v->nsamples; i++) {
+        int c = memcmp(v->samples + (size_t)i * v->keylen, key, pl);
+        if (c < 0)
+            nlt++;
+        else if (c == 0)
+            neq++;
+    }
+    *lt = v->nsamples ? (double)nlt / v->nsamples : 0;
+    *eq = v->nsamples ? (double)neq / v->nsamples : 0;
+}
+
+/* Distinct values of a key prefix once nins keys with dins distinct values
+ * were added.  If nearly all inserted values are distinct they are taken to
+ * be new; otherwise old and new rows are modelled as uniform draws from a
+ * domain of K values, K fitted to the inserts by dins = K(1 - e^(-nins/K)). */
+static double sketch_distinct(double dold, double nins, double dins, double nnew)
+{
+    double d = dold + dins;
+    if (nins > 0 && dins < 0.95 * nins) {
+        double lo = dins > 1 ? dins : 1, hi = 1e18;
+        for (int i = 0; i < 200 && hi / lo > 1.0001; i++) {
+            double k = sqrt(lo * hi);
+            if (-k * expm1(-nins / k) < dins)
+                lo = k;
+            else
+                hi = k;
+        }
+        double k = sqrt(lo * hi);
+        double model = -k * expm1(-nnew / k);
+        if (model < dold)
+            model = dold;
+        if (model < dins)
+            model = dins;
+        if (model < d)
+            d = model;
+    }
+    return d > nnew ? nnew : d;
+}
+
+/* Fold index ixnum's sketch into its stat1 row and stat4 samples */
+static int sketch_refresh_index(struct dbtable *db, const char *sqltbl, int ixnum, struct ixsketch_view *v,
+                                const char *stat1, struct sketch_rows *stat4, struct sketch_stmts *dels,
+                                struct sketch_stmts *ins)
+{
+    const char *idx = db->ixschema[ixnum]->sqlitetag;
+    if (ixsketch_view(db, ixnum, v))
+        return 0;
+    if (v->nins == 0 && v->ndel == 0)
+        return 0;
+
+    int maxcols = v->ncols + 2;
+    double *old = calloc(maxcols + 1, sizeof(double));
+    double *dold = calloc(maxcols, sizeof(double));
+    double *dgrow = calloc(maxcols, sizeof(double));
+    double *cols = calloc(3 * maxcols, sizeof(double));
+    uint8_t *key = malloc(v->keylen);
+    uint8_t *maxkey = calloc(1, v->keylen);
+    int changed = 0;
+    if (!old || !dold || !dgrow || !cols || !key || !maxkey)
+        goto done;
+
+    /* stat1: "nrows avg1 avg2 ... [flags]" */
+    const char *rest;
+    int nstat = sketch_parse_list(stat1, old, maxcols + 1, &rest);
+    if (nstat < 2 || old[0] <= 0)
+        goto done;
+    double nold = old[0];
+    double nnew = nold + v->nins - v->ndel;
+    if (nnew < 1) /* emptied; leave it for a full analyze */
+        goto done;
+    double shrink = nold > v->ndel ? (nold - v->ndel) / nold : 0;
+
+    strbuf *s = strbuf_new();
+    strbuf_appendf(s, "%lld", (long long)nnew);
+    double prev = 1;
+    for (int c = 0; c < maxcols; c++) {
+        dold[c] = c < nstat - 1 ? nold / (old[c + 1] > 0 ? old[c + 1] : 1) : nold;
+        double d = c < v->ncols ? sketch_distinct(dold[c], v->nins, v->distinct[c], nnew) : nnew;
+        if (d < prev)
+            d = prev;
+        prev = d;
+        dgrow[c] = d > dold[c] ? d - dold[c] : 0;
+        if (c >= nstat - 1)
+            continue;
+        strbuf_appendf(s, " %lld", (long long)((nnew + d - 1) / d));
+    }
+    if (*rest)
+        strbuf_appendf(s, " %s", rest);
+    sketch_stmt_add(dels, sqlite3_mprintf("DELETE FROM sqlite_stat1 WHERE tbl=%Q AND idx=%Q", sqltbl, idx));
+    sketch_stmt_add(ins, sqlite3_mprintf("INSERT INTO sqlite_stat1(tbl, idx, stat) VALUES(%Q, %Q, %Q)", sqltbl,
+                                         idx, strbuf_buf(s)));
+    strbuf_free(s);
+    changed = 1;
+
+    /* stat4: rescale the existing samples by what was inserted below and
+     * at each of them, then extend past the largest one with new samples */
+    struct sketch_stmts rows = {0};
+    int nrows = 0, ncol4 = 0, failed = 0;
+    for (int i = 0; i < stat4->n && !failed; i++) {
+        if (strcasecmp(SKETCH_VAL(stat4, i, 0), idx) != 0)
+            continue;
+        double *neq = cols, *nlt = cols + maxcols, *ndlt = cols + 2 * maxcols;
+        int n = sketch_parse_list(SKETCH_VAL(stat4, i, 1), neq, maxcols, NULL);
+        if (n == 0 || n != sketch_parse_list(SKETCH_VAL(stat4, i, 2), nlt, maxcols, NULL) ||
+            n != sketch_parse_list(SKETCH_VAL(stat4, i, 3), ndlt, maxcols, NULL) || (ncol4 && n != ncol4)) {
+            failed = 1;
+            break;
+        }
+        ncol4 = n;
+
+        /* quote() renders the sample as X'...' */
+        const char *q = SKETCH_VAL(stat4, i, 4);
+        int hexlen = strlen(q) - 3;
+        if (hexlen <= 0 || (hexlen & 1) || q[0] != 'X' || q[1] != '\'') {
+            failed = 1;
+            break;
+        }
+        char *hex = strndup(q + 2, hexlen);
+        char *rec = malloc(hexlen / 2);
+        if (!hex || !rec || util_tobytes(rec, hex, hexlen / 2) ||
+            sqlite_record_to_ondisk_key(db, ixnum, rec, hexlen / 2, key))
+            failed = 1;
+        free(hex);
+        free(rec);
+        if (failed)
+            break;
+        if (nrows == 0 || memcmp(key, maxkey, v->keylen) > 0)
+            memcpy(maxkey, key, v->keylen);
+        nrows++;
+
+        for (int c = 0; c < n; c++) {
+            double lt, eq;
+            sketch_fractions(v, key, c < v->ncols ? v->prefixlen[c] : v->keylen, &lt, &eq);
+            nlt[c] = nlt[c] * shrink + lt * v->nins;
+            if (c < v->ncols) {
+                neq[c] = neq[c] * shrink + eq * v->nins;
+                if (neq[c] < 1)
+                    neq[c] = 1;
+            }
+            ndlt[c] += lt * dgrow[c];
+        }
+        char *l1 = sketch_format_list(neq, n), *l2 = sketch_format_list(nlt, n), *l3 = sketch_format_list(ndlt, n);
+        sketch_stmt_add(&rows, sqlite3_mprintf("INSERT INTO sqlite_stat4(tbl, idx, neq, nlt, ndlt, sample) "
+                                               "VALUES(%Q, %Q, %Q, %Q, %Q, %s)",
+                                               sqltbl, idx, l1, l2, l3, q));
+        free(l1);
+        free(l2);
+        free(l3);
+    }
+
+    if (!failed && nrows > 0) {
+        /* sketch samples above every stat4 sample: the appended range */
+        int first = v->nsamples;
+        while (first > 0 && memcmp(v->samples + (size_t)(first - 1) * v->keylen, maxkey, v->keylen) > 0)
+            first--;
+        int m = v->nsamples - first;
+        double kept = nold * shrink > 1 ? nold * shrink : 1;
+        int nadd = m ? (int)(nrows * (v->nins * (double)m / v->nsamples) / kept + 0.5) : 0;
+        if (nadd > m)
+            nadd = m;
+        if (nadd > nrows)
+            nadd = nrows;
+        for (int j = 0; j < nadd; j++) {
+            int pos = first + (2 * j + 1) * m / (2 * nadd);
+            const uint8_t *k = v->samples + (size_t)pos * v->keylen;
+            double *neq = cols, *nlt = cols + maxcols, *ndlt = cols + 2 * maxcols;
+            for (int c = 0; c < ncol4; c++) {
+                double lt, eq;
+                sketch_fractions(v, k, c < v->ncols ? v->prefixlen[c] : v->keylen, &lt, &eq);
+                nlt[c] = nold * shrink + lt * v->nins;
+                neq[c] = c < v->ncols && eq * v->nins > 1 ? eq * v->nins : 1;
+                ndlt[c] = dold[c] + lt * dgrow[c];
+            }
+            void *rec;
+            int reclen;
+            if (ondisk_key_to_sqlite_record(db, ixnum, k, v->genids[pos], &rec, &reclen))
+                continue;
+            char *hex = malloc(2 * reclen + 1);
+            if (hex) {
+                util_tohex(hex, rec, reclen);
+                char *l1 = sketch_format_list(neq, ncol4), *l2 = sketch_format_list(nlt, ncol4),
+                     *l3 = sketch_format_list(ndlt, ncol4);
+                sketch_stmt_add(&rows, sqlite3_mprintf("INSERT INTO sqlite_stat4(tbl, idx, neq, nlt, ndlt, sample) "
+                                                       "VALUES(%Q, %Q, %Q, %Q, %Q, X'%s')",
+                                                       sqltbl, idx, l1, l2, l3, hex));
+                free(l1);
+                free(l2);
+                free(l3);
+                free(hex);
+            }
+            free(rec);
+        }
+
+        sketch_stmt_add(dels, sqlite3_mprintf("DELETE FROM sqlite_stat4 WHERE tbl=%Q AND idx=%Q", sqltbl, idx));
+        for (int i = 0; i < rows.n; i++) {
+            sketch_stmt_add(ins, rows.sql[i]);
+            rows.sql[i] = NULL;
+        }
+    } else if (failed) {
+        logmsg(LOGMSG_WARN, "%s: keeping sqlite_stat4 samples of %s.%s as they are\n", __func__, sqltbl, idx);
+    }
+    sketch_stmts_free(&rows);
+
+done:
+    free(old);
+    free(dold);
+    free(dgrow);
+    free(cols);
+    free(key);
+    free(maxkey);
+    return changed;
+}
+
+/* Refresh the statistics of a table from the write-path sketches (see
+ * ixsketch.c) instead of scanning it.  Indexes without a sqlite_stat1 row
+ * still need a regular analyze. */
+int analyze_table_from_sketch(char *table, COMDB2BUF *sb)
+{
+    if (check_stat1(sb))
+        return -1;
+    if (!gbl_ixsketch) {
+        cdb2buf_printf(sb, "?Index sketches are disabled\n");
+        cdb2buf_printf(sb, "FAILED\n");
+        return -1;
+    }
+    if (set_analyze_running(sb))
+        return SQLITE_ANALYZE_ALREADY_RUNNING;
+
+    int rc = 0, nix = 0;
+    struct sketch_rows stat1 = {.ncols = 2}, stat4 = {.ncols = 5};
+    struct sketch_stmts dels = {0}, ins = {0};
+    struct ixsketch_view *views = NULL;
+    int *folded = NULL;
+    struct sqlclntstate clnt;
+    struct errstat err = {0};
+    char sqltblname[MAXTABLELEN];
+
+    start_internal_sql_clnt(&clnt, 0);
+    clnt.dbtran.mode = TRANLEVEL_RECOM;
+    clnt.osql_max_trans = 0;
+    clnt.admin = 1;
+
+    rdlock_schema_lk();
+    struct dbtable *db = get_dbtable_by_name(table);
+    if (db == NULL) {
+        cdb2buf_printf(sb, "?Cannot find table '%s'\n", table);
+        rc = -1;
+        goto out;
+    }
+    strncpy0(sqltblname, db->sqlaliasname ? db->sqlaliasname : db->tablename, sizeof(sqltblname));
+    views = calloc(db->nix, sizeof(struct ixsketch_view));
+    folded = calloc(db->nix, sizeof(int));
+    if ((views == NULL || folded == NULL) && db->nix) {
+        cdb2buf_printf(sb, "?Out of memory\n");
+        rc = -1;
+        goto out;
+    }
+
+    char *sql = sqlite3_mprintf("SELECT idx, stat FROM sqlite_stat1 WHERE tbl=%Q", sqltblname);
+    rc = run_sql_select(sql, sketch_collect, &stat1, &err);
+    sqlite3_free(sql);
+    if (rc == 0 && get_dbtable_by_name("sqlite_stat4")) {
+        sql = sqlite3_mprintf("SELECT idx, neq, nlt, ndlt, quote(sample) FROM sqlite_stat4 WHERE tbl=%Q",
+                              sqltblname);
+        rc = run_sql_select(sql, sketch_collect, &stat4, &err);
+        sqlite3_free(sql);
+    }
+    if (rc) {
+        cdb2buf_printf(sb, "?Reading statistics of table %s failed rc %d %s\n", table, rc, err.errstr);
+        goto out;
+    }
+
+    for (int i = 0; i < stat1.n; i++) {
+        for (int ixnum = 0; ixnum < db->nix; ixnum++) {
+            if (strcasecmp(SKETCH_VAL(&stat1, i, 0), db->ixschema[ixnum]->sqlitetag) == 0) {
+                folded[ixnum] = sketch_refresh_index(db, sqltblname, ixnum, &views[ixnum], SKETCH_VAL(&stat1, i, 1),
+                                                     &stat4, &dels, &ins);
+                nix += folded[ixnum];
+                break;
+            }
+        }
+    }
+    if (nix == 0) {
+        cdb2buf_printf(sb, "?No statistics of table %s to refresh\n", table);
+        goto out;
+    }
+
+    rc = run_internal_sql_clnt(&clnt, "BEGIN");
+    if (rc)
+        goto out;
+    /* deletes from the stat tables are skipped under is_analyze */
+    for (int i = 0; i < dels.n && rc == 0; i++)
+        rc = run_internal_sql_clnt(&clnt, dels.sql[i]);
+    clnt.is_analyze = 1;
+    for (int i = 0; i < ins.n && rc == 0; i++)
+        rc = run_internal_sql_clnt(&clnt, ins.sql[i]);
+    clnt.is_analyze = 0;
+    if (rc) {
+        if (run_internal_sql_clnt(&clnt, "ROLLBACK /* from analyze sketch */") != 0)
+            osql_unregister_sqlthr(&clnt);
+    } else if ((rc = run_internal_sql_clnt(&clnt, "COMMIT /* from analyze sketch */")) != 0) {
+        osql_unregister_sqlthr(&clnt);
+    }
+    if (rc) {
+        cdb2buf_printf(sb, "?Refreshing statistics of table %s failed rc %d: '%s'\n", table, rc, clnt.sql);
+    } else {
+        /* only now that the rows are in are the sketches spent; on any
+         * failure they are kept for the next refresh */
+        for (int ixnum = 0; ixnum < db->nix; ixnum++)
+            if (folded[ixnum])
+                ixsketch_consume(db, ixnum, &views[ixnum]);
+        cdb2buf_printf(sb, "?Refreshed %d index(es) of table %s from sketches\n", nix, table);
+    }
+
+out:
+    for (int ixnum = 0; views && ixnum < db->nix; ixnum++)
+        ixsketch_view_free(&views[ixnum]);
+    free(views);
+    free(folded);
+    unlock_schema_lk();
+    end_internal_sql_clnt(&clnt);
+    sketch_rows_free(&stat1);
+    sketch_rows_free(&stat4);
+    sketch_stmts_free(&dels);
+    sketch_stmts_free(&ins);
+
+    cdb2buf_printf(sb, rc ? "FAILED\n" : "SUCCESS\n");
+    cdb2buf_flush(sb);
+    analyze_running_flag = 0;
+    return rc;
+}
+
 int do_analyze(char *tbl, int percent)
 {
     COMDB2BUF *sb2 = cdb2buf_open(fileno(stdout), 0);
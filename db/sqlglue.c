@@ -109,6 +109,7 @@
 #include <sqlwriter.h>
 
 #include "views.h"
+#include "query_plan_baseline.h"
 
 int gbl_delay_sql_lock_release_sec = 5;
 
@@ -1027,6 +1028,48 @@ static int ondisk_to_sqlite(struct dbtable *db, struct schema *s, void *inp, int
                                blob, blobsz, bloboffs, reqsize, NULL, NULL);
 }
 
+/* Convert an ondisk key of index ixnum to an sqlite record with the genid as
+ * the trailing rowid, as sqlite_stat4 samples are stored.  Caller frees *rec. */
+int ondisk_key_to_sqlite_record(struct dbtable *db, int ixnum, const void *key, unsigned long long genid, void **rec,
+                                int *reclen)
+{
+    struct schema *s = db->ixschema[ixnum];
+    int keylen = db->ix_keylen[ixnum];
+    int maxout = 2 * keylen + 64;
+    int reqsize = 0;
+    int rc;
+
+    /* conversion flips descending fields in place */
+    void *in = alloca(keylen);
+    memcpy(in, key, keylen);
+
+    *rec = NULL;
+    for (int attempt = 0; attempt < 2; attempt++) {
+        void *out = malloc(maxout);
+        if (out == NULL)
+            return -1;
+        rc = ondisk_to_sqlite(db, s, in, 2, genid, out, maxout, 0, NULL, NULL, NULL, &reqsize);
+        if (rc == 0) {
+            *rec = out;
+            *reclen = reqsize;
+            return 0;
+        }
+        free(out);
+        if (rc != -2)
+            break;
+        maxout = reqsize;
+    }
+    return -1;
+}
+
+/* Convert an sqlite record holding index ixnum's columns (and possibly a
+ * trailing rowid) to its ondisk key */
+int sqlite_record_to_ondisk_key(struct dbtable *db, int ixnum, const void *rec, int reclen, void *key)
+{
+    int rc = sqlite_to_ondisk(db->ixschema[ixnum], rec, reclen, key, "UTC", NULL, 0, NULL, NULL);
+    return rc < 0 ? rc : 0;
+}
+
 /* Convert a sequence of Mem * to a serialized sqlite row */
 int sqlite3_unpacked_to_packed(Mem *mems, int nmems, char **ret_rec,
                                int *ret_rec_len)
@@ -11577,6 +11620,17 @@ int comdb2_get_planner_effort()
     return clnt->planner_effort;
 }
 
+/* Return 1 if a plan baseline pins the index used for table zTab; zIdx is
+ * set to the index name, or to "" if the baseline scanned the table. */
+int comdb2_pinned_index(const char *zTab, char *zIdx, int nIdx)
+{
+    struct sql_thread *thd = pthread_getspecific(query_info_key);
+
+    if (!thd || !thd->clnt || !thd->clnt->work.zPlanPin)
+        return 0;
+    return query_plan_hint_find(thd->clnt->work.zPlanPin, zTab, zIdx, nIdx);
+}
+
 /* Return the index number. */
 int comdb2_get_index(const char *dbname, char *idx)
 {
@@ -13080,26 +13134,13 @@ int _some_callback(void *theresult, int ncols, char **vals, char **cols)
     return SQLITE_OK;
 }
 
-long long run_sql_return_ll(const char *sql, struct errstat *err)
-{
-    struct sql_thread *thd;
-    int rc;
-
-    thd = start_sql_thread();
-    rc = run_sql_thd_return_ll(sql, thd, err);
-    done_sql_thread();
-
-    return rc;
-}
-
-long long run_sql_thd_return_ll(const char *query, struct sql_thread *thd,
-                                struct errstat *err)
+static int run_sql_thd_exec(const char *query, struct sql_thread *thd,
+                            int (*callback)(void *, int, char **, char **), void *arg, struct errstat *err)
 {
     sqlite3 *sqldb;
     int rc;
     int crc;
     char *msg;
-    long long ret = LLONG_MIN;
 
     struct sqlclntstate clnt;
     start_internal_sql_clnt(&clnt, 1);
@@ -13123,7 +13164,7 @@ long long run_sql_thd_return_ll(const char *query, struct sql_thread *thd,
         goto cleanup;
     }
 
-    if ((rc = sqlite3_exec(sqldb, query, _some_callback, &ret, &msg)) != 0) {
+    if ((rc = sqlite3_exec(sqldb, query, callback, arg, &msg)) != 0) {
         errstat_set_rcstrf(err, -1, "q:\"%.100s\" failed rc %d: \"%.50s\"",
                            query, rc, msg ? msg : "<unknown error>");
         goto cleanup;
@@ -13139,9 +13180,43 @@ cleanup:
 done:
     end_internal_sql_clnt(&clnt);
     thd->clnt = NULL;
+    return rc;
+}
+
+long long run_sql_return_ll(const char *sql, struct errstat *err)
+{
+    struct sql_thread *thd;
+    int rc;
+
+    thd = start_sql_thread();
+    rc = run_sql_thd_return_ll(sql, thd, err);
+    done_sql_thread();
+
+    return rc;
+}
+
+long long run_sql_thd_return_ll(const char *query, struct sql_thread *thd,
+                                struct errstat *err)
+{
+    long long ret = LLONG_MIN;
+    run_sql_thd_exec(query, thd, _some_callback, &ret, err);
     return ret;
 }
 
+/* Run a read-only query, handing each row to callback as sqlite3_exec does */
+int run_sql_select(const char *query, int (*callback)(void *, int, char **, char **), void *arg,
+                   struct errstat *err)
+{
+    struct sql_thread *thd;
+    int rc;
+
+    thd = start_sql_thread();
+    rc = run_sql_thd_exec(query, thd, callback, arg, err);
+    done_sql_thread();
+
+    return rc;
+}
+
 struct temptable get_tbl_by_rootpg(const sqlite3 *db, int i)
 {
     // aDb[1]: sqlite_temp_master
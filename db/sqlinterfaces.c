@@ -99,6 +99,8 @@
 #include <net_appsock.h>
 #include <typessql.h>
 #include <sqlwriter.h>
+#include <wait_events.h>
+#include "query_plan_baseline.h"
 
 /*
 ** WARNING: These enumeration values are not arbitrary.  They represent
@@ -128,6 +130,8 @@ extern int gbl_fdb_track;
 extern int gbl_stable_rootpages_test;
 extern int gbl_verbose_normalized_queries;
 extern int gbl_group_concat_mem_limit;
+extern int gbl_latency_histograms;
+extern int gbl_latency_step_sample;
 extern int gbl_expressions_indexes;
 extern int gbl_old_column_names;
 extern hash_t *gbl_fingerprint_hash;
@@ -188,6 +192,7 @@ comdb2_query_preparer_t *query_preparer_plugin;
 int gbl_sql_recover_time = 10;
 int gbl_debug_recover_deadlock_evbuffer = 0;
 int gbl_sql_row_delay_msecs = 0; /* testing delay per sql row, before sending the row */
+int gbl_sql_query_arena = 1;
 
 void rcache_init(size_t, size_t);
 void rcache_destroy(void);
@@ -373,7 +378,10 @@ int write_response(struct sqlclntstate *clnt, int R, void *D, int I)
             }
         }
     }
-    return clnt->plugin.write_response(clnt, R, D, I); /* newsql_write_response */
+    int wait_prev = wait_event_begin(WAIT_EVENT_NET_SEND);
+    int rc = clnt->plugin.write_response(clnt, R, D, I); /* newsql_write_response */
+    wait_event_end(wait_prev);
+    return rc;
 }
 
 int read_response(struct sqlclntstate *clnt, int R, void *D, int I)
@@ -926,7 +934,15 @@ int sqlite3_maybe_step(
       return SQLITE_DONE;
     }
   }
-  clnt->step_rc = sqlite3_step(stmt);
+  /* time the first step of each statement and every Nth one after it */
+  if( gbl_latency_histograms && gbl_latency_step_sample>0
+   && (steps % gbl_latency_step_sample)==0 ){
+    uint64_t start = comdb2_time_epochus();
+    clnt->step_rc = sqlite3_step(stmt);
+    latency_hist_add(LATENCY_SQL_STEP, comdb2_time_epochus() - start);
+  }else{
+    clnt->step_rc = sqlite3_step(stmt);
+  }
   return clnt->step_rc;
 }
 
@@ -1265,6 +1281,8 @@ static void sql_statement_done(struct sql_thread *thd, struct reqlogger *logger,
         reqlog_logf(logger, REQL_INFO, "rqid=%llx", clnt->osql.rqid);
     }
     reqlog_set_netwaitus(logger, clnt->netwaitus);
+    if (clnt->arena)
+        reqlog_set_arenabytes(logger, comdb2ma_arena_used(clnt->arena));
 
     unsigned char fingerprint[FINGERPRINTSZ];
     int have_fingerprint = 0;
@@ -1293,13 +1311,13 @@ static void sql_statement_done(struct sql_thread *thd, struct reqlogger *logger,
                 rows = clnt->nrows;
             }
             if (clnt->work.zOrigNormSql) { /* NOTE: Not subject to prepare. */
-                add_fingerprint(clnt, stmt, h->sql_ref, clnt->work.zOrigNormSql, cost, time, prepTime, rows, logger,
-                                fingerprint, is_lua);
+                add_fingerprint(clnt, stmt, h->sql_ref, clnt->work.zOrigNormSql, cost, time, prepTime, rows,
+                                bdb_get_thread_stats(), logger, fingerprint, is_lua);
                 have_fingerprint = 1;
             } else if (clnt->work.zNormSql &&
                        sqlite3_is_success(clnt->prep_rc)) {
-                add_fingerprint(clnt, stmt, h->sql_ref, clnt->work.zNormSql, cost, time, prepTime, rows, logger,
-                                fingerprint, is_lua);
+                add_fingerprint(clnt, stmt, h->sql_ref, clnt->work.zNormSql, cost, time, prepTime, rows,
+                                bdb_get_thread_stats(), logger, fingerprint, is_lua);
                 have_fingerprint = 1;
             } else {
                 reqlog_reset_fingerprint(logger, FINGERPRINTSZ);
@@ -2829,6 +2847,12 @@ static int check_thd_gen(struct sqlthdstate *thd, struct sqlclntstate *clnt, int
         return SQLITE_SCHEMA_REMOTE;
     }
 
+    /* A plan baseline was pinned or dropped: cached plans may be stale */
+    if (thd->plan_baseline_gen != gbl_plan_baseline_gen) {
+        stmt_cache_reset(thd->stmt_cache);
+        thd->plan_baseline_gen = gbl_plan_baseline_gen;
+    }
+
     return SQLITE_OK;
 }
 
@@ -3218,6 +3242,17 @@ static void normalize_stmt_and_store(
   }
 }
 
+static void free_vtable_locks(struct sqlthdstate *thd)
+{
+    for (int i = 0; i < thd->authState.numVTableLocks; i++) {
+        free(thd->authState.vTableLocks[i]);
+    }
+    free(thd->authState.vTableLocks);
+    thd->authState.numVTableLocks = 0;
+    thd->authState.vTableLocks = NULL;
+    thd->authState.hasVTables = 0;
+}
+
 static struct fingerprint_track *prepare_fingerprint(struct sqlclntstate *clnt,
                                                      struct sql_state *rec,
                                                      unsigned char fingerprint[FINGERPRINTSZ],
@@ -3303,16 +3338,32 @@ static int get_prepared_stmt_int(struct sqlthdstate *thd,
 
     /* If we did not get a cached stmt, need to prepare it in sql engine */
     int startPrepMs = comdb2_time_epochms(); /* start of prepare phase */
+    int pinned = 0;
     while (rec->stmt == NULL) {
         clnt->in_sqlite_init = 1;
         comdb2_set_authstate(thd, clnt, flags);
         rec->prepFlags = flags;
 
+        uint64_t prep_start = comdb2_time_epochus();
         clnt->prep_rc = rc = sqlite3_prepare_v3(thd->sqldb, rec->sql, -1,
                                                 sqlPrepFlags, &rec->stmt, &tail);
+        latency_hist_add(LATENCY_SQL_PREPARE, comdb2_time_epochus() - prep_start);
+        free(clnt->work.zPlanPin);
+        clnt->work.zPlanPin = NULL;
         clnt->tail_offset = tail ? (tail - clnt->sql) : 0;
         if (rc == SQLITE_OK && rec->stmt != NULL) {
             t = prepare_fingerprint(clnt, rec, fingerprint, flags);
+
+            /* The plan regressed against its baseline: prepare it again,
+             * restricted to the indexes the baseline used */
+            if (!pinned && !prepareOnly &&
+                query_plan_baseline_pin(clnt, rec->stmt, fingerprint, &clnt->work.zPlanPin)) {
+                pinned = 1;
+                sqlite3_finalize(rec->stmt);
+                rec->stmt = NULL;
+                free_vtable_locks(thd);
+                continue;
+            }
         }
 
         /* Prepare the query with the query_preparer plugin. */
@@ -3347,13 +3398,7 @@ static int get_prepared_stmt_int(struct sqlthdstate *thd,
             thd->authState.vTableLocks = NULL;
             thd->authState.hasVTables = 0;
         } else {
-            for (int i = 0; i < thd->authState.numVTableLocks; i++) {
-                free(thd->authState.vTableLocks[i]);
-            }
-            free(thd->authState.vTableLocks);
-            thd->authState.numVTableLocks = 0;
-            thd->authState.vTableLocks = NULL;
-            thd->authState.hasVTables = 0;
+            free_vtable_locks(thd);
         }
 
         thd->authState.flags = 0;
@@ -3376,6 +3421,7 @@ static int get_prepared_stmt_int(struct sqlthdstate *thd,
         if (!t)
             t = prepare_fingerprint(clnt, rec, fingerprint, flags);
         reqlog_set_fingerprint(thd->logger, (const char *)fingerprint, FINGERPRINTSZ);
+        wait_state_set_fingerprint(fingerprint);
 
         sqlite3_resetclock(rec->stmt);
         thr_set_current_sql(rec->sql);
@@ -4241,6 +4287,14 @@ int handle_sqlite_requests(struct sqlthdstate *thd, struct sqlclntstate *clnt)
     struct sql_state rec = {0};
     rec.sql = clnt->sql;
     char *allocd_str = NULL;
+    comdb2ma_arena prev_arena = NULL;
+    int use_arena = 0;
+
+    if (gbl_sql_query_arena) {
+        if (clnt->arena == NULL)
+            clnt->arena = comdb2ma_arena_create(COMDB2MA_STATIC_SQLITE, 0);
+        use_arena = (clnt->arena != NULL);
+    }
 
     do {
 retry_legacy_remote:
@@ -4302,8 +4356,15 @@ retry_legacy_remote:
 
         int fast_error = 0;
 
-        /* run the engine */
+        /* run the engine. Execution scratch memory comes from the client's
+           arena and is rewound in one step once the statement is done. The
+           statement itself is prepared outside of the arena: it may be cached
+           past this request and would pin the arena's blocks. */
+        if (use_arena)
+            prev_arena = comdb2ma_arena_bind(clnt->arena);
         rc = run_stmt(thd, clnt, &rec, &fast_error, &err);
+        if (use_arena)
+            comdb2ma_arena_bind(prev_arena);
         if (rc) {
             int irc = errstat_get_rc(&err);
             switch(irc) {
@@ -4332,6 +4393,8 @@ done:
 
     if (allocd_str)
         free(allocd_str);
+    if (use_arena)
+        comdb2ma_arena_reset(clnt->arena);
     return rc;
 }
 
@@ -4877,6 +4940,7 @@ void sqlengine_work_appsock(struct sqlthdstate *thd, struct sqlclntstate *clnt)
     clnt->added_to_hist = clnt->isselect = 0;
     clnt->was_consumer = 0;
     clnt_change_state(clnt, CONNECTION_RUNNING);
+    wait_state_begin_work();
     clnt->osql.timings.query_dispatched = osql_log_time();
 
     reqlog_set_origin(thd->logger, "%s", clnt->origin);
@@ -4892,6 +4956,7 @@ void sqlengine_work_appsock(struct sqlthdstate *thd, struct sqlclntstate *clnt)
             /* Another iteration was scheduled on a new worker.
              * That worker now owns the clnt; do NOT signal_clnt_as_done
              * here or it would race with the new worker's enqueue. */
+            wait_state_end_work();
             thrman_setid(thrman_self(), "[done]");
             return;
         }
@@ -4908,6 +4973,7 @@ void sqlengine_work_appsock(struct sqlthdstate *thd, struct sqlclntstate *clnt)
         clnt->osql.timings.query_finished = osql_log_time();
         osql_log_time_done(clnt);
         clnt_change_state(clnt, CONNECTION_IDLE);
+        wait_state_end_work();
         signal_clnt_as_done(clnt);
         return;
     }
@@ -4960,6 +5026,7 @@ done:
     osql_log_time_done(clnt);
     clnt_change_state(clnt, CONNECTION_IDLE);
     debug_close_clnt(clnt);
+    wait_state_end_work();
     signal_clnt_as_done(clnt);
 
     thrman_setid(thrman_self(), "[done]");
@@ -5335,13 +5402,17 @@ void cleanup_clnt(struct sqlclntstate *clnt)
         release_node_stats(clnt->origin_argv0 ? clnt->origin_argv0 : clnt->argv0, clnt->stack, clnt->origin);
         clnt->rawnodestats = NULL;
     }
-    close_sp(clnt);
+    park_sp(clnt);
     osql_clean_sqlclntstate(clnt);
     clnt_try_enable_logdel(clnt);
     if (clnt->dbglog) {
         cdb2buf_close(clnt->dbglog);
         clnt->dbglog = NULL;
     }
+    if (clnt->arena) {
+        comdb2ma_arena_destroy(clnt->arena);
+        clnt->arena = NULL;
+    }
     if (clnt->saved_errstr) {
         free(clnt->saved_errstr);
         clnt->saved_errstr = NULL;
@@ -60,6 +60,7 @@
 #include "schemachange.h" /* sc_errf() */
 #include "dynschematypes.h"
 #include "fdb_fend.h"
+#include "ixsketch.h"
 
 extern struct dbenv *thedb;
 extern pthread_mutex_t csc2_subsystem_mtx;
@@ -69,6 +70,7 @@ const int gbl_ondisk_ver_len = sizeof ".ONDISK.VER.255xx";
 
 int _dbg_tags = 0;
 int gbl_debug_alter_sequences_sleep = 0;
+int gbl_instant_sc_drop_column = 1;
 
 #define TAGLOCK_RW_LOCK
 #ifdef TAGLOCK_RW_LOCK
@@ -2528,6 +2530,10 @@ int vtag_to_ondisk_vermap(const dbtable *db, uint8_t *rec, int *len,
                 set_dbstore(db, i, &rec[offset], 0 /* only set null bit */);
             }
         }
+
+        /* clear what is left of a wider version */
+        if (db->lrl > to_schema->recsize)
+            memset(rec + to_schema->recsize, 0, db->lrl - to_schema->recsize);
     } else {
         // same ordering of fields between ver and ondisk
         // so we can loop from the end until when we hit .ver < ver
@@ -2635,6 +2641,10 @@ int vtag_to_ondisk(const dbtable *db, uint8_t *rec, int *len, uint8_t ver,
         }
     }
 
+    /* clear what is left of a wider version */
+    if (db->lrl > to_schema->recsize)
+        memset(rec + to_schema->recsize, 0, db->lrl - to_schema->recsize);
+
 done:
     if (len)
         *len = db->lrl;
@@ -3950,6 +3960,7 @@ int compare_tag_int(struct schema *old, struct schema *new, FILE *out, int stric
     int rc = SC_NO_CHANGE;
     int change = SC_NO_CHANGE;
     int oidx, nidx;
+    int dropped = 0;
     sc_tag_change_subtype subtype = SC_TAG_CHANGE_UNKNOWN;
 
     /* Find changes to old fields */
@@ -4055,8 +4066,15 @@ int compare_tag_int(struct schema *old, struct schema *new, FILE *out, int stric
         /* if old column has been deleted */
         if (!found) {
             snprintf(buf, sizeof(buf), "field has been deleted");
-            change = SC_TAG_CHANGE;
-            subtype = SC_TAG_CHANGE_COLUMN_DROPPED;
+            if (strict || !gbl_instant_sc_drop_column) {
+                change = SC_TAG_CHANGE;
+                subtype = SC_TAG_CHANGE_COLUMN_DROPPED;
+            } else {
+                /* older versions are mapped to .ONDISK by name, so the
+                 * column is simply not carried over */
+                change = SC_COLUMN_ADDED;
+                dropped = 1;
+            }
         }
 
         /* These kind of changes would require a rebuild if this were the
@@ -4218,8 +4236,9 @@ int compare_tag_int(struct schema *old, struct schema *new, FILE *out, int stric
     }
 
     /* Cannot do instant schema change if recsize does not
-     * atleast increase by 2 bytes */
-    if (rc == SC_COLUMN_ADDED) {
+     * atleast increase by 2 bytes. A drop is exempt: the record length stays
+     * at the widest stored version (see update_dbstore()). */
+    if (rc == SC_COLUMN_ADDED && !dropped) {
         if (new->recsize < old->recsize + 2) {
             if (out) {
                 logmsg(LOGMSG_INFO, "tag %s recsize %d, was %d\n", old->tag,
@@ -5968,6 +5987,8 @@ void update_dbstore(dbtable *db)
     logmsg(LOGMSG_DEBUG, "%s table '%s' schema version %d\n", __func__,
            db->tablename, db->schema_version);
 
+    int lrl = ondisk->recsize;
+
     for (int v = 1; v <= db->schema_version; ++v) {
         char tag[MAXTAGLEN];
         struct schema *ver;
@@ -5996,15 +6017,12 @@ void update_dbstore(dbtable *db)
 
             to = get_field_position(ondisk, from->name, &position);
             if (position < 0) {
-                logmsg(LOGMSG_FATAL,
-                       "%s: %s no such field: %s in .ONDISK. but in %s!! "
-                       "PANIC!!\n",
-                       db->tablename, __func__, from->name, tag);
-                abort();
+                /* column was dropped after version v */
+                db->vers_compat_ondisk[v] = 0;
+                continue;
             }
 
-            if (db->versmap[v][i] != i || from->type != to->type ||
-                from->len != to->len)
+            if (i >= ondisk->nmembers || db->versmap[v][i] != i || from->type != to->type || from->len != to->len)
                 db->vers_compat_ondisk[v] = 0; // not compatible
 
             if (db->dbstore[position].ver == 0) {
@@ -6038,7 +6056,21 @@ void update_dbstore(dbtable *db)
                 }
             }
         } /* end for each field */
-    }     /* end for each version */
+
+        if (ver->recsize > lrl)
+            lrl = ver->recsize;
+    } /* end for each version */
+
+    /* Rows of every stored version are fetched into lrl sized buffers and
+     * converted in place, so after a DROP COLUMN the record length stays at
+     * the widest version until a rebuild resets the versions. */
+    if (lrl != db->lrl) {
+        logmsg(LOGMSG_INFO, "%s table '%s' lrl %d -> %d\n", __func__,
+               db->tablename, db->lrl, lrl);
+        db->lrl = lrl;
+        if (db->handle)
+            bdb_set_lrl(db->handle, lrl);
+    }
 }
 
 void replace_tag_schema(dbtable *db, struct schema *schema)
@@ -6217,6 +6249,7 @@ void freedb_int(dbtable *db, dbtable *replace)
 
     free(db->ixuse);
     free(db->sqlixuse);
+    ixsketch_free(db);
     free(db->csc2_schema);
     free(db->ixschema);
     if (db->sc_genids)
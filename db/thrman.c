@@ -48,6 +48,7 @@
 #include "reqlog.h"
 #include "str0.h"
 #include "phys_rep.h"
+#include "wait_events.h"
 
 extern struct thdpool *gbl_loadcache_thdpool;
 
@@ -86,6 +87,9 @@ struct thr_handle {
 
     enum thrsubtype subtype;
 
+    /* What this thread is waiting on; see wait_events.h */
+    struct wait_state wait;
+
     LINKC_T(struct thr_handle) linkv;
 };
 
@@ -150,6 +154,7 @@ struct thr_handle *thrman_register(enum thrtype type)
     thr->fd = -1;
 
     Pthread_setspecific(thrman_key, thr);
+    wait_state_self = &thr->wait;
     Pthread_mutex_lock(&mutex);
     listc_abl(&thr_list, thr);
     thr_type_counts[type]++;
@@ -210,6 +215,9 @@ static void thrman_destructor(void *param)
         return;
     }
 
+    if (wait_state_self == &thr->wait)
+        wait_state_self = NULL;
+
     Pthread_mutex_lock(&mutex);
     listc_rfl(&thr_list, thr);
     thr_type_counts[thr->type]--;
@@ -609,6 +617,19 @@ int thrman_wait_type_exit(enum thrtype type)
     return 0;
 }
 
+/* Call fn for every registered thread that is busy with a request */
+void thrman_foreach_active(void (*fn)(enum thrtype, const struct wait_state *, void *), void *arg)
+{
+    struct thr_handle *thr;
+    Pthread_mutex_lock(&mutex);
+    LISTC_FOR_EACH(&thr_list, thr, linkv)
+    {
+        if (thr->wait.active)
+            fn(thr->type, &thr->wait, arg);
+    }
+    Pthread_mutex_unlock(&mutex);
+}
+
 /* Count the number of threads of the given type already running. */
 int thrman_count_type(enum thrtype type)
 {
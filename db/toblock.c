@@ -80,7 +80,9 @@
 #include "str0.h"
 #include "schemachange.h"
 #include "views.h"
+#include "perf.h"
 #include <disttxn.h>
+#include "ixsketch.h"
 
 #if 0
 #define TEST_OSQL
@@ -3011,6 +3013,8 @@ static int toblock_main_int(struct javasp_trans_state *javasp_trans_handle, stru
     /* same for oplog counter */
     iq->oplog_numops = 0;
 
+    ixsketch_txn_begin(iq);
+
     num_reqs = p_blkstate->numreq;
 
     if (gbl_is_physical_replicant) {
@@ -6411,6 +6415,7 @@ add_blkseq:
         /* Committed new sqlite_stat1 statistics from analyze - reload sqlite
          * engines */
         iq->dbenv->txns_committed++;
+        ixsketch_txn_commit(iq);
         if (iq->dbglog_file) {
             dbglog_dump_write_stats(iq);
             cdb2buf_close(iq->dbglog_file);
@@ -6450,6 +6455,7 @@ add_blkseq:
 
     ATOMIC_ADD64(n_commit_time, diff_time_micros);
     ATOMIC_ADD32(n_commits, 1);
+    latency_hist_add(LATENCY_COMMIT, diff_time_micros);
 
     if (outrc == 0) {
         if (iq->__limits.maxcost_warn &&
@@ -6481,6 +6487,9 @@ cleanup:
     if (outrc != RC_INTERNAL_RETRY)
         osql_blkseq_unregister(iq);
 
+    /* anything not applied at commit was rolled back */
+    ixsketch_txn_abort(iq);
+
     /* XXX
        This can't happen .. we wait-for-seqnum on the commit for failed transactions
 
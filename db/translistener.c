@@ -39,6 +39,7 @@
 #include <unistd.h>
 #include <logmsg.h>
 #include "str0.h"
+#include "crc32c.h"
 
 struct javasp_trans_state {
     /* Which events we are subscribed for. */
@@ -79,6 +80,8 @@ struct stored_proc {
 
     char *qname;
     int flags;
+    int npartitions; /* items hashed on partfield into this many consumers */
+    char *partfield;
     LISTC_T(struct sp_table) tables;
     LINKC_T(struct stored_proc) lnk;
 };
@@ -776,6 +779,32 @@ static int append_field(struct byte_buffer *bytes, struct field *f,
     return 0;
 }
 
+/* Hash of a field's value for picking a queue partition.  Blob and vutf8
+ * values are hashed from the blob, not from their ondisk descriptor. */
+static uint32_t partition_hash(struct field *f, struct javasp_rec *rec)
+{
+    const uint8_t *fld = (const uint8_t *)rec->ondisk_dta + f->offset;
+    int len;
+
+    if (stype_is_null(fld))
+        return 0;
+    switch (f->type) {
+    case SERVER_BLOB:
+    case SERVER_BLOB2:
+    case SERVER_VUTF8:
+        if (rec->blobs[f->blob_index].bloblen)
+            return crc32c((uint8_t *)rec->blobs[f->blob_index].blobdta, rec->blobs[f->blob_index].bloblen);
+        if (f->type == SERVER_BLOB)
+            return 0;
+        /* zero-length or fits in the inline portion */
+        memcpy(&len, fld + 1, sizeof(int));
+        len = ntohl(len);
+        return crc32c((uint8_t *)fld + 1 + sizeof(int), len);
+    default:
+        return crc32c((uint8_t *)fld, f->len);
+    }
+}
+
 /* This is the actual "stored procedure" call. */
 static int sp_trigger_run(struct javasp_trans_state *javasp_trans_handle,
                           struct stored_proc *p, struct sp_table *t, int event,
@@ -789,6 +818,7 @@ static int sp_trigger_run(struct javasp_trans_state *javasp_trans_handle,
     int i;
     struct sp_field *fld;
     struct dbtable *usedb;
+    int partition = -1;
 
     /* TODO: can cache most of this information, don't allocate 2 buffers per
        record, don't
@@ -803,6 +833,18 @@ static int sp_trigger_run(struct javasp_trans_state *javasp_trans_handle,
         goto done;
     }
 
+    if (p->npartitions) {
+        struct javasp_rec *rec = newrec ? newrec : oldrec;
+        partition = 0;
+        for (i = 0; i < s->nmembers; i++) {
+            f = &s->member[i];
+            if (strcasecmp(p->partfield, f->name) == 0) {
+                partition = partition_hash(f, rec) % p->npartitions;
+                break;
+            }
+        }
+    }
+
     append_header(&bytes, t->name, event);
     /* TODO: again, this can be much better */
     LISTC_FOR_EACH(&t->fields, fld, lnk)
@@ -867,8 +909,8 @@ static int sp_trigger_run(struct javasp_trans_state *javasp_trans_handle,
     /* post it to queue */
     usedb = javasp_trans_handle->iq->usedb;
     javasp_trans_handle->iq->usedb = getqueuebyname(p->qname);
-    rc = dbq_add(javasp_trans_handle->iq, javasp_trans_handle->trans,
-                 bytes.bytes, bytes.used);
+    rc = dbq_add_partition(javasp_trans_handle->iq, javasp_trans_handle->trans,
+                           partition, bytes.bytes, bytes.used);
     javasp_trans_handle->iq->usedb = usedb;
 
 done:
@@ -1080,6 +1122,7 @@ int javasp_unload_procedure_int(const char *name)
             free(sp->name);
             free(sp->param);
             free(sp->qname);
+            free(sp->partfield);
 
             t = listc_rtl(&sp->tables);
             while (t) {
@@ -1234,6 +1277,8 @@ int javasp_load_procedure_int(const char *name, const char *param,
     if (!p->param) goto oom;
 
     listc_init(&p->tables, offsetof(struct sp_table, lnk));
+    p->npartitions = 0;
+    p->partfield = NULL;
 
     if (param) {
         paramcpy = strdup(param);
@@ -1316,6 +1361,21 @@ int javasp_load_procedure_int(const char *name, const char *param,
                 }
                 p->qname = strdup(queue);
             }
+        } else if (strcasecmp(s, "partition") == 0) {
+            char *count = strtok_r(NULL, toksep, &endp);
+            char *fieldname = strtok_r(NULL, toksep, &endp);
+            if (count == NULL || fieldname == NULL) {
+                logmsg(LOGMSG_ERROR, "partition takes a count and a field name\n");
+                rc = -1;
+                goto done;
+            }
+            p->npartitions = atoi(count);
+            if (p->npartitions < 2 || p->npartitions > MAXCONSUMERS) {
+                logmsg(LOGMSG_ERROR, "bad partition count %s\n", count);
+                rc = -1;
+                goto done;
+            }
+            p->partfield = strdup(fieldname);
         } else if (strcasecmp(s, "table") == 0) {
             char *tablename;
 
@@ -1425,6 +1485,11 @@ int javasp_load_procedure_int(const char *name, const char *param,
             goto done;
         }
     }
+    if (p->npartitions) {
+        struct dbtable *qdb = getqueuebyname(p->qname);
+        if (qdb)
+            qdb->queue_partitions = p->npartitions;
+    }
     listc_abl(&stored_procs, p);
 
 done:
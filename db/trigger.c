@@ -304,17 +304,23 @@ int trigger_stat()
         }
         const char *type = ctype == CONSUMER_TYPE_LUA ? "trigger" : "consumer";
         char *spname = SP4Q(qdb->tablename);
-        trigger_info_t *info =
-            trigger_hash ? hash_find(trigger_hash, spname) : NULL;
-        if (info) {
-            logmsg(LOGMSG_USER,
-                   "%s: %8s:%s ASSIGNED to node:%s cookie:%016" PRIx64
-                   " last heartbeat: %.0fs\n",
-                   __func__, type, info->spname, info->host,
-                   info->trigger_cookie, difftime(now, info->hbeat));
-        } else {
-            logmsg(LOGMSG_USER, "%s: %8s:%s UNASSIGNED\n", __func__, type,
-                   spname);
+        int npartitions = qdb->queue_partitions ? qdb->queue_partitions : 1;
+        for (int p = 0; p < npartitions; ++p) {
+            trigger_info_t *info = NULL;
+            if (trigger_hash)
+                info = qdb->queue_partitions ? trigger_find_partition(spname, p) : hash_find(trigger_hash, spname);
+            if (info) {
+                logmsg(LOGMSG_USER,
+                       "%s: %8s:%s ASSIGNED to node:%s cookie:%016" PRIx64
+                       " last heartbeat: %.0fs\n",
+                       __func__, type, info->spname, info->host,
+                       info->trigger_cookie, difftime(now, info->hbeat));
+            } else if (qdb->queue_partitions) {
+                logmsg(LOGMSG_USER, "%s: %8s:%s/%d UNASSIGNED\n", __func__, type, spname, p);
+            } else {
+                logmsg(LOGMSG_USER, "%s: %8s:%s UNASSIGNED\n", __func__, type,
+                       spname);
+            }
         }
         consumer_unlock(qdb);
     }
@@ -322,18 +328,32 @@ int trigger_stat()
     return 0;
 }
 
+/* Each partition of a partitioned queue registers as "<sp>/<partition>" */
+static trigger_info_t *trigger_find_partition(const char *spname, int partition)
+{
+    char name[MAX_SPNAME + 16];
+    snprintf(name, sizeof(name), "%s/%d", spname, partition);
+    return hash_find(trigger_hash, name);
+}
+
 static int trigger_registered_int(const char *spname)
 {
     trigger_info_t *info;
     if (!trigger_hash) {
         return 0;
     }
+    time_t now = time(NULL);
     if ((info = hash_find(trigger_hash, spname)) != NULL) {
-        time_t diff = time(NULL) - info->hbeat;
+        time_t diff = now - info->hbeat;
         if (diff < gbl_queuedb_timeout_sec) {
             return 1;
         }
     }
+    for (int i = 0; i < MAXCONSUMERS; ++i) {
+        if ((info = trigger_find_partition(spname, i)) != NULL && now - info->hbeat < gbl_queuedb_timeout_sec) {
+            return 1;
+        }
+    }
     return 0;
 }
 
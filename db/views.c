@@ -47,6 +47,7 @@ extern int gbl_is_physical_replicant;
 int gbl_partitioned_table_enabled = 1;
 int gbl_merge_table_enabled = 1;
 int gbl_retro_tpt = 1;
+int gbl_timepart_prune_shards = 1;
 int gbl_legacy_tpt = 1;
 int gbl_retro_tpt_verbose = 0;
 int gbl_retro_tpt_start = 24; /* default 24 hours in the future */
@@ -972,6 +973,19 @@ void *_view_cron_phase1(struct cron_event *event, struct errstat *err)
             goto done;
         }
 
+        /* a period change requeued phase 1 for a different rollout time;
+           the old event can be due before or after the new one */
+        if (IS_TIMEPARTITION(view->period) &&
+            event->epoch != view->roll_time - _get_preemptive_rolltime(view)) {
+            print_dbg_verbose(view->name, &view->source_id, "TTT",
+                              "Dropping obsolete phase1 at %d, rollout %d\n",
+                              event->epoch, view->roll_time);
+            rc = VIEW_ERR_GENERIC;
+            errstat_set_rc(err, rc);
+            errstat_set_strf(err, "obsolete rollout event");
+            goto done;
+        }
+
         if (view->nshards > view->retention) {
             errstat_set_strf(err, "view %s already rolled, missing purge?",
                              view->name);
@@ -2701,6 +2715,109 @@ done:
     return rc;
 }
 
+/**
+ * Update the period of the existing partition
+ * Existing shards keep their data and time limits; the newest shard is
+ * closed at the boundary computed with the new period, or at the next
+ * possible rollout if that boundary has passed, and every shard rolled in
+ * after that covers the new period.  No rows are copied.
+ * NOTE: this is called from bpfunc on master, and we already
+ * have the views lock
+ */
+int timepart_update_period(void *tran, const char *name,
+                           enum view_partition_period period,
+                           struct errstat *err)
+{
+    timepart_views_t *views = thedb->timepart_views;
+    timepart_view_t *view;
+    enum view_partition_period old_period;
+    int old_roll_time;
+    int roll_time;
+    int now;
+    char *tmp_str;
+    int rc = VIEW_NOERR;
+
+    view = _get_view(views, name);
+    if (!view) {
+        errstat_set_strf(err, "Partition %s doesn't exists!", name);
+        errstat_set_rc(err, rc = VIEW_ERR_EXIST);
+        goto done;
+    }
+
+    if (!IS_TIMEPARTITION(view->period) || !IS_TIMEPARTITION(period) ||
+        view->rolltype == TIMEPART_ROLLOUT_TRUNCATE) {
+        errstat_set_strf(err, "Partition %s period cannot be changed to %s",
+                         name, period_to_name(period));
+        errstat_set_rc(err, rc = VIEW_ERR_UNIMPLEMENTED);
+        goto done;
+    }
+
+    if (view->period == period)
+        goto done;
+
+    /* phase 1 might have already created the next shard with the old
+       period limits; let the rollout finish first */
+    if (comdb2_time_epoch() >=
+        view->roll_time - _get_preemptive_rolltime(view)) {
+        errstat_set_strf(
+            err, "Partition %s is rolling out, retry the period change later",
+            name);
+        errstat_set_rc(err, rc = VIEW_ERR_PARAM);
+        goto done;
+    }
+
+    /* rebase the next rollout on the newest split; for a single shard, the
+       start time is still the first split */
+    roll_time = _view_get_next_rollout(period, view->retention,
+                                       view->starttime, view->shards[0].low,
+                                       view->nshards, 0);
+    if (roll_time == INT_MAX) {
+        errstat_set_strf(err, "Failed to compute next rollout time");
+        errstat_set_rc(err, rc = VIEW_ERR_BUG);
+        goto done;
+    }
+
+    /* a shorter period can put the boundary in the past; rolling out to
+       catch up would evict live shards, since retention counts shards, so
+       close the newest shard at the next rollout we can still schedule */
+    now = comdb2_time_epoch();
+    if (roll_time < now + _get_preemptive_rolltime(view))
+        roll_time = now + _get_preemptive_rolltime(view);
+
+    old_period = view->period;
+    old_roll_time = view->roll_time;
+    view->period = period;
+    view->roll_time = roll_time;
+
+    rc = partition_llmeta_write(tran, view, 1, err);
+    if (rc != VIEW_NOERR) {
+        view->period = old_period;
+        view->roll_time = old_roll_time;
+        goto done;
+    }
+
+    logmsg(LOGMSG_INFO, "Partition %s period %s -> %s, next rollout %d\n",
+           name, period_to_name(old_period), period_to_name(period),
+           roll_time);
+
+    /* the phase 1 already queued for the old rollout time is obsolete and
+       will be dropped when it fires, see _view_cron_phase1 */
+    rc = (cron_add_event(_get_sched_byname(view->period, view->name), NULL,
+                         view->roll_time - _get_preemptive_rolltime(view),
+                         _view_cron_phase1, tmp_str = strdup(view->name), NULL,
+                         NULL, NULL, &view->source_id, err, NULL) == NULL)
+             ? err->errval
+             : VIEW_NOERR;
+    if (rc != VIEW_NOERR) {
+        logmsg(LOGMSG_ERROR, "%s: failed rc=%d errstr=%s\n", __func__,
+               err->errval, err->errstr);
+        free(tmp_str);
+    }
+
+done:
+    return rc;
+}
+
 /**
  * Locking the views subsystem, needed for ordering locks with schema
  *
@@ -2854,6 +2971,76 @@ const char *timepart_is_next_shard(const char *shardname,
     return ret_name;
 }
 
+static pthread_mutex_t shard_limit_lk = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Oldest (or newest) row timestamp in the shard of a time partition,
+ * read from the edges of the data stripes.  Updates assign new genids,
+ * so this is data driven rather than based on the shard time limits.
+ * A table that is not a shard, or a read error, returns an open limit;
+ * an empty shard returns an empty range.
+ *
+ * The limit is cached in the shard until the next commit; the oldest row
+ * of a non-empty shard only gets newer, so that one is kept across
+ * commits.  A client whose transaction wrote the shard, or which reads
+ * a snapshot, gets an open limit: neither sees the committed data alone.
+ *
+ */
+int timepart_shard_timelimit(const char *shardname, int newest)
+{
+    struct sql_thread *thd = pthread_getspecific(query_info_key);
+    struct sqlclntstate *clnt = thd ? thd->clnt : NULL;
+    int open = newest ? INT_MAX : INT_MIN;
+    struct dbtable *db;
+    unsigned long long genid;
+    unsigned long long ctx;
+    int limit = newest ? INT_MIN : INT_MAX;
+    int bdberr;
+    int rc;
+    int ts;
+
+    db = get_dbtable_by_name(shardname);
+    if (!db || !db->timepartition_name)
+        return open;
+
+    if (clnt && (clnt->dbtran.mode == TRANLEVEL_SNAPISOL ||
+                 clnt->dbtran.mode == TRANLEVEL_SERIAL ||
+                 osql_get_shadow_bydb(clnt, db)))
+        return open;
+
+    newest = !!newest;
+    ctx = bdb_get_commit_genid(thedb->bdb_env, NULL);
+    Pthread_mutex_lock(&shard_limit_lk);
+    if (db->shard_limit_valid[newest] &&
+        (db->shard_limit_ctx[newest] == ctx ||
+         (!newest && db->shard_limit[newest] != INT_MAX))) {
+        limit = db->shard_limit[newest];
+        Pthread_mutex_unlock(&shard_limit_lk);
+        return limit;
+    }
+    Pthread_mutex_unlock(&shard_limit_lk);
+
+    for (int stripe = 0; stripe < gbl_dtastripe; stripe++) {
+        rc = bdb_find_edge_genid(db->handle, NULL, newest, stripe, &genid,
+                                 &bdberr);
+        if (rc == 1)
+            continue; /* empty stripe */
+        if (rc)
+            return open; /* not cached */
+        ts = bdb_genid_timestamp(genid);
+        if (newest ? (ts > limit) : (ts < limit))
+            limit = ts;
+    }
+
+    Pthread_mutex_lock(&shard_limit_lk);
+    db->shard_limit[newest] = limit;
+    db->shard_limit_ctx[newest] = ctx;
+    db->shard_limit_valid[newest] = 1;
+    Pthread_mutex_unlock(&shard_limit_lk);
+
+    return limit;
+}
+
 static void _failed_new_view(timepart_view_t **view, const char *errs, int rc,
                              struct errstat *err, const char *func, int line)
 {
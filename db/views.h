@@ -340,6 +340,15 @@ int views_cron_restart(timepart_views_t *views);
  */
 int timepart_update_retention(void *tran, const char *name, int value, struct errstat *err);
 
+/**
+ * Update the period of the existing partition; existing shards are kept,
+ * the next rollout is rebased using the new period
+ *
+ */
+int timepart_update_period(void *tran, const char *name,
+                           enum view_partition_period period,
+                           struct errstat *err);
+
 /**
  * Locking the views subsystem, needed for ordering locks with schema
  *
@@ -409,6 +418,13 @@ int timepart_is_partition(const char *name);
 const char *timepart_is_next_shard(const char *shardname,
                                    unsigned long long *version);
 
+/**
+ * Oldest (newest != 0) or newest row timestamp stored in a shard;
+ * INT_MIN/INT_MAX if unknown
+ *
+ */
+int timepart_shard_timelimit(const char *shardname, int newest);
+
 /**
  * Create a view object with the specified parameters
  * Called also internally when loading from llmeta
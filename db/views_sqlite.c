@@ -20,6 +20,7 @@ static int _views_destroy_triggers(const char *view_name, sqlite3 *db,
                                    struct errstat *err);
 
 static void dbg_verbose_sqlite(const char *fmt, ...);
+extern int comdb2genidcontainstime(void);
 #include "views_updates.c"
 #include "logmsg.h"
 
@@ -191,7 +192,14 @@ static char *_views_create_view_query(timepart_view_t *view, sqlite3 *db,
     }
     table0name = view->shards[0].tblname;
 
-    cols_str = sqlite3_mprintf("rowid as __hidden__rowid, ");
+    /* the row timestamp lets queries filter, and timepart_prune_shard_arm
+       prune shards, on the insert time of the rows; see
+       sqlite3IsComdb2ViewRowTimestamp */
+    cols_str = sqlite3_mprintf("rowid as __hidden__rowid, %s",
+                               comdb2genidcontainstime()
+                                   ? "comdb2_rowtimestamp as "
+                                     "__hidden__rowtimestamp, "
+                                   : "");
     if (!cols_str) {
         goto malloc;
     }
@@ -247,6 +255,158 @@ malloc:
     return NULL;
 }
 
+static int _is_shard_rowtimestamp(Expr *pExpr, int iCursor)
+{
+    return pExpr->op == TK_COLUMN && pExpr->iColumn == -3 &&
+           pExpr->iTable == iCursor;
+}
+
+static int _row_independent_cb(Walker *pWalker, Expr *pExpr)
+{
+    switch (pExpr->op) {
+    case TK_COLUMN:
+    case TK_AGG_COLUMN:
+    case TK_AGG_FUNCTION:
+    case TK_REGISTER:
+        pWalker->eCode = 0;
+        return WRC_Abort;
+    }
+    return WRC_Continue;
+}
+
+static int _is_row_independent(Expr *pExpr)
+{
+    Walker w;
+
+    memset(&w, 0, sizeof(w));
+    w.eCode = 1;
+    w.xExprCallback = _row_independent_cb;
+    w.xSelectCallback = sqlite3SelectWalkFail;
+    sqlite3WalkExpr(&w, pExpr);
+
+    return w.eCode;
+}
+
+/**
+ * "comdb2_shard_timelimit(shard, newest) >= bound" for the newest row,
+ * "<= bound" for the oldest one; the bound is compared as epoch seconds
+ *
+ */
+static Expr *_shard_guard(Parse *pParse, const char *shard, int newest,
+                          Expr *bound)
+{
+    sqlite3 *db = pParse->db;
+    Token fn = {"comdb2_shard_timelimit", 22};
+    Token dt = {"DATETIME", 8};
+    Token in = {"INT", 3};
+    ExprList *args;
+    Expr *limit, *cast, *ts;
+
+    args = sqlite3ExprListAppend(pParse, NULL,
+                                 sqlite3Expr(db, TK_STRING, shard));
+    args = sqlite3ExprListAppend(pParse, args,
+                                 sqlite3Expr(db, TK_INTEGER, newest ? "1" : "0"));
+    limit = sqlite3ExprFunction(pParse, args, &fn, 0);
+    /* constant, so it is checked once before the shard is opened */
+    if (limit)
+        ExprSetProperty(limit, EP_ConstFunc);
+
+    cast = sqlite3ExprAlloc(db, TK_CAST, &dt, 1);
+    sqlite3ExprAttachSubtrees(db, cast, sqlite3ExprDup(db, bound, 0), 0);
+    ts = sqlite3ExprAlloc(db, TK_CAST, &in, 1);
+    sqlite3ExprAttachSubtrees(db, ts, cast, 0);
+
+    return sqlite3PExpr(pParse, newest ? TK_GE : TK_LE, limit, ts);
+}
+
+/**
+ * Guards for each comdb2_rowtimestamp bound in a where clause
+ *
+ */
+static Expr *_shard_prune_guards(Parse *pParse, Expr *pExpr, SrcList *pSrc)
+{
+    const char *shard = pSrc->a[0].zName;
+    int iCursor = pSrc->a[0].iCursor;
+    sqlite3 *db = pParse->db;
+    Expr *guards = NULL;
+    Expr *bound;
+    int op;
+
+    op = pExpr->op;
+    switch (op) {
+    case TK_AND:
+        guards = _shard_prune_guards(pParse, pExpr->pLeft, pSrc);
+        return sqlite3ExprAnd(db, guards,
+                              _shard_prune_guards(pParse, pExpr->pRight, pSrc));
+    case TK_GT:
+    case TK_GE:
+    case TK_LT:
+    case TK_LE:
+    case TK_EQ:
+        if (_is_shard_rowtimestamp(pExpr->pLeft, iCursor)) {
+            bound = pExpr->pRight;
+        } else if (_is_shard_rowtimestamp(pExpr->pRight, iCursor)) {
+            bound = pExpr->pLeft;
+            /* "bound op ts" is "ts mirror(op) bound" */
+            if (op == TK_GT)
+                op = TK_LT;
+            else if (op == TK_GE)
+                op = TK_LE;
+            else if (op == TK_LT)
+                op = TK_GT;
+            else if (op == TK_LE)
+                op = TK_GE;
+        } else {
+            return NULL;
+        }
+        if (!_is_row_independent(bound))
+            return NULL;
+        /* rows newer than bound need a newest row past the bound */
+        if (op != TK_LT && op != TK_LE)
+            guards = _shard_guard(pParse, shard, 1, bound);
+        if (op != TK_GT && op != TK_GE)
+            guards = sqlite3ExprAnd(db, guards,
+                                    _shard_guard(pParse, shard, 0, bound));
+        return guards;
+    case TK_BETWEEN:
+        if (!_is_shard_rowtimestamp(pExpr->pLeft, iCursor) ||
+            !_is_row_independent(pExpr->x.pList->a[0].pExpr) ||
+            !_is_row_independent(pExpr->x.pList->a[1].pExpr))
+            return NULL;
+        return sqlite3ExprAnd(
+            db, _shard_guard(pParse, shard, 1, pExpr->x.pList->a[0].pExpr),
+            _shard_guard(pParse, shard, 0, pExpr->x.pList->a[1].pExpr));
+    }
+
+    return NULL;
+}
+
+/**
+ * A select reading one shard of a time partition, typically an arm of the
+ * partition's UNION ALL view once the query's where clause was pushed into
+ * it, gets a guard for each comdb2_rowtimestamp bound, comparing the bound
+ * with the oldest or newest row of the shard.  The guards do not depend on
+ * the rows, so sqlite checks them before opening the shard and skips it if
+ * it cannot match, whether or not dohsql runs the arms.
+ *
+ */
+void timepart_prune_shard_arm(Parse *pParse, Select *p)
+{
+    struct dbtable *db;
+    Expr *guards;
+
+    if (!gbl_timepart_prune_shards || !p->pWhere || p->pSrc->nSrc != 1 ||
+        !p->pSrc->a[0].zName || p->pSrc->a[0].zDatabase)
+        return;
+    db = get_dbtable_by_name(p->pSrc->a[0].zName);
+    if (!db || !db->timepartition_name)
+        return;
+
+    guards = _shard_prune_guards(pParse, p->pWhere, p->pSrc);
+    if (guards)
+        p->pWhere = sqlite3ExprAnd(pParse->db, guards, p->pWhere);
+}
+
 static char *_views_destroy_view_query(const char *view_name, sqlite3 *db,
                                        struct errstat *err)
 {
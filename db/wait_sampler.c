@@ -0,0 +1,194 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/*
+ * Wait event sampler. Every wait_event_sample_ms a background thread looks at
+ * what each busy request thread is waiting on (wait_events.h) and bumps a
+ * counter keyed by the thread's current query fingerprint. Counters live in a
+ * ring of fixed-length time windows so comdb2_wait_events can show where the
+ * time went over the last hour, not just right now.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <poll.h>
+
+#include "comdb2.h"
+#include "thrman.h"
+#include "thread_util.h"
+#include "wait_events.h"
+#include "wait_sampler.h"
+#include "compile_time_assert.h"
+#include "logmsg.h"
+
+BB_COMPILE_TIME_ASSERT(wait_event_fpsz, WAIT_EVENT_FPSZ == FINGERPRINTSZ);
+
+#define WAIT_SAMPLER_NWINDOWS 60
+
+int gbl_wait_event_sample_ms = 100;
+int gbl_wait_event_window_secs = 60;
+
+struct wait_sample_key {
+    unsigned char fingerprint[FINGERPRINTSZ];
+    int thrtype;
+    int event;
+};
+
+struct wait_sample {
+    struct wait_sample_key key; /* must be first */
+    int64_t samples;
+    int64_t wait_ms;
+};
+
+struct wait_window {
+    int64_t start;
+    hash_t *samples;
+};
+
+static pthread_mutex_t wait_lk = PTHREAD_MUTEX_INITIALIZER;
+static struct wait_window windows[WAIT_SAMPLER_NWINDOWS];
+static int cur_window = -1;
+
+static int free_wait_sample(void *obj, void *arg)
+{
+    free(obj);
+    return 0;
+}
+
+/* Called with wait_lk held */
+static struct wait_window *current_window(int64_t now)
+{
+    struct wait_window *w = cur_window >= 0 ? &windows[cur_window] : NULL;
+    int secs = gbl_wait_event_window_secs > 0 ? gbl_wait_event_window_secs : 60;
+    if (w && now < w->start + secs)
+        return w;
+
+    cur_window = (cur_window + 1) % WAIT_SAMPLER_NWINDOWS;
+    w = &windows[cur_window];
+    if (w->samples == NULL) {
+        w->samples = hash_init(sizeof(struct wait_sample_key));
+    } else {
+        hash_for(w->samples, free_wait_sample, NULL);
+        hash_clear(w->samples);
+    }
+    w->start = now - now % secs;
+    return w;
+}
+
+struct sample_arg {
+    struct wait_window *w;
+    int sample_ms;
+};
+
+static void sample_thread(enum thrtype type, const struct wait_state *ws, void *varg)
+{
+    struct sample_arg *arg = varg;
+    struct wait_sample_key key = {{0}};
+    struct wait_sample *s;
+
+    memcpy(key.fingerprint, ws->fingerprint, FINGERPRINTSZ);
+    key.thrtype = type;
+    key.event = ws->event;
+    if (key.event < 0 || key.event >= WAIT_EVENT_MAX)
+        return;
+
+    if ((s = hash_find(arg->w->samples, &key)) == NULL) {
+        if ((s = calloc(1, sizeof(struct wait_sample))) == NULL)
+            return;
+        s->key = key;
+        hash_add(arg->w->samples, s);
+    }
+    ++s->samples;
+    s->wait_ms += arg->sample_ms;
+}
+
+static void *wait_sampler_thd(void *unused)
+{
+    comdb2_name_thread(__func__);
+    thrman_register(THRTYPE_GENERIC);
+    thread_started("wait sampler");
+
+    while (!db_is_exiting()) {
+        int sample_ms = gbl_wait_event_sample_ms;
+        if (sample_ms <= 0) {
+            sleep(1);
+            continue;
+        }
+        poll(NULL, 0, sample_ms);
+
+        Pthread_mutex_lock(&wait_lk);
+        struct sample_arg arg = {.w = current_window(comdb2_time_epoch()), .sample_ms = sample_ms};
+        if (arg.w->samples)
+            thrman_foreach_active(sample_thread, &arg);
+        Pthread_mutex_unlock(&wait_lk);
+    }
+    return NULL;
+}
+
+void create_wait_sampler_thread(void)
+{
+    pthread_t tid;
+    Pthread_create(&tid, &gbl_pthread_attr_detached, wait_sampler_thd, NULL);
+}
+
+struct collect_arg {
+    struct wait_sample_row *rows;
+    int nrows;
+    int64_t start;
+};
+
+static int collect_sample(void *obj, void *varg)
+{
+    struct wait_sample *s = obj;
+    struct collect_arg *arg = varg;
+    struct wait_sample_row *r = &arg->rows[arg->nrows++];
+    r->window_start = arg->start;
+    memcpy(r->fingerprint, s->key.fingerprint, FINGERPRINTSZ);
+    r->thrtype = s->key.thrtype;
+    r->event = s->key.event;
+    r->samples = s->samples;
+    r->wait_ms = s->wait_ms;
+    return 0;
+}
+
+int wait_sampler_collect(struct wait_sample_row **rows, int *nrows)
+{
+    struct collect_arg arg = {0};
+    int total = 0;
+
+    Pthread_mutex_lock(&wait_lk);
+    for (int i = 0; i < WAIT_SAMPLER_NWINDOWS; ++i) {
+        if (windows[i].samples)
+            total += hash_get_num_entries(windows[i].samples);
+    }
+    if (total > 0 && (arg.rows = malloc(total * sizeof(struct wait_sample_row))) == NULL) {
+        Pthread_mutex_unlock(&wait_lk);
+        return -1;
+    }
+    for (int i = 0; i < WAIT_SAMPLER_NWINDOWS; ++i) {
+        if (windows[i].samples == NULL)
+            continue;
+        arg.start = windows[i].start;
+        hash_for(windows[i].samples, collect_sample, &arg);
+    }
+    Pthread_mutex_unlock(&wait_lk);
+
+    *rows = arg.rows;
+    *nrows = arg.nrows;
+    return 0;
+}
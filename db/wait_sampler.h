@@ -0,0 +1,41 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#ifndef INCLUDED_WAIT_SAMPLER_H
+#define INCLUDED_WAIT_SAMPLER_H
+
+#include <stdint.h>
+#include "fingerprint.h"
+
+/* One (window, fingerprint, thread type, wait event) bucket */
+struct wait_sample_row {
+    int64_t window_start; /* epoch seconds */
+    unsigned char fingerprint[FINGERPRINTSZ];
+    int thrtype;
+    int event;
+    int64_t samples;
+    int64_t wait_ms; /* samples weighted by the sampling interval */
+};
+
+extern int gbl_wait_event_sample_ms;
+extern int gbl_wait_event_window_secs;
+
+void create_wait_sampler_thread(void);
+
+/* Copy out every retained bucket; free *rows when done */
+int wait_sampler_collect(struct wait_sample_row **rows, int *nrows);
+
+#endif
@@ -161,6 +161,10 @@ struct dbconsumer_t {
     int emit_timeoutms;
     time_t registration_time;
     const char *type;
+    int partition; /* consumer slot of a partitioned queue; -1 if not */
+    genid_t *batch; /* events handed out by get_batch(), not yet consumed */
+    int nbatch;
+    int batchsz;
 
     /* signaling from libdb on qdb insert */
     pthread_mutex_t *lock;
@@ -671,7 +675,7 @@ static int dbq_poll_int(Lua L, dbconsumer_t *q)
     SP sp = getsp(L);
     struct sqlclntstate *clnt = sp->clnt;
     struct qfound f = {0};
-    int rc = dbq_get(&q->iq, 0, &q->last, &f.item, NULL, NULL, &q->fnd, &f.seq,
+    int rc = dbq_get(&q->iq, q->partition < 0 ? 0 : q->partition, &q->last, &f.item, NULL, NULL, &q->fnd, &f.seq,
                      bdb_get_lid_from_cursortran(clnt->dbtran.cursor_tran));
     Pthread_mutex_unlock(q->lock);
     if (debug_switch_test_trigger_deadlock()) {
@@ -798,6 +802,14 @@ static void dbconsumer_getargs(Lua L, dbconsumer_t *consumer)
                 if (timeoutms > 0) {
                     consumer->register_timeoutms = timeoutms;
                 }
+            } else if (strcasecmp(key, "partition") == 0) {
+                long long partition = -1;
+                luabb_tointeger(L, -1, &partition);
+                if (partition < 0 || partition >= MAXCONSUMERS) {
+                    luaL_error(L, "bad argument for 'partition'");
+                    return;
+                }
+                consumer->partition = partition;
             }
         }
         lua_pop(L, 1);
@@ -854,6 +866,7 @@ static void reset_consumer_cursor(SP sp)
     if (!q) return;
     sp->clnt->osql_max_trans = q->osql_max_trans;
     q->genid = 0;
+    q->nbatch = 0;
     memset(&q->fnd, 0, sizeof(q->fnd));
     memset(&q->last, 0, sizeof(q->last));
 }
@@ -893,7 +906,7 @@ static int dbconsumer_consume(Lua L)
                        __func__, clnt->intrans, err, rc);
         }
     }
-    if ((rc = osql_dbq_consume_logic(clnt, q->info.spname, q->genid)) != 0) {
+    if ((rc = osql_dbq_consume_logic(clnt, sp->spname, q->genid)) != 0) {
         if (implicit_txn) {
             err = db_rollback_int(L, &rc);
             if (err || rc || clnt->intrans) {
@@ -939,7 +952,7 @@ static int dbconsumer_next(Lua L)
             luaL_error(L, "%s osql_sock_start rc:%d", __func__, rc);
         }
     }
-    Q4SP(qname, q->info.spname);
+    Q4SP(qname, sp->spname);
     ++clnt->osql_max_trans;
     rc = osql_delrec_qdb(clnt, qname, q->genid);
     if (rc) {
@@ -953,6 +966,104 @@ static int dbconsumer_next(Lua L)
     return push_and_return(L, 0);
 }
 
+/*
+** Returns a Lua array of up to n events following any already handed out by
+** get_batch(). Blocks for the first event only.
+*/
+static int dbconsumer_get_batch(Lua L)
+{
+    dbconsumer_t *q = luaL_checkudata(L, 1, dbtypes.dbconsumer);
+    lua_Number arg = luaL_checknumber(L, 2);
+    lua_Integer n;
+    lua_number2integer(n, arg);
+    if (n <= 0) {
+        return luaL_error(L, "bad argument for 'get_batch'");
+    }
+    if (q->nbatch + n > q->batchsz) {
+        int sz = q->nbatch + n;
+        genid_t *batch = realloc(q->batch, sz * sizeof(genid_t));
+        if (batch == NULL) {
+            return luaL_error(L, "%s: out of memory for %d events", __func__, sz);
+        }
+        q->batch = batch;
+        q->batchsz = sz;
+    }
+    lua_createtable(L, n, 0);
+    int i = 0;
+    while (i < n) {
+        int rc = i ? dbq_poll(L, q, 0) : dbconsumer_get_int(L, q);
+        if (rc < 0) {
+            return luaL_error(L, getsp(L)->error);
+        }
+        if (rc == 0) {
+            break;
+        }
+        lua_rawseti(L, -2, ++i);
+        q->batch[q->nbatch++] = q->genid;
+        q->last = q->fnd;
+    }
+    return 1;
+}
+
+/*
+** Consumes every event returned by get_batch() since the last consume, in
+** one transaction. Like dbconsumer:consume(), joins an explicit transaction
+** if there is one, and commits its own otherwise.
+*/
+static int dbconsumer_consume_batch(Lua L)
+{
+    dbconsumer_t *q = luaL_checkudata(L, 1, dbtypes.dbconsumer);
+
+    if (q->nbatch == 0) {
+        return push_and_return(L, -1);
+    }
+
+    int rc = 0;
+    const char *err = NULL;
+    SP sp = getsp(L);
+    struct sqlclntstate *clnt = sp->clnt;
+    int implicit_txn = in_parent_trans(sp);
+    if (implicit_txn) {
+        err = db_begin_int(L, &rc);
+        if (err || rc || clnt->intrans) {
+            luaL_error(L, "%s: begin intrans:%d err:%s rc:%d\n", __func__, clnt->intrans, err, rc);
+        }
+    }
+    if (!clnt->intrans) {
+        if ((rc = start_new_transaction(clnt)) != 0) {
+            luaL_error(L, "%s: start_new_transaction intrans:%d rc:%d\n",
+                       __func__, clnt->intrans, rc);
+        }
+        if ((rc = osql_sock_start_no_reorder(clnt, OSQL_SOCK_REQ, 0, 0)) != 0) {
+            luaL_error(L, "%s: osql_sock_start rc:%d\n", __func__, rc);
+        }
+    }
+    if (clnt->osql_max_trans) {
+        clnt->osql_max_trans += q->nbatch;
+    }
+    if ((rc = osql_dbq_consume_batch_logic(clnt, sp->spname, q->partition < 0 ? 0 : q->partition,
+                                           q->batch, q->nbatch)) != 0) {
+        if (implicit_txn) {
+            err = db_rollback_int(L, &rc);
+            if (err || rc || clnt->intrans) {
+                luaL_error(L, "%s: rollback - unexpected intrans:%d err:%s rc:%d\n",
+                           __func__, clnt->intrans, err, rc);
+            }
+        }
+        luaL_error(L, "%s osql_dbq_consume_batch_logic rc:%d\n", __func__, rc);
+    }
+    q->nbatch = 0;
+    if (implicit_txn) {
+        err = db_commit_int(L, &rc);
+        if (err || rc || clnt->intrans) {
+            luaL_error(L, "%s: commit failed intrans:%d err:%s rc:%d\n",
+                       __func__, clnt->intrans, err, rc);
+        }
+        reset_consumer_cursor(sp);
+    }
+    return push_and_return(L, rc);
+}
+
 static int db_emit_int(Lua);
 static int dbconsumer_emit(Lua L)
 {
@@ -985,6 +1096,8 @@ static int dbconsumer_free(Lua L)
     ctrace("%s:%s %016" PRIx64 " unregister done\n", q->type, q->info.spname, q->info.trigger_cookie);
     SP sp = getsp(L);
     sp->clnt->osql_max_trans = q->osql_max_trans;
+    free(q->batch);
+    q->batch = NULL;
     return 0;
 }
 
@@ -1369,6 +1482,54 @@ static int disable_global_variables(lua_State *lua)
     return 0;
 }
 
+/*
+** Pooled vms are shared between connections, so remember the globals of a
+** fresh vm and put them back before the vm is parked.  rawset() and
+** setmetatable() get around disable_global_variables().
+*/
+static void save_sp_globals(Lua L)
+{
+    lua_newtable(L);
+    lua_pushnil(L);
+    while (lua_next(L, LUA_GLOBALSINDEX) != 0) {
+        lua_pushvalue(L, -2);
+        lua_insert(L, -2);
+        lua_rawset(L, -4);
+    }
+    lua_setfield(L, LUA_REGISTRYINDEX, "comdb2_sp_globals");
+}
+
+static void restore_sp_globals(Lua L)
+{
+    lua_settop(L, 0);
+    lua_getfield(L, LUA_REGISTRYINDEX, "comdb2_sp_globals");
+    lua_pushnil(L);
+    while (lua_next(L, LUA_GLOBALSINDEX) != 0) {
+        lua_pop(L, 1);
+        lua_pushvalue(L, -1);
+        lua_rawget(L, 1);
+        int saved = !lua_isnil(L, -1);
+        lua_pop(L, 1);
+        if (!saved) {
+            /* clearing the current key is allowed while traversing */
+            lua_pushvalue(L, -1);
+            lua_pushnil(L);
+            lua_rawset(L, LUA_GLOBALSINDEX);
+        }
+    }
+    lua_pushnil(L);
+    while (lua_next(L, 1) != 0) {
+        lua_pushvalue(L, -2);
+        lua_insert(L, -2);
+        lua_rawset(L, LUA_GLOBALSINDEX);
+    }
+    lua_settop(L, 0);
+    lua_pushliteral(L, "_SP");
+    lua_newtable(L);
+    lua_rawset(L, LUA_GLOBALSINDEX);
+    disable_global_variables(L);
+}
+
 /*
 ** This returns dbrow or nil on end of result set. There is no way to signal
 ** error. I'll throw runtime error -- seems appropriate, SQL encountered some
@@ -2175,7 +2336,7 @@ static void lua_end_step(struct sqlclntstate *clnt, SP sp,
             unsigned char fingerprint[FINGERPRINTSZ];
             struct string_ref *sql_ref = create_string_ref(sqlite3_sql(pStmt));
             add_fingerprint(clnt, pStmt, sql_ref, zNormSql, cost,
-                            timeMs, prepMs, pVdbe->luaRows, NULL, fingerprint, 1); // TODO: Make work for query plans
+                            timeMs, prepMs, pVdbe->luaRows, NULL, NULL, fingerprint, 1); // TODO: Make work for query plans
             put_ref(&sql_ref);
             if (clnt->rawnodestats) {
                 add_fingerprint_to_rawstats(clnt->rawnodestats, fingerprint, cost, pVdbe->luaRows, timeMs);
@@ -2981,10 +3142,153 @@ static int get_func_by_name(Lua L, const char *func, char **err)
     return 0;
 }
 
-static int process_src(Lua L, const char *src, char **err)
+/*
+** Compiled procedure chunks, shared by every vm. Keyed by the full source so
+** a hit is always the code that load_src returned; the whole cache is dropped
+** when procedure ddl bumps gbl_lua_version.
+*/
+struct sp_bytecode {
+    char *src;
+    char *code;
+    size_t len;
+};
+
+struct sp_dump {
+    char *buf;
+    size_t len;
+    size_t cap;
+};
+
+int gbl_lua_bytecode_cache_size = 256;
+int64_t gbl_lua_bytecode_hits;
+int64_t gbl_lua_bytecode_misses;
+
+static pthread_mutex_t sp_bytecode_lk = PTHREAD_MUTEX_INITIALIZER;
+static hash_t *sp_bytecode_hash;
+static int sp_bytecode_lua_version;
+
+static int free_sp_bytecode(void *obj, void *arg)
+{
+    struct sp_bytecode *bc = obj;
+    free(bc->src);
+    free(bc->code);
+    free(bc);
+    return 0;
+}
+
+static void clear_sp_bytecode_int(void)
+{
+    if (sp_bytecode_hash == NULL) return;
+    hash_for(sp_bytecode_hash, free_sp_bytecode, NULL);
+    hash_clear(sp_bytecode_hash);
+}
+
+static char *get_sp_bytecode(const char *src, size_t *len)
+{
+    char *code = NULL;
+    Pthread_mutex_lock(&sp_bytecode_lk);
+    if (sp_bytecode_lua_version != gbl_lua_version) {
+        clear_sp_bytecode_int();
+        sp_bytecode_lua_version = gbl_lua_version;
+    }
+    struct sp_bytecode *bc = NULL;
+    if (sp_bytecode_hash) bc = hash_find_readonly(sp_bytecode_hash, &src);
+    if (bc && (code = malloc(bc->len)) != NULL) {
+        memcpy(code, bc->code, bc->len);
+        *len = bc->len;
+    }
+    Pthread_mutex_unlock(&sp_bytecode_lk);
+    return code;
+}
+
+static void put_sp_bytecode(const char *src, int lua_version, struct sp_dump *d)
+{
+    struct sp_bytecode *bc = calloc(1, sizeof(struct sp_bytecode));
+    if (bc == NULL) return;
+    bc->src = strdup(src);
+    bc->code = d->buf;
+    bc->len = d->len;
+    d->buf = NULL;
+    Pthread_mutex_lock(&sp_bytecode_lk);
+    if (sp_bytecode_hash == NULL) {
+        sp_bytecode_hash = hash_init_strptr(offsetof(struct sp_bytecode, src));
+    }
+    if (sp_bytecode_lua_version != gbl_lua_version) {
+        clear_sp_bytecode_int();
+        sp_bytecode_lua_version = gbl_lua_version;
+    }
+    if (bc->src == NULL || sp_bytecode_hash == NULL ||
+        lua_version != gbl_lua_version ||
+        hash_find_readonly(sp_bytecode_hash, &src) != NULL) {
+        Pthread_mutex_unlock(&sp_bytecode_lk);
+        free_sp_bytecode(bc, NULL);
+        return;
+    }
+    if (hash_get_num_entries(sp_bytecode_hash) >= gbl_lua_bytecode_cache_size) {
+        clear_sp_bytecode_int();
+    }
+    hash_add(sp_bytecode_hash, bc);
+    Pthread_mutex_unlock(&sp_bytecode_lk);
+}
+
+static int sp_dump_writer(Lua L, const void *p, size_t sz, void *ud)
+{
+    struct sp_dump *d = ud;
+    if (d->len + sz > d->cap) {
+        size_t cap = (d->len + sz) * 2;
+        char *buf = realloc(d->buf, cap);
+        if (buf == NULL) return 1;
+        d->buf = buf;
+        d->cap = cap;
+    }
+    memcpy(d->buf + d->len, p, sz);
+    d->len += sz;
+    return 0;
+}
+
+/* Same as luaL_loadstring(L, src), but skips the parser when a compiled chunk
+ * for this source is cached. Chunks keep src as their name, so error
+ * messages are unchanged. */
+static int load_src_chunk(Lua L, const char *src)
 {
     int rc;
-    if ((rc = luaL_dostring(L, src)) != 0) {
+    size_t len;
+    int lua_version = gbl_lua_version;
+    if (gbl_lua_bytecode_cache_size <= 0) {
+        return luaL_loadstring(L, src);
+    }
+    char *code = get_sp_bytecode(src, &len);
+    if (code) {
+        ATOMIC_ADD64(gbl_lua_bytecode_hits, 1);
+        rc = luaL_loadbuffer(L, code, len, src);
+        free(code);
+    } else {
+        ATOMIC_ADD64(gbl_lua_bytecode_misses, 1);
+        rc = luaL_loadbuffer(L, src, strlen(src), src);
+        if (rc == 0) {
+            struct sp_dump d = {0};
+            if (lua_dump(L, sp_dump_writer, &d) == 0) {
+                put_sp_bytecode(src, lua_version, &d);
+            }
+            free(d.buf);
+        }
+    }
+    return rc;
+}
+
+static int compile_src(Lua L, const char *src, char **err)
+{
+    if (load_src_chunk(L, src) != 0) {
+        *err = strdup(lua_tostring(L, -1));
+        return -1;
+    }
+    return 0;
+}
+
+/* run the top-level chunk left on the stack by compile_src */
+static int run_src(Lua L, char **err)
+{
+    if (lua_pcall(L, 0, LUA_MULTRET, 0) != 0) {
         *err = strdup(lua_tostring(L, -1));
         return -1;
     }
@@ -2992,6 +3296,13 @@ static int process_src(Lua L, const char *src, char **err)
     return 0;
 }
 
+static int process_src(Lua L, const char *src, char **err)
+{
+    if (compile_src(L, src, err) != 0)
+        return -1;
+    return run_src(L, err);
+}
+
 static void drop_temp_tables(SP sp)
 {
     int expire = 0;
@@ -3079,11 +3390,8 @@ static void free_spversion(SP sp)
     sp->spversion.version_str = NULL;
 }
 
-// SP can't be used anymore
-static void close_sp_int(SP sp, int freesp)
+static void free_sp(SP sp)
 {
-    if (!sp) return;
-    reset_sp(sp);
     if (sp->lua) lua_close(sp->lua);
 #   ifdef PER_THREAD_MALLOC
     comdb2ma mspace = sp->mspace;
@@ -3095,6 +3403,85 @@ static void close_sp_int(SP sp, int freesp)
     free(sp);
 }
 
+// SP can't be used anymore
+static void close_sp_int(SP sp, int freesp)
+{
+    if (!sp) return;
+    reset_sp(sp);
+    free_sp(sp);
+}
+
+/*
+** Idle vms parked by closed connections. The next connection to run the same
+** procedure as the same user takes one instead of building a new lua state.
+** Newest first; the oldest is closed once the pool is over its size.
+*/
+struct sp_pooled {
+    SP sp;
+    char user[MAX_USERNAME_LEN];
+    TAILQ_ENTRY(sp_pooled) entries;
+};
+
+int gbl_lua_vm_pool_size = 0;
+int64_t gbl_lua_vm_pool_hits;
+int64_t gbl_lua_vm_pool_misses;
+int64_t gbl_lua_sp_setups;
+int64_t gbl_lua_sp_setup_us;
+
+static pthread_mutex_t sp_pool_lk = PTHREAD_MUTEX_INITIALIZER;
+static TAILQ_HEAD(sp_pool_head, sp_pooled) sp_pool = TAILQ_HEAD_INITIALIZER(sp_pool);
+static int sp_pool_count;
+
+static SP get_pooled_sp(const char *spname, const char *user)
+{
+    SP sp = NULL;
+    struct sp_pooled *p;
+    if (gbl_lua_vm_pool_size <= 0) return NULL;
+    Pthread_mutex_lock(&sp_pool_lk);
+    TAILQ_FOREACH(p, &sp_pool, entries) {
+        if (strcmp(p->sp->spname, spname) == 0 && strcmp(p->user, user) == 0) {
+            TAILQ_REMOVE(&sp_pool, p, entries);
+            --sp_pool_count;
+            sp = p->sp;
+            free(p);
+            break;
+        }
+    }
+    Pthread_mutex_unlock(&sp_pool_lk);
+    if (sp)
+        ATOMIC_ADD64(gbl_lua_vm_pool_hits, 1);
+    else
+        ATOMIC_ADD64(gbl_lua_vm_pool_misses, 1);
+    return sp;
+}
+
+static void put_pooled_sp(SP sp, const char *user)
+{
+    struct sp_pooled *p = malloc(sizeof(struct sp_pooled));
+    if (p == NULL) {
+        free_sp(sp);
+        return;
+    }
+    p->sp = sp;
+    strncpy0(p->user, user, sizeof(p->user));
+    TAILQ_HEAD(, sp_pooled) evicted = TAILQ_HEAD_INITIALIZER(evicted);
+    Pthread_mutex_lock(&sp_pool_lk);
+    TAILQ_INSERT_HEAD(&sp_pool, p, entries);
+    ++sp_pool_count;
+    while (sp_pool_count > gbl_lua_vm_pool_size) {
+        p = TAILQ_LAST(&sp_pool, sp_pool_head);
+        TAILQ_REMOVE(&sp_pool, p, entries);
+        --sp_pool_count;
+        TAILQ_INSERT_TAIL(&evicted, p, entries);
+    }
+    Pthread_mutex_unlock(&sp_pool_lk);
+    while ((p = TAILQ_FIRST(&evicted)) != NULL) {
+        TAILQ_REMOVE(&evicted, p, entries);
+        free_sp(p->sp);
+        free(p);
+    }
+}
+
 static void free_dbthread_type(dbthread_type *thd)
 {
     if (!thd) return;
@@ -4715,13 +5102,14 @@ static int register_queue_with_berkdb_and_master(Lua L, const char *type)
     }
 
     dbconsumer_t *consumer;
-    size_t sz = dbconsumer_sz(sp->spname);
+    size_t sz = dbconsumer_sz(sp->spname) + 3; /* room for "/<partition>" */
     new_lua_t_sz(L, consumer, DBTYPES_DBCONSUMER, sz);
 
     sp->consumer = consumer;
     consumer->type = type;
     consumer->emit_timeoutms = 60000; /* emit times-out after 1 min */
     consumer->osql_max_trans = clnt->osql_max_trans;
+    consumer->partition = -1;
 
     if (lua_gettop(L) == 2) {
         lua_insert(L, 1); /* move dbconsumer to bottom of stack */
@@ -4729,11 +5117,16 @@ static int register_queue_with_berkdb_and_master(Lua L, const char *type)
     }
 
     /* register with master */
+    /* each partition of a partitioned queue registers as its own consumer */
     trigger_reg_t *info = &consumer->info;
     info->elect_cookie = ATOMIC_LOAD32(gbl_master_changes);
     info->trigger_cookie = get_id(thedb->bdb_env);
-    info->spname_len = strlen(sp->spname);
-    memcpy(info->spname, sp->spname, info->spname_len + 1);
+    if (consumer->partition >= 0) {
+        info->spname_len = sprintf(info->spname, "%s/%d", sp->spname, consumer->partition);
+    } else {
+        info->spname_len = strlen(sp->spname);
+        memcpy(info->spname, sp->spname, info->spname_len + 1);
+    }
     int hostname_len = strlen(gbl_myhostname);
     memcpy(trigger_hostname(info), gbl_myhostname, hostname_len + 1);
     if (strcmp(type, "consumer") == 0) {
@@ -4756,6 +5149,14 @@ static int register_queue_with_berkdb_and_master(Lua L, const char *type)
 
     init_fake_ireq(thedb, &consumer->iq);
     consumer->iq.usedb = find_and_lock_queue_table(L);
+    int npartitions = consumer->iq.usedb->queue_partitions;
+    if (consumer->partition >= npartitions) {
+        return luaL_error(L, "%s:%s partition:%d out of range (queue has %d partitions)", type, sp->spname,
+                          consumer->partition, npartitions);
+    }
+    if (npartitions && consumer->partition < 0) {
+        return luaL_error(L, "%s:%s is partitioned; 'partition' required", type, sp->spname);
+    }
 
     /* register with berkdb */
     if (bdb_trigger_subscribe(consumer->iq.usedb->handle, &consumer->cond, &consumer->lock, &consumer->status, &consumer->hndl) != 0) {
@@ -5164,6 +5565,8 @@ static const struct luaL_Reg dbconsumer_funcs[] = {
     {"poll", dbconsumer_poll},
     {"consume", dbconsumer_consume},
     {"next", dbconsumer_next},
+    {"get_batch", dbconsumer_get_batch},
+    {"consume_batch", dbconsumer_consume_batch},
     {"emit", dbconsumer_emit},
     {"emit_timeout", dbconsumer_emit_timeout},
     {NULL, NULL}
@@ -5222,6 +5625,7 @@ static int create_sp_int(SP sp, char **err)
     }
 
     disable_global_variables(lua);
+    save_sp_globals(lua);
 
     /* To be given as lrl value. */
     lua_sethook(lua, InstructionCountHook, LUA_MASKCOUNT, 1);
@@ -6201,6 +6605,8 @@ static int setup_sp_int(char *spname, struct sqlthdstate *thd, struct sqlclntsta
             close_sp(clnt);
             sp = NULL;
         }
+    } else if (!clnt->want_stored_procedure_trace) {
+        sp = get_pooled_sp(spname, clnt->current_user.name);
     }
     if (sp && sp->lua) {
         // Have lua vm
@@ -7041,12 +7447,18 @@ static int exec_procedure_int(struct sqlthdstate *thd,
     if ((rc = get_spname(clnt, spname, &end_ptr, err)) != 0)
         return rc;
 
+    int64_t setup_start = comdb2_time_epochus();
     if ((rc = setup_sp_int(spname, thd, clnt, trigger, &new_vm, err)) != 0) return rc;
     SP sp = clnt->sp;
     Lua L = sp->lua;
     const char *main_func = trigger ? "comdb2_trigger_main" : "main";
 
-    if ((rc = process_src(L, sp->src, err)) != 0) return rc;
+    if ((rc = compile_src(L, sp->src, err)) != 0) return rc;
+    /* setup ends once the chunk is compiled; its top-level code is the
+     * procedure's own work */
+    ATOMIC_ADD64(gbl_lua_sp_setups, 1);
+    ATOMIC_ADD64(gbl_lua_sp_setup_us, comdb2_time_epochus() - setup_start);
+    if ((rc = run_src(L, err)) != 0) return rc;
     if ((rc = get_func_by_name(L, main_func, err)) != 0) return rc;
 
     int consumer = 0;
@@ -7166,6 +7578,27 @@ void close_sp(struct sqlclntstate *clnt)
     clnt->sp = NULL;
 }
 
+/* Like close_sp, but hand a reusable vm to the pool instead of closing it */
+void park_sp(struct sqlclntstate *clnt)
+{
+    SP sp = clnt->sp;
+    if (sp == NULL || gbl_lua_vm_pool_size <= 0 || sp->lua == NULL ||
+        sp->src == NULL || sp->spname[0] == 0 || sp->parent != sp ||
+        sp->lua_version != gbl_lua_version || !LIST_EMPTY(&sp->dbthds) ||
+        clnt->exec_lua_thread || clnt->was_consumer ||
+        clnt->want_stored_procedure_trace) {
+        close_sp(clnt);
+        return;
+    }
+    reset_sp(sp);
+    restore_sp_globals(sp->lua);
+    sp->clnt = NULL;
+    sp->thd = NULL;
+    sp->emit_mutex = NULL;
+    clnt->sp = NULL;
+    put_pooled_sp(sp, clnt->current_user.name);
+}
+
 void lua_final(sqlite3_context *context)
 {
     lua_func_arg_t *arg = sqlite3_user_data(context);
@@ -30,6 +30,7 @@ int exec_procedure(struct sqlthdstate *, struct sqlclntstate *, char **err);
 void exec_thread(struct sqlthdstate *, struct sqlclntstate *);
 void *exec_trigger(char *);
 void close_sp(struct sqlclntstate *);
+void park_sp(struct sqlclntstate *);
 int is_pingpong(struct sqlclntstate *);
 int can_consume(struct sqlclntstate *);
 
@@ -26,6 +26,7 @@
 #include <alloca.h>
 #include <errno.h>
 #include <stdint.h>
+#include <inttypes.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -43,6 +44,7 @@
 #include "mem.h"
 #include <logmsg.h>
 #include <sys_wrap.h>
+#include <comdb2_atomic.h>
 
 //^macros
 #define COMDB2MA_SUCCESS 0
@@ -59,6 +61,22 @@
     (((M)->cap != COMDB2MA_UNLIMITED) && (mspace_footprint((M)->m) > (M)->cap))
 #define COMDB2MA_SENTINEL_OFS (-2)
 #define COMDB2MA_ALLOC_OFS (-1)
+/* set in the allocator word of chunks carved out by the thread cache */
+#define COMDB2MA_TCACHE_BIT ((uintptr_t)2)
+#define COMDB2MA_ISTCACHE(p)                                                   \
+    ((int)(((uintptr_t)(p)[COMDB2MA_ALLOC_OFS] & COMDB2MA_TCACHE_BIT) != 0))
+/* set in the allocator word of chunks carved out of an arena block. the word
+   then points to the arena block instead of to an allocator. */
+#define COMDB2MA_ARENA_BIT ((uintptr_t)4)
+#define COMDB2MA_ISARENA(p)                                                    \
+    ((int)(((uintptr_t)(p)[COMDB2MA_ALLOC_OFS] & COMDB2MA_ARENA_BIT) != 0))
+#define COMDB2MA_ARENA_BLK(p)                                                  \
+    ((struct arena_blk *)((uintptr_t)(p)[COMDB2MA_ALLOC_OFS] &                 \
+                          ~COMDB2MA_ARENA_BIT))
+/* arena chunks carry their size ahead of the sentinel */
+#define COMDB2MA_ARENA_SIZE_OFS (-3)
+#define COMDB2MA_ARENA_OVERHEAD (sizeof(void *) * 3)
+#define COMDB2MA_ARENA_BLKSZ (16 << 10)
 
 #ifndef COMDB2_OMIT_DEBUG
 #define COMDB2MA_ISDEBUG(p) ((int)((uintptr_t)(p)[-1] & 1))
@@ -73,12 +91,14 @@
 #define COMDB2MA_OVERHEAD(d)                                                   \
     ((d) ? (sizeof(void *) * 36) : (sizeof(void *) << 1))
 #define COMDB2MA_ALLOCATOR(p)                                                  \
-    ((comdb2ma)((uintptr_t)(p)[COMDB2MA_ALLOC_OFS] & (uintptr_t)~1))
+    ((comdb2ma)((uintptr_t)(p)[COMDB2MA_ALLOC_OFS] &                           \
+                ~((uintptr_t)1 | COMDB2MA_TCACHE_BIT)))
 #else
 #define COMDB2MA_ISDEBUG(p) 0
 #define COMDB2MA_SETDEBUG(p)
 #define COMDB2MA_OVERHEAD(d) (sizeof(void *) << 1)
-#define COMDB2MA_ALLOCATOR(p) ((comdb2ma)((p)[COMDB2MA_ALLOC_OFS]))
+#define COMDB2MA_ALLOCATOR(p)                                                  \
+    ((comdb2ma)((uintptr_t)(p)[COMDB2MA_ALLOC_OFS] & ~COMDB2MA_TCACHE_BIT))
 #endif /* COMDB2_OMIT_DEBUG */
 
 #define COMDB2MA_MIN_NAME_SZ 8
@@ -92,6 +112,15 @@
     ((p)[COMDB2MA_SENTINEL_OFS] ==                                             \
      COMDB2MA_SENTINEL((p) + COMDB2MA_SENTINEL_OFS, (p)[COMDB2MA_ALLOC_OFS]))
 
+/*
+ * Thread cache size classes: 16-byte steps up to 128, then 4 classes per
+ * power of two up to COMDB2MA_TCACHE_MAX_SZ.
+ */
+#define COMDB2MA_TCACHE_NCLASSES 20
+#define COMDB2MA_TCACHE_MAX_SZ 1024
+#define COMDB2MA_TCACHE_BIN_MAX 64    /* chunks per class per thread */
+#define COMDB2MA_TCACHE_BATCH 16      /* chunks moved per lock acquisition */
+
 #define COMDB2MA_MALLINFO_SAFE(cm)                                             \
     ((cm)->use_lock ? mspace_mallinfo((cm)->m) : mspace_mallinfo_fast((cm)->m))
 
@@ -161,6 +190,9 @@ struct comdb2mspace {
     const char *func; /* function */
     int line;         /* line */
 
+    int indx; /* index of the static allocator this mspace serves,
+                 0 if it is a dynamic allocator */
+
     const char *thr_type; /* thread type.
                              we do not write it to name because an allocator
                              may be reused by another type of thread later on */
@@ -194,6 +226,22 @@ struct comdb2bmspace {
     int nblocks; /* number of blocking threads */
 };
 
+struct arena_blk {
+    int live;  /* live chunks, +1 while the block is current */
+    int indx;  /* static allocator of the block */
+    char *pos; /* next free byte */
+    char *end; /* end of the block */
+};
+
+struct comdb2ma_arena {
+    int indx;      /* static allocator served by the arena */
+    size_t blksz;  /* block size */
+    size_t maxsz;  /* larger requests bypass the arena */
+    size_t used;   /* bytes carved since the last reset */
+    size_t hwm;    /* largest `used' seen at a reset */
+    struct arena_blk *cur;
+};
+
 #if !defined(USE_SYS_ALLOC) && !defined(COMDB2MA_OMIT_BMEM)
 /* the pthread key is shared amongst all blocking allocators */
 static pthread_once_t privileged_once = PTHREAD_ONCE_INIT;
@@ -240,6 +288,7 @@ static struct {
                      always set to 1. */
     int mmap_thresh; /* user defined MMAP_THRESHOLD */
     int nice; /* mem niceness */
+    pthread_key_t tcache; /* flushes the thread cache on thread exit */
 #ifdef PER_THREAD_MALLOC
     pthread_t main_thr_id;
     pthread_key_t zone;
@@ -372,11 +421,48 @@ static void *abortable_calloc(size_t, size_t);
 /* ctrace with prefix */
 static void pfx_ctrace(const char *format, ...);
 
+/* thread cache */
+struct tcache;
+static void *tcache_malloc(comdb2ma cm, size_t size);
+static int tcache_free(comdb2ma cm, void **p);
+static void tcache_destroy(void *arg);
+static void tcache_sweep(void);
+static void ma_tcache_dump(int toctrc);
+
+/* per-query arena */
+static __thread comdb2ma_arena t_arena;
+static void *arena_malloc(comdb2ma_arena a, size_t size);
+static void *arena_realloc(void **p, size_t n, int copy);
+static void arena_blk_release(struct arena_blk *b);
+static void ma_arena_dump(int toctrc);
+
+/* free `n' chunks of `cm' under a single lock acquisition */
+static void comdb2_free_batch(comdb2ma cm, void **ptrs, size_t n);
+
 /* Mem debug config */
 static int find_switch_index(const char *name);
 static int debug_started = 0;
 static unsigned char debug_master_switch = 0;
 static unsigned char debug_switches[COMDB2MA_COUNT] = {0};
+
+/* Thread cache config and statistics, per static allocator */
+static int tcache_enabled[COMDB2MA_COUNT] = {0};
+static int tcache_gen = 0; /* bumped to make threads drop their caches */
+static __thread int t_tcache_gen; /* tcache_gen as of the last sweep */
+static struct {
+    uint64_t hits;    /* served from a thread cache */
+    uint64_t refills; /* lock acquisitions to refill a thread cache */
+    uint64_t flushes; /* lock acquisitions to return chunks */
+    int64_t nchunks;  /* chunks currently held by thread caches */
+    int64_t nbytes;   /* bytes currently held by thread caches */
+} tcache_stats[COMDB2MA_COUNT];
+
+/* Arena statistics, per static allocator */
+static struct {
+    int64_t nbytes; /* bytes held in arena blocks */
+    int64_t pinned; /* bytes in blocks no longer current but still live */
+    int64_t hwm;    /* largest number of bytes carved by one statement */
+} arena_stats[COMDB2MA_COUNT];
 // static variables and function prototypes$
 
 //^root
@@ -425,6 +511,7 @@ int comdb2ma_init(size_t init_sz, size_t max_cap)
 
             listc_init(&(root.list), offsetof(struct comdb2mspace, lnk));
             listc_init(&(root.blist), offsetof(struct comdb2bmspace, lnk));
+            Pthread_key_create(&root.tcache, tcache_destroy);
 
 #ifdef PER_THREAD_MALLOC
             /* create freelists for threaded allocators */
@@ -447,7 +534,9 @@ int comdb2ma_init(size_t init_sz, size_t max_cap)
                     NULL, COMDB2MA_MT_SAFE, NULL, NULL, __FILE__, __func__,
                     __LINE__);
 
-                if (COMDB2_STATIC_MAS[i] == NULL) {
+                if (COMDB2_STATIC_MAS[i] != NULL)
+                    COMDB2_STATIC_MAS[i]->indx = i;
+                else {
                     /* oops. rollback all previous progress */
                     rc = errno;
                     for (--i; i != 0; --i) {
@@ -545,6 +634,8 @@ int comdb2ma_stats(char *pattern, int verbose, int hr, comdb2ma_order_by ord,
 
             ma_pair_dump(pairs, sz, grp, verbose, hr, &total, pattern == NULL,
                          toctrc);
+            ma_tcache_dump(toctrc);
+            ma_arena_dump(toctrc);
             ma_pair_clean(pairs, sz);
             mspace_free(root.m, pairs);
 
@@ -565,10 +656,11 @@ int comdb2ma_stats(char *pattern, int verbose, int hr, comdb2ma_order_by ord,
 
 int comdb2ma_usages(comdb2ma_usage **pusages, int *n)
 {
-    int rc, unlock_rc, cnt;
+    int rc, unlock_rc, cnt, i, narenas = 0;
     struct mallinfo info;
     comdb2ma_usage *usages;
     comdb2ma curr;
+    int64_t nbytes, pinned;
 
     rc = COMDB2MA_LOCK(&root);
     if (rc != 0)
@@ -577,8 +669,13 @@ int comdb2ma_usages(comdb2ma_usage **pusages, int *n)
     if (root.m == NULL)
         rc = EPERM;
     else {
-        *n = cnt = listc_size(&(root.list));
-        *pusages = usages = comdb2_calloc_static(1, cnt, sizeof(comdb2ma_usage));
+        for (i = 1; i != COMDB2MA_COUNT; ++i)
+            if (ATOMIC_LOAD64(arena_stats[i].nbytes) != 0 ||
+                ATOMIC_LOAD64(arena_stats[i].hwm) != 0)
+                ++narenas;
+        cnt = listc_size(&(root.list));
+        *pusages = usages =
+            comdb2_calloc_static(1, cnt + narenas, sizeof(comdb2ma_usage));
 
         LISTC_FOR_EACH(&(root.list), curr, lnk) {
             info = comdb2_mallinfo(curr);
@@ -592,6 +689,28 @@ int comdb2ma_usages(comdb2ma_usage **pusages, int *n)
             usages->unused = info.fordblks;
             ++usages;
         }
+
+        /* one "arena" row per arena'd allocator, scoped by the allocator.
+           used is the bytes pinned by chunks that outlived their statement;
+           peak is the largest number of bytes a single statement carved. */
+        for (i = 1; i != COMDB2MA_COUNT && narenas != 0; ++i) {
+            nbytes = ATOMIC_LOAD64(arena_stats[i].nbytes);
+            pinned = ATOMIC_LOAD64(arena_stats[i].pinned);
+            if (nbytes == 0 && ATOMIC_LOAD64(arena_stats[i].hwm) == 0)
+                continue;
+            strncpy(usages->name_str, "arena", sizeof(usages->name_str) - 1);
+            usages->name = usages->name_str;
+            strncpy(usages->scope_str, COMDB2_STATIC_MA_METAS[i].name,
+                    sizeof(usages->scope_str) - 1);
+            usages->scope = usages->scope_str;
+            usages->peak = ATOMIC_LOAD64(arena_stats[i].hwm);
+            usages->total = nbytes;
+            usages->used = pinned;
+            usages->unused = nbytes - pinned;
+            ++usages;
+            --narenas;
+        }
+        *n = usages - *pusages;
     }
 
     unlock_rc = COMDB2MA_UNLOCK(&root);
@@ -646,10 +765,14 @@ int comdb2_mallopt(int opt, int val) { return mspace_mallopt(opt, val); }
 
 size_t comdb2_malloc_usable_size(void *ptr)
 {
-    return (ptr == NULL)
-               ? 0
-               : (dlmalloc_usable_size((void **)ptr + COMDB2MA_SENTINEL_OFS) -
-                  COMDB2MA_OVERHEAD(COMDB2MA_ISDEBUG((void **)ptr)));
+    void **p = (void **)ptr;
+
+    if (p == NULL)
+        return 0;
+    if (COMDB2MA_ISARENA(p) && COMDB2MA_OK_SENTINEL(p))
+        return (size_t)(uintptr_t)p[COMDB2MA_ARENA_SIZE_OFS];
+    return dlmalloc_usable_size(p + COMDB2MA_SENTINEL_OFS) -
+           COMDB2MA_OVERHEAD(COMDB2MA_ISDEBUG(p));
 }
 
 int comdb2ma_release(void)
@@ -789,9 +912,19 @@ void *comdb2_malloc(comdb2ma cm, size_t size)
     int d = debug_started;
     char *fp;
 
+    /* hand back chunks of thread caches disabled since the last call */
+    if (t_tcache_gen != tcache_gen)
+        tcache_sweep();
+
     if (size > COMDB2MA_MAX_MEM) {
         // force failure if integer overflow
         errno = ENOMEM;
+    } else if (t_arena != NULL && t_arena->indx == cm->indx &&
+               size <= t_arena->maxsz && !(d && cm->debug)) {
+        out = arena_malloc(t_arena, size);
+    } else if (size <= COMDB2MA_TCACHE_MAX_SZ && tcache_enabled[cm->indx] &&
+               !(d && cm->debug)) {
+        out = tcache_malloc(cm, size);
     } else if (COMDB2MA_LOCK(cm) == 0) {
         if (!COMDB2MA_FULL(cm))
             out = mspace_malloc(cm->m, size + COMDB2MA_OVERHEAD(d));
@@ -834,9 +967,22 @@ void *comdb2_calloc(comdb2ma cm, size_t n, size_t size)
     int d = debug_started;
     char *fp;
 
+    if (t_tcache_gen != tcache_gen)
+        tcache_sweep();
+
     if (n && size && COMDB2MA_MAX_MEM / n < size) {
         // force failure if integer overflow
         errno = ENOMEM;
+    } else if (t_arena != NULL && t_arena->indx == cm->indx &&
+               n * size <= t_arena->maxsz && !(d && cm->debug)) {
+        nb = n * size;
+        if ((out = arena_malloc(t_arena, nb)) != NULL)
+            memset(out, 0, nb);
+    } else if (n * size <= COMDB2MA_TCACHE_MAX_SZ &&
+               tcache_enabled[cm->indx] && !(d && cm->debug)) {
+        nb = n * size;
+        if ((out = tcache_malloc(cm, nb)) != NULL)
+            memset(out, 0, nb);
     } else if (COMDB2MA_LOCK(cm) == 0) {
         nb = n * size;
         if (!COMDB2MA_FULL(cm))
@@ -865,7 +1011,7 @@ void *comdb2_calloc(comdb2ma cm, size_t n, size_t size)
 static void *comdb2_realloc_int(comdb2ma cm, void *ptr, size_t n)
 {
     void **out = (void **)ptr;
-    int d;
+    int d, tc;
     char *fp;
 
     if (COMDB2MA_LOCK(cm) != 0)
@@ -879,10 +1025,15 @@ static void *comdb2_realloc_int(comdb2ma cm, void *ptr, size_t n)
             out = NULL;
         } else {
             d = COMDB2MA_ISDEBUG(out);
+            tc = COMDB2MA_ISTCACHE(out);
             out = mspace_realloc(cm->m, (void *)(out + COMDB2MA_SENTINEL_OFS),
                                  n + COMDB2MA_OVERHEAD(d));
             if (out != NULL) {
-                /* Recompute sentinel for realloc() b/c addr may be changed. */
+                if (tc)
+                    ATOMIC_ADD64(tcache_stats[cm->indx].nchunks, -1);
+                /* Recompute sentinel for realloc() b/c addr may be changed.
+                   The chunk no longer belongs to a size class. */
+                out[1] = (void *)cm;
                 out[0] = COMDB2MA_SENTINEL(out, cm);
                 out -= COMDB2MA_SENTINEL_OFS;
                 if (d && cm->debug) {
@@ -913,6 +1064,8 @@ void *comdb2_realloc(comdb2ma cm, void *ptr, size_t n)
             /* sentinel does not match. ptr could be allocated by system call.
                hand it over to system realloc. */
             out = realloc(ptr, n);
+        } else if (COMDB2MA_ISARENA(out)) {
+            out = arena_realloc(out, n, 1);
         } else {
             cm = COMDB2MA_ALLOCATOR(out);
 
@@ -929,7 +1082,7 @@ void *comdb2_realloc(comdb2ma cm, void *ptr, size_t n)
 void *comdb2_resize(comdb2ma cm, void *ptr, size_t n)
 {
     void **out = NULL;
-    int d;
+    int d, tc;
     char *fp;
 
     if (ptr == NULL) {
@@ -942,6 +1095,8 @@ void *comdb2_resize(comdb2ma cm, void *ptr, size_t n)
             /* sentinel does not match. ptr could be allocated by system call.
                hand it over to system realloc. */
             out = realloc(ptr, n);
+        } else if (COMDB2MA_ISARENA(out)) {
+            out = arena_realloc(out, n, 0);
         } else {
             cm = COMDB2MA_ALLOCATOR(out);
             if (COMDB2MA_LOCK(cm) != 0)
@@ -953,9 +1108,12 @@ void *comdb2_resize(comdb2ma cm, void *ptr, size_t n)
                     out = NULL;
                 } else {
                     d = COMDB2MA_ISDEBUG(out);
+                    tc = COMDB2MA_ISTCACHE(out);
                     out = mspace_resize(cm->m, (void *)(out + COMDB2MA_SENTINEL_OFS),
                                         n + COMDB2MA_OVERHEAD(d));
                     if (out != NULL) {
+                        if (tc)
+                            ATOMIC_ADD64(tcache_stats[cm->indx].nchunks, -1);
                         out[0] = COMDB2MA_SENTINEL(out, cm);
                         out[1] = (void *)cm;
                         out -= COMDB2MA_SENTINEL_OFS;
@@ -974,14 +1132,15 @@ void *comdb2_resize(comdb2ma cm, void *ptr, size_t n)
     return (void *)out;
 }
 
-static void comdb2_free_int(comdb2ma cm, void *ptr)
+static void comdb2_free_batch(comdb2ma cm, void **ptrs, size_t n)
 {
-    void **p = (void **)ptr;
+    size_t i;
 
     if (COMDB2MA_LOCK(cm) == 0) {
-        mspace_free(cm->m, p + COMDB2MA_SENTINEL_OFS);
+        for (i = 0; i != n; ++i)
+            mspace_free(cm->m, (void **)ptrs[i] + COMDB2MA_SENTINEL_OFS);
 #ifdef PER_THREAD_MALLOC
-        --cm->refs;
+        cm->refs -= n;
 
         /*
          * We must use (cm->nthds == 0) instead of (cm->nthds == 1) because
@@ -1026,6 +1185,11 @@ static void comdb2_free_int(comdb2ma cm, void *ptr)
     }
 }
 
+static void comdb2_free_int(comdb2ma cm, void *ptr)
+{
+    comdb2_free_batch(cm, &ptr, 1);
+}
+
 void comdb2_free(void *ptr)
 {
     comdb2ma cm;
@@ -1038,13 +1202,19 @@ void comdb2_free(void *ptr)
                call.
                2) ptr was not malloc'd by me. hand it over to system free. */
             free(ptr);
+        } else if (COMDB2MA_ISARENA(p)) {
+            arena_blk_release(COMDB2MA_ARENA_BLK(p));
         } else {
             cm = COMDB2MA_ALLOCATOR(p);
 
-            if (cm->bm == NULL)
-                comdb2_free_int(cm, ptr);
-            else
+            if (cm->bm != NULL)
                 comdb2_bfree(cm->bm, ptr);
+            else if (!COMDB2MA_ISTCACHE(p))
+                comdb2_free_int(cm, ptr);
+            else if (!tcache_free(cm, p)) {
+                ATOMIC_ADD64(tcache_stats[cm->indx].nchunks, -1);
+                comdb2_free_int(cm, ptr);
+            }
         }
     }
 }
@@ -1118,6 +1288,488 @@ int comdb2_malloc_trim(comdb2ma cm, size_t pad)
 }
 // dynamic$
 
+//^thread cache
+/*
+ * Per-thread cache of small chunks in front of the static allocators.
+ *
+ * A cached chunk is an ordinary comdb2ma chunk (same header, same mspace)
+ * whose allocator word carries COMDB2MA_TCACHE_BIT. Chunks are carved from
+ * and returned to the owning mspace COMDB2MA_TCACHE_BATCH at a time under a
+ * single lock acquisition. They keep counting towards cm->refs while they
+ * sit in a cache, so a per-thread mspace is never destroyed underneath one.
+ */
+static const size_t tcache_class_sz[COMDB2MA_TCACHE_NCLASSES] = {
+    16,  32,  48,  64,  80,  96,  112, 128, 160, 192,
+    224, 256, 320, 384, 448, 512, 640, 768, 896, 1024};
+
+struct tcache_bin {
+    void **head; /* chunks are linked through their first word */
+    int n;
+};
+
+struct tcache {
+    comdb2ma cm;   /* allocator the bins belong to */
+    uint64_t hits; /* folded into tcache_stats on refill and flush */
+    struct tcache_bin bins[COMDB2MA_TCACHE_NCLASSES];
+};
+
+/* one slot per static allocator, indexed by cm->indx */
+static __thread struct tcache t_tcache[COMDB2MA_COUNT];
+static __thread int t_tcache_registered;
+
+/* smallest class that holds `size' bytes */
+static inline int tcache_class(size_t size)
+{
+    if (size <= 128)
+        return (size == 0) ? 0 : (int)((size - 1) >> 4);
+    if (size <= 256)
+        return 8 + (int)((size - 129) >> 5);
+    if (size <= 512)
+        return 12 + (int)((size - 257) >> 6);
+    return 16 + (int)((size - 513) >> 7);
+}
+
+/* largest class that fits in a chunk with `usable' bytes */
+static inline int tcache_class_of(size_t usable)
+{
+    if (usable >= COMDB2MA_TCACHE_MAX_SZ)
+        return COMDB2MA_TCACHE_NCLASSES - 1;
+    return tcache_class(usable + 1) - 1;
+}
+
+/* return chunks of class `cls' to the mspace until `keep' are left */
+static void tcache_flush_bin(struct tcache *tc, int cls, int keep)
+{
+    struct tcache_bin *bin = &tc->bins[cls];
+    comdb2ma cm = tc->cm;
+    int indx = cm->indx;
+    void *ptrs[COMDB2MA_TCACHE_BATCH];
+    int n;
+
+    while (bin->n > keep) {
+        for (n = 0; n != COMDB2MA_TCACHE_BATCH && bin->n > keep; ++n) {
+            ptrs[n] = bin->head;
+            bin->head = (void **)bin->head[0];
+            --bin->n;
+        }
+        ATOMIC_ADD64(tcache_stats[indx].flushes, 1);
+        ATOMIC_ADD64(tcache_stats[indx].nchunks, -n);
+        /* `cm' may be destroyed once the last chunk is gone */
+        comdb2_free_batch(cm, ptrs, n);
+    }
+}
+
+static void tcache_flush(struct tcache *tc)
+{
+    int i;
+
+    ATOMIC_ADD64(tcache_stats[tc->cm->indx].hits, tc->hits);
+    tc->hits = 0;
+    for (i = 0; i != COMDB2MA_TCACHE_NCLASSES; ++i)
+        tcache_flush_bin(tc, i, 0);
+    tc->cm = NULL;
+}
+
+static struct tcache *tcache_get(comdb2ma cm)
+{
+    struct tcache *tc;
+
+    if (t_tcache_gen != tcache_gen)
+        tcache_sweep();
+    tc = &t_tcache[cm->indx];
+    if (tc->cm != cm) {
+        if (tc->cm != NULL)
+            tcache_flush(tc);
+        tc->cm = cm;
+        if (!t_tcache_registered) {
+            Pthread_setspecific(root.tcache, (void *)t_tcache);
+            t_tcache_registered = 1;
+        }
+    }
+    return tc;
+}
+
+/* carve up to COMDB2MA_TCACHE_BATCH chunks of class `cls' */
+static int tcache_refill(struct tcache *tc, int cls)
+{
+    comdb2ma cm = tc->cm;
+    struct tcache_bin *bin = &tc->bins[cls];
+    size_t sz = tcache_class_sz[cls] + COMDB2MA_OVERHEAD(0);
+    void **out;
+    int n = 0;
+
+    if (COMDB2MA_LOCK(cm) != 0)
+        return 0;
+
+    while (n != COMDB2MA_TCACHE_BATCH && !COMDB2MA_FULL(cm) &&
+           (out = mspace_malloc(cm->m, sz)) != NULL) {
+        out[1] = (void *)((uintptr_t)cm | COMDB2MA_TCACHE_BIT);
+        out[0] = COMDB2MA_SENTINEL(out, out[1]);
+        out -= COMDB2MA_SENTINEL_OFS;
+        out[0] = (void *)bin->head;
+        bin->head = out;
+        ++n;
+    }
+#ifdef PER_THREAD_MALLOC
+    cm->refs += n;
+#endif
+    COMDB2MA_UNLOCK(cm);
+
+    bin->n += n;
+    ATOMIC_ADD64(tcache_stats[cm->indx].refills, 1);
+    ATOMIC_ADD64(tcache_stats[cm->indx].nchunks, n);
+    ATOMIC_ADD64(tcache_stats[cm->indx].hits, tc->hits);
+    tc->hits = 0;
+    return n;
+}
+
+static void *tcache_malloc(comdb2ma cm, size_t size)
+{
+    struct tcache *tc = tcache_get(cm);
+    int cls = tcache_class(size);
+    struct tcache_bin *bin = &tc->bins[cls];
+    void **out;
+
+    if (bin->head != NULL)
+        ++tc->hits;
+    else if (tcache_refill(tc, cls) == 0)
+        return NULL;
+
+    out = bin->head;
+    bin->head = (void **)out[0];
+    --bin->n;
+    return (void *)out;
+}
+
+/* return 1 if `p' has been taken by the thread cache */
+static int tcache_free(comdb2ma cm, void **p)
+{
+    struct tcache *tc;
+    struct tcache_bin *bin;
+    int cls;
+
+    if (!tcache_enabled[cm->indx]) {
+        if (t_tcache_gen != tcache_gen)
+            tcache_sweep();
+        return 0;
+    }
+
+    /* a chunk of another thread's mspace must not evict our own cache */
+    tc = &t_tcache[cm->indx];
+    if (tc->cm != NULL && tc->cm != cm)
+        return 0;
+
+    tc = tcache_get(cm);
+    cls = tcache_class_of(comdb2_malloc_usable_size(p));
+    bin = &tc->bins[cls];
+    p[0] = (void *)bin->head;
+    bin->head = p;
+    if (++bin->n > COMDB2MA_TCACHE_BIN_MAX)
+        tcache_flush_bin(tc, cls,
+                         COMDB2MA_TCACHE_BIN_MAX - COMDB2MA_TCACHE_BATCH);
+    return 1;
+}
+
+/* hand back the chunks of every allocator whose cache has been disabled */
+static void tcache_sweep(void)
+{
+    int i;
+
+    t_tcache_gen = tcache_gen;
+    for (i = 1; i != COMDB2MA_COUNT; ++i)
+        if (t_tcache[i].cm != NULL && !tcache_enabled[i])
+            tcache_flush(&t_tcache[i]);
+}
+
+/* pthread key destructor: hand everything back on thread exit */
+static void tcache_destroy(void *arg)
+{
+    struct tcache *tcs = (struct tcache *)arg;
+    int i;
+
+    for (i = 1; i != COMDB2MA_COUNT; ++i)
+        if (tcs[i].cm != NULL)
+            tcache_flush(&tcs[i]);
+    /* re-register if a later destructor allocates again */
+    t_tcache_registered = 0;
+}
+
+static void ma_tcache_dump(int toctrc)
+{
+    int i, hdr = 0;
+
+    for (i = 1; i != COMDB2MA_COUNT; ++i) {
+        if (!tcache_enabled[i] && ATOMIC_LOAD64(tcache_stats[i].refills) == 0)
+            continue;
+        if (!hdr) {
+            if (toctrc)
+                pfx_ctrace("%-16s %-3s %15s %12s %12s %12s\n", "thread cache",
+                           "on", "hits", "refills", "flushes", "outstanding");
+            else
+                logmsg(LOGMSG_USER, "%-16s %-3s %15s %12s %12s %12s\n",
+                       "thread cache", "on", "hits", "refills", "flushes",
+                       "outstanding");
+            hdr = 1;
+        }
+        if (toctrc)
+            pfx_ctrace("%-16s %-3s %15" PRIu64 " %12" PRIu64 " %12" PRIu64
+                       " %12" PRId64 "\n",
+                       COMDB2_STATIC_MA_METAS[i].name,
+                       tcache_enabled[i] ? "Y" : "N",
+                       ATOMIC_LOAD64(tcache_stats[i].hits),
+                       ATOMIC_LOAD64(tcache_stats[i].refills),
+                       ATOMIC_LOAD64(tcache_stats[i].flushes),
+                       ATOMIC_LOAD64(tcache_stats[i].nchunks));
+        else
+            logmsg(LOGMSG_USER, "%-16s %-3s %15" PRIu64 " %12" PRIu64
+                   " %12" PRIu64 " %12" PRId64 "\n",
+                   COMDB2_STATIC_MA_METAS[i].name,
+                   tcache_enabled[i] ? "Y" : "N",
+                   ATOMIC_LOAD64(tcache_stats[i].hits),
+                   ATOMIC_LOAD64(tcache_stats[i].refills),
+                   ATOMIC_LOAD64(tcache_stats[i].flushes),
+                   ATOMIC_LOAD64(tcache_stats[i].nchunks));
+    }
+}
+
+int comdb2ma_tcache_set(const char *names)
+{
+    char *copy, *tok, *last = NULL;
+    int enabled[COMDB2MA_COUNT] = {0};
+    int i, rc = 0;
+
+    if (names != NULL && (copy = strdup(names)) != NULL) {
+        for (tok = strtok_r(copy, ", ", &last); tok != NULL;
+             tok = strtok_r(NULL, ", ", &last)) {
+            if (strcmp(tok, "*") == 0) {
+                for (i = 1; i != COMDB2MA_COUNT; ++i)
+                    enabled[i] = 1;
+            } else if (strcasecmp(tok, "none") == 0) {
+                continue;
+            } else if ((i = find_switch_index(tok)) > 0) {
+                enabled[i] = 1;
+            } else {
+                logmsg(LOGMSG_ERROR, "%s: unknown allocator %s\n", __func__,
+                       tok);
+                rc = EINVAL;
+            }
+        }
+        free(copy);
+    }
+
+    if (rc != 0)
+        return rc;
+
+    for (i = 1; i != COMDB2MA_COUNT; ++i) {
+        if (tcache_enabled[i] && !enabled[i])
+            ATOMIC_ADD32(tcache_gen, 1);
+        tcache_enabled[i] = enabled[i];
+    }
+    /* other threads sweep on their next allocation */
+    tcache_sweep();
+    return 0;
+}
+// thread cache$
+
+//^arena
+/*
+ * Per-query arena.
+ *
+ * Chunks are carved from fixed-size blocks with a bump pointer. A block
+ * counts its live chunks plus one reference held by the arena while the
+ * block is current; freeing a chunk only drops the count, and the block goes
+ * back to its allocator when the count reaches zero. Chunks that outlive
+ * the query therefore stay valid; they merely pin their block. A pinned block
+ * is not reused by the arena, so callers should keep long-lived allocations
+ * out of it. The bytes held in pinned blocks are reported by memstat and
+ * comdb2_memstats.
+ */
+static inline char *arena_blk_start(struct arena_blk *b)
+{
+    return (char *)b + COMDB2MA_ROUND8(sizeof(struct arena_blk));
+}
+
+static inline int64_t arena_blk_size(struct arena_blk *b)
+{
+    return (int64_t)(b->end - (char *)b);
+}
+
+static void arena_blk_release(struct arena_blk *b)
+{
+    int64_t sz;
+
+    /* the arena's reference is dropped first, so the block is retired */
+    if (ATOMIC_ADD32(b->live, -1) == 0) {
+        sz = arena_blk_size(b);
+        ATOMIC_ADD64(arena_stats[b->indx].nbytes, -sz);
+        ATOMIC_ADD64(arena_stats[b->indx].pinned, -sz);
+        comdb2_free(b);
+    }
+}
+
+/* drop the arena's reference to its current block */
+static void arena_blk_retire(struct arena_blk *b)
+{
+    ATOMIC_ADD64(arena_stats[b->indx].pinned, arena_blk_size(b));
+    arena_blk_release(b);
+}
+
+static struct arena_blk *arena_blk_new(comdb2ma_arena a)
+{
+    struct arena_blk *b;
+
+    /* blksz is above maxsz, so this never recurses into the arena */
+    b = comdb2_malloc(get_area(a->indx), a->blksz);
+    if (b == NULL)
+        return NULL;
+    b->live = 1;
+    b->indx = a->indx;
+    b->pos = arena_blk_start(b);
+    b->end = (char *)b + a->blksz;
+    ATOMIC_ADD64(arena_stats[a->indx].nbytes, arena_blk_size(b));
+    if (a->cur != NULL)
+        arena_blk_retire(a->cur);
+    a->cur = b;
+    return b;
+}
+
+static void *arena_malloc(comdb2ma_arena a, size_t size)
+{
+    struct arena_blk *b = a->cur;
+    size_t rsz = COMDB2MA_ROUND8(size);
+    size_t need = rsz + COMDB2MA_ARENA_OVERHEAD;
+    void **out;
+
+    if (b == NULL || (size_t)(b->end - b->pos) < need) {
+        if ((b = arena_blk_new(a)) == NULL)
+            return NULL;
+    }
+
+    out = (void **)b->pos;
+    b->pos += need;
+    a->used += need;
+    ATOMIC_ADD32(b->live, 1);
+
+    out[0] = (void *)(uintptr_t)rsz;
+    out[2] = (void *)((uintptr_t)b | COMDB2MA_ARENA_BIT);
+    out[1] = COMDB2MA_SENTINEL(out + 1, out[2]);
+    return (void *)(out + 3);
+}
+
+/* move an arena chunk to a fresh allocation of `n' bytes */
+static void *arena_realloc(void **p, size_t n, int copy)
+{
+    size_t sz = (size_t)(uintptr_t)p[COMDB2MA_ARENA_SIZE_OFS];
+    struct arena_blk *b = COMDB2MA_ARENA_BLK(p);
+    void *out;
+
+    if (n <= sz)
+        return (void *)p;
+    if ((out = comdb2_malloc(get_area(b->indx), n)) == NULL)
+        return NULL;
+    if (copy)
+        memcpy(out, p, sz);
+    arena_blk_release(b);
+    return out;
+}
+
+comdb2ma_arena comdb2ma_arena_create(int indx, size_t blksz)
+{
+    comdb2ma_arena a;
+
+    STATIC_RANGE_CHECK(indx, NULL);
+    if (blksz == 0)
+        blksz = COMDB2MA_ARENA_BLKSZ;
+    if ((a = calloc(1, sizeof(struct comdb2ma_arena))) == NULL)
+        return NULL;
+    a->indx = indx;
+    a->blksz = blksz;
+    a->maxsz = (blksz >> 3) - COMDB2MA_ARENA_OVERHEAD;
+    return a;
+}
+
+void comdb2ma_arena_destroy(comdb2ma_arena a)
+{
+    if (a == NULL)
+        return;
+    if (t_arena == a)
+        t_arena = NULL;
+    if (a->cur != NULL)
+        arena_blk_retire(a->cur);
+    free(a);
+}
+
+comdb2ma_arena comdb2ma_arena_bind(comdb2ma_arena a)
+{
+    comdb2ma_arena prev = t_arena;
+    t_arena = a;
+    return prev;
+}
+
+size_t comdb2ma_arena_used(comdb2ma_arena a)
+{
+    return a->used;
+}
+
+size_t comdb2ma_arena_highwater(comdb2ma_arena a)
+{
+    return (a->used > a->hwm) ? a->used : a->hwm;
+}
+
+size_t comdb2ma_arena_reset(comdb2ma_arena a)
+{
+    size_t used = a->used;
+    struct arena_blk *b = a->cur;
+    int64_t hwm;
+
+    /* Only the arena allocates from its current block, so once the count is
+       down to the arena's own reference nobody else can raise it. */
+    if (b != NULL && ATOMIC_LOAD32(b->live) == 1)
+        b->pos = arena_blk_start(b);
+    if (used > a->hwm)
+        a->hwm = used;
+    hwm = ATOMIC_LOAD64(arena_stats[a->indx].hwm);
+    while ((int64_t)a->hwm > hwm &&
+           !CAS64(arena_stats[a->indx].hwm, hwm, (int64_t)a->hwm))
+        hwm = ATOMIC_LOAD64(arena_stats[a->indx].hwm);
+    a->used = 0;
+    return used;
+}
+
+static void ma_arena_dump(int toctrc)
+{
+    int i, hdr = 0;
+
+    for (i = 1; i != COMDB2MA_COUNT; ++i) {
+        if (ATOMIC_LOAD64(arena_stats[i].nbytes) == 0 &&
+            ATOMIC_LOAD64(arena_stats[i].hwm) == 0)
+            continue;
+        if (!hdr) {
+            if (toctrc)
+                pfx_ctrace("%-16s %15s %15s %15s\n", "arena", "bytes",
+                           "pinned", "highwater");
+            else
+                logmsg(LOGMSG_USER, "%-16s %15s %15s %15s\n", "arena",
+                       "bytes", "pinned", "highwater");
+            hdr = 1;
+        }
+        if (toctrc)
+            pfx_ctrace("%-16s %15" PRId64 " %15" PRId64 " %15" PRId64 "\n",
+                       COMDB2_STATIC_MA_METAS[i].name,
+                       ATOMIC_LOAD64(arena_stats[i].nbytes),
+                       ATOMIC_LOAD64(arena_stats[i].pinned),
+                       ATOMIC_LOAD64(arena_stats[i].hwm));
+        else
+            logmsg(LOGMSG_USER,
+                   "%-16s %15" PRId64 " %15" PRId64 " %15" PRId64 "\n",
+                   COMDB2_STATIC_MA_METAS[i].name,
+                   ATOMIC_LOAD64(arena_stats[i].nbytes),
+                   ATOMIC_LOAD64(arena_stats[i].pinned),
+                   ATOMIC_LOAD64(arena_stats[i].hwm));
+    }
+}
+// arena$
+
 //^static mspaces
 int comdb2ma_attach_static(int indx, comdb2ma child)
 {
@@ -1354,6 +2006,7 @@ static comdb2ma get_area(int indx)
                         COMDB2_STATIC_MA_METAS[indx].name, NULL, 1, NULL, NULL,
                         __FILE__, __func__, __LINE__);
                     zone[indx]->onfreelist = indx;
+                    zone[indx]->indx = indx;
                     zone[indx]->debug = (debug_master_switch | debug_switches[indx]);
                     listc_abl(&root.busylist[indx], zone[indx]);
                 } else {
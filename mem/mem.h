@@ -196,7 +196,12 @@ typedef struct comdb2ma_usage {
 **
 ** PARAMETERS
 ** usages - output
-** n      - number of allocators
+** n      - number of rows
+**
+** Each static allocator served by an arena adds a row named "arena" and
+** scoped by the allocator: total is the bytes held in arena blocks, used the
+** bytes in blocks pinned by chunks that outlived their statement, and peak
+** the largest number of bytes a single statement carved.
 */
 int comdb2ma_usages(comdb2ma_usage **usages, int *n);
 
@@ -218,6 +223,24 @@ int comdb2ma_nice(int);
 */
 int comdb2ma_niceness();
 
+/*
+** Put a per-thread cache of small chunks in front of static allocators.
+**
+** Allocations of up to 1KB from the listed allocators are rounded up to a
+** size class and served from a thread-local free list, which is refilled
+** from and returned to the allocator in batches.
+**
+** PARAMETERS
+** names - comma or space separated allocator names (e.g., "sqlite,
+**         protobuf"), "*" for all of them, or "none". Allocators that are
+**         not listed are turned off.
+**
+** RETURN VALUE
+** 0      - success
+** EINVAL - unknown allocator name
+*/
+int comdb2ma_tcache_set(const char *names);
+
 /*
 ** Return the value of mallopt(M_MMAP_THRESHOLD).
 */
@@ -571,6 +594,34 @@ int comdb2_malloc_stats_static(int indx, int verbose, int human_readable,
 */
 int comdb2_malloc_trim_static(int indx, size_t pad);
 
+/*
+** Per-query arena on a static allocator.
+**
+** While an arena is bound to a thread, small allocations that thread makes
+** from the arena's static allocator are carved from arena blocks with a bump
+** pointer. comdb2_free() of an arena chunk is a counter decrement; a block
+** is released once all of its chunks are freed, so chunks may safely
+** outlive a reset. Such a chunk pins its whole block though, so long-lived
+** allocations should be made with no arena bound. Per-allocator totals are
+** reported by memstat and comdb2_memstats.
+**
+** comdb2ma_arena_create   - create an arena; blksz of 0 picks the default.
+** comdb2ma_arena_bind     - bind `a' (or NULL) to the calling thread;
+**                           returns the previously bound arena.
+** comdb2ma_arena_used     - bytes carved since the last reset.
+** comdb2ma_arena_highwater - largest number of bytes carved between resets.
+** comdb2ma_arena_reset    - rewind the current block if nothing in it is
+**                           live; returns the bytes carved since the last
+**                           reset.
+*/
+typedef struct comdb2ma_arena *comdb2ma_arena;
+comdb2ma_arena comdb2ma_arena_create(int indx, size_t blksz);
+void comdb2ma_arena_destroy(comdb2ma_arena a);
+comdb2ma_arena comdb2ma_arena_bind(comdb2ma_arena a);
+size_t comdb2ma_arena_used(comdb2ma_arena a);
+size_t comdb2ma_arena_highwater(comdb2ma_arena a);
+size_t comdb2ma_arena_reset(comdb2ma_arena a);
+
 #endif /* COMDB2MA_OMIT_STATIC */
 
 /****************************************
@@ -72,6 +72,7 @@
 #include "thrman.h"
 #include "thread_util.h"
 #include <timer_util.h>
+#include <wait_events.h>
 #include <comdb2_atomic.h>
 #include <hostname_support.h>
 
@@ -823,10 +824,10 @@ static int remove_seqnum_from_waitlist(host_node_type *host_node_ptr,
 }
 
 
-int net_send_message_payload_ack(netinfo_type *netinfo_ptr, const char *to_host,
-                                 int usertype, void *data, int datalen,
-                                 uint8_t **payloadptr, int *payloadlen,
-                                 int waitforack, int waitms)
+static int net_send_message_payload_ack_int(netinfo_type *netinfo_ptr, const char *to_host,
+                                            int usertype, void *data, int datalen,
+                                            uint8_t **payloadptr, int *payloadlen,
+                                            int waitforack, int waitms)
 {
     net_send_message_header tmphd, msghd;
     uint8_t *p_buf, *p_buf_end;
@@ -987,6 +988,18 @@ end:
     return rc;
 }
 
+int net_send_message_payload_ack(netinfo_type *netinfo_ptr, const char *to_host,
+                                 int usertype, void *data, int datalen,
+                                 uint8_t **payloadptr, int *payloadlen,
+                                 int waitforack, int waitms)
+{
+    int wait_prev = wait_event_begin(WAIT_EVENT_NET_SEND);
+    int rc = net_send_message_payload_ack_int(netinfo_ptr, to_host, usertype, data, datalen, payloadptr,
+                                              payloadlen, waitforack, waitms);
+    wait_event_end(wait_prev);
+    return rc;
+}
+
 int net_send_message(netinfo_type *netinfo_ptr, const char *to_host,
                      int usertype, void *data, int datalen, int waitforack,
                      int waitms)
@@ -1004,7 +1017,10 @@ static int net_send_int(netinfo_type *netinfo_ptr, const char *host,
     int f = 0;
     if (nodelay) f |= NET_SEND_NODELAY;
     if (nodrop) f |= NET_SEND_NODROP;
-    return net_send_evbuffer(netinfo_ptr, host, usertype, data, datalen, numtails, tails, taillens, f);
+    int wait_prev = wait_event_begin(WAIT_EVENT_NET_SEND);
+    int rc = net_send_evbuffer(netinfo_ptr, host, usertype, data, datalen, numtails, tails, taillens, f);
+    wait_event_end(wait_prev);
+    return rc;
 }
 
 int net_send_authcheck_all(netinfo_type *netinfo_ptr)
@@ -379,6 +379,8 @@ int net_listen(int port);
 
 void net_queue_stat_iterate(netinfo_type *, QSTATITERFP, struct net_get_records *);
 void net_queue_stat_iterate_evbuffer(netinfo_type *, QSTATITERFP, struct net_get_records *);
+/* Per-host histogram of messages coalesced into each socket write */
+void net_batch_stats_evbuffer(netinfo_type *);
 void net_userfunc_iterate(netinfo_type *netinfo_ptr, UFUNCITERFP *uf_iter, void *arg);
 
 void kill_subnet(const char *subnet);
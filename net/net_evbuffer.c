@@ -21,6 +21,7 @@
 #include <alloca.h>
 #include <arpa/inet.h>
 #include <fcntl.h>
+#include <inttypes.h>
 #include <limits.h>
 #include <netinet/tcp.h>
 #include <pthread.h>
@@ -48,6 +49,7 @@
 #include <comdb2buf.h>
 #include <compat.h>
 #include <connectmsg.pb-c.h>
+#include <epochlib.h>
 #include <hostname_support.h>
 #include <intern_strings.h>
 #include <logmsg.h>
@@ -84,6 +86,7 @@
 #endif
 
 #define MAX_DISTRESS_COUNT 3
+#define NET_BATCH_HIST_BUCKETS 12 /* messages per write: 1, 2-3, 4-7, .. 2048+ */
 
 #define hprintf_lvl LOGMSG_USER
 #define hprintf_format(a) "[%.3s %-8s fd:%-4d %3s %24s] " a, e->service, e->host, e->fd, e->ssl_data ? "TLS" : "", __func__
@@ -111,6 +114,8 @@
 int gbl_accept_headroom = 100;
 int gbl_pb_connectmsg = 1;
 int gbl_libevent_rte_only = 0;
+int gbl_net_batch_usec = 0;
+int gbl_net_batch_bytes = 65536;
 
 extern char gbl_dbname[MAX_DBNAME_LENGTH];
 extern char *gbl_myhostname;
@@ -395,6 +400,15 @@ struct event_info {
     struct evbuffer *wr_buf;
     struct event *wr_ev;
     time_t wr_full;
+
+    /* write batching */
+    struct event *batch_ev;
+    int batch_pending;
+    unsigned batch_msgs;
+    uint64_t batches;
+    uint64_t batch_msgs_total;
+    uint64_t batch_bytes_total;
+    uint64_t batch_hist[NET_BATCH_HIST_BUCKETS];
 };
 
 #define EVENT_HASH_KEY_SZ 128
@@ -979,6 +993,12 @@ static void do_disable_write(struct event_info *e)
         event_free(e->wr_ev);
         e->wr_ev = NULL;
     }
+    if (e->batch_ev) {
+        event_free(e->batch_ev);
+        e->batch_ev = NULL;
+    }
+    e->batch_pending = 0;
+    e->batch_msgs = 0;
     if (e->flush_buf) {
         evbuffer_free(e->flush_buf);
         e->flush_buf = NULL;
@@ -1156,11 +1176,26 @@ static ssize_t writev_plaintext(struct event_info *e)
     return evbuffer_write(e->wr_buf, e->fd);
 }
 
+/* Called with wr_lk held, just before flush_buf is handed to the writer */
+static void record_batch(struct event_info *e)
+{
+    if (!e->batch_msgs) return;
+    unsigned msgs = e->batch_msgs;
+    int b = 0;
+    while ((msgs >>= 1) && b < NET_BATCH_HIST_BUCKETS - 1) ++b;
+    ++e->batch_hist[b];
+    ++e->batches;
+    e->batch_msgs_total += e->batch_msgs;
+    e->batch_bytes_total += evbuffer_get_length(e->flush_buf);
+    e->batch_msgs = 0;
+}
+
 static void writecb(int fd, short what, void *data)
 {
     struct event_info *e = data;
     Pthread_mutex_lock(&e->wr_lk);
     if (fd != e->fd || !e->flush_buf || !e->wr_buf) abort(); /* sanity check */
+    record_batch(e);
     evbuffer_add_buffer(e->wr_buf, e->flush_buf);
     if (e->host_node_ptr) {
         e->host_node_ptr->enque_count = 0;
@@ -1182,6 +1217,7 @@ static void writecb(int fd, short what, void *data)
         }
         e->sent_at = time(NULL);
         Pthread_mutex_lock(&e->wr_lk);
+        record_batch(e);
         evbuffer_add_buffer(e->wr_buf, e->flush_buf);
         len = evbuffer_get_length(e->wr_buf);
         if (len == 0) {
@@ -1195,10 +1231,52 @@ static void writecb(int fd, short what, void *data)
     }
 }
 
-static void flush_evbuffer(struct event_info *e, int nodelay)
+static void batch_timeout(int dummyfd, short what, void *data)
+{
+    struct event_info *e = data;
+    check_wr_thd();
+    Pthread_mutex_lock(&e->wr_lk);
+    e->batch_pending = 0;
+    if (e->wr_ev && evbuffer_get_length(e->flush_buf)) {
+        event_add(e->wr_ev, NULL);
+    }
+    Pthread_mutex_unlock(&e->wr_lk);
+}
+
+/*
+ * FLUSH_LAZY:  wait for a later flush, or for half of wr_max to accumulate
+ * FLUSH_BATCH: not urgent; written within net_batch_usec, together with
+ *              whatever else is queued for this destination by then
+ * FLUSH_NOW:   nodelay; write as soon as the writer thread can
+ *
+ * Called with wr_lk held.
+ */
+enum { FLUSH_LAZY, FLUSH_BATCH, FLUSH_NOW };
+
+/* Nodelay messages are never held back: osql replies and block replies are
+ * nodelay without being nodrop, and every transaction waits on them. */
+static inline int flush_how(int nodelay)
 {
+    if (nodelay) return FLUSH_NOW;
+    return gbl_net_batch_usec > 0 ? FLUSH_BATCH : FLUSH_LAZY;
+}
+
+static void flush_evbuffer(struct event_info *e, int how, int nmsgs)
+{
+    e->batch_msgs += nmsgs;
+    size_t len = evbuffer_get_length(e->flush_buf);
     size_t flush_threashold = e->net_info->wr_max / 2;
-    if (nodelay || evbuffer_get_length(e->flush_buf) > flush_threashold) {
+    int usec = gbl_net_batch_usec;
+    if (how == FLUSH_BATCH) {
+        if (len >= (size_t)gbl_net_batch_bytes) {
+            how = FLUSH_NOW;
+        } else if (!e->batch_pending && e->batch_ev && usec > 0) {
+            struct timeval tv = {.tv_sec = usec / 1000000, .tv_usec = usec % 1000000};
+            e->batch_pending = 1;
+            event_add(e->batch_ev, &tv);
+        }
+    }
+    if (how == FLUSH_NOW || len > flush_threashold) {
         event_add(e->wr_ev, NULL);
     }
     check_wr_full(e);
@@ -2066,6 +2144,7 @@ static void enable_write(int dummyfd, short what, void *data)
         abort();
     }
     e->wr_ev = event_new(wr_base, e->fd, EV_WRITE | EV_PERSIST, writecb, e);
+    e->batch_ev = evtimer_new(wr_base, batch_timeout, e);
     e->flush_buf = evbuffer_new();
     e->wr_buf = evbuffer_new();
     e->wr_full = 0;
@@ -3955,6 +4034,7 @@ int write_list_evbuffer(host_node_type *host_node_ptr, int type, const struct io
     int rc;
     int nodrop = flags & WRITE_MSG_NOLIMIT;
     int nodelay = flags & WRITE_MSG_NODELAY;
+    int how = flush_how(nodelay);
     struct event_info *e = host_node_ptr->event_info;
     int total = e->wirehdr_len;
     for (int i = 0; i < n; ++i) total += iov[i].iov_len;
@@ -3965,7 +4045,7 @@ int write_list_evbuffer(host_node_type *host_node_ptr, int type, const struct io
         if ((rc = evbuffer_expand(e->flush_buf, total)) == 0) {
             evbuffer_add(e->flush_buf, e->wirehdr[type], e->wirehdr_len);
             for (int i = 0; i < n; ++i) evbuffer_add(e->flush_buf, iov[i].iov_base, iov[i].iov_len);
-            flush_evbuffer(e, nodelay);
+            flush_evbuffer(e, how, 1);
         } else {
             rc = -1;
         }
@@ -3994,6 +4074,7 @@ int net_send_all_evbuffer(netinfo_type *netinfo_ptr, int n, void **buf, int *len
         nodelay |= flags[i] & NET_SEND_NODELAY;
         logput |= flags[i] & NET_SEND_LOGPUT;
     }
+    int how = flush_how(nodelay);
     struct shared_msg **msg = NULL;
     if (sz > KB(1)) {
         msg = alloca(sizeof(struct shared_msg *) * n);
@@ -4021,7 +4102,7 @@ int net_send_all_evbuffer(netinfo_type *netinfo_ptr, int n, void **buf, int *len
             } else {
                 memcpy_evbuffer(e->flush_buf, e, sz, n, buf, len, type);
             }
-            flush_evbuffer(e, nodelay);
+            flush_evbuffer(e, how, n);
         }
         Pthread_mutex_unlock(&e->wr_lk);
         if (e->host_node_ptr) {
@@ -4046,7 +4127,7 @@ int net_flush_evbuffer(host_node_type *host_node_ptr)
     struct event_info *e = host_node_ptr->event_info;
     Pthread_mutex_lock(&e->wr_lk);
     if (e->flush_buf) {
-        flush_evbuffer(e, 1);
+        flush_evbuffer(e, FLUSH_NOW, 0);
     }
     Pthread_mutex_unlock(&e->wr_lk);
     return 0;
@@ -4191,6 +4272,31 @@ void net_queue_stat_iterate_evbuffer(netinfo_type *netinfo_ptr, QSTATITERFP func
     }
 }
 
+void net_batch_stats_evbuffer(netinfo_type *netinfo_ptr)
+{
+    struct net_info *ni = netinfo_ptr->net_info;
+    struct event_info *e;
+    logmsg(LOGMSG_USER, "net:%s batch_usec:%d batch_bytes:%d\n", netinfo_ptr->service, gbl_net_batch_usec,
+           gbl_net_batch_bytes);
+    LIST_FOREACH(e, &ni->event_list, net_list_entry) {
+        uint64_t hist[NET_BATCH_HIST_BUCKETS];
+        Pthread_mutex_lock(&e->wr_lk);
+        uint64_t batches = e->batches;
+        uint64_t msgs = e->batch_msgs_total;
+        uint64_t bytes = e->batch_bytes_total;
+        memcpy(hist, e->batch_hist, sizeof(hist));
+        Pthread_mutex_unlock(&e->wr_lk);
+        logmsg(LOGMSG_USER, "  %-24s writes:%" PRIu64 " msgs:%" PRIu64 " avg-msgs:%.1f avg-bytes:%.0f\n", e->host,
+               batches, msgs, batches ? (double)msgs / batches : 0.0, batches ? (double)bytes / batches : 0.0);
+        if (!batches) continue;
+        logmsg(LOGMSG_USER, "  %-24s", "");
+        for (int i = 0; i < NET_BATCH_HIST_BUCKETS; ++i) {
+            if (hist[i]) logmsg(LOGMSG_USER, " %u:%" PRIu64, 1u << i, hist[i]);
+        }
+        logmsg(LOGMSG_USER, "\n");
+    }
+}
+
 void increase_net_buf(void)
 {
     run_on_base(base, do_increase_net_buf, NULL);
@@ -417,6 +417,12 @@ static void dbqueue_check_inactivity(struct consumer *consumer)
         unsigned long long genid;
 
         genid = dbqueue_get_front_genid(consumer->db, consumer->consumern);
+        /* a partitioned queue is stuck if its oldest head doesn't move */
+        for (int i = 1; i < consumer->db->queue_partitions; i++) {
+            unsigned long long g = dbqueue_get_front_genid(consumer->db, i);
+            if (g && (!genid || bdb_cmp_genids(g, genid) < 0))
+                genid = g;
+        }
 
         if (!genid)
             return;
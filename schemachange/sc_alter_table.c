@@ -28,6 +28,8 @@
 #include "sc_logic.h"
 #include "sc_records.h"
 #include "analyze.h"
+#include "cron.h"
+#include "epochlib.h"
 #include "comdb2_atomic.h"
 #include "views.h"
 #include "macc_glue.h"
@@ -910,6 +912,7 @@ convert_records:
 
 static int finalize_merge_table(struct ireq *iq, struct schema_change_type *s,
                                 tran_type *transac);
+static void schedule_instant_upgrade(const char *tablename);
 #define BACKOUT                                                                \
     do {                                                                       \
         sc_errf(s, "%s:%d backing out\n", __func__, __LINE__);                 \
@@ -1061,6 +1064,11 @@ int finalize_alter_table(struct ireq *iq, struct schema_change_type *s,
     /* TODO: need to free db handle - right now we just leak some memory */
     /* replace the old db definition with a new one */
 
+    /* a new row version over the old data file: rows are upgraded on read
+     * and, if configured, by a background table upgrade */
+    int instant = newdb->instant_schema_change && newdb->plan && newdb->plan->dta_plan == 0 &&
+                  newdb->schema_version > db->schema_version;
+
     newdb->plan = NULL;
     db->schema = clone_schema(newdb->schema);
 
@@ -1107,6 +1115,9 @@ int finalize_alter_table(struct ireq *iq, struct schema_change_type *s,
 
     sc_printf(s, "Schema change ok\n");
 
+    if (instant)
+        schedule_instant_upgrade(db->tablename);
+
     rc = bdb_close_only_sc(old_bdb_handle, NULL, &bdberr);
     if (rc) {
         sc_errf(s, "Failed closing old db, bdberr %d\n", bdberr);
@@ -1234,6 +1245,64 @@ static int finalize_merge_table(struct ireq *iq, struct schema_change_type *s,
     return finalize_drop_table(iq, s, transac);
 }
 
+int gbl_instant_sc_upgrade_delay = 0;
+static cron_sched_t *instant_upgrade_sched;
+
+/* Rewrite the rows still at older versions.  Runs as a regular table
+ * upgrade, so it is throttled like any other schema change. */
+static void *instant_upgrade_event(struct cron_event *evt, struct errstat *err)
+{
+    const char *tablename = evt->arg1;
+    if (db_is_stopped() || thedb->master != gbl_myhostname)
+        return NULL;
+    if (get_dbtable_by_name(tablename) == NULL)
+        return NULL;
+
+    int rc = start_table_upgrade(thedb, tablename, 0, 1, 0, 0);
+    if (rc) {
+        /* most likely another schema change on the table; try again later */
+        logmsg(LOGMSG_INFO, "%s: upgrade of %s not started rc %d, will retry\n", __func__, tablename, rc);
+        schedule_instant_upgrade(tablename);
+    } else {
+        logmsg(LOGMSG_INFO, "%s: upgrading rows of %s to the current version\n", __func__, tablename);
+    }
+    return NULL;
+}
+
+static char *instant_upgrade_describe(sched_if_t *impl)
+{
+    return strdup("Instant schema change upgrader");
+}
+
+static char *instant_upgrade_event_describe(sched_if_t *impl, cron_event_t *event)
+{
+    return strdup("Upgrade rows to the current version");
+}
+
+static void schedule_instant_upgrade(const char *tablename)
+{
+    struct errstat xerr = {0};
+    sched_if_t impl = {0};
+    int delay = gbl_instant_sc_upgrade_delay;
+    char *arg;
+
+    if (delay <= 0 || (arg = strdup(tablename)) == NULL)
+        return;
+    if (instant_upgrade_sched == NULL) {
+        time_cron_create(&impl, instant_upgrade_describe, instant_upgrade_event_describe);
+        instant_upgrade_sched =
+            cron_add_event(NULL, "Instant SC Upgrader", comdb2_time_epoch() + delay,
+                           (FCRON)instant_upgrade_event, arg, NULL, NULL, NULL, NULL, &xerr, &impl);
+    } else {
+        cron_add_event(instant_upgrade_sched, NULL, comdb2_time_epoch() + delay, (FCRON)instant_upgrade_event, arg,
+                       NULL, NULL, NULL, NULL, &xerr, NULL);
+    }
+    if (instant_upgrade_sched == NULL || xerr.errval) {
+        logmsg(LOGMSG_ERROR, "%s: failed to schedule upgrade of %s rc %d %s\n", __func__, tablename, xerr.errval,
+               xerr.errstr);
+    }
+}
+
 int do_upgrade_table_int(struct schema_change_type *s)
 {
     int rc = SC_OK;
@@ -33,6 +33,7 @@
 #include "alias.h"
 #include "gen_shard.h"
 #include "tag.h"
+#include "query_plan_baseline.h"
 
 extern int gbl_retro_tpt_verbose;
 
@@ -141,6 +142,14 @@ int is_genid_right_of_stripe_pointer(bdb_state_type *bdb_state,
     return rc;
 }
 
+int is_genid_right_of_sc_pointer(struct dbtable *from, unsigned long long genid)
+{
+    unsigned long long *sc_genids = NULL;
+    if (from->sc_ranges)
+        sc_genids = sc_range_genids(from->sc_ranges, from->handle, genid);
+    return is_genid_right_of_stripe_pointer(from->handle, genid, sc_genids ? sc_genids : from->sc_genids);
+}
+
 unsigned long long get_genid_stripe_pointer(unsigned long long genid,
                                             unsigned long long *sc_genids)
 {
@@ -285,7 +294,7 @@ int live_sc_post_update_delayed_key_adds(struct ireq *iq, void *trans, unsigned
 #endif
     /* need to check where the cursor is, even tho that check was done once in
      * post_update */
-    int is_gen_gt_scptr = is_genid_right_of_stripe_pointer(iq->usedb->handle, newgenid, usedb->sc_from->sc_genids);
+    int is_gen_gt_scptr = is_genid_right_of_sc_pointer(usedb->sc_from, newgenid);
     if (is_gen_gt_scptr) {
         if (iq->debug) {
             reqprintf(iq, "%s: skip genid 0x%llx to the right of scptr", __func__, newgenid);
@@ -1202,6 +1211,11 @@ static int scdone_default_cons(const char table[], void *arg, scdone_t type)
     return scdone_llmeta_queue(table, arg, llmeta_queue_add);
 }
 
+static int scdone_plan_baseline(const char tablename[], void *arg, scdone_t type)
+{
+    return query_plan_baseline_load();
+}
+
 static int scdone_genid48(const char tablename[], void *arg, scdone_t type)
 {
     switch (type) {
@@ -1335,7 +1349,7 @@ int (*SCDONE_CALLBACKS[])(const char *, void *, scdone_t) = {
     &scdone_lua_sfunc,     &scdone_lua_afunc,      &scdone_rename_table,
     &scdone_change_stripe, &scdone_user_view,      &scdone_queue_file,
     &scdone_queue_file,    &scdone_rename_table,   &scdone_alias,
-    &scdone_default_cons};
+    &scdone_default_cons,  &scdone_plan_baseline};
 
 /* TODO fail gracefully now that inline? */
 /* called by bdb layer through a callback as a detached thread,
@@ -22,6 +22,11 @@
 int is_genid_right_of_stripe_pointer(bdb_state_type *bdb_state,
                                      unsigned long long genid,
                                      unsigned long long *sc_genids);
+/* Same, for a live writer to 'from': uses the pointer of the genid range
+ * holding 'genid' when the conversion is split into ranges */
+int is_genid_right_of_sc_pointer(struct dbtable *from, unsigned long long genid);
+struct sc_ranges;
+unsigned long long *sc_range_genids(struct sc_ranges *ranges, bdb_state_type *bdb_state, unsigned long long genid);
 
 unsigned long long get_genid_stripe_pointer(unsigned long long genid,
                                             unsigned long long *sc_genids);
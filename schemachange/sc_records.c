@@ -16,6 +16,7 @@
 
 #include <unistd.h>
 #include <poll.h>
+#include <arpa/inet.h>
 
 #include "schemachange.h"
 #include "sc_records.h"
@@ -43,6 +44,10 @@ int gbl_logical_live_sc = 0;
 extern __thread snap_uid_t *osql_snap_info; /* contains cnonce */
 extern int gbl_partial_indexes;
 extern int gbl_debug_omit_zap_on_rebuild;
+
+static void sorted_rows_reset(struct convert_record_data *data);
+static int sc_save_progress(struct convert_record_data *data, void *trans, unsigned long long genid, int *bdberr);
+static double sc_progress_fraction(struct convert_record_data *data);
 // Increase max threads to do SC -- called when no contention is detected
 // A simple atomic add sufices here since this function is called from one
 // place at any given time, currently from lkcounter_check() once per sec
@@ -150,6 +155,15 @@ static inline int print_aggregate_sc_stat(struct convert_record_data *data,
               data->from->sc_nrecs -
                   (data->from->sc_adds + data->from->sc_updates),
               total_nrecs_diff / sc_report_freq);
+
+    /* estimate from genid timestamps when converting by range; rows are
+     * spread evenly enough in time for this to beat a guess from counts */
+    double done = sc_progress_fraction(data);
+    if (done > 0 && now > data->cmembers->start_time) {
+        int elapsed = now - data->cmembers->start_time;
+        sc_printf(data->s, "[%s] progress ~%.1f%% eta %.0fs\n", data->from->tablename, done * 100,
+                  elapsed * (1 - done) / done);
+    }
     return 1;
 }
 
@@ -224,6 +238,10 @@ int init_sc_genids(struct dbtable *db, unsigned long long **p_sc_genids, struct
                                  "genids\n");
             return -1;
         }
+        if (bdb_del_sc_ranges(NULL, db->tablename, &bdberr) != 0) {
+            logmsg(LOGMSG_ERROR, "init_sc_genids: failed to clear saved ranges\n");
+            return -1;
+        }
 
         unsigned long long opgenid = 0ULL;
         if (s->preserve_oplog_count >= 0) {
@@ -392,6 +410,11 @@ void convert_record_data_cleanup(struct convert_record_data *data)
         free_db_record(data->rec);
         data->rec = NULL;
     }
+    if (data->sorted_rows) {
+        sorted_rows_reset(data);
+        free(data->sorted_rows);
+        data->sorted_rows = NULL;
+    }
 }
 
 static inline int convert_server_record(const void *inbufp,
@@ -655,6 +678,526 @@ static void increment_sc_logbytes(int64_t bytes)
     Pthread_mutex_unlock(&sc_bps_lk);
 }
 
+int gbl_sc_sorted_index_build = 0;
+int gbl_sc_sorted_index_batch = 256;
+
+struct sc_sorted_row {
+    unsigned long long genid;
+    unsigned long long dirty_keys;
+    int rrn;
+    int keylen;
+    int reclen;
+    char buf[1]; /* key of sort_ixnum, then the new ondisk record */
+};
+
+/* When the plan keeps the data file and only builds new indexes, rows are
+ * added a batch per transaction, in the order of the first new index, so
+ * neighbouring keys of a batch share leaf fetches and one commit.  This is
+ * not a bulk load: the btree is still built by ordinary inserts, and a batch
+ * holds its page locks until it commits, which makes live writers more
+ * likely to deadlock with it.  Off unless sc_sorted_index_build is set. */
+static int sorted_build_ixnum(struct convert_record_data *data)
+{
+    struct scplan *plan = data->to->plan;
+
+    if (!gbl_sc_sorted_index_build || gbl_sc_sorted_index_batch <= 1 || is_dta_being_rebuilt(plan))
+        return -1;
+    if (data->scanmode != SCAN_PARALLEL && data->scanmode != SCAN_PAGEORDER)
+        return -1;
+    if (gbl_rowlocks || data->s->use_new_genids || data->from->sharding_func ||
+        data->s->schema_change == SC_CONSTRAINT_CHANGE)
+        return -1;
+    /* rows must be convertible without reading their blobs */
+    if (data->to->ix_expr || data->to->n_check_constraints)
+        return -1;
+    if (data->from->numblobs != 0 &&
+        ((gbl_partial_indexes && data->to->ix_partial) || !plan->plan_blobs || data->s->force_rebuild ||
+         data->s->use_old_blobs_on_rebuild))
+        return -1;
+    for (int ix = 0; ix < data->to->nix; ++ix) {
+        if (plan->ix_plan[ix] == -1)
+            return ix;
+    }
+    return -1;
+}
+
+static void sorted_rows_reset(struct convert_record_data *data)
+{
+    for (int i = 0; i < data->nsorted; ++i)
+        free(data->sorted_rows[i]);
+    data->nsorted = 0;
+}
+
+static int sorted_row_cmp(const void *p1, const void *p2)
+{
+    const struct sc_sorted_row *r1 = *(const struct sc_sorted_row **)p1;
+    const struct sc_sorted_row *r2 = *(const struct sc_sorted_row **)p2;
+    int cmp = memcmp(r1->buf, r2->buf, r1->keylen);
+    if (cmp)
+        return cmp;
+    return r1->genid < r2->genid ? -1 : r1->genid > r2->genid;
+}
+
+static int sorted_row_add(struct convert_record_data *data, unsigned long long genid, int rrn,
+                          unsigned long long dirty_keys, const uint8_t *rec, int reclen)
+{
+    int keylen = data->to->ix_keylen[data->sort_ixnum];
+    struct sc_sorted_row *r;
+
+    if (data->sorted_rows == NULL) {
+        data->sorted_rows = malloc(sizeof(struct sc_sorted_row *) * data->maxsorted);
+        if (data->sorted_rows == NULL)
+            return -1;
+    }
+    if ((r = malloc(offsetof(struct sc_sorted_row, buf) + keylen + reclen)) == NULL)
+        return -1;
+    if (create_key_from_ondisk(data->to, data->sort_ixnum, (const char *)rec, r->buf) != 0) {
+        free(r);
+        return -1;
+    }
+    r->genid = genid;
+    r->dirty_keys = dirty_keys;
+    r->rrn = rrn;
+    r->keylen = keylen;
+    r->reclen = reclen;
+    memcpy(r->buf + keylen, rec, reclen);
+    data->sorted_rows[data->nsorted++] = r;
+    return 0;
+}
+
+/* Add the batch in key order, move the stripe pointer past the last row read
+ * and commit.  The pointer only moves at commit, and the transaction holds
+ * the pages it read, so live writers see the batch exactly as they would see
+ * the same rows converted one at a time.  Returns like convert_record(). */
+static int sorted_rows_commit(struct convert_record_data *data)
+{
+    char *tagname = ".NEW..ONDISK";
+    int addflags = RECFLAGS_NO_TRIGGERS | RECFLAGS_NO_CONSTRAINTS | RECFLAGS_NEW_SCHEMA | RECFLAGS_KEEP_GENID |
+                   RECFLAGS_NO_BLOBS;
+    int nrows = data->nsorted;
+    int64_t estimate = 0;
+    int rc = 0, bdberr, opfailcode = 0, ixfailnum = 0;
+    db_seqnum_type ss;
+
+    qsort(data->sorted_rows, nrows, sizeof(struct sc_sorted_row *), sorted_row_cmp);
+    for (int i = 0; i < nrows; ++i)
+        estimate += data->sorted_rows[i]->reclen;
+    throttle_sc_logbytes(estimate);
+
+    data->iq.usedb = data->to;
+    for (int i = 0; i < nrows && rc == 0; ++i) {
+        struct sc_sorted_row *r = data->sorted_rows[i];
+        uint8_t *rec = (uint8_t *)r->buf + r->keylen;
+        unsigned long long ngenid = r->genid;
+        int nrrn = r->rrn;
+        rc = add_record(&data->iq, data->trans, (uint8_t *)tagname, (uint8_t *)tagname + 12, rec, rec + r->reclen,
+                        NULL, data->wrblb, MAXBLOBS, &opfailcode, &ixfailnum, &nrrn, &ngenid,
+                        (gbl_partial_indexes && data->to->ix_partial) ? r->dirty_keys : -1ULL, BLOCK2_ADDKL, 0,
+                        addflags, 0);
+    }
+    if (rc == 0) {
+        rc = sc_save_progress(data, data->trans, data->sorted_genids[data->stripe], &bdberr);
+        if (rc != 0)
+            rc = (bdberr == BDBERR_DEADLOCK) ? RC_INTERNAL_RETRY : ERR_INTERNAL;
+    }
+    if (rc) {
+        increment_sc_logbytes(bdb_tran_logbytes(data->trans) - estimate);
+        trans_abort(&data->iq, data->trans);
+        data->trans = NULL;
+        sorted_rows_reset(data);
+        data->totnretries++;
+        if (rc == RC_INTERNAL_RETRY) {
+            data->num_retry_errors++;
+            if (data->cmembers->is_decrease_thrds)
+                decrease_max_threads(&data->cmembers->maxthreads);
+            else
+                poll(0, 0, (rand() % 500 + 10));
+        } else {
+            /* redo these rows one at a time; that path knows how to report
+             * or skip whatever went wrong */
+            sc_printf(data->s, "[%s] sorted index build rc %d ixfailnum %d, stripe %d continues row by row\n",
+                      data->from->tablename, rc, ixfailnum, data->stripe);
+            data->sort_ixnum = -1;
+        }
+        return 1;
+    }
+
+    data->sc_genids[data->stripe] = data->sorted_genids[data->stripe];
+    if (data->live) {
+        rc = trans_commit_seqnum(&data->iq, data->trans, &ss);
+    } else {
+        rc = trans_commit(&data->iq, data->trans, gbl_myhostname);
+    }
+    increment_sc_logbytes(data->iq.txnsize - estimate);
+    data->trans = NULL;
+    sorted_rows_reset(data);
+
+    if (rc) {
+        sc_errf(data->s, "convert_record: trans_commit failed with rcode %d", rc);
+        return -2;
+    }
+
+    data->nrecs += nrows;
+    if (data->live)
+        delay_sc_if_needed(data, &ss);
+
+    ATOMIC_ADD64(data->from->sc_nrecs, nrows);
+    if (data->s->iq->sorese != NULL) {
+        snap_uid_t *snap_info = data->s->iq->sorese->snap_info;
+        if (snap_info != NULL)
+            snap_info->effects.num_inserted = data->from->sc_nrecs;
+    }
+
+    int now = comdb2_time_epoch();
+    if ((rc = report_sc_progress(data, now)))
+        return rc;
+    if (data->cmembers->is_decrease_thrds)
+        lkcounter_check(data, now);
+    return 1;
+}
+
+int gbl_sc_range_threads = 0;
+int gbl_sc_ranges_per_thread = 8;
+
+/* A stripe split by genid timestamp.  Each range has its own stripe pointer,
+ * genids[stripe], which follows the same rules as sc_genids: rows at or to
+ * the left of it have been converted.  The last range of a stripe is open
+ * ended, so new genids always land there. */
+struct sc_range {
+    unsigned long long genids[MAXDTASTRIPE];
+    unsigned long long lo; /* exclusive */
+    unsigned long long hi; /* inclusive, 0 for the last range */
+    uint32_t lo_epoch, hi_epoch;
+    int stripe;
+    int done;
+};
+
+struct sc_ranges {
+    pthread_mutex_t lk;
+    int nranges;
+    int nclaim;             /* ranges in order[] */
+    int next;               /* next unclaimed in order[] */
+    struct sc_range **order; /* claim order: stripes interleaved */
+    struct sc_range *stripe[MAXDTASTRIPE];
+    int nstripe[MAXDTASTRIPE];
+};
+
+static unsigned long long genid_for_epoch(uint32_t epoch, int stripe)
+{
+    unsigned long long genid = 0;
+    uint32_t e = htonl(epoch);
+    memcpy(&genid, &e, sizeof(e));
+    return format_genid_for_stripe(genid, stripe);
+}
+
+/* Record the genid timestamps of the oldest and newest rows of each stripe,
+ * for splitting stripes */
+static void sc_find_epochs(struct convert_record_data *data)
+{
+    struct common_members *cm = data->cmembers;
+    void *rec = malloc(MAXLRL);
+    if (rec == NULL)
+        return;
+    for (int stripe = 0; stripe < gbl_dtastripe; ++stripe) {
+        unsigned long long genid;
+        int dtalen, bdberr;
+        uint8_t ver;
+        cm->epoch_lo[stripe] = cm->epoch_hi[stripe] = 0;
+        dtalen = MAXLRL;
+        if (bdb_find_oldest_genid(data->from->handle, NULL, stripe, rec, &dtalen, dtalen, &genid, &ver, &bdberr) !=
+            IX_FND)
+            continue;
+        cm->epoch_lo[stripe] = bdb_genid_timestamp(genid);
+        dtalen = MAXLRL;
+        if (bdb_find_newest_genid(data->from->handle, NULL, stripe, rec, &dtalen, dtalen, &genid, &ver, &bdberr) !=
+            IX_FND)
+            continue;
+        cm->epoch_hi[stripe] = bdb_genid_timestamp(genid);
+    }
+    free(rec);
+}
+
+static void sc_ranges_free(struct sc_ranges *ranges)
+{
+    if (ranges == NULL)
+        return;
+    for (int stripe = 0; stripe < MAXDTASTRIPE; ++stripe)
+        free(ranges->stripe[stripe]);
+    free(ranges->order);
+    Pthread_mutex_destroy(&ranges->lk);
+    free(ranges);
+}
+
+/* Save how far range r got, in trans if given.  Resuming a range mode
+ * schema change restarts every range from its saved genid. */
+static int sc_range_save(struct convert_record_data *data, void *trans, struct sc_range *r, unsigned long long genid,
+                         int *bdberr)
+{
+    struct sc_ranges *ranges = data->cmembers->ranges;
+    llmeta_sc_range_data saved = {.stripe = r->stripe,
+                                  .range = r - ranges->stripe[r->stripe],
+                                  .lo = r->lo,
+                                  .hi = r->hi,
+                                  .genid = genid,
+                                  .lo_epoch = r->lo_epoch,
+                                  .hi_epoch = r->hi_epoch};
+    return bdb_set_sc_range(trans, data->to->tablename, &saved, bdberr);
+}
+
+/* Rebuild the ranges saved by an interrupted run.  Returns the number of
+ * ranges, 0 if none were saved, <0 on error. */
+static int sc_ranges_load(struct convert_record_data *data, struct sc_ranges *ranges)
+{
+    llmeta_sc_range_data *saved;
+    int n, bdberr;
+
+    if (!data->s->resume)
+        return 0;
+    if (bdb_get_sc_ranges(NULL, data->to->tablename, &saved, &n, &bdberr) != 0)
+        return -1;
+    for (int i = 0; i < n; ++i) {
+        int stripe = saved[i].stripe;
+        if (stripe < 0 || stripe >= gbl_dtastripe || saved[i].range != ranges->nstripe[stripe]) {
+            sc_errf(data->s, "[%s] bad saved range %d of stripe %d\n", data->from->tablename, saved[i].range, stripe);
+            free(saved);
+            return -1;
+        }
+        ranges->nstripe[stripe]++;
+    }
+    for (int stripe = 0, i = 0; stripe < gbl_dtastripe; ++stripe) {
+        if (ranges->nstripe[stripe] == 0)
+            continue;
+        struct sc_range *r = ranges->stripe[stripe] = calloc(ranges->nstripe[stripe], sizeof(struct sc_range));
+        if (r == NULL) {
+            free(saved);
+            return -1;
+        }
+        for (int j = 0; j < ranges->nstripe[stripe]; ++j, ++i) {
+            r[j].stripe = stripe;
+            r[j].lo = saved[i].lo;
+            r[j].hi = saved[i].hi;
+            r[j].lo_epoch = saved[i].lo_epoch;
+            r[j].hi_epoch = saved[i].hi_epoch;
+            r[j].genids[stripe] = saved[i].genid;
+            r[j].done = saved[i].genid == -1ULL;
+        }
+    }
+    free(saved);
+    return n;
+}
+
+/* Split what is left of each stripe into about 'per_stripe' ranges of equal
+ * genid timestamp span, and save them so a resume converts the same ranges */
+static int sc_ranges_split(struct convert_record_data *data, struct sc_ranges *ranges, int per_stripe)
+{
+    struct common_members *cm = data->cmembers;
+    int bdberr;
+
+    sc_find_epochs(data);
+    for (int stripe = 0; stripe < gbl_dtastripe; ++stripe) {
+        unsigned long long start = data->sc_genids[stripe];
+        if (start == -1ULL)
+            continue;
+        uint32_t lo = cm->epoch_lo[stripe], hi = cm->epoch_hi[stripe];
+        if (start && bdb_genid_timestamp(start) > lo)
+            lo = bdb_genid_timestamp(start);
+        int n = per_stripe;
+        if (hi <= lo)
+            n = 1;
+        else if (hi - lo < n)
+            n = hi - lo;
+        struct sc_range *r = ranges->stripe[stripe] = calloc(n, sizeof(struct sc_range));
+        if (r == NULL)
+            return -1;
+        for (int i = 0; i < n; ++i) {
+            r[i].stripe = stripe;
+            r[i].lo = i ? r[i - 1].hi : start;
+            r[i].lo_epoch = lo + (uint64_t)(hi - lo) * i / n;
+            r[i].hi_epoch = lo + (uint64_t)(hi - lo) * (i + 1) / n;
+            r[i].hi = (i == n - 1) ? 0 : genid_for_epoch(r[i].hi_epoch, stripe);
+            r[i].genids[stripe] = r[i].lo;
+        }
+        ranges->nstripe[stripe] = n;
+    }
+    if (bdb_del_sc_ranges(NULL, data->to->tablename, &bdberr) != 0)
+        return -1;
+    for (int stripe = 0; stripe < gbl_dtastripe; ++stripe) {
+        for (int i = 0; i < ranges->nstripe[stripe]; ++i) {
+            struct sc_range *r = &ranges->stripe[stripe][i];
+            if (sc_range_save(data, NULL, r, r->genids[stripe], &bdberr) != 0)
+                return -1;
+        }
+    }
+    return 0;
+}
+
+static struct sc_ranges *sc_ranges_create(struct convert_record_data *data, int per_stripe)
+{
+    struct sc_ranges *ranges = calloc(1, sizeof(struct sc_ranges));
+    int maxn = 0, rc;
+
+    if (ranges == NULL)
+        return NULL;
+    Pthread_mutex_init(&ranges->lk, NULL);
+    data->cmembers->ranges = ranges;
+    rc = sc_ranges_load(data, ranges);
+    if (rc == 0)
+        rc = sc_ranges_split(data, ranges, per_stripe);
+    else if (rc > 0)
+        sc_printf(data->s, "[%s] resuming %d saved ranges\n", data->from->tablename, rc);
+    data->cmembers->ranges = NULL;
+    if (rc < 0) {
+        sc_errf(data->s, "[%s] failed to set up genid ranges\n", data->from->tablename);
+        sc_ranges_free(ranges);
+        return NULL;
+    }
+    for (int stripe = 0; stripe < gbl_dtastripe; ++stripe) {
+        if (ranges->nstripe[stripe] > maxn)
+            maxn = ranges->nstripe[stripe];
+        ranges->nranges += ranges->nstripe[stripe];
+    }
+    ranges->order = malloc(sizeof(struct sc_range *) * (ranges->nranges + 1));
+    if (ranges->order == NULL) {
+        sc_ranges_free(ranges);
+        return NULL;
+    }
+    /* only ranges with work left are claimed */
+    int k = 0;
+    for (int i = 0; i < maxn; ++i) {
+        for (int stripe = 0; stripe < gbl_dtastripe; ++stripe) {
+            if (i < ranges->nstripe[stripe] && !ranges->stripe[stripe][i].done)
+                ranges->order[k++] = &ranges->stripe[stripe][i];
+        }
+    }
+    ranges->nclaim = k;
+    return ranges;
+}
+
+unsigned long long *sc_range_genids(struct sc_ranges *ranges, bdb_state_type *bdb_state, unsigned long long genid)
+{
+    int stripe = get_dtafile_from_genid(genid);
+    int lo = 0, hi = ranges->nstripe[stripe] - 1;
+    struct sc_range *r = ranges->stripe[stripe];
+
+    if (r == NULL) /* stripe was done before we started */
+        return NULL;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (bdb_inplace_cmp_genids(bdb_state, genid, r[mid].hi) <= 0)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+    return r[lo].genids;
+}
+
+/* Stripe pointer for a resume that does not convert by range: everything
+ * to its left is committed.  Ranges are only marked done after their last
+ * commit. */
+static unsigned long long sc_range_low_water(struct convert_record_data *data)
+{
+    struct sc_ranges *ranges = data->cmembers->ranges;
+    struct sc_range *r = ranges->stripe[data->stripe];
+    unsigned long long lw = -1ULL;
+    Pthread_mutex_lock(&ranges->lk);
+    for (int i = 0; i < ranges->nstripe[data->stripe]; ++i) {
+        if (!r[i].done) {
+            lw = r[i].lo;
+            break;
+        }
+    }
+    Pthread_mutex_unlock(&ranges->lk);
+    return lw;
+}
+
+static int sc_save_progress(struct convert_record_data *data, void *trans, unsigned long long genid, int *bdberr)
+{
+    if (data->range)
+        return sc_range_save(data, trans, data->range, genid, bdberr);
+    return bdb_set_high_genid_stripe(trans, data->to->tablename, data->stripe, genid, bdberr, __func__, __LINE__);
+}
+
+static int sc_range_past_end(struct convert_record_data *data, unsigned long long genid)
+{
+    struct sc_range *r = data->range;
+    return r->hi && bdb_inplace_cmp_genids(data->from->handle, genid, r->hi) > 0;
+}
+
+/* Finish the current range and claim the next one.  Returns 1 if there is
+ * more work, 0 when all ranges are claimed, <0 on error. */
+static int sc_range_next(struct convert_record_data *data)
+{
+    struct sc_ranges *ranges = data->cmembers->ranges;
+    int rc, bdberr;
+
+    if (data->trans) {
+        rc = trans_commit(&data->iq, data->trans, gbl_myhostname);
+        data->trans = NULL;
+        if (rc) {
+            sc_errf(data->s, "%s: trans_commit failed with rcode %d\n", __func__, rc);
+            return -2;
+        }
+    }
+    if (data->range) {
+        rc = sc_range_save(data, NULL, data->range, -1ULL, &bdberr);
+        if (rc) {
+            sc_errf(data->s, "%s: failed to save stripe %d range rc %d bdberr %d\n", __func__, data->stripe, rc,
+                    bdberr);
+            return -2;
+        }
+        Pthread_mutex_lock(&ranges->lk);
+        data->range->done = 1;
+        Pthread_mutex_unlock(&ranges->lk);
+        data->range = NULL;
+
+        unsigned long long lw = sc_range_low_water(data);
+        data->from->sc_genids[data->stripe] = lw;
+        rc = bdb_set_high_genid_stripe(NULL, data->to->tablename, data->stripe, lw, &bdberr, __func__, __LINE__);
+        if (rc) {
+            sc_errf(data->s, "%s: failed to save stripe %d pointer rc %d bdberr %d\n", __func__, data->stripe, rc,
+                    bdberr);
+            return -2;
+        }
+    }
+
+    Pthread_mutex_lock(&ranges->lk);
+    if (ranges->next < ranges->nclaim)
+        data->range = ranges->order[ranges->next++];
+    Pthread_mutex_unlock(&ranges->lk);
+    if (data->range == NULL)
+        return 0;
+
+    data->stripe = data->range->stripe;
+    data->sc_genids = data->range->genids;
+    return 1;
+}
+
+/* Fraction of the table converted so far, judged by the genid timestamps
+ * the range converters have reached, or -1 if not converting by range */
+static double sc_progress_fraction(struct convert_record_data *data)
+{
+    struct sc_ranges *ranges = data->cmembers->ranges;
+    double done = 0, total = 0;
+
+    if (ranges == NULL)
+        return -1;
+    Pthread_mutex_lock(&ranges->lk);
+    for (int stripe = 0; stripe < gbl_dtastripe; ++stripe) {
+        for (int i = 0; i < ranges->nstripe[stripe]; ++i) {
+            struct sc_range *r = &ranges->stripe[stripe][i];
+            unsigned long long cur = r->done ? -1ULL : r->genids[stripe];
+            double span = (double)(r->hi_epoch - r->lo_epoch) + 1;
+            total += span;
+            if (cur == -1ULL)
+                done += span;
+            else if (cur && bdb_genid_timestamp(cur) > r->lo_epoch)
+                done += (bdb_genid_timestamp(cur) >= r->hi_epoch) ? span : bdb_genid_timestamp(cur) - r->lo_epoch;
+        }
+    }
+    Pthread_mutex_unlock(&ranges->lk);
+    return total > 0 ? done / total : -1;
+}
+
 /* converts a single record and prepares for the next one
  * should be called from a while loop
  * param data: pointer to all the state information
@@ -704,6 +1247,10 @@ static int convert_record(struct convert_record_data *data)
             sc_errf(data->s, "Error %d starting transaction\n", rc);
             return -2;
         }
+        if (data->sort_ixnum >= 0) {
+            sorted_rows_reset(data);
+            data->sorted_genids[data->stripe] = data->sc_genids[data->stripe];
+        }
     }
 
     data->iq.debug = debug_this_request(gbl_debug_until);
@@ -749,13 +1296,15 @@ static int convert_record(struct convert_record_data *data)
     }
 
     if (data->scanmode == SCAN_PARALLEL || data->scanmode == SCAN_PAGEORDER) {
+        /* a sorted batch reads ahead of the stripe pointer */
+        unsigned long long *sc_genids = data->sort_ixnum >= 0 ? data->sorted_genids : data->sc_genids;
         if (data->scanmode == SCAN_PARALLEL) {
-            rc = dtas_next(&data->iq, data->sc_genids, &genid, &data->stripe, 1,
+            rc = dtas_next(&data->iq, sc_genids, &genid, &data->stripe, 1,
                            data->dta_buf, data->trans, data->from->lrl, &dtalen,
                            NULL);
         } else {
             rc = dtas_next_pageorder(
-                &data->iq, data->sc_genids, &genid, &data->stripe, 1,
+                &data->iq, sc_genids, &genid, &data->stripe, 1,
                 data->dta_buf, data->trans, data->from->lrl, &dtalen, NULL);
         }
 
@@ -763,6 +1312,8 @@ static int convert_record(struct convert_record_data *data)
         logmsg(LOGMSG_DEBUG, "(%u) %s rc=%d genid %llx (%llu)\n", (unsigned int)pthread_self(), __func__, rc, genid,
                genid);
 #endif
+        if (rc == 0 && data->range && sc_range_past_end(data, genid))
+            rc = 1; /* next range's row */
         if (rc == 0) {
             dta = data->dta_buf;
             check_genid = bdb_normalise_genid(data->to->handle, genid);
@@ -784,6 +1335,9 @@ static int convert_record(struct convert_record_data *data)
                 }
             }
         } else if (rc == 1) {
+            if (data->sort_ixnum >= 0 && data->nsorted > 0)
+                return sorted_rows_commit(data);
+
             /* we have finished all the records in our stripe
              * set pointer to -1 so all insert/update/deletes will be
              * the the left of SC pointer. This works because we now hold
@@ -804,6 +1358,10 @@ static int convert_record(struct convert_record_data *data)
             // bdb_dump_active_locks(data->to->handle, stdout);
             data->sc_genids[data->stripe] = -1ULL;
 
+            /* sc_range_next saves the stripe pointer */
+            if (data->range)
+                return 0;
+
             if (debug_switch_scconvert_finish_delay()) {
                 logmsg(LOGMSG_WARN, "scgenid reset. sleeping 10 sec.\n");
                 sleep(10);
@@ -1037,6 +1595,22 @@ static int convert_record(struct convert_record_data *data)
 
     assert(data->trans != NULL);
 
+    if (data->sort_ixnum >= 0) {
+        if (sorted_row_add(data, ngenid, rrn, dirty_keys, p_buf_data, p_buf_data_end - p_buf_data) != 0) {
+            sc_errf(data->s, "[%s] sorted index build failed to buffer genid 0x%llx, stripe %d continues row by row\n",
+                    data->from->tablename, genid, data->stripe);
+            trans_abort(&data->iq, data->trans);
+            data->trans = NULL;
+            sorted_rows_reset(data);
+            data->sort_ixnum = -1;
+            return 1;
+        }
+        data->sorted_genids[data->stripe] = genid;
+        if (data->nsorted < data->maxsorted)
+            return 1;
+        return sorted_rows_commit(data);
+    }
+
     if (data->s->schema_change != SC_CONSTRAINT_CHANGE) {
         int nrrn = rrn;
 
@@ -1084,7 +1658,7 @@ static int convert_record(struct convert_record_data *data)
         (data->nrecs %
          BDB_ATTR_GET(thedb->bdb_attr, INDEXREBUILD_SAVE_EVERY_N)) == 0) {
         int bdberr;
-        rc = bdb_set_high_genid(data->trans, data->to->tablename, genid, &bdberr, __func__, __LINE__);
+        rc = sc_save_progress(data, data->trans, genid, &bdberr);
         if (rc != 0) {
             if (bdberr == BDBERR_DEADLOCK)
                 rc = RC_INTERNAL_RETRY;
@@ -1266,6 +1840,10 @@ static void *convert_records_thd(struct convert_record_data *data)
     data->curkey = data->key1;
     data->lastkey = data->key2;
     data->rec = allocate_db_record(data->to, ".NEW..ONDISK");
+    data->sort_ixnum = sorted_build_ixnum(data);
+    data->nsorted = 0;
+    data->maxsorted = gbl_sc_sorted_index_batch;
+    data->sorted_rows = NULL;
     data->dta_buf = malloc(data->from->lrl);
     if (!data->dta_buf) {
         sc_errf(data->s, "convert_records_thd: ran out of memory trying to "
@@ -1297,6 +1875,8 @@ static void *convert_records_thd(struct convert_record_data *data)
     }
 
     int prev_preempted = data->s->preempted;
+    if (data->cmembers->ranges)
+        rc = sc_range_next(data);
     /* convert each record */
     while (rc > 0) {
         if (data->cmembers->is_decrease_thrds &&
@@ -1313,6 +1893,8 @@ static void *convert_records_thd(struct convert_record_data *data)
         rc = convert_record(data);
         if (data->cmembers->is_decrease_thrds)
             release_rebuild_thr(&data->cmembers->thrcount);
+        if (rc == 0 && data->range)
+            rc = sc_range_next(data);
 
         if (get_stopsc(__func__, __LINE__)) { // set from downgrade
             data->outrc = SC_MASTER_DOWNGRADE;
@@ -1400,6 +1982,100 @@ static void stop_sc_redo_wait(bdb_state_type *bdb_state,
     Pthread_mutex_unlock(&bdb_state->sc_redo_lk);
 }
 
+/* Range mode keeps a pointer per range instead of per stripe.  Resuming a
+ * rebuilt data file derives the stripe pointer from its newest genid, which
+ * only works when a stripe is converted in order, so only index rebuilds
+ * qualify. */
+static int use_sc_ranges(struct convert_record_data *data)
+{
+    if (gbl_sc_range_threads <= 0 || data->scanmode != SCAN_PARALLEL)
+        return 0;
+    if (data->s->logical_livesc || gbl_rowlocks || data->from->sharding_func)
+        return 0;
+    return !is_dta_being_rebuilt(data->to->plan);
+}
+
+/* Run a pool of gbl_sc_range_threads threads over genid ranges.  A thread
+ * that finishes its range takes the next unclaimed one, so stripes with more
+ * rows get more threads. */
+static int convert_records_by_range(struct convert_record_data *data)
+{
+    struct dbtable *from = data->from;
+    int nthreads = gbl_sc_range_threads;
+    int per_stripe = gbl_sc_ranges_per_thread * nthreads / gbl_dtastripe;
+    struct convert_record_data *threadData;
+    struct sc_ranges *ranges;
+    pthread_attr_t attr;
+    int outrc = 0;
+
+    if (per_stripe < 1)
+        per_stripe = 1;
+    ranges = sc_ranges_create(data, per_stripe);
+    threadData = calloc(nthreads, sizeof(struct convert_record_data));
+    if (ranges == NULL || threadData == NULL) {
+        sc_errf(data->s, "%s: out of memory\n", __func__);
+        sc_ranges_free(ranges);
+        free(threadData);
+        return -1;
+    }
+    sc_printf(data->s, "[%s] converting %d ranges with %d threads\n", from->tablename, ranges->nclaim, nthreads);
+
+    data->cmembers->ranges = ranges;
+    data->cmembers->maxthreads = nthreads;
+    Pthread_rwlock_wrlock(&from->sc_live_lk);
+    from->sc_ranges = ranges;
+    Pthread_rwlock_unlock(&from->sc_live_lk);
+
+    Pthread_attr_init(&attr);
+    Pthread_attr_setstacksize(&attr, DEFAULT_THD_STACKSZ);
+    Pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
+    for (int i = 0; i < nthreads; ++i) {
+        threadData[i] = *data;
+        threadData[i].isThread = 1;
+        Pthread_create(&threadData[i].tid, &attr, (void *(*)(void *))convert_records_thd, &threadData[i]);
+    }
+    for (int i = 0; i < nthreads; ++i) {
+        void *ret;
+        int rc = pthread_join(threadData[i].tid, &ret);
+        if (rc) {
+            sc_errf(data->s, "joining range thread %d failed with return code: %d\n", i, rc);
+            outrc = -1;
+        } else if (threadData[i].outrc != 0) {
+            outrc = threadData[i].outrc;
+        }
+    }
+    Pthread_attr_destroy(&attr);
+
+    /* hand the stripe pointers back to the writers */
+    Pthread_rwlock_wrlock(&from->sc_live_lk);
+    for (int stripe = 0; stripe < gbl_dtastripe; ++stripe) {
+        int n = ranges->nstripe[stripe];
+        if (n == 0)
+            continue;
+        if (outrc == 0) {
+            from->sc_genids[stripe] = -1ULL;
+            continue;
+        }
+        from->sc_genids[stripe] = 0;
+        for (int i = 0; i < n; ++i) {
+            struct sc_range *r = &ranges->stripe[stripe][i];
+            if (!r->done) {
+                from->sc_genids[stripe] = r->genids[stripe] == -1ULL ? r->lo : r->genids[stripe];
+                break;
+            }
+        }
+        if (from->sc_genids[stripe] == 0)
+            from->sc_genids[stripe] = -1ULL;
+    }
+    from->sc_ranges = NULL;
+    Pthread_rwlock_unlock(&from->sc_live_lk);
+
+    data->cmembers->ranges = NULL;
+    sc_ranges_free(ranges);
+    free(threadData);
+    return outrc;
+}
+
 int gbl_sc_pause_at_end = 0;
 int gbl_sc_is_at_end = 0;
 
@@ -1584,10 +2260,14 @@ int convert_all_records(struct dbtable *from, struct dbtable *to,
         s->logical_livesc = 0;
     }
 
+    data.cmembers->start_time = comdb2_time_epoch();
+
     /* if were not in parallel, dont start any threads */
     if (data.scanmode != SCAN_PARALLEL && data.scanmode != SCAN_PAGEORDER) {
         convert_records_thd(&data);
         outrc = data.outrc;
+    } else if (use_sc_ranges(&data)) {
+        outrc = convert_records_by_range(&data);
     } else {
         struct convert_record_data threadData[gbl_dtastripe];
         int threadSkipped[gbl_dtastripe];
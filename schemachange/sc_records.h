@@ -21,6 +21,10 @@
 #include <bdb/bdb_int.h>
 
 extern int gbl_logical_live_sc;
+extern int gbl_sc_sorted_index_build;
+extern int gbl_sc_sorted_index_batch;
+extern int gbl_sc_range_threads;
+extern int gbl_sc_ranges_per_thread;
 
 struct common_members {
     int64_t ndeadlocks;
@@ -30,6 +34,10 @@ struct common_members {
     uint32_t maxthreads;         // maximum number of SC threads allowed
     int is_decrease_thrds;       // is feature on to backoff and decrease threads
     uint32_t total_lasttime;     // last time we computed total stats
+    uint32_t start_time;         // for the progress estimate
+    uint32_t epoch_lo[MAXDTASTRIPE]; // genid timestamps of the oldest and
+    uint32_t epoch_hi[MAXDTASTRIPE]; // newest records of each stripe
+    struct sc_ranges *ranges;    // genid ranges claimed by a thread pool
 };
 
 struct redo_genid_lsns {
@@ -85,6 +93,13 @@ struct convert_record_data {
                                     constraint violation on */
     LISTC_T(struct redo_genid_lsns) redo_lsns;
     hash_t *redo_genids;
+    /* sorted index build: rows read by the open transaction, added in the
+     * order of new index sort_ixnum when the batch is full (-1: disabled) */
+    int sort_ixnum;
+    int nsorted, maxsorted;
+    struct sc_sorted_row **sorted_rows;
+    unsigned long long sorted_genids[MAXDTASTRIPE];
+    struct sc_range *range; /* range being converted, sc_genids points into it */
 };
 
 int convert_all_records(struct dbtable *from, struct dbtable *to,
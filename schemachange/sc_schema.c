@@ -614,7 +614,7 @@ void verify_schema_change_constraint(struct ireq *iq, void *trans,
     if (usedb->sc_to->n_constraints == 0)
         goto unlock;
 
-    if (is_genid_right_of_stripe_pointer(usedb->handle, newgenid, usedb->sc_from->sc_genids)) {
+    if (is_genid_right_of_sc_pointer(usedb->sc_from, newgenid)) {
         goto unlock;
     }
 
@@ -747,6 +747,44 @@ int ondisk_schema_changed(const char *table, struct dbtable *newdb, FILE *out,
             sc_printf(s, i + 1, ##args);                                       \
     } while (0)
 
+/* Rows of older versions are mapped to .ONDISK by column name, so a new
+ * column must not pick up the values of a dropped column with its name */
+static int reuses_dropped_column(struct dbtable *db, struct schema *oldsc, struct schema *newsc)
+{
+    for (int v = 1; v < db->schema_version; ++v) {
+        char tag[MAXTAGLEN];
+        snprintf(tag, sizeof(tag), gbl_ondisk_ver_fmt, v);
+        struct schema *ver = find_tag_schema(db, tag);
+        if (ver == NULL)
+            continue;
+        for (int i = 0; i < newsc->nmembers; ++i) {
+            const char *name = newsc->member[i].name;
+            if (find_field_idx_in_tag(oldsc, name) < 0 && find_field_idx_in_tag(ver, name) >= 0)
+                return 1;
+        }
+    }
+    return 0;
+}
+
+/* A blob whose inline length changed gets its file rebuilt below, which an
+ * instant schema change would leave empty. Blob files of the old table are
+ * otherwise renamed onto the new blob numbers, so dropping a blob column
+ * keeps the data of every later blob. */
+static int blob_length_changed(struct dbtable *olddb, struct dbtable *newdb, struct schema *oldsc,
+                               struct schema *newsc)
+{
+    for (int blobn = 0; blobn < newdb->numblobs; blobn++) {
+        int map = tbl_blob_no_to_tbl_blob_no(newdb, ".NEW..ONDISK", blobn, olddb, ".ONDISK");
+        if (map < 0 || map >= olddb->numblobs)
+            continue;
+        int oldidx = get_schema_blob_field_idx(olddb, ".ONDISK", map);
+        int newidx = get_schema_blob_field_idx(newdb, ".NEW..ONDISK", blobn);
+        if (oldsc->member[oldidx].len != newsc->member[newidx].len)
+            return 1;
+    }
+    return 0;
+}
+
 int create_schema_change_plan(struct schema_change_type *s, struct dbtable *olddb,
                               struct dbtable *newdb, struct scplan *plan)
 {
@@ -799,6 +837,22 @@ int create_schema_change_plan(struct schema_change_type *s, struct dbtable *oldd
         }
     }
 
+    if (rc == SC_COLUMN_ADDED && newdb->odh && newdb->instant_schema_change &&
+        blob_length_changed(olddb, newdb, oldsc, newsc)) {
+        rc = SC_TAG_CHANGE;
+        subtype = SC_TAG_CHANGE_BLOB_CHANGED;
+        info = ">    Blob changed in record length\n";
+        scprint(s, info);
+    }
+
+    if (rc == SC_COLUMN_ADDED && newdb->odh && newdb->instant_schema_change &&
+        reuses_dropped_column(olddb, oldsc, newsc)) {
+        rc = SC_TAG_CHANGE;
+        subtype = SC_TAG_CHANGE_COLUMN_DROPPED;
+        info = ">    New column reuses the name of a dropped column\n";
+        scprint(s, info);
+    }
+
     if (rc == SC_COLUMN_ADDED) {
         if (newdb->odh && newdb->instant_schema_change) {
             info = ">    Will perform instant schema change\n";
@@ -592,7 +592,7 @@ int live_sc_post_delete_int(struct ireq *iq, void *trans,
         return 0;
     }
 
-    if (is_genid_right_of_stripe_pointer(iq->usedb->handle, genid, iq->usedb->sc_from->sc_genids)) {
+    if (is_genid_right_of_sc_pointer(iq->usedb->sc_from, genid)) {
         return 0;
     }
 
@@ -689,7 +689,7 @@ int live_sc_post_add_int(struct ireq *iq, void *trans, unsigned long long genid,
         return 0;
     }
 
-    if (is_genid_right_of_stripe_pointer(iq->usedb->handle, genid, iq->usedb->sc_from->sc_genids)) {
+    if (is_genid_right_of_sc_pointer(iq->usedb->sc_from, genid)) {
         return 0;
     }
 
@@ -782,10 +782,8 @@ int live_sc_post_update_int(struct ireq *iq, void *trans,
         reqpushprefixf(iq, "live_sc_post_update: ");
     }
 
-    int is_oldgen_gt_scptr = is_genid_right_of_stripe_pointer(
-        iq->usedb->handle, oldgenid, sc_genids);
-    int is_newgen_gt_scptr = is_genid_right_of_stripe_pointer(
-        iq->usedb->handle, newgenid, sc_genids);
+    int is_oldgen_gt_scptr = is_genid_right_of_sc_pointer(iq->usedb->sc_from, oldgenid);
+    int is_newgen_gt_scptr = is_genid_right_of_sc_pointer(iq->usedb->sc_from, newgenid);
     int rc = 0;
 
     // spelling this out for legibility, various situations:
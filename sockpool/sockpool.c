@@ -35,8 +35,10 @@
 #include <arpa/inet.h>
 
 #include <errno.h>
+#include <poll.h>
 #include <pthread.h>
 #include <signal.h>
+#include <stdarg.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -49,7 +51,9 @@
 #include <pool.h>
 #include <passfd.h>
 #include <syslog.h>
+#include <sys/time.h>
 #include <sys_wrap.h>
+#include <comdb2_atomic.h>
 
 //#define SOCKET_POOL_DEBUG
 
@@ -59,6 +63,9 @@
 #define DBG(x)
 #endif
 
+/* Protects the connection to the global sockpool (sockpool_fd).  Pooled
+ * items live in shards, each with its own lock; when both are needed the
+ * shard lock is taken first. */
 pthread_mutex_t sockpool_lk = PTHREAD_MUTEX_INITIALIZER;
 
 /* This bit gets set by sockpool.tsk when it starts up to indicate that it is
@@ -79,9 +86,19 @@ struct stats {
     unsigned n_duped;
     unsigned n_trimmed;
     unsigned n_timeouts;
+    unsigned n_dead;
     unsigned peak_n_held;
 };
 
+/* Checkout latency histogram; bucket i counts checkouts that took
+ * [2^(i-1), 2^i) microseconds, the last bucket is open ended. */
+#define SOCKET_POOL_LAT_BUCKETS 24
+struct latency_hist {
+    unsigned buckets[SOCKET_POOL_LAT_BUCKETS];
+    unsigned long long total_usecs;
+    unsigned count;
+};
+
 /* We keep the item struct in our hash table even after the file descriptor
  * has been reused with an fd of -1.  This means we don't need to reallocate
  * memory when we recyle the same thing again (not a huge concern as this is
@@ -96,6 +113,7 @@ struct item {
     int dbnum;         /* if >0 this is associated with a database number */
     int flags;         /* passed in at donation time */
     int donation_time; /* epoch time of donation */
+    int64_t donation_seq; /* orders donations across shards */
     fd_destructor_fn destructor;
     void *destructor_arg;
 
@@ -118,13 +136,31 @@ struct itemtype {
     char typestr[1]; /* must be last thing in struct; this is hash table key */
 };
 
-static hash_t *hash = NULL;
-static pool_t *pool = NULL;
-static struct stats stats;
+/* The pool is split into shards by type string so that checkouts for
+ * different databases don't serialize on one mutex.  Each shard has its own
+ * hash, item allocator and lru list. */
+#define SOCKET_POOL_NSHARDS 16
+
+struct shard {
+    pthread_mutex_t lk;
+    hash_t *hash;
+    pool_t *pool;
+    /* List of active file descriptors; bottom of list is most recently added */
+    LISTC_T(struct item) lru_list;
+    struct stats stats;
+    struct latency_hist local_lat;  /* served from this shard */
+    struct latency_hist global_lat; /* round trip to sockpool */
+};
+
+static struct shard shards[SOCKET_POOL_NSHARDS];
+static pthread_once_t shards_once = PTHREAD_ONCE_INIT;
 static const struct stats empty_stats = {0};
 
-/* List of active file descriptors; bottom of list is most recently added */
-static LISTC_T(struct item) lru_list;
+/* Number of fds held across all shards, for max_active_fds */
+static int n_held;
+
+/* Source of item->donation_seq */
+static int64_t donation_seq;
 
 static unsigned max_active_fds = 16;
 
@@ -143,6 +179,66 @@ static unsigned sockpool_enabled = 1;
  * pooling maybe!).  This is protected by our bb_mutex of course. */
 static int sockpool_fd = -1;
 
+static void shards_init(void)
+{
+    int i;
+    for (i = 0; i < SOCKET_POOL_NSHARDS; i++) {
+        Pthread_mutex_init(&shards[i].lk, NULL);
+        listc_init(&shards[i].lru_list, offsetof(struct item, lru_linkv));
+    }
+}
+
+static struct shard *get_shard(const char *typestr)
+{
+    /* FNV-1a over the type string, which leads with dbname and type */
+    unsigned h = 2166136261u;
+    pthread_once(&shards_once, shards_init);
+    for (; *typestr; typestr++)
+        h = (h ^ (unsigned char)*typestr) * 16777619u;
+    return &shards[h % SOCKET_POOL_NSHARDS];
+}
+
+static inline long long now_usecs(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (long long)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+static void latency_record(struct latency_hist *h, long long usecs)
+{
+    int b = 0;
+    if (usecs < 0)
+        usecs = 0;
+    while (b < SOCKET_POOL_LAT_BUCKETS - 1 && usecs >= (1LL << b))
+        b++;
+    h->buckets[b]++;
+    h->total_usecs += usecs;
+    h->count++;
+}
+
+/* Returns 1 if a pooled, idle socket still looks usable.  An idle
+ * connection should have nothing to read: EOF or an error means the server
+ * went away (or restarted) while the fd sat in the pool. */
+static int item_is_healthy(int fd)
+{
+    struct pollfd pfd = {.fd = fd, .events = POLLIN};
+    char c;
+    int rc = poll(&pfd, 1, 0);
+    if (rc == 0)
+        return 1;
+    if (rc < 0)
+        return errno == EINTR;
+    if (pfd.revents & (POLLERR | POLLHUP | POLLNVAL))
+        return 0;
+    if (pfd.revents & POLLIN) {
+        rc = recv(fd, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+        if (rc == 0 || (rc < 0 && errno != EAGAIN && errno != EWOULDBLOCK))
+            return 0;
+    }
+    return 1;
+}
+
 /* to be called ONLY from pekludgl_fork() */
 void socket_pool_reset_connection_(void)
 {
@@ -295,8 +391,9 @@ static void default_destructor(enum socket_pool_event event,
              event == SOCKET_POOL_EVENT_DUP ||
              event == SOCKET_POOL_EVENT_ENDEVENT) &&
             sockpool_enabled && SOCKPOOL_ENABLED()) {
-            /* Donate this socket to the global socket pool.  We know that the
-             * mutex is held. */
+            /* Donate this socket to the global socket pool.  We may be
+             * holding a shard lock, which orders before sockpool_lk. */
+            Pthread_mutex_lock(&sockpool_lk);
             hold_sigpipe_ll(1);
             if (sockpool_fd == -1) {
                 sockpool_fd = open_sockpool_ll();
@@ -325,6 +422,7 @@ static void default_destructor(enum socket_pool_event event,
                      __func__, fd, typestr, ttl, dbnum, rc));
             }
             hold_sigpipe_ll(0);
+            Pthread_mutex_unlock(&sockpool_lk);
         }
 
         /* Close the local file descriptor regardless of whether or not it
@@ -349,38 +447,102 @@ static void destroy_item_ll(enum socket_pool_event event, struct item *item)
                      item->flags, ttl, item->destructor_arg);
 }
 
-static void socket_pool_trim_ll(unsigned max, enum socket_pool_event event)
+/* Remove an item from its shard and release it.  Call with the shard
+ * lock held. */
+static void remove_item_ll(struct shard *sh, struct item *item)
 {
-    if (hash && lru_list.count > max) {
-        struct item *tmpp, *item;
-        /* The lru list has the most recent donations at its end, so this
-         * way we free the oldest sockets first. */
-        LISTC_FOR_EACH_SAFE(&lru_list, item, tmpp, lru_linkv)
-        {
-            DBG(("%s: closing fd %d for %s\n", __func__, item->fd,
-                 item->type->typestr));
-            destroy_item_ll(event, item);
-            item->type->stats.n_trimmed++;
-            stats.n_trimmed++;
-            listc_rfl(&lru_list, item);
-            listc_rfl(&item->type->item_list, item);
-            pool_relablk(pool, item);
-            if (lru_list.count <= max) {
-                break;
+    listc_rfl(&sh->lru_list, item);
+    listc_rfl(&item->type->item_list, item);
+    pool_relablk(sh->pool, item);
+    ATOMIC_ADD32(n_held, -1);
+}
+
+/* Trim the oldest items of one shard until the pool holds no more than max
+ * fds overall, or the shard is empty. */
+static void socket_pool_trim_shard_ll(struct shard *sh, unsigned max,
+                                      enum socket_pool_event event)
+{
+    struct item *tmpp, *item;
+    if (!sh->hash)
+        return;
+    /* The lru list has the most recent donations at its end, so this
+     * way we free the oldest sockets first. */
+    LISTC_FOR_EACH_SAFE(&sh->lru_list, item, tmpp, lru_linkv)
+    {
+        if ((unsigned)ATOMIC_LOAD32(n_held) <= max)
+            break;
+        DBG(("%s: closing fd %d for %s\n", __func__, item->fd,
+             item->type->typestr));
+        destroy_item_ll(event, item);
+        item->type->stats.n_trimmed++;
+        sh->stats.n_trimmed++;
+        remove_item_ll(sh, item);
+    }
+}
+
+/* Trim the whole pool down to max fds, oldest donation first across all
+ * shards.  The caller's shard (if any, and locked) is always searched;
+ * other shards are only searched if their lock is free so that a donation
+ * never waits on an unrelated checkout.  keep (the item just donated) is
+ * never evicted. */
+static void socket_pool_trim(struct shard *locked, unsigned max,
+                             enum socket_pool_event event, int wait,
+                             const struct item *keep)
+{
+    struct shard *held[SOCKET_POOL_NSHARDS];
+    int i, nheld = 0;
+
+    if ((unsigned)ATOMIC_LOAD32(n_held) <= max)
+        return;
+    /* Callers that wait hold no shard lock, so taking them all in order
+     * can't deadlock against a donor's trylocks. */
+    for (i = 0; i < SOCKET_POOL_NSHARDS; i++) {
+        struct shard *sh = &shards[i];
+        if (sh != locked) {
+            if (wait)
+                Pthread_mutex_lock(&sh->lk);
+            else if (pthread_mutex_trylock(&sh->lk) != 0)
+                continue;
+        }
+        held[nheld++] = sh;
+    }
+
+    while ((unsigned)ATOMIC_LOAD32(n_held) > max) {
+        struct shard *oldest_sh = NULL;
+        struct item *oldest = NULL;
+        for (i = 0; i < nheld; i++) {
+            struct item *item;
+            if (!held[i]->hash)
+                continue;
+            /* The lru list has the most recent donations at its end */
+            item = LISTC_TOP(&held[i]->lru_list);
+            if (item == keep)
+                item = LISTC_NEXT(item, lru_linkv);
+            if (item && (!oldest || item->donation_seq < oldest->donation_seq)) {
+                oldest = item;
+                oldest_sh = held[i];
             }
         }
+        if (!oldest)
+            break;
+        DBG(("%s: closing fd %d for %s\n", __func__, oldest->fd,
+             oldest->type->typestr));
+        destroy_item_ll(event, oldest);
+        oldest->type->stats.n_trimmed++;
+        oldest_sh->stats.n_trimmed++;
+        remove_item_ll(oldest_sh, oldest);
     }
+
+    for (i = 0; i < nheld; i++)
+        if (held[i] != locked)
+            Pthread_mutex_unlock(&held[i]->lk);
 }
 
 /* Close all sockets in the pool. */
 void socket_pool_close_all(void)
 {
-
-    Pthread_mutex_lock(&sockpool_lk);
-    if (hash) {
-        socket_pool_trim_ll(0, SOCKET_POOL_EVENT_CLOSE);
-    }
-    Pthread_mutex_unlock(&sockpool_lk);
+    pthread_once(&shards_once, shards_init);
+    socket_pool_trim(NULL, 0, SOCKET_POOL_EVENT_CLOSE, 1, NULL);
 }
 
 void socket_pool_close_all_(void) { socket_pool_close_all(); }
@@ -395,58 +557,96 @@ void socket_pool_end_event_(void) { socket_pool_end_event(); }
 
 void socket_pool_end_event(void)
 {
-    Pthread_mutex_lock(&sockpool_lk);
-    if (hash) {
-        socket_pool_trim_ll(0, SOCKET_POOL_EVENT_ENDEVENT);
-    }
-    Pthread_mutex_unlock(&sockpool_lk);
+    pthread_once(&shards_once, shards_init);
+    socket_pool_trim(NULL, 0, SOCKET_POOL_EVENT_ENDEVENT, 1, NULL);
 }
 
 /* Close all pooled sockets and free all memory used by the pool. */
 void socket_pool_free_all(void)
 {
-    Pthread_mutex_lock(&sockpool_lk);
-    if (hash) {
-        socket_pool_trim_ll(0, SOCKET_POOL_EVENT_CLOSE);
-        hash_for(hash, socket_pool_free_callback, NULL);
-        hash_free(hash);
-        pool_free(pool);
-        hash = NULL;
-        pool = NULL;
+    int i;
+    pthread_once(&shards_once, shards_init);
+    for (i = 0; i < SOCKET_POOL_NSHARDS; i++) {
+        struct shard *sh = &shards[i];
+        Pthread_mutex_lock(&sh->lk);
+        if (sh->hash) {
+            socket_pool_trim_shard_ll(sh, 0, SOCKET_POOL_EVENT_CLOSE);
+            hash_for(sh->hash, socket_pool_free_callback, NULL);
+            hash_free(sh->hash);
+            pool_free(sh->pool);
+            sh->hash = NULL;
+            sh->pool = NULL;
+        }
+        Pthread_mutex_unlock(&sh->lk);
     }
-    Pthread_mutex_unlock(&sockpool_lk);
 }
 
 void socket_pool_free_all_(void) { socket_pool_free_all(); }
 
-/* Check for sockets that have timed out and close them */
+/* Close sockets that have timed out, and sockets whose server end has gone
+ * away while they were pooled. */
 void socket_pool_timeout(void)
 {
-    Pthread_mutex_lock(&sockpool_lk);
-    if (hash) {
-        int now;
+    int i, now;
+    pthread_once(&shards_once, shards_init);
+    now = comdb2_time_epoch_sp();
+    for (i = 0; i < SOCKET_POOL_NSHARDS; i++) {
+        struct shard *sh = &shards[i];
         struct item *tmpp, *item;
-        now = comdb2_time_epoch_sp();
-        LISTC_FOR_EACH_SAFE(&lru_list, item, tmpp, lru_linkv)
-        {
-            if (item->timeout_secs > 0 &&
-                now >= item->donation_time + item->timeout_secs) {
-                DBG(("%s: closing fd %d for %s\n", __func__, item->fd,
-                     item->type->typestr));
-                destroy_item_ll(SOCKET_POOL_EVENT_TIMEOUT, item);
-                item->type->stats.n_timeouts++;
-                stats.n_timeouts++;
-                listc_rfl(&lru_list, item);
-                listc_rfl(&item->type->item_list, item);
-                pool_relablk(pool, item);
+        Pthread_mutex_lock(&sh->lk);
+        if (sh->hash) {
+            LISTC_FOR_EACH_SAFE(&sh->lru_list, item, tmpp, lru_linkv)
+            {
+                if (item->timeout_secs > 0 &&
+                    now >= item->donation_time + item->timeout_secs) {
+                    DBG(("%s: closing fd %d for %s\n", __func__, item->fd,
+                         item->type->typestr));
+                    destroy_item_ll(SOCKET_POOL_EVENT_TIMEOUT, item);
+                    item->type->stats.n_timeouts++;
+                    sh->stats.n_timeouts++;
+                    remove_item_ll(sh, item);
+                } else if (!item_is_healthy(item->fd)) {
+                    DBG(("%s: dead fd %d for %s\n", __func__, item->fd,
+                         item->type->typestr));
+                    destroy_item_ll(SOCKET_POOL_EVENT_DEAD, item);
+                    item->type->stats.n_dead++;
+                    sh->stats.n_dead++;
+                    remove_item_ll(sh, item);
+                }
             }
         }
+        Pthread_mutex_unlock(&sh->lk);
     }
-    Pthread_mutex_unlock(&sockpool_lk);
 }
 
 void socket_pool_timeout_(void) { socket_pool_timeout(); }
 
+/* Close every pooled socket whose type string starts with prefix, e.g.
+ * "comdb2/mydb/" after a connection to mydb failed. */
+void socket_pool_evict(const char *prefix)
+{
+    int i;
+    size_t len = strlen(prefix);
+    pthread_once(&shards_once, shards_init);
+    for (i = 0; i < SOCKET_POOL_NSHARDS; i++) {
+        struct shard *sh = &shards[i];
+        struct item *tmpp, *item;
+        Pthread_mutex_lock(&sh->lk);
+        if (sh->hash) {
+            LISTC_FOR_EACH_SAFE(&sh->lru_list, item, tmpp, lru_linkv)
+            {
+                if (strncmp(item->type->typestr, prefix, len) == 0) {
+                    destroy_item_ll(SOCKET_POOL_EVENT_DEAD, item);
+                    item->type->stats.n_dead++;
+                    sh->stats.n_dead++;
+                    remove_item_ll(sh, item);
+                }
+            }
+        }
+        Pthread_mutex_unlock(&sh->lk);
+    }
+}
+
 struct stats_args {
     int all;
     int reset;
@@ -454,6 +654,16 @@ struct stats_args {
     FILE *fh;
 };
 
+static void stats_printf(const struct stats_args *args, const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    if (args->syslog)
+        vsyslog(LOG_INFO, fmt, ap);
+    else
+        vfprintf(args->fh, fmt, ap);
+    va_end(ap);
+}
 
 static int socket_pool_stats_callback(void *obj, void *voidarg)
 {
@@ -461,19 +671,12 @@ static int socket_pool_stats_callback(void *obj, void *voidarg)
     struct itemtype *type = obj;
     if (args->all ||
         memcmp(&type->stats, &empty_stats, sizeof(struct stats)) != 0) {
-        if (args->syslog) {
-            syslog(LOG_INFO, "%-32s [%2d/%2u] %5u, %5u (%u, %u, %u)\n",
-                    type->typestr, listc_size(&type->item_list),
-                    type->stats.peak_n_held, type->stats.n_donated,
-                    type->stats.n_reused, type->stats.n_duped,
-                    type->stats.n_trimmed, type->stats.n_timeouts);
-        } else {
-            fprintf(args->fh, "%-32s [%2d/%2u] %5u, %5u (%u, %u, %u)\n",
-                    type->typestr, listc_size(&type->item_list),
-                    type->stats.peak_n_held, type->stats.n_donated,
-                    type->stats.n_reused, type->stats.n_duped,
-                    type->stats.n_trimmed, type->stats.n_timeouts);
-        }
+        stats_printf(args, "%-32s [%2d/%2u] %5u, %5u (%u, %u, %u, %u)\n",
+                     type->typestr, listc_size(&type->item_list),
+                     type->stats.peak_n_held, type->stats.n_donated,
+                     type->stats.n_reused, type->stats.n_duped,
+                     type->stats.n_trimmed, type->stats.n_timeouts,
+                     type->stats.n_dead);
         if (args->reset) {
             bzero(&type->stats, sizeof(type->stats));
         }
@@ -481,6 +684,107 @@ static int socket_pool_stats_callback(void *obj, void *voidarg)
     return 0;
 }
 
+static void latency_merge(struct latency_hist *to, const struct latency_hist *from)
+{
+    int i;
+    for (i = 0; i < SOCKET_POOL_LAT_BUCKETS; i++)
+        to->buckets[i] += from->buckets[i];
+    to->total_usecs += from->total_usecs;
+    to->count += from->count;
+}
+
+/* Upper bound in usecs of the bucket holding the given percentile */
+static long long latency_percentile(const struct latency_hist *h, double pct)
+{
+    unsigned target, seen = 0;
+    int i;
+    if (h->count == 0)
+        return 0;
+    target = (unsigned)(h->count * pct / 100.0);
+    if (target >= h->count)
+        target = h->count - 1;
+    for (i = 0; i < SOCKET_POOL_LAT_BUCKETS; i++) {
+        seen += h->buckets[i];
+        if (seen > target)
+            break;
+    }
+    return 1LL << i;
+}
+
+static void latency_dump(const struct stats_args *args, const char *name,
+                         const struct latency_hist *h)
+{
+    int i;
+    if (h->count == 0)
+        return;
+    stats_printf(args,
+                 "%s checkouts %u avg %lldus p50 <%lldus p99 <%lldus "
+                 "p999 <%lldus\n",
+                 name, h->count, (long long)(h->total_usecs / h->count),
+                 latency_percentile(h, 50), latency_percentile(h, 99),
+                 latency_percentile(h, 99.9));
+    if (!args->all)
+        return;
+    for (i = 0; i < SOCKET_POOL_LAT_BUCKETS; i++) {
+        if (h->buckets[i])
+            stats_printf(args, "    <%-10lld %u\n", 1LL << i, h->buckets[i]);
+    }
+}
+
+static void socket_pool_dump_stats_int(struct stats_args *args,
+                                       int incl_hash_stats)
+{
+    struct stats total = {0};
+    struct latency_hist local_lat = {{0}}, global_lat = {{0}};
+    int i, used = 0, held = 0;
+
+    stats_printf(args, "Socket pool stats, enabled=%d, sockpool enabled=%d\n",
+                 enabled, sockpool_enabled);
+    pthread_once(&shards_once, shards_init);
+    for (i = 0; i < SOCKET_POOL_NSHARDS; i++) {
+        struct shard *sh = &shards[i];
+        Pthread_mutex_lock(&sh->lk);
+        if (sh->hash) {
+            used = 1;
+            hash_for(sh->hash, socket_pool_stats_callback, args);
+            held += listc_size(&sh->lru_list);
+            total.n_donated += sh->stats.n_donated;
+            total.n_reused += sh->stats.n_reused;
+            total.n_duped += sh->stats.n_duped;
+            total.n_trimmed += sh->stats.n_trimmed;
+            total.n_timeouts += sh->stats.n_timeouts;
+            total.n_dead += sh->stats.n_dead;
+            if (sh->stats.peak_n_held > total.peak_n_held)
+                total.peak_n_held = sh->stats.peak_n_held;
+            if (incl_hash_stats && !args->syslog) {
+                fprintf(args->fh, "shard %d hash table statistics:\n", i);
+                hash_dump_stats(sh->hash, args->fh, NULL);
+            }
+        }
+        latency_merge(&local_lat, &sh->local_lat);
+        latency_merge(&global_lat, &sh->global_lat);
+        if (args->reset) {
+            bzero(&sh->stats, sizeof(sh->stats));
+            bzero(&sh->local_lat, sizeof(sh->local_lat));
+            bzero(&sh->global_lat, sizeof(sh->global_lat));
+        }
+        Pthread_mutex_unlock(&sh->lk);
+    }
+    if (used) {
+        stats_printf(args, "%-32s [%2d/%2u] %5u, %5u (%u, %u, %u, %u)\n",
+                     "Global stats:", held, total.peak_n_held,
+                     total.n_donated, total.n_reused, total.n_duped,
+                     total.n_trimmed, total.n_timeouts, total.n_dead);
+        stats_printf(args, "Counters are: [fds held/peak held] num donated, "
+                           "num reused (num duped, trimmed, timed out, "
+                           "dead)\n");
+    } else {
+        stats_printf(args, "Socket pool unused\n");
+    }
+    latency_dump(args, "local", &local_lat);
+    latency_dump(args, "global", &global_lat);
+}
+
 /* Write stats to dbglog and reset all stats */
 void socket_pool_dump_stats(FILE *fh, int reset, int all)
 {
@@ -489,49 +793,15 @@ void socket_pool_dump_stats(FILE *fh, int reset, int all)
 
 void socket_pool_dump_stats_syslog(int reset, int all)
 {
-    syslog(LOG_INFO, "Socket pool stats, enabled=%d, sockpool enabled=%d\n", enabled,
-            sockpool_enabled);
-    Pthread_mutex_lock(&sockpool_lk);
-    if (hash) {
-        struct stats_args args = {all, reset, 1, NULL};
-        hash_for(hash, socket_pool_stats_callback, &args);
-        syslog(LOG_INFO, "%-32s [%2d/%2u] %5u, %5u (%u, %u, %u)\n", "Global stats:",
-                listc_size(&lru_list), stats.peak_n_held, stats.n_donated,
-                stats.n_reused, stats.n_duped, stats.n_trimmed,
-                stats.n_timeouts);
-        syslog(LOG_INFO, "Counters are: [fds held/peak held] num donated, num "
-                    "reused (num duped, trimmed, timed out)\n");
-
-    } else {
-        syslog(LOG_INFO, "Socket pool unused\n");
-    }
-    Pthread_mutex_unlock(&sockpool_lk);
+    struct stats_args args = {all, reset, 1, NULL};
+    socket_pool_dump_stats_int(&args, 0);
 }
 
 void socket_pool_dump_stats_ex(FILE *fh, int reset, int all,
                                int incl_hash_stats)
 {
-    fprintf(fh, "Socket pool stats, enabled=%d, sockpool enabled=%d\n", enabled,
-            sockpool_enabled);
-    Pthread_mutex_lock(&sockpool_lk);
-    if (hash) {
-        struct stats_args args = {all, reset, 0, fh};
-        hash_for(hash, socket_pool_stats_callback, &args);
-        fprintf(fh, "%-32s [%2d/%2u] %5u, %5u (%u, %u, %u)\n", "Global stats:",
-                listc_size(&lru_list), stats.peak_n_held, stats.n_donated,
-                stats.n_reused, stats.n_duped, stats.n_trimmed,
-                stats.n_timeouts);
-        fprintf(fh, "Counters are: [fds held/peak held] num donated, num "
-                    "reused (num duped, trimmed, timed out)\n");
-        /* hash_dump uses printf... */
-        if (incl_hash_stats) {
-            fprintf(fh, "socket pool hash table statistics:\n");
-            hash_dump_stats(hash, fh, NULL);
-        }
-    } else {
-        fprintf(fh, "Socket pool unused\n");
-    }
-    Pthread_mutex_unlock(&sockpool_lk);
+    struct stats_args args = {all, reset, 0, fh};
+    socket_pool_dump_stats_int(&args, incl_hash_stats);
 }
 
 void socket_pool_dump_stats_(const int *reset, const int *all)
@@ -553,12 +823,14 @@ socket_pool_get_ext_ll(const char *typestr, int dbnum, int flags,
                        void *context, int *hint)
 {
     int fd = -1;
+    struct shard *sh = get_shard(typestr);
+    long long start = now_usecs();
     if (enabled) {
-        Pthread_mutex_lock(&sockpool_lk);
-        if (hash) {
+        Pthread_mutex_lock(&sh->lk);
+        if (sh->hash) {
             struct item *fnd_item;
             struct itemtype *fnd_type;
-            fnd_type = hash_find(hash, typestr);
+            fnd_type = hash_find(sh->hash, typestr);
             /* Try least recently donated items first. */
             while (fnd_type && fd == -1 &&
                    (fnd_item = listc_rbl(&fnd_type->item_list)) != NULL) {
@@ -574,20 +846,30 @@ socket_pool_get_ext_ll(const char *typestr, int dbnum, int flags,
                          comdb2_time_epoch_sp()));
                     destroy_item_ll(SOCKET_POOL_EVENT_TIMEOUT, fnd_item);
                     fnd_type->stats.n_timeouts++;
-                    stats.n_timeouts++;
+                    sh->stats.n_timeouts++;
+                } else if (!item_is_healthy(fnd_item->fd)) {
+                    /* Server closed it while it was pooled */
+                    DBG(("%s: fd %d dead for %s\n", __func__, fnd_item->fd,
+                         fnd_type->typestr));
+                    destroy_item_ll(SOCKET_POOL_EVENT_DEAD, fnd_item);
+                    fnd_type->stats.n_dead++;
+                    sh->stats.n_dead++;
                 } else {
                     fd = fnd_item->fd;
                     destroy_item_ll(SOCKET_POOL_EVENT_DONATE, fnd_item);
                     fnd_type->stats.n_reused++;
-                    stats.n_reused++;
+                    sh->stats.n_reused++;
                     DBG(("%s: fd %d for %s\n", __func__, fd,
                          fnd_type->typestr));
                 }
-                listc_rfl(&lru_list, fnd_item);
-                pool_relablk(pool, fnd_item);
+                listc_rfl(&sh->lru_list, fnd_item);
+                pool_relablk(sh->pool, fnd_item);
+                ATOMIC_ADD32(n_held, -1);
             }
         }
-        Pthread_mutex_unlock(&sockpool_lk);
+        if (fd != -1)
+            latency_record(&sh->local_lat, now_usecs() - start);
+        Pthread_mutex_unlock(&sh->lk);
     }
     /* If we couldn't get this socket locally it may be available from the
      * global socket pool. */
@@ -652,6 +934,10 @@ socket_pool_get_ext_ll(const char *typestr, int dbnum, int flags,
         }
         hold_sigpipe_ll(0);
         Pthread_mutex_unlock(&sockpool_lk);
+
+        Pthread_mutex_lock(&sh->lk);
+        latency_record(&sh->global_lat, now_usecs() - start);
+        Pthread_mutex_unlock(&sh->lk);
     }
     return fd;
 }
@@ -689,27 +975,27 @@ void socket_pool_donate_ext(const char *typestr, int fd, int timeout_secs,
     if (!destructor)
         destructor = default_destructor;
     if (enabled && !(flags & SOCKET_POOL_DONATE_NOLOCAL)) {
-        Pthread_mutex_lock(&sockpool_lk);
-        if (!hash) {
-            hash = hash_init_str(offsetof(struct itemtype, typestr));
-            if (!hash) {
+        struct shard *sh = get_shard(typestr);
+        Pthread_mutex_lock(&sh->lk);
+        if (!sh->hash) {
+            sh->hash = hash_init_str(offsetof(struct itemtype, typestr));
+            if (!sh->hash) {
                 fprintf(stderr, "%s: cannot init hash table\n", __func__);
             } else {
-                pool = pool_init(sizeof(struct item), 0);
-                if (!pool) {
+                sh->pool = pool_init(sizeof(struct item), 0);
+                if (!sh->pool) {
                     fprintf(stderr, "%s: cannot init pool\n", __func__);
-                    hash_free(hash);
-                    hash = NULL;
+                    hash_free(sh->hash);
+                    sh->hash = NULL;
                 }
-                listc_init(&lru_list, offsetof(struct item, lru_linkv));
             }
         }
-        if (hash) {
+        if (sh->hash) {
             struct item *item;
             struct itemtype *type;
 
             /* First find or allocate an item type head */
-            type = hash_find(hash, typestr);
+            type = hash_find(sh->hash, typestr);
             if (!type) {
                 int len;
                 len = strlen(typestr);
@@ -723,7 +1009,7 @@ void socket_pool_donate_ext(const char *typestr, int fd, int timeout_secs,
                     bzero(&type->stats, sizeof(type->stats));
                     bzero(&type->dbgstats, sizeof(type->dbgstats));
                     memcpy(type->typestr, typestr, len + 1);
-                    if (hash_add(hash, type) != 0) {
+                    if (hash_add(sh->hash, type) != 0) {
                         free(type);
                         type = NULL;
                         fprintf(stderr, "%s(%s):hash_add failed\n", __func__,
@@ -742,12 +1028,13 @@ void socket_pool_donate_ext(const char *typestr, int fd, int timeout_secs,
                          item->type->typestr));
                     destroy_item_ll(SOCKET_POOL_EVENT_DUP, item);
                     type->stats.n_duped++;
-                    stats.n_duped++;
-                    listc_rfl(&lru_list, item);
-                    pool_relablk(pool, item);
+                    sh->stats.n_duped++;
+                    listc_rfl(&sh->lru_list, item);
+                    pool_relablk(sh->pool, item);
+                    ATOMIC_ADD32(n_held, -1);
                 }
 
-                item = pool_getablk(pool);
+                item = pool_getablk(sh->pool);
                 if (!item) {
                     fprintf(stderr, "%s(%s): pool_getablk failed\n", __func__,
                             typestr);
@@ -756,11 +1043,13 @@ void socket_pool_donate_ext(const char *typestr, int fd, int timeout_secs,
                     DBG(("%s: pooled fd %d for %s dbnum %d timeout %d\n",
                          __func__, fd, typestr, dbnum, timeout_secs));
                     listc_abl(&type->item_list, item);
-                    listc_abl(&lru_list, item);
+                    listc_abl(&sh->lru_list, item);
+                    ATOMIC_ADD32(n_held, 1);
                     type->stats.n_donated++;
-                    stats.n_donated++;
+                    sh->stats.n_donated++;
                     item->timeout_secs = timeout_secs;
                     item->donation_time = comdb2_time_epoch_sp();
+                    item->donation_seq = ATOMIC_ADD64(donation_seq, 1);
                     item->flags = flags;
                     item->dbnum = dbnum;
                     item->destructor = destructor;
@@ -771,8 +1060,8 @@ void socket_pool_donate_ext(const char *typestr, int fd, int timeout_secs,
                     if (num_fds > type->stats.peak_n_held) {
                         type->stats.peak_n_held = num_fds;
                     }
-                    if (num_fds > stats.peak_n_held) {
-                        stats.peak_n_held = num_fds;
+                    if (num_fds > sh->stats.peak_n_held) {
+                        sh->stats.peak_n_held = num_fds;
                     }
                     DBG(("item->timeout_secs=%d item->donation_time=%d\n",
                          item->timeout_secs, item->donation_time));
@@ -785,17 +1074,16 @@ void socket_pool_donate_ext(const char *typestr, int fd, int timeout_secs,
              * we may have been on the edge but the donation may not tip us
              * over if we close an old file descriptor for this typestr. */
             if (max_active_fds > 0) {
-                socket_pool_trim_ll(max_active_fds, SOCKET_POOL_EVENT_TRIM);
+                socket_pool_trim(sh, max_active_fds, SOCKET_POOL_EVENT_TRIM, 0,
+                                 pooled ? item : NULL);
             }
         }
-        Pthread_mutex_unlock(&sockpool_lk);
+        Pthread_mutex_unlock(&sh->lk);
     }
 
     /* if it wasn't pooled then it must be closed. */
     if (!pooled) {
-        Pthread_mutex_lock(&sockpool_lk);
         destructor(SOCKET_POOL_EVENT_CLOSE, typestr, fd, dbnum, flags,
                    timeout_secs, destructor_arg);
-        Pthread_mutex_unlock(&sockpool_lk);
     }
 }
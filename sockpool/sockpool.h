@@ -47,7 +47,9 @@ enum socket_pool_event {
                                        the same type string */
     SOCKET_POOL_EVENT_ENDEVENT = 4, /* socket is being discarded at the end
                                        of the event */
-    SOCKET_POOL_EVENT_TIMEOUT = 5   /* socket has timed out */
+    SOCKET_POOL_EVENT_TIMEOUT = 5,  /* socket has timed out */
+    SOCKET_POOL_EVENT_DEAD = 6      /* peer closed the socket or it was
+                                       evicted after an error */
 };
 
 enum socket_pool_flags {
@@ -62,7 +64,7 @@ enum socket_pool_flags {
 
 /* Destructor function.  This is called by the socket pool code when it
  * discards of a file descriptor for whatever reason (including donation).
- * Note that the socket pool bb mutex may or may not be held when this is
+ * Note that a socket pool shard mutex may or may not be held when this is
  * called so this should not call back in to socket pool apis. */
 typedef void (*fd_destructor_fn)(enum socket_pool_event event,
                                  const char *typestr, int fd, int dbnum,
@@ -129,10 +131,16 @@ void socket_pool_close_all_(void);
 void socket_pool_free_all(void);
 void socket_pool_free_all_(void);
 
-/* Check for sockets that have timed out and close them */
+/* Check for sockets that have timed out, or whose peer has closed them,
+ * and close them */
 void socket_pool_timeout(void);
 void socket_pool_timeout_(void);
 
+/* Close all pooled sockets whose type string starts with prefix.  Call this
+ * on a connection error to a database so that siblings of the broken
+ * socket aren't handed out. */
+void socket_pool_evict(const char *prefix);
+
 /* Event based request processors e.g. bigs should call this after each
  * event.  Based on paulbit settings we will either close all our sockets
  * or just timeout older sockets.  Also dump dbglog stats if dbg logging
@@ -0,0 +1,156 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#if (!defined(SQLITE_CORE) || defined(SQLITE_BUILDING_FOR_COMDB2)) &&          \
+    !defined(SQLITE_OMIT_VIRTUALTABLE)
+
+#if defined(SQLITE_BUILDING_FOR_COMDB2) && !defined(SQLITE_CORE)
+#define SQLITE_CORE 1
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <comdb2.h>
+#include <comdb2systblInt.h>
+#include <ezsystables.h>
+#include <bdb_api.h>
+
+/* Per-file buffer pool residency, read from the mpool file counters so it
+ * is cheap enough to poll; nothing here walks the buffer pool. */
+struct cache_residency_entry {
+    char *tablename;
+    char *type;
+    char *name;
+    int64_t filenum;
+    int64_t stripe;
+    int64_t pages;
+    int64_t dirty_pages;
+    int64_t gets;
+    int64_t misses;
+    int64_t evictions;
+    double hit_ratio;
+};
+
+struct cache_residency_ctx {
+    struct dbtable *db;
+    struct cache_residency_entry *entries;
+    int n;
+    int capacity;
+    int nomem;
+};
+
+static void release_cache_residency(void *data, int n)
+{
+    struct cache_residency_entry *e = data;
+    for (int i = 0; i < n; i++) {
+        free(e[i].tablename);
+        free(e[i].name);
+    }
+    free(data);
+}
+
+static void add_cache_residency(const struct bdb_cache_file_stats *st, void *arg)
+{
+    struct cache_residency_ctx *ctx = arg;
+    struct cache_residency_entry *e;
+
+    if (ctx->nomem)
+        return;
+    if (ctx->n == ctx->capacity) {
+        int capacity = ctx->capacity ? ctx->capacity * 2 : 64;
+        void *space = realloc(ctx->entries, capacity * sizeof(*ctx->entries));
+        if (!space) {
+            ctx->nomem = 1;
+            return;
+        }
+        ctx->entries = space;
+        ctx->capacity = capacity;
+    }
+
+    e = &ctx->entries[ctx->n++];
+    memset(e, 0, sizeof(*e));
+    e->tablename = strdup(ctx->db->tablename);
+    switch (st->type) {
+    case BDB_CACHE_FILE_DATA:
+        e->type = "data";
+        break;
+    case BDB_CACHE_FILE_BLOB:
+        e->type = "blob";
+        break;
+    case BDB_CACHE_FILE_INDEX:
+        e->type = "index";
+        if (st->filenum < ctx->db->nix && ctx->db->ixschema[st->filenum]->csctag)
+            e->name = strdup(ctx->db->ixschema[st->filenum]->csctag);
+        break;
+    }
+    e->filenum = st->filenum;
+    e->stripe = st->stripe;
+    e->pages = st->pages;
+    e->dirty_pages = st->dirty_pages;
+    e->gets = st->hits + st->misses;
+    e->misses = st->misses;
+    e->evictions = st->evictions;
+    e->hit_ratio = e->gets ? (double)st->hits / e->gets : 0;
+}
+
+static int get_cache_residency(void **data, int *npoints)
+{
+    struct cache_residency_ctx ctx = {0};
+
+    for (int i = 0; i < thedb->num_dbs && !ctx.nomem; i++) {
+        ctx.db = thedb->dbs[i];
+        if (ctx.db->handle == NULL)
+            continue;
+        bdb_cache_residency(ctx.db->handle, add_cache_residency, &ctx);
+    }
+    if (ctx.nomem) {
+        release_cache_residency(ctx.entries, ctx.n);
+        return SQLITE_NOMEM;
+    }
+    *data = ctx.entries;
+    *npoints = ctx.n;
+    return 0;
+}
+
+static sqlite3_module systblCacheResidencyModule = {
+    .access_flag = CDB2_ALLOW_USER,
+    .systable_lock_count = 1,
+    .systable_locks = (const char *[]){ "comdb2_tables" }
+};
+
+int systblCacheResidencyInit(sqlite3 *db)
+{
+    return create_system_table(
+        db, "comdb2_cache_residency", &systblCacheResidencyModule,
+        get_cache_residency, release_cache_residency,
+        sizeof(struct cache_residency_entry),
+        CDB2_CSTRING, "tablename", -1, offsetof(struct cache_residency_entry, tablename),
+        CDB2_CSTRING, "type", -1, offsetof(struct cache_residency_entry, type),
+        CDB2_CSTRING, "name", -1, offsetof(struct cache_residency_entry, name),
+        CDB2_INTEGER, "filenum", -1, offsetof(struct cache_residency_entry, filenum),
+        CDB2_INTEGER, "stripe", -1, offsetof(struct cache_residency_entry, stripe),
+        CDB2_INTEGER, "pages", -1, offsetof(struct cache_residency_entry, pages),
+        CDB2_INTEGER, "dirty_pages", -1, offsetof(struct cache_residency_entry, dirty_pages),
+        CDB2_INTEGER, "gets", -1, offsetof(struct cache_residency_entry, gets),
+        CDB2_INTEGER, "misses", -1, offsetof(struct cache_residency_entry, misses),
+        CDB2_INTEGER, "evictions", -1, offsetof(struct cache_residency_entry, evictions),
+        CDB2_REAL, "hit_ratio", -1, offsetof(struct cache_residency_entry, hit_ratio),
+        SYSTABLE_END_OF_FIELDS);
+}
+
+#endif /* (!defined(SQLITE_CORE) || defined(SQLITE_BUILDING_FOR_COMDB2))       \
+          && !defined(SQLITE_OMIT_VIRTUALTABLE) */
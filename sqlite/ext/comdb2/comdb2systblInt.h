@@ -59,6 +59,10 @@ extern sqlite3_module systblTimepartPermissionsModule;
 extern sqlite3_module systblRulesetsModule;
 
 int systblTriggersInit(sqlite3 *);
+int systblQueuePartitionsInit(sqlite3 *);
+int systblWaitEventsInit(sqlite3 *);
+int systblCacheResidencyInit(sqlite3 *);
+int systblLatencyHistogramsInit(sqlite3 *);
 int systblTablesInit(sqlite3 *db);
 int systblColumnsInit(sqlite3 *db);
 int systblTagsInit(sqlite3 *db);
@@ -81,6 +85,7 @@ int systblCronInit(sqlite3*db);
 int systblFingerprintsInit(sqlite3 *);
 int systblSampleQueriesInit(sqlite3 *db);
 int systblQueryPlansInit(sqlite3 *db);
+int systblQueryPlanBaselinesInit(sqlite3 *db);
 int systblViewsInit(sqlite3 *);
 int systblSQLClientStats(sqlite3 *);
 int systblSQLIndexStatsInit(sqlite3 *);
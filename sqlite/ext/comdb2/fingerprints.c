@@ -42,6 +42,13 @@ struct fingerprint_track_systbl {
     int64_t total_replication_pagein_read;    /* Page-ins from applying this statement's
                                                  writes off the log, on a replicant */
     int64_t total_replication_pagein_read_io; /* Subset of the above that required disk I/O */
+    int64_t total_cache_misses;     /* Cumulative bufferpool misses */
+    int64_t total_lock_waits;       /* Cumulative number of lock waits */
+    int64_t total_lock_wait_time;   /* Cumulative lock wait time (ms) */
+    int64_t total_log_bytes;        /* Cumulative log bytes, including the
+                                       master's write-apply */
+    int64_t total_temp_spills;      /* Cumulative temp tables spilled to disk */
+    int64_t total_temp_spill_bytes; /* Cumulative bytes spilled by temp tables */
     char *has_query_info; /* 'Y' if this node has the full query text (a
                              gbl_fingerprint_hash entry); 'N' for rtstats-only
                              fingerprints (e.g. master write-apply accounting) */
@@ -90,7 +97,7 @@ static void rtstats_merge_cb(const unsigned char *fingerprint, const uint64_t *c
     struct fingerprint_track_systbl *row;
     (void)has_main_entry;
 
-    if (counts[2] == 0 && counts[3] == 0 && counts[4] == 0 && counts[5] == 0)
+    if (counts[2] == 0 && counts[3] == 0 && counts[4] == 0 && counts[5] == 0 && counts[6] == 0)
         return; /* no apply-side activity -- read-side-only/in-flight entry */
     if (ctx->seen != NULL && hash_find(ctx->seen, fingerprint) != NULL)
         return; /* already emitted above with full query info */
@@ -111,6 +118,7 @@ static void rtstats_merge_cb(const unsigned char *fingerprint, const uint64_t *c
     row->total_write_pagein_read_io = counts[3];
     row->total_replication_pagein_read = counts[4];
     row->total_replication_pagein_read_io = counts[5];
+    row->total_log_bytes = counts[6];
     ctx->copied++;
 }
 
@@ -160,6 +168,12 @@ static int fingerprints_callback(void **data, int *npoints)
             pFp[copied].time = pEntry->time;
             pFp[copied].prepTime = pEntry->prepTime;
             pFp[copied].rows = pEntry->rows;
+            pFp[copied].total_cache_misses = pEntry->cache_misses;
+            pFp[copied].total_lock_waits = pEntry->lock_waits;
+            pFp[copied].total_lock_wait_time = pEntry->lock_wait_us / 1000;
+            pFp[copied].total_log_bytes = pEntry->log_bytes;
+            pFp[copied].total_temp_spills = pEntry->temp_spills;
+            pFp[copied].total_temp_spill_bytes = pEntry->temp_spill_bytes;
             pFp[copied].excluded =
                 reqlog_fingerprint_is_excluded((char *)pEntry->fingerprint) ? "Y" : "N";
             pFp[copied].has_query_info = "Y";
@@ -175,6 +189,7 @@ static int fingerprints_callback(void **data, int *npoints)
             pFp[copied].total_write_pagein_read_io = counts[3];
             pFp[copied].total_replication_pagein_read = counts[4];
             pFp[copied].total_replication_pagein_read_io = counts[5];
+            pFp[copied].total_log_bytes += counts[6];
             /* remember this fingerprint so the rtstats merge below skips it */
             memcpy(&seen_keys[copied * FINGERPRINTSZ], pEntry->fingerprint, FINGERPRINTSZ);
             hash_add(seen, &seen_keys[copied * FINGERPRINTSZ]);
@@ -236,6 +251,18 @@ int systblFingerprintsInit(sqlite3 *db)
         offsetof(struct fingerprint_track_systbl, total_replication_pagein_read),
         CDB2_INTEGER, "total_replication_pagein_read_io", -1,
         offsetof(struct fingerprint_track_systbl, total_replication_pagein_read_io),
+        CDB2_INTEGER, "total_cache_misses", -1,
+        offsetof(struct fingerprint_track_systbl, total_cache_misses),
+        CDB2_INTEGER, "total_lock_waits", -1,
+        offsetof(struct fingerprint_track_systbl, total_lock_waits),
+        CDB2_INTEGER, "total_lock_wait_time", -1,
+        offsetof(struct fingerprint_track_systbl, total_lock_wait_time),
+        CDB2_INTEGER, "total_log_bytes", -1,
+        offsetof(struct fingerprint_track_systbl, total_log_bytes),
+        CDB2_INTEGER, "total_temp_spills", -1,
+        offsetof(struct fingerprint_track_systbl, total_temp_spills),
+        CDB2_INTEGER, "total_temp_spill_bytes", -1,
+        offsetof(struct fingerprint_track_systbl, total_temp_spill_bytes),
         CDB2_CSTRING, "normalized_sql", -1,
         offsetof(struct fingerprint_track_systbl, zNormSql),
         CDB2_CSTRING, "excluded_from_longreqs", -1,
@@ -0,0 +1,103 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#if (!defined(SQLITE_CORE) || defined(SQLITE_BUILDING_FOR_COMDB2)) &&          \
+    !defined(SQLITE_OMIT_VIRTUALTABLE)
+
+#if defined(SQLITE_BUILDING_FOR_COMDB2) && !defined(SQLITE_CORE)
+#define SQLITE_CORE 1
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <comdb2.h>
+#include <comdb2systblInt.h>
+#include <ezsystables.h>
+#include <perf.h>
+
+struct latency_histogram_entry {
+    char *name;
+    int64_t window_secs;
+    int64_t count;
+    int64_t p50;
+    int64_t p90;
+    int64_t p99;
+    int64_t p999;
+    int64_t max;
+    double mean;
+};
+
+static void release_latency_histograms(void *data, int n)
+{
+    free(data);
+}
+
+static int get_latency_histograms(void **data, int *npoints)
+{
+    struct latency_histogram_entry *entries;
+    struct latency_summary sum;
+    int n = 0;
+
+    entries = calloc(LATENCY_MAX * latency_hist_nwindows, sizeof(*entries));
+    if (entries == NULL)
+        return SQLITE_NOMEM;
+
+    for (int id = 0; id < LATENCY_MAX; id++) {
+        for (int w = 0; w < latency_hist_nwindows; w++) {
+            if (latency_hist_summary(id, latency_hist_windows[w], &sum) != 0)
+                continue;
+            struct latency_histogram_entry *e = &entries[n++];
+            e->name = (char *)latency_hist_name(id);
+            e->window_secs = latency_hist_windows[w];
+            e->count = sum.count;
+            e->p50 = sum.p50;
+            e->p90 = sum.p90;
+            e->p99 = sum.p99;
+            e->p999 = sum.p999;
+            e->max = sum.max;
+            e->mean = sum.mean;
+        }
+    }
+    *data = entries;
+    *npoints = n;
+    return 0;
+}
+
+static sqlite3_module systblLatencyHistogramsModule = {
+    .access_flag = CDB2_ALLOW_USER,
+};
+
+int systblLatencyHistogramsInit(sqlite3 *db)
+{
+    return create_system_table(
+        db, "comdb2_latency_histograms", &systblLatencyHistogramsModule,
+        get_latency_histograms, release_latency_histograms,
+        sizeof(struct latency_histogram_entry),
+        CDB2_CSTRING, "name", -1, offsetof(struct latency_histogram_entry, name),
+        CDB2_INTEGER, "window_secs", -1, offsetof(struct latency_histogram_entry, window_secs),
+        CDB2_INTEGER, "count", -1, offsetof(struct latency_histogram_entry, count),
+        CDB2_INTEGER, "p50_us", -1, offsetof(struct latency_histogram_entry, p50),
+        CDB2_INTEGER, "p90_us", -1, offsetof(struct latency_histogram_entry, p90),
+        CDB2_INTEGER, "p99_us", -1, offsetof(struct latency_histogram_entry, p99),
+        CDB2_INTEGER, "p999_us", -1, offsetof(struct latency_histogram_entry, p999),
+        CDB2_INTEGER, "max_us", -1, offsetof(struct latency_histogram_entry, max),
+        CDB2_REAL, "mean_us", -1, offsetof(struct latency_histogram_entry, mean),
+        SYSTABLE_END_OF_FIELDS);
+}
+
+#endif /* (!defined(SQLITE_CORE) || defined(SQLITE_BUILDING_FOR_COMDB2))       \
+          && !defined(SQLITE_OMIT_VIRTUALTABLE) */
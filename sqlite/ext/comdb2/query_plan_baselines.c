@@ -0,0 +1,55 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#if (!defined(SQLITE_CORE) || defined(SQLITE_BUILDING_FOR_COMDB2)) &&          \
+    !defined(SQLITE_OMIT_VIRTUALTABLE)
+
+#if defined(SQLITE_BUILDING_FOR_COMDB2) && !defined(SQLITE_CORE)
+#define SQLITE_CORE 1
+#endif
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+
+#include <comdb2systblInt.h>
+#include <ezsystables.h>
+#include <query_plan_baseline.h>
+
+sqlite3_module systblQueryPlanBaselinesModule = {
+    .access_flag = CDB2_ALLOW_USER,
+};
+
+int systblQueryPlanBaselinesInit(sqlite3 *db)
+{
+    return create_system_table(
+        db, "comdb2_query_plan_baselines", &systblQueryPlanBaselinesModule,
+        query_plan_baseline_collect, query_plan_baseline_collect_free,
+        sizeof(struct query_plan_baseline_info),
+        CDB2_CSTRING, "fingerprint", -1, offsetof(struct query_plan_baseline_info, fingerprint),
+        CDB2_CSTRING, "plan_fingerprint", -1, offsetof(struct query_plan_baseline_info, plan_fingerprint),
+        CDB2_CSTRING, "plan", -1, offsetof(struct query_plan_baseline_info, plan),
+        CDB2_CSTRING, "hints", -1, offsetof(struct query_plan_baseline_info, hints),
+        CDB2_REAL, "cost_per_row", -1, offsetof(struct query_plan_baseline_info, cost_per_row),
+        CDB2_CSTRING, "regressed_plan_fingerprint", -1,
+            offsetof(struct query_plan_baseline_info, regressed_plan_fingerprint),
+        CDB2_REAL, "regressed_cost_per_row", -1, offsetof(struct query_plan_baseline_info, regressed_cost_per_row),
+        CDB2_INTEGER, "num_pinned", -1, offsetof(struct query_plan_baseline_info, npinned),
+        SYSTABLE_END_OF_FIELDS);
+}
+
+#endif /* (!defined(SQLITE_CORE) || defined(SQLITE_BUILDING_FOR_COMDB2))       \
+          && !defined(SQLITE_OMIT_VIRTUALTABLE) */
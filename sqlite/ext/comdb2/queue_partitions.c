@@ -0,0 +1,110 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#if (!defined(SQLITE_CORE) || defined(SQLITE_BUILDING_FOR_COMDB2)) &&          \
+    !defined(SQLITE_OMIT_VIRTUALTABLE)
+
+#if defined(SQLITE_BUILDING_FOR_COMDB2) && !defined(SQLITE_CORE)
+#define SQLITE_CORE 1
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <comdb2.h>
+#include <comdb2systblInt.h>
+#include <ezsystables.h>
+#include <bdb_int.h>
+#include <sql.h>
+
+extern pthread_key_t query_info_key;
+
+struct queue_partition_entry {
+    char *queuename;
+    int64_t partition;
+    int64_t depth;
+    int64_t head_age;
+};
+
+static void release_queue_partitions(void *data, int n)
+{
+    struct queue_partition_entry *e = data;
+    for (int i = 0; i < n; i++)
+        free(e[i].queuename);
+    free(data);
+}
+
+static int get_queue_partitions(void **data, int *npoints)
+{
+    struct sql_thread *thd = pthread_getspecific(query_info_key);
+    uint32_t lockid = bdb_get_lid_from_cursortran(thd->clnt->dbtran.cursor_tran);
+    struct queue_partition_entry *entries = NULL;
+    int n = 0, capacity = 0;
+    int now = comdb2_time_epoch();
+
+    for (int i = 0; i < thedb->num_qdbs; i++) {
+        struct dbtable *qdb = thedb->qdbs[i];
+        int npartitions = qdb->queue_partitions;
+        if (npartitions == 0)
+            continue;
+
+        struct consumer_stat stats[MAXCONSUMERS] = {{0}};
+        if (dbqueuedb_get_stats(qdb, stats, lockid) != 0)
+            continue;
+
+        if (n + npartitions > capacity) {
+            capacity = n + npartitions + 32;
+            void *space = realloc(entries, capacity * sizeof(*entries));
+            if (!space) {
+                release_queue_partitions(entries, n);
+                return SQLITE_NOMEM;
+            }
+            entries = space;
+        }
+        for (int p = 0; p < npartitions; p++) {
+            struct queue_partition_entry *e = &entries[n++];
+            e->queuename = strdup(qdb->tablename);
+            e->partition = p;
+            e->depth = stats[p].has_stuff ? stats[p].depth : 0;
+            e->head_age = stats[p].has_stuff && stats[p].epoch ? now - stats[p].epoch : 0;
+        }
+    }
+    *data = entries;
+    *npoints = n;
+    return 0;
+}
+
+static sqlite3_module systblQueuePartitionsModule = {
+    .access_flag = CDB2_ALLOW_USER,
+    .systable_lock_count = 1,
+    .systable_locks = (const char *[]){ "comdb2_queues" }
+};
+
+int systblQueuePartitionsInit(sqlite3 *db)
+{
+    return create_system_table(
+        db, "comdb2_queue_partitions", &systblQueuePartitionsModule,
+        get_queue_partitions, release_queue_partitions,
+        sizeof(struct queue_partition_entry),
+        CDB2_CSTRING, "queuename", -1, offsetof(struct queue_partition_entry, queuename),
+        CDB2_INTEGER, "partition", -1, offsetof(struct queue_partition_entry, partition),
+        CDB2_INTEGER, "depth", -1, offsetof(struct queue_partition_entry, depth),
+        CDB2_INTEGER, "head_age", -1, offsetof(struct queue_partition_entry, head_age),
+        SYSTABLE_END_OF_FIELDS);
+}
+
+#endif /* (!defined(SQLITE_CORE) || defined(SQLITE_BUILDING_FOR_COMDB2))       \
+          && !defined(SQLITE_OMIT_VIRTUALTABLE) */
@@ -126,14 +126,19 @@ static int get_stats(struct systbl_queues_cursor *pCur) {
   if (rc) {
       /* TODO: signal error? */
   }
+  time_t epoch = 0;
   for (int consumern = 0; consumern < MAXCONSUMERS; consumern++) {
-      if (stats[consumern].has_stuff)
+      if (stats[consumern].has_stuff) {
           depth += stats[consumern].depth;
+          /* oldest head across the partitions of a partitioned queue */
+          if (stats[consumern].epoch && (epoch == 0 || stats[consumern].epoch < epoch))
+              epoch = stats[consumern].epoch;
+      }
   }
 
   pCur->depth = depth;
-  if (stats[0].epoch)
-      pCur->age  = comdb2_time_epoch() - stats[0].epoch;
+  if (epoch)
+      pCur->age  = comdb2_time_epoch() - epoch;
   else
       pCur->age  = 0;
   pCur->tot_enqueued = bdb_get_qdb_adds(qdb->handle);
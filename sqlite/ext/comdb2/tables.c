@@ -197,6 +197,8 @@ int comdb2SystblInit(
     rc = systblSampleQueriesInit(db);
   if (rc == SQLITE_OK)
     rc = systblQueryPlansInit(db);
+  if (rc == SQLITE_OK)
+    rc = systblQueryPlanBaselinesInit(db);
   if (rc == SQLITE_OK)
     rc = systblScStatusInit(db);
   if (rc == SQLITE_OK)
@@ -231,6 +233,14 @@ int comdb2SystblInit(
     rc = systblTransactionStateInit(db);
   if (rc == SQLITE_OK)
     rc = systblTriggersInit(db);
+  if (rc == SQLITE_OK)
+    rc = systblQueuePartitionsInit(db);
+  if (rc == SQLITE_OK)
+    rc = systblWaitEventsInit(db);
+  if (rc == SQLITE_OK)
+    rc = systblCacheResidencyInit(db);
+  if (rc == SQLITE_OK)
+    rc = systblLatencyHistogramsInit(db);
   if (rc == SQLITE_OK)  
     rc = systblStacks(db);
 #ifdef COMDB2_TEST
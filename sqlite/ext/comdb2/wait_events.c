@@ -0,0 +1,103 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#if (!defined(SQLITE_CORE) || defined(SQLITE_BUILDING_FOR_COMDB2)) &&          \
+    !defined(SQLITE_OMIT_VIRTUALTABLE)
+
+#if defined(SQLITE_BUILDING_FOR_COMDB2) && !defined(SQLITE_CORE)
+#define SQLITE_CORE 1
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <comdb2.h>
+#include <comdb2systblInt.h>
+#include <ezsystables.h>
+#include <thrman.h>
+#include <tohex.h>
+#include <wait_events.h>
+#include <wait_sampler.h>
+
+struct wait_event_entry {
+    cdb2_client_datetime_t window_start;
+    char *fingerprint;
+    char *thread_type;
+    char *wait_event;
+    int64_t samples;
+    int64_t wait_ms;
+    char fp[FINGERPRINTSZ * 2 + 1];
+};
+
+static const unsigned char nofingerprint[FINGERPRINTSZ];
+
+static void release_wait_events(void *data, int n)
+{
+    free(data);
+}
+
+static int get_wait_events(void **data, int *npoints)
+{
+    struct wait_sample_row *rows = NULL;
+    struct wait_event_entry *entries = NULL;
+    int n = 0;
+
+    if (wait_sampler_collect(&rows, &n) != 0)
+        return SQLITE_NOMEM;
+    if (n > 0 && (entries = calloc(n, sizeof(struct wait_event_entry))) == NULL) {
+        free(rows);
+        return SQLITE_NOMEM;
+    }
+    for (int i = 0; i < n; i++) {
+        struct wait_event_entry *e = &entries[i];
+        dttz_t dt = (dttz_t){.dttz_sec = rows[i].window_start};
+        dttz_to_client_datetime(&dt, "UTC", &e->window_start);
+        if (memcmp(rows[i].fingerprint, nofingerprint, FINGERPRINTSZ) != 0) {
+            util_tohex(e->fp, (char *)rows[i].fingerprint, FINGERPRINTSZ);
+            e->fingerprint = e->fp;
+        }
+        e->thread_type = (char *)thrman_type2a(rows[i].thrtype);
+        e->wait_event = (char *)wait_event_name(rows[i].event);
+        e->samples = rows[i].samples;
+        e->wait_ms = rows[i].wait_ms;
+    }
+    free(rows);
+    *data = entries;
+    *npoints = n;
+    return 0;
+}
+
+static sqlite3_module systblWaitEventsModule = {
+    .access_flag = CDB2_ALLOW_USER,
+};
+
+int systblWaitEventsInit(sqlite3 *db)
+{
+    return create_system_table(
+        db, "comdb2_wait_events", &systblWaitEventsModule,
+        get_wait_events, release_wait_events,
+        sizeof(struct wait_event_entry),
+        CDB2_DATETIME, "window_start", -1, offsetof(struct wait_event_entry, window_start),
+        CDB2_CSTRING, "fingerprint", -1, offsetof(struct wait_event_entry, fingerprint),
+        CDB2_CSTRING, "thread_type", -1, offsetof(struct wait_event_entry, thread_type),
+        CDB2_CSTRING, "wait_event", -1, offsetof(struct wait_event_entry, wait_event),
+        CDB2_INTEGER, "samples", -1, offsetof(struct wait_event_entry, samples),
+        CDB2_INTEGER, "wait_ms", -1, offsetof(struct wait_event_entry, wait_ms),
+        SYSTABLE_END_OF_FIELDS);
+}
+
+#endif /* (!defined(SQLITE_CORE) || defined(SQLITE_BUILDING_FOR_COMDB2))       \
+          && !defined(SQLITE_OMIT_VIRTUALTABLE) */
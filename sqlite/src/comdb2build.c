@@ -3002,6 +3002,89 @@ clean_arg:
         free_bpfunc_arg(arg);
 }
 
+void comdb2timepartPeriod(Parse *pParse, Token *nm, Token *lnm, Token *period)
+{
+    char period_str[50];
+    int iPeriod;
+
+    if (comdb2IsPrepareOnly(pParse))
+        return;
+
+#ifndef SQLITE_OMIT_AUTHORIZATION
+    {
+        if( sqlite3AuthCheck(pParse, SQLITE_PUT_TUNABLE, 0, 0, 0) ){
+            setError(pParse, SQLITE_AUTH, COMDB2_NOT_AUTHORIZED_ERRMSG);
+            return;
+        }
+    }
+#endif
+
+    if (comdb2AuthenticateUserOp(pParse))
+        return;
+
+    Vdbe *v  = sqlite3GetVdbe(pParse);
+    BpfuncArg *arg = NULL;
+
+    assert (*period->z == '\'' || *period->z == '\"');
+    if (period->n - 2 >= sizeof(period_str)) {
+        setError(pParse, SQLITE_MISUSE, "Invalid period name");
+        return;
+    }
+    strncpy0(period_str, period->z + 1, period->n - 1);
+    iPeriod = name_to_period(period_str);
+    if (!IS_TIMEPARTITION(iPeriod)) {
+        setError(pParse, SQLITE_ERROR, "Invalid period name");
+        return;
+    }
+
+    arg = (BpfuncArg*) malloc(sizeof(BpfuncArg));
+
+    if (arg)
+        bpfunc_arg__init(arg);
+    else
+        goto err;
+    BpfuncTimepartPeriod *tp_period = (BpfuncTimepartPeriod*)
+        malloc(sizeof(BpfuncTimepartPeriod));
+
+    if (tp_period)
+        bpfunc_timepart_period__init(tp_period);
+    else
+        goto err;
+
+    arg->tp_period = tp_period;
+    arg->type = BPFUNC_TIMEPART_PERIOD;
+    tp_period->timepartname = (char*) malloc(MAXTABLELEN);
+
+    if (!tp_period->timepartname)
+        goto err;
+
+    if (chkAndCopyTableTokens(pParse, tp_period->timepartname, nm, lnm,
+                              ERROR_ON_TBL_NOT_FOUND, 1, 0, NULL, /* check_for_illegal_chars */ 0))
+        goto clean_arg;
+
+    int rc = timepart_rollout(tp_period->timepartname);
+    if (rc == ROLLOUT_INVALID) {
+        setError(pParse, SQLITE_ERROR, "Partition does not exist");
+        goto clean_arg;
+    } else if (rc == ROLLOUT_TRUNC) {
+        setError(pParse, SQLITE_ERROR, "Use alter to change partition config");
+        goto clean_arg;
+    }
+
+    tp_period->period = iPeriod;
+
+    comdb2prepareNoRows(v, pParse, 0, arg, &comdb2SendBpfunc,
+                        (vdbeFuncArgFree)&free_bpfunc_arg);
+
+    return;
+err:
+    logmsg(LOGMSG_ERROR, "%s error!\n", __func__);
+    setError(pParse, SQLITE_INTERNAL, "Internal Error");
+clean_arg:
+    if (arg)
+        free_bpfunc_arg(arg);
+}
+
 static void comdb2CounterInt(Parse *pParse, Token *nm, Token *lnm,
         int isset, long long value)
 {
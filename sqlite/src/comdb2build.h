@@ -136,6 +136,7 @@ void comdb2grant(Parse* pParse, int revoke, int permission, Token* nm,
         Token* lnm, Token* u);
 
 void comdb2timepartRetention(Parse*, Token*, Token*, int val);
+void comdb2timepartPeriod(Parse*, Token*, Token*, Token*);
 void comdb2CounterIncr(Parse*, Token*, Token*);
 void comdb2CounterSet(Parse*, Token*, Token*, long long val);
 
@@ -140,7 +140,7 @@ static int can_create_default_consumer_atomically()
     return gbl_create_default_consumer_atomically && gbl_sc_protobuf;
 }
 
-void comdb2CreateTrigger(Parse *parse, int consumer, int seq, Token *proc, Cdb2TrigTables *tbl)
+void comdb2CreateTrigger(Parse *parse, int consumer, int seq, Token *proc, Cdb2TrigPartition *part, Cdb2TrigTables *tbl)
 {
     if (comdb2IsPrepareOnly(parse))
         return;
@@ -197,7 +197,39 @@ void comdb2CreateTrigger(Parse *parse, int consumer, int seq, Token *proc, Cdb2T
         return;
     }
 
+    char partcol[MAXCOLNAME + 1] = {0};
+    int npartitions = 0;
+    if (part->count.n) {
+        char count[16];
+        if (consumer != 1) {
+            sqlite3ErrorMsg(parse, "PARTITIONED BY is only supported for lua consumers");
+            return;
+        }
+        if (comdb2TokenToStr(&part->count, count, sizeof(count)) ||
+            (npartitions = atoi(count)) < 2 || npartitions > MAXCONSUMERS) {
+            sqlite3ErrorMsg(parse, "number of partitions must be between 2 and %d", MAXCONSUMERS);
+            return;
+        }
+        if (comdb2TokenToStr(&part->col, partcol, sizeof(partcol))) {
+            sqlite3ErrorMsg(parse, "partition column name is too long");
+            return;
+        }
+        for (Cdb2TrigTables *t = tbl; t; t = t->next) {
+            int i;
+            for (i = 0; i < t->table->nCol; ++i) {
+                if (sqlite3StrICmp(t->table->aCol[i].zName, partcol) == 0) break;
+            }
+            if (i == t->table->nCol) {
+                sqlite3ErrorMsg(parse, "no such column:%s in table:%s", partcol, t->table->zName);
+                return;
+            }
+        }
+    }
+
     strbuf *s = strbuf_new();
+    if (npartitions) {
+        strbuf_appendf(s, "partition %d %s\n", npartitions, partcol);
+    }
     while (tbl) {
         Table *table = tbl->table;
         Cdb2TrigEvents *events = tbl->events;
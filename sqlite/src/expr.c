@@ -2274,6 +2274,14 @@ int sqlite3IsComdb2RowTimestamp(Table *pTab, const char *z){
   }
   return 0;
 }
+
+/* Time partition views carry the row timestamp of their shards in a hidden
+** column; let "comdb2_rowtimestamp" name it, as it does for a table. */
+int sqlite3IsComdb2ViewRowTimestamp(const char *zColName, const char *z){
+  if( sqlite3StrICmp(zColName, "__hidden__rowtimestamp")!=0 ) return 0;
+  return (sqlite3StrICmp(z, "COMDB2_ROW_TIMESTAMP") == 0 ||
+          sqlite3StrICmp(z, "COMDB2_ROWTIMESTAMP") == 0);
+}
 #endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
 
 /*
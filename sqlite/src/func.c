@@ -1019,6 +1019,26 @@ static void tableVersionFunc(
   sqlite3_result_int64(context, version);
 }
 
+extern int timepart_shard_timelimit(const char *shardname, int newest);
+/*
+** Implementation of the comdb2_shard_timelimit() SQL function.  This
+** returns the oldest (second argument 0) or newest row timestamp, as epoch
+** seconds, in a shard of a time partition.
+*/
+static void shardTimelimitFunc(
+  sqlite3_context *context,
+  int argc,
+  sqlite3_value **argv
+){
+  assert( argc==2 );
+  if( sqlite3_value_type(argv[0]) != SQLITE_TEXT ){
+    return;
+  }
+  sqlite3_result_int64(context,
+      timepart_shard_timelimit((const char *)sqlite3_value_text(argv[0]),
+                               sqlite3_value_int(argv[1])));
+}
+
 extern char* comdb2_partition_info(const char *partition, const char *option);
 /*
 ** Implementation of the table_version() SQL function.  This returns
@@ -3083,6 +3103,7 @@ void sqlite3RegisterBuiltinFunctions(void){
     FUNCTION(comdb2_semver,         0, 0, 0, comdb2SemVerFunc),
     FUNCTION(table_version,         1, 0, 0, tableVersionFunc),
     FUNCTION(partition_info,        2, 0, 0, partitionInfoFunc),
+    FUNCTION(comdb2_shard_timelimit, 2, 0, 0, shardTimelimitFunc),
     FUNCTION(comdb2_host,           0, 0, 0, comdb2HostFunc),
     FUNCTION(comdb2_node,           0, 0, 0, comdb2HostFunc),
     FUNCTION(comdb2_port,           0, 0, 0, comdb2PortFunc),
@@ -2328,6 +2328,10 @@ putcmd ::= TIME PARTITION nm(Y) dbnm(Z) RETENTION  INTEGER(R). {
     comdb2timepartRetention(pParse, &Y, &Z, tmp);
 }
 
+putcmd ::= TIME PARTITION nm(Y) dbnm(Z) PERIOD STRING(P). {
+    comdb2timepartPeriod(pParse, &Y, &Z, &P);
+}
+
 putcmd ::= COUNTER nm(Y) dbnm(Z) INCREMENT. {
     comdb2CounterIncr(pParse, &Y, &Z);
 }
@@ -2640,12 +2644,12 @@ cmd ::= dryrun CREATE LUA AGGREGATE FUNCTION nm(Q). {
     comdb2CreateAggFunc(pParse, &Q);
 }
 
-cmd ::= dryrun CREATE trigger(T) nm(Q) withsequence(S) ON table_trigger_event(E). {
-    comdb2CreateTrigger(pParse,T,S,&Q,E);
+cmd ::= dryrun CREATE trigger(T) nm(Q) withsequence(S) trigpartition(P) ON table_trigger_event(E). {
+    comdb2CreateTrigger(pParse,T,S,&Q,&P,E);
 }
 
-cmd ::= dryrun CREATE trigger(T) nm(Q) withsequence(S) FOR table_trigger_new_event(E). {
-    comdb2CreateTrigger(pParse,T,S,&Q,E);
+cmd ::= dryrun CREATE trigger(T) nm(Q) withsequence(S) trigpartition(P) FOR table_trigger_new_event(E). {
+    comdb2CreateTrigger(pParse,T,S,&Q,&P,E);
 }
 
 %type trigger {int}
@@ -2674,6 +2678,10 @@ withsequence(A) ::= .                   { A = -1; }
 withsequence(A) ::= WITHOUT SEQUENCE.   { A = 0; }
 withsequence(A) ::= WITH SEQUENCE.      { A = 1; }
 
+%type trigpartition {Cdb2TrigPartition}
+trigpartition(A) ::= .                  { memset(&A, 0, sizeof(A)); }
+trigpartition(A) ::= PARTITIONED BY nm(C) INTO INTEGER(N). { A.col = C; A.count = N; }
+
 %type table_trigger_event {Cdb2TrigTables*}
 %destructor table_trigger_event {sqlite3DbFree(pParse->db, $$);}
 
@@ -20,6 +20,7 @@
 extern int gbl_strict_dbl_quotes;
 int sqlite3IsComdb2Rowid(Table *pTab, const char *);
 int sqlite3IsComdb2RowTimestamp(Table *pTab, const char *);
+int sqlite3IsComdb2ViewRowTimestamp(const char *, const char *);
 int is_comdb2_index_blob(const char *dbname, int icol);
 #endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
 
@@ -279,7 +280,12 @@ static int lookupName(
           pMatch = pItem;
         }
         for(j=0, pCol=pTab->aCol; j<pTab->nCol; j++, pCol++){
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+          if( sqlite3StrICmp(pCol->zName, zCol)==0
+           || sqlite3IsComdb2ViewRowTimestamp(pCol->zName, zCol) ){
+#else /* defined(SQLITE_BUILDING_FOR_COMDB2) */
           if( sqlite3StrICmp(pCol->zName, zCol)==0 ){
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
             /* If there has been exactly one prior match and this match
             ** is for the right-hand table of a NATURAL JOIN or is in a 
             ** USING clause, then skip this match.
@@ -87,6 +87,7 @@ extern int comdb2_register_limit(int, int);
 extern void comdb2_register_offset(int, int, int);
 extern const char *comdb2_get_dbname(void);
 extern void comdb2_set_verify_remote_schemas(void);
+extern void timepart_prune_shard_arm(Parse *, Select *);
 
 static void _set_src_recording(
   Parse *pParse,
@@ -5950,6 +5951,8 @@ int sqlite3Select(
 #endif
 
 #if defined(SQLITE_BUILDING_FOR_COMDB2)
+  /* arms of a time partition view skip shards outside a rowtimestamp range */
+  if( p->pPrior==0 ) timepart_prune_shard_arm(pParse, p);
   ast_t *ast = ast_init(pParse, __func__);
   if( ast ) ast_push(ast, AST_TYPE_SELECT, v, p);
 #endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
@@ -51,6 +51,7 @@ int comdb2_shard_table_constraints(Parse *pParse,
         const char *zName, const char *zDatabase, Expr **pWhere);
 int is_comdb2_index_unique(const char *tbl, char *idx);
 int comdb2_get_planner_effort();
+int comdb2_pinned_index(const char *zTab, char *zIdx, int nIdx);
 
 static char *comdb2IndexName(char *src, char *dest)
 {
@@ -887,6 +888,31 @@ static void constructAutomaticIndex(
     VdbeCoverage(v);
     VdbeComment((v, "next row of %s", pTabItem->pTab->zName));
   }else{
+#if defined(SQLITE_BUILDING_FOR_COMDB2) && defined(SQLITE_ENABLE_CURSOR_HINTS)
+    /* The fill scan of a remote table runs once; push down the terms that
+    ** only filter this table so the remote node does not ship every row */
+    if( pTable->iDb>1 ){
+      Expr *pHint = 0;
+      for(pTerm=pWC->a; pTerm<pWCEnd; pTerm++){
+        Expr *pExpr = pTerm->pExpr;
+        if( (pTerm->wtFlags & TERM_VIRTUAL)!=0 ) continue;
+        if( !sqlite3ExprIsTableConstant(pExpr, pSrc->iCursor) ) continue;
+        if( sqlite3ExprContainsSubquery(pExpr) ) continue;
+        /* see codeCursorHint() for why LEFT JOIN terms are excluded */
+        if( ExprHasProperty(pExpr, EP_FromJoin) ){
+          if( pExpr->iRightJoinTable!=pSrc->iCursor ) continue;
+        }else if( pTabItem->fg.jointype & JT_LEFT ){
+          continue;
+        }
+        pHint = sqlite3ExprAnd(pParse->db, pHint,
+                               sqlite3ExprDup(pParse->db, pExpr, 0));
+      }
+      if( pHint ){
+        sqlite3VdbeAddOp4(v, OP_CursorHint, pLevel->iTabCur, 0, 0,
+                          (const char*)pHint, P4_EXPR);
+      }
+    }
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) && defined(SQLITE_ENABLE_CURSOR_HINTS) */
     addrTop = sqlite3VdbeAddOp1(v, OP_Rewind, pLevel->iTabCur); VdbeCoverage(v);
   }
   if( pPartial ){
@@ -2935,6 +2961,10 @@ static int whereLoopAddBtree(
   LogEst rLogSize;            /* Logarithm of the number of rows in the table */
   WhereClause *pWC;           /* The parsed WHERE clause */
   Table *pTab;                /* Table being queried */
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+  char zPinned[128];          /* Index pinned by a query plan baseline */
+  int bPinned = 0;            /* True to consider only zPinned */
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
   
   pNew = pBuilder->pNew;
   pWInfo = pBuilder->pWInfo;
@@ -2974,6 +3004,19 @@ static int whereLoopAddBtree(
     }
     pProbe = &sPk;
   }
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+  /* A regressed query plan baseline may pin the index for this table.  The
+  ** rowid scan stays available in case the pinned index cannot be used, and
+  ** an index that no longer exists pins nothing. */
+  if( pSrc->pIBIndex==0 && pSrc->fg.notIndexed==0 && HasRowid(pTab)
+   && comdb2_pinned_index(pTab->zName, zPinned, sizeof(zPinned)) ){
+    Index *pIdx;
+    bPinned = zPinned[0]==0;
+    for(pIdx=pTab->pIndex; pIdx && !bPinned; pIdx=pIdx->pNext){
+      if( pIdx->zName && sqlite3StrICmp(pIdx->zName, zPinned)==0 ) bPinned = 1;
+    }
+  }
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
   rSize = pTab->nRowLogEst;
   rLogSize = estLog(rSize);
 
@@ -3047,6 +3090,16 @@ static int whereLoopAddBtree(
         sqlite3DebugPrintf("Not using disabled index %s:%s\n",
                            pProbe->pTable->zName, pProbe->zName);
       }
+#endif
+      continue;
+    }
+    /* if a query plan baseline pinned another index then skip */
+    if( bPinned && pProbe->zName && sqlite3StrICmp(pProbe->zName, zPinned)!=0 ){
+#ifdef WHERETRACE_ENABLED /* 0x4 */
+      if( sqlite3WhereTrace&0x4 ){
+        sqlite3DebugPrintf("Not using unpinned index %s:%s\n",
+                           pProbe->pTable->zName, pProbe->zName);
+      }
 #endif
       continue;
     }
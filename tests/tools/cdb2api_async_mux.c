@@ -0,0 +1,243 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/*
+ * Drive many logical async handles over a couple of physical connections
+ * and verify that every result set comes back complete.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <cdb2api.h>
+#include <cdb2api_async.h>
+
+#define NHNDLS 64
+#define NROWS 100
+#define MAXCONNS 2
+
+static pthread_mutex_t lk = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+static int outstanding;
+static int failed;
+static int max_physical;
+static cdb2_async_loop *loop;
+
+struct query {
+    int id;
+    long long sum;
+};
+
+static void finish(int ok)
+{
+    pthread_mutex_lock(&lk);
+    if (!ok)
+        failed = 1;
+    --outstanding;
+    pthread_cond_signal(&cond);
+    pthread_mutex_unlock(&lk);
+}
+
+static void on_row(cdb2_async_hndl_tp *ah, int rc, void *arg)
+{
+    struct query *q = arg;
+    struct cdb2_async_stats st;
+
+    cdb2_async_get_stats(loop, &st);
+    if (st.physical_conns > max_physical)
+        max_physical = st.physical_conns;
+
+    if (rc == CDB2_OK) {
+        q->sum += *(long long *)cdb2_column_value(cdb2_async_hndl(ah), 0);
+        if ((rc = cdb2_async_next_record(ah, on_row, q)) == 0)
+            return;
+    }
+    if (rc != CDB2_OK_DONE) {
+        fprintf(stderr, "query %d: rc %d %s\n", q->id, rc, cdb2_async_errstr(ah));
+        finish(0);
+        return;
+    }
+    if (q->sum != (long long)NROWS * (NROWS + 1) / 2) {
+        fprintf(stderr, "query %d: sum %lld\n", q->id, q->sum);
+        finish(0);
+        return;
+    }
+    finish(1);
+}
+
+static void on_run(cdb2_async_hndl_tp *ah, int rc, void *arg)
+{
+    struct query *q = arg;
+    if (rc) {
+        fprintf(stderr, "query %d: run rc %d %s\n", q->id, rc, cdb2_async_errstr(ah));
+        finish(0);
+        return;
+    }
+    if ((rc = cdb2_async_next_record(ah, on_row, q)) != 0) {
+        fprintf(stderr, "query %d: next rc %d\n", q->id, rc);
+        finish(0);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    cdb2_async_hndl_tp *hndls[NHNDLS];
+    struct query queries[NHNDLS];
+    struct cdb2_async_stats st;
+    char sql[128], sql_rows[128];
+    int i, rc, nconns;
+
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <dbname> <tier> [cfg]\n", argv[0]);
+        return 1;
+    }
+    if (argc > 3)
+        cdb2_set_comdb2db_config(argv[3]);
+
+    if ((loop = cdb2_async_loop_create(NULL, MAXCONNS)) == NULL) {
+        fprintf(stderr, "cdb2_async_loop_create failed\n");
+        return 1;
+    }
+
+    for (i = 0; i < NHNDLS; ++i) {
+        if ((rc = cdb2_async_open(loop, &hndls[i], argv[1], argv[2], 0)) != 0) {
+            fprintf(stderr, "cdb2_async_open rc %d\n", rc);
+            return 1;
+        }
+    }
+
+    snprintf(sql, sizeof(sql), "select value from generate_series(1, %d)", NROWS);
+    snprintf(sql_rows, sizeof(sql_rows), "%s", sql);
+    pthread_mutex_lock(&lk);
+    for (i = 0; i < NHNDLS; ++i) {
+        queries[i].id = i;
+        queries[i].sum = 0;
+        ++outstanding;
+        if ((rc = cdb2_async_run_statement(hndls[i], sql, on_run, &queries[i])) != 0) {
+            fprintf(stderr, "cdb2_async_run_statement rc %d\n", rc);
+            return 1;
+        }
+    }
+    while (outstanding > 0)
+        pthread_cond_wait(&cond, &lk);
+    pthread_mutex_unlock(&lk);
+
+    if (failed)
+        return 1;
+    if (max_physical > MAXCONNS) {
+        fprintf(stderr, "%d physical connections, expected at most %d\n", max_physical, MAXCONNS);
+        return 1;
+    }
+
+    /* Synchronous wrapper: a transaction keeps its connection */
+    if ((rc = cdb2_async_run_statement_sync(hndls[0], "begin")) != 0 ||
+        (rc = cdb2_async_run_statement_sync(hndls[0], "select 1")) != 0 ||
+        (rc = cdb2_async_next_record_sync(hndls[0])) != CDB2_OK ||
+        (rc = cdb2_async_next_record_sync(hndls[0])) != CDB2_OK_DONE ||
+        (rc = cdb2_async_run_statement_sync(hndls[0], "commit")) != 0) {
+        fprintf(stderr, "sync transaction rc %d %s\n", rc, cdb2_async_errstr(hndls[0]));
+        return 1;
+    }
+
+    /* Statements without a result set return their connection at once, so
+     * every handle gets a turn even though there are fewer connections. */
+    for (i = 0; i < NHNDLS; ++i) {
+        snprintf(sql, sizeof(sql), "insert into async_mux values(%d)", i);
+        if ((rc = cdb2_async_run_statement_sync(hndls[i], sql)) != 0 ||
+            (rc = cdb2_async_run_statement_sync(hndls[i], "begin")) != 0 ||
+            (rc = cdb2_async_run_statement_sync(hndls[i], sql)) != 0 ||
+            (rc = cdb2_async_run_statement_sync(hndls[i], "commit")) != 0) {
+            fprintf(stderr, "handle %d: dml rc %d %s\n", i, rc, cdb2_async_errstr(hndls[i]));
+            return 1;
+        }
+        cdb2_async_get_stats(loop, &st);
+        if (st.busy_conns != 0 || st.physical_conns > MAXCONNS) {
+            fprintf(stderr, "handle %d: %d busy of %d connections after dml\n", i, st.busy_conns,
+                    st.physical_conns);
+            return 1;
+        }
+    }
+    if ((rc = cdb2_async_run_statement_sync(hndls[1], "select count(*) from async_mux")) != 0 ||
+        (rc = cdb2_async_next_record_sync(hndls[1])) != CDB2_OK ||
+        *(long long *)cdb2_column_value(cdb2_async_hndl(hndls[1]), 0) != 2 * NHNDLS ||
+        (rc = cdb2_async_next_record_sync(hndls[1])) != CDB2_OK_DONE) {
+        fprintf(stderr, "count rc %d %s\n", rc, cdb2_async_errstr(hndls[1]));
+        return 1;
+    }
+
+    /* Closing a handle with unread rows pools its connection */
+    cdb2_async_get_stats(loop, &st);
+    nconns = st.physical_conns;
+    if ((rc = cdb2_async_run_statement_sync(hndls[2], sql_rows)) != 0 ||
+        (rc = cdb2_async_next_record_sync(hndls[2])) != CDB2_OK) {
+        fprintf(stderr, "unread rows rc %d %s\n", rc, cdb2_async_errstr(hndls[2]));
+        return 1;
+    }
+    cdb2_async_close(hndls[2]);
+    hndls[2] = NULL;
+    cdb2_async_get_stats(loop, &st);
+    if (st.busy_conns != 0 || st.physical_conns != nconns) {
+        fprintf(stderr, "close: %d busy of %d connections, expected 0 of %d\n", st.busy_conns,
+                st.physical_conns, nconns);
+        return 1;
+    }
+    if ((rc = cdb2_async_run_statement_sync(hndls[3], "select 1")) != 0 ||
+        (rc = cdb2_async_next_record_sync(hndls[3])) != CDB2_OK ||
+        (rc = cdb2_async_next_record_sync(hndls[3])) != CDB2_OK_DONE) {
+        fprintf(stderr, "reuse rc %d %s\n", rc, cdb2_async_errstr(hndls[3]));
+        return 1;
+    }
+
+    /* Rows are found from the response, not from the first keyword */
+    const char *selects[] = {"/* comment */ select 1", "-- comment\nselect 1", "/* a */ with x as (select 1) select * from x"};
+    for (i = 0; i < (int)(sizeof(selects) / sizeof(selects[0])); ++i) {
+        if ((rc = cdb2_async_run_statement_sync(hndls[3], selects[i])) != 0 ||
+            (rc = cdb2_async_next_record_sync(hndls[3])) != CDB2_OK) {
+            fprintf(stderr, "'%s' rc %d %s\n", selects[i], rc, cdb2_async_errstr(hndls[3]));
+            return 1;
+        }
+        while ((rc = cdb2_async_next_record_sync(hndls[3])) == CDB2_OK)
+            ;
+        if (rc != CDB2_OK_DONE) {
+            fprintf(stderr, "'%s' drain rc %d %s\n", selects[i], rc, cdb2_async_errstr(hndls[3]));
+            return 1;
+        }
+    }
+
+    /* A failed commit still ends the transaction and frees the connection */
+    if ((rc = cdb2_async_run_statement_sync(hndls[4], "insert into async_uniq values(1)")) != 0 ||
+        (rc = cdb2_async_run_statement_sync(hndls[4], "begin")) != 0 ||
+        (rc = cdb2_async_run_statement_sync(hndls[4], "insert into async_uniq values(1)")) != 0) {
+        fprintf(stderr, "dup txn rc %d %s\n", rc, cdb2_async_errstr(hndls[4]));
+        return 1;
+    }
+    if ((rc = cdb2_async_run_statement_sync(hndls[4], "commit")) == 0) {
+        fprintf(stderr, "commit of a duplicate key succeeded\n");
+        return 1;
+    }
+    cdb2_async_get_stats(loop, &st);
+    if (st.busy_conns != 0) {
+        fprintf(stderr, "failed commit: %d busy connections\n", st.busy_conns);
+        return 1;
+    }
+
+    for (i = 0; i < NHNDLS; ++i)
+        cdb2_async_close(hndls[i]);
+    cdb2_async_loop_destroy(loop);
+    printf("passed\n");
+    return 0;
+}
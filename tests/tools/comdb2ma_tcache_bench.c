@@ -0,0 +1,138 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/*
+ * Allocator microbenchmark: short-lived small allocations from a static
+ * comdb2ma allocator, with and without the per-thread cache.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <mem.h>
+
+#define NLIVE 64
+
+static int nthds = 8;
+static long niters = 1000000;
+static int per_thread;
+static int failed;
+
+static uint64_t now_us(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (uint64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+static void *worker(void *arg)
+{
+    unsigned char *live[NLIVE] = {0};
+    size_t sizes[NLIVE] = {0};
+    uint32_t x = (uint32_t)(uintptr_t)arg * 2654435761U + 1;
+    long i;
+    int slot;
+
+    if (per_thread)
+        ENABLE_PER_THREAD_MALLOC("bench");
+
+    for (i = 0; i != niters; ++i) {
+        slot = i % NLIVE;
+        if (live[slot] != NULL) {
+            if (live[slot][0] != (unsigned char)sizes[slot] ||
+                live[slot][sizes[slot] - 1] != (unsigned char)slot)
+                failed = 1;
+            comdb2_free(live[slot]);
+        }
+        /* xorshift; mostly tiny, sometimes up to 1KB */
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        sizes[slot] = (x & 3) ? 8 + (x >> 8) % 120 : 8 + (x >> 8) % 1016;
+        live[slot] = comdb2_malloc_static(COMDB2MA_STATIC_SQLITE, sizes[slot]);
+        if (live[slot] == NULL) {
+            failed = 1;
+            break;
+        }
+        live[slot][0] = (unsigned char)sizes[slot];
+        live[slot][sizes[slot] - 1] = (unsigned char)slot;
+    }
+
+    for (slot = 0; slot != NLIVE; ++slot)
+        comdb2_free(live[slot]);
+    return NULL;
+}
+
+static double run(const char *tcache)
+{
+    pthread_t *tids = malloc(sizeof(pthread_t) * nthds);
+    uint64_t start;
+    double secs;
+    int i;
+
+    comdb2ma_tcache_set(tcache);
+    start = now_us();
+    for (i = 0; i != nthds; ++i)
+        pthread_create(&tids[i], NULL, worker, (void *)(uintptr_t)(i + 1));
+    for (i = 0; i != nthds; ++i)
+        pthread_join(tids[i], NULL);
+    secs = (now_us() - start) / 1e6;
+    free(tids);
+
+    printf("%-8s %3d threads %10.0f ops/sec\n", tcache, nthds,
+           (double)nthds * niters / secs);
+    return secs;
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr, "Usage: %s [-t threads] [-n iterations] [-p]\n", argv0);
+    fprintf(stderr, "  -p  give each thread its own mspace\n");
+    exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+    int c;
+
+    while ((c = getopt(argc, argv, "t:n:ph")) != -1) {
+        switch (c) {
+        case 't': nthds = atoi(optarg); break;
+        case 'n': niters = atol(optarg); break;
+        case 'p': per_thread = 1; break;
+        default: usage(argv[0]);
+        }
+    }
+    if (nthds <= 0 || niters <= 0)
+        usage(argv[0]);
+
+    comdb2ma_init(0, 0);
+
+    run("none");
+    run("sqlite");
+    comdb2ma_stats("sqlite", 0, 0, COMDB2MA_TOTAL_DESC, COMDB2MA_GRP_NONE, 0);
+
+    if (failed) {
+        fprintf(stderr, "FAILED: chunk corrupted or allocation failed\n");
+        return 1;
+    }
+    printf("passed\n");
+    return 0;
+}
@@ -0,0 +1,159 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/*
+ * Lua consumer throughput: drain the same number of events with
+ * dbconsumer:consume() (batch size 1) and with get_batch(n)/consume_batch()
+ * at increasing batch sizes, and report items/sec for each.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <cdb2api.h>
+
+static const char *dbname, *tier = "default";
+static int nitems = 10000;
+
+static const char *sp =
+    "create procedure qbench version 'bench' {\n"
+    "local function main(batch, total)\n"
+    "    local c = db:consumer()\n"
+    "    local n = 0\n"
+    "    while n < total do\n"
+    "        if batch == 1 then\n"
+    "            c:get()\n"
+    "            c:consume()\n"
+    "            n = n + 1\n"
+    "        else\n"
+    "            n = n + #c:get_batch(batch)\n"
+    "            c:consume_batch()\n"
+    "        end\n"
+    "    end\n"
+    "    db:emit(n)\n"
+    "end\n"
+    "}";
+
+static uint64_t now_us(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (uint64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+static int run_stmt(cdb2_hndl_tp *db, const char *stmt, int64_t *val)
+{
+    int rc = cdb2_run_statement(db, stmt);
+    if (rc != CDB2_OK) {
+        fprintf(stderr, "cdb2_run_statement sql:%s err:%d errstr:%s\n", stmt, rc, cdb2_errstr(db));
+        return -1;
+    }
+    while ((rc = cdb2_next_record(db)) == CDB2_OK) {
+        if (val)
+            *val = *(int64_t *)cdb2_column_value(db, 0);
+    }
+    if (rc != CDB2_OK_DONE) {
+        fprintf(stderr, "cdb2_next_record sql:%s err:%d errstr:%s\n", stmt, rc, cdb2_errstr(db));
+        return -1;
+    }
+    return 0;
+}
+
+static int run_batch(cdb2_hndl_tp *db, int batch)
+{
+    char sql[128];
+    int64_t n = 0;
+
+    snprintf(sql, sizeof(sql), "insert into t select value from generate_series(1, %d)", nitems);
+    if (run_stmt(db, sql, NULL))
+        return -1;
+
+    snprintf(sql, sizeof(sql), "exec procedure qbench(%d, %d)", batch, nitems);
+    uint64_t start = now_us();
+    if (run_stmt(db, sql, &n))
+        return -1;
+    double secs = (now_us() - start) / 1e6;
+    if (n != nitems) {
+        fprintf(stderr, "batch %d: consumed %" PRId64 " of %d\n", batch, n, nitems);
+        return -1;
+    }
+
+    int64_t depth = -1;
+    if (run_stmt(db, "select depth from comdb2_queues where queuename = '__qqbench'", &depth))
+        return -1;
+    if (depth != 0) {
+        fprintf(stderr, "batch %d: queue depth %" PRId64 " after drain\n", batch, depth);
+        return -1;
+    }
+
+    printf("batch %5d %10.0f items/sec\n", batch, nitems / secs);
+    return 0;
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr, "Usage: %s [-n items] <dbname> [tier] [cfg]\n", argv0);
+    exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+    static const int batches[] = {1, 10, 100, 1000};
+    cdb2_hndl_tp *db;
+    int c, rc;
+
+    while ((c = getopt(argc, argv, "n:h")) != -1) {
+        switch (c) {
+        case 'n': nitems = atoi(optarg); break;
+        default: usage(argv[0]);
+        }
+    }
+    argc -= optind;
+    argv += optind;
+    switch (argc) {
+    case 3: cdb2_set_comdb2db_config(argv[2]);
+    case 2: tier = argv[1];
+    case 1: dbname = argv[0]; break;
+    default: usage(argv[-optind]);
+    }
+    if (nitems <= 0)
+        usage(argv[-optind]);
+
+    if ((rc = cdb2_open(&db, dbname, tier, 0)) != 0) {
+        fprintf(stderr, "cdb2_open err:%d errstr:%s\n", rc, cdb2_errstr(db));
+        return 1;
+    }
+
+    run_stmt(db, "drop lua consumer qbench", NULL); /* might not exist */
+    if (run_stmt(db, "drop table if exists t", NULL) ||
+        run_stmt(db, "create table t(i int)", NULL) ||
+        run_stmt(db, sp, NULL) ||
+        run_stmt(db, "create lua consumer qbench on (table t for insert)", NULL))
+        return 1;
+
+    for (int i = 0; i < sizeof(batches) / sizeof(batches[0]); ++i) {
+        if (run_batch(db, batches[i]))
+            return 1;
+    }
+
+    cdb2_close(db);
+    printf("passed\n");
+    return 0;
+}
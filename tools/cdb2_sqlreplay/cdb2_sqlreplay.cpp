@@ -31,7 +31,14 @@
 #include <map>
 #include <list>
 #include <algorithm>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
 #include <unistd.h>
+#include <strings.h>
 #include <ctime>
 #include <sys/time.h>
 #include <cstdint>
@@ -54,6 +61,12 @@ bool replay_externalauth = false; /* skip 'PUT TUNABLE externalauth' by default
 int threshold_percent = 5;
 
 int64_t maxevents = 0;
+const char *tier = nullptr;
+
+bool bench = false;
+double speed = 1.0;
+int max_connections = 128;
+int top_fingerprints = 20;
 
 void replay(cdb2_hndl_tp *db, cson_value *val);
 
@@ -65,9 +78,19 @@ static const char *usage_text =
     "  --verbose              Lots of verbose output\n"
     "  --threshold N          Set diff threshold to N% (default 5)\n"
     "  --stopat N             Stop after N events processed\n"
+    "  --tier T               Connect to tier T (default: 'default' when\n"
+    "                         CDB2_CONFIG is set, 'local' otherwise)\n"
     "  --replay-externalauth  Replay 'PUT TUNABLE externalauth' statements\n"
     "                         (skipped by default)\n"
     "\n"
+    "Benchmark options:\n"
+    "  --bench                Replay with the captured concurrency and timing,\n"
+    "                         then report throughput, latencies and errors\n"
+    "  --speed F              Scale inter-arrival times; 2 replays twice as fast\n"
+    "                         (F > 0, default 1)\n"
+    "  --max-connections N    Most connections to open (default 128)\n"
+    "  --top N                Fingerprints to list in the report (default 20)\n"
+    "\n"
     ;
 
 /* Start of functions */
@@ -309,12 +332,12 @@ bool do_bindings(cdb2_hndl_tp *db, cson_value *event_val, std::vector<uint8_t *>
             blobs_vect.push_back((uint8_t *)varaddr);
             if (name[0] == '?') {
                 int idx = atoi(name + 1);
-                if ((ret = cdb2_bind_array_index(cdb2h, idx, cdb2_type, varaddr, count, length)) != 0) {
+                if ((ret = cdb2_bind_array_index(db, idx, cdb2_type, varaddr, count, length)) != 0) {
                     std::cerr << "cdb2_bind_array_index failed for parameter index:" << idx
                               << " type:" << type << " count:" << count << " ret:" << ret << std::endl;
                     return false;
                 }
-            } else if ((ret = cdb2_bind_array(cdb2h, name, cdb2_type, varaddr, count, length)) != 0) {
+            } else if ((ret = cdb2_bind_array(db, name, cdb2_type, varaddr, count, length)) != 0) {
                 std::cerr << "cdb2_bind_array failed for parameter name:" << name
                           << " type:" << type << " count:" << count << " ret:" << ret << std::endl;
                 return false;
@@ -399,13 +422,13 @@ bool do_bindings(cdb2_hndl_tp *db, cson_value *event_val, std::vector<uint8_t *>
 
         if (name[0] == '?') {
             int idx = atoi(name + 1);
-            if ((ret = cdb2_bind_index(cdb2h, idx, cdb2_type, varaddr, length)) != 0) {
+            if ((ret = cdb2_bind_index(db, idx, cdb2_type, varaddr, length)) != 0) {
                 std::cerr << "Error from cdb2_bind_index() column " << name << ", ret=" << ret << std::endl;
                 return false;
             }
         }
         else {
-            if ((ret = cdb2_bind_param(cdb2h, name, cdb2_type, varaddr, length)) != 0) {
+            if ((ret = cdb2_bind_param(db, name, cdb2_type, varaddr, length)) != 0) {
                 std::cerr << "Error from cdb2_bind_param column " << name << ", ret=" << ret << std::endl;
                 return false;
             }
@@ -722,21 +745,28 @@ static bool is_put_tunable_externalauth(const char *sql) {
     return name == "externalauth";
 }
 
-void replay(cdb2_hndl_tp *db, cson_value *event_val) {
+static const char *event_sql(cson_value *event_val) {
     const char *sql = get_strprop(event_val, "sql");
     if(sql == nullptr) {
 	    const char *fp = get_strprop(event_val, "fingerprint");
 	    if (fp == nullptr) {
 		    std::cerr << "Error: No fingerprint logged?" << std::endl;
-		    return;
+		    return nullptr;
 	    }
 	    auto s = sqltrack.find(fp);
 	    if (s == sqltrack.end()) {
 		    std::cerr << "Error: Unknown fingerprint? " << fp << std::endl;
-		    return;
+		    return nullptr;
 	    }
 	    sql = (*s).second.c_str();
     }
+    return sql;
+}
+
+void replay(cdb2_hndl_tp *db, cson_value *event_val) {
+    const char *sql = event_sql(event_val);
+    if (sql == nullptr)
+        return;
 
     if (!replay_externalauth && is_put_tunable_externalauth(sql)) {
         if (verbose)
@@ -1094,6 +1124,15 @@ protected:
     std::vector<event_source> sources;
 };
 
+static int open_db(cdb2_hndl_tp **hndl) {
+    char *conf = getenv("CDB2_CONFIG");
+    if (conf) {
+        cdb2_set_comdb2db_config(conf);
+        return cdb2_open(hndl, dbname, tier ? tier : "default", 0);
+    }
+    return cdb2_open(hndl, dbname, tier ? tier : "local", 0);
+}
+
 void process_events(cdb2_hndl_tp *db, event_queue &queue) {
     std::string line;
     int linenum = 0;
@@ -1109,13 +1148,7 @@ void process_events(cdb2_hndl_tp *db, event_queue &queue) {
             if (had_errors) {
                 had_errors = 0;
                 cdb2_close(cdb2h);
-                char *conf = getenv("CDB2_CONFIG");
-                if (conf) {
-                    cdb2_set_comdb2db_config(conf);
-                    rc = cdb2_open(&cdb2h, dbname, "default", 0);
-                } else { 
-                    rc = cdb2_open(&cdb2h, dbname, "local", 0);
-                }
+                rc = open_db(&cdb2h);
                 db = cdb2h;
             }
             numevents++;
@@ -1129,6 +1162,369 @@ void process_events(cdb2_hndl_tp *db, event_queue &queue) {
         std::cout << "got " << linenum  << " lines" << std::endl;
 }
 
+/* Benchmark mode.  Statements are replayed on one connection per captured
+   session, each started at its original offset from the first event
+   (divided by --speed).  A session is the client connection that issued the
+   statement; all statements of a transaction share it, so a transaction
+   runs begin to commit on a single handle just as it did originally.  When
+   there are more sessions than --max-connections, sessions share
+   connections, but never one that has a transaction open: a session that
+   finds every connection inside another session's transaction is held,
+   with its later statements, until one of those transactions ends. */
+
+struct latency_stats {
+    std::string sql;
+    int64_t errors = 0;
+    std::vector<int64_t> latencies; /* microseconds */
+
+    void merge(latency_stats &from) {
+        if (sql.empty())
+            sql = from.sql;
+        errors += from.errors;
+        latencies.insert(latencies.end(), from.latencies.begin(), from.latencies.end());
+    }
+};
+
+struct bench_event {
+    int64_t due; /* hrtime() at which to start */
+    cson_value *val;
+};
+
+static const size_t bench_queue_max = 1024;
+
+struct bench_worker {
+    std::thread thd;
+    std::mutex lk;
+    std::condition_variable cond;
+    std::deque<bench_event> events;
+    bool done = false;
+
+    /* dispatcher only: session holding an open transaction on this worker */
+    std::string txn_owner;
+
+    /* worker only, read after join */
+    cdb2_hndl_tp *db = nullptr;
+    int64_t txn_start = 0;
+    std::map<std::string, latency_stats> stats;
+    latency_stats txns;
+    std::vector<int64_t> lag;
+};
+
+static bool is_connection_error(int rc) {
+    return rc == CDB2ERR_CONNECT_ERROR || rc == CDB2ERR_NOTCONNECTED || rc == CDB2ERR_IO_ERROR;
+}
+
+static void bench_replay(bench_worker *w, cson_value *event_val) {
+    const char *sql = event_sql(event_val);
+    if (sql == nullptr)
+        return;
+    if (!replay_externalauth && is_put_tunable_externalauth(sql))
+        return;
+
+    const char *fp = get_strprop(event_val, "fingerprint");
+    latency_stats &st = w->stats[fp ? fp : sql];
+    if (st.sql.empty())
+        st.sql = sql;
+
+    if (w->db == nullptr && open_db(&w->db) != 0) {
+        std::cerr << "Error: cdb2_open() failed: " << cdb2_errstr(w->db) << std::endl;
+        cdb2_close(w->db);
+        w->db = nullptr;
+        st.errors++;
+        return;
+    }
+
+    std::vector<uint8_t *> blobs_vect;
+    if (!do_bindings(w->db, event_val, blobs_vect)) {
+        cdb2_clearbindings(w->db);
+        free_blobs(blobs_vect);
+        st.errors++;
+        return;
+    }
+
+    bool is_begin = strcasecmp(sql, "begin") == 0;
+    bool is_end = strcasecmp(sql, "commit") == 0 || strcasecmp(sql, "rollback") == 0;
+
+    int64_t start_time = hrtime();
+    int rc = cdb2_run_statement(w->db, sql);
+    cdb2_clearbindings(w->db);
+    free_blobs(blobs_vect);
+    if (rc == CDB2_OK) {
+        while ((rc = cdb2_next_record(w->db)) == CDB2_OK)
+            ;
+        if (rc == CDB2_OK_DONE)
+            rc = CDB2_OK;
+    }
+    int64_t end_time = hrtime();
+
+    st.latencies.push_back(end_time - start_time);
+    if (rc != CDB2_OK) {
+        st.errors++;
+        if (verbose)
+            std::cerr << "Error: rc " << rc << ": " << cdb2_errstr(w->db) << " " << sql << std::endl;
+    }
+
+    if (is_begin) {
+        w->txn_start = start_time;
+    } else if (is_end && w->txn_start) {
+        w->txns.latencies.push_back(end_time - w->txn_start);
+        if (rc != CDB2_OK)
+            w->txns.errors++;
+        w->txn_start = 0;
+    }
+
+    if (is_connection_error(rc)) {
+        cdb2_close(w->db);
+        w->db = nullptr;
+        w->txn_start = 0;
+    }
+}
+
+static void bench_work(bench_worker *w) {
+    for (;;) {
+        bench_event ev;
+        {
+            std::unique_lock<std::mutex> l(w->lk);
+            w->cond.wait(l, [w] { return w->done || !w->events.empty(); });
+            if (w->events.empty())
+                break;
+            ev = w->events.front();
+            w->events.pop_front();
+        }
+        w->cond.notify_all();
+
+        int64_t now = hrtime();
+        if (ev.due > now) {
+            std::this_thread::sleep_for(std::chrono::microseconds(ev.due - now));
+            now = hrtime();
+        }
+        w->lag.push_back(now - ev.due);
+        bench_replay(w, ev.val);
+        cson_free_value(ev.val);
+    }
+    if (w->db)
+        cdb2_close(w->db);
+}
+
+static void bench_enqueue(bench_worker *w, bench_event &ev) {
+    std::unique_lock<std::mutex> l(w->lk);
+    w->cond.wait(l, [w] { return w->events.size() < bench_queue_max; });
+    w->events.push_back(ev);
+    l.unlock();
+    w->cond.notify_all();
+}
+
+static std::string session_key(cson_value *val) {
+    const char *host = get_strprop(val, "host");
+    std::string key(host ? host : "");
+    int64_t id;
+    if (get_intprop(val, "connid", &id))
+        return key + "/" + std::to_string(id);
+    const char *cnonce = get_strprop(val, "cnonce");
+    if (cnonce)
+        return cnonce;
+    if (get_intprop(val, "pid", &id))
+        return key + "/pid" + std::to_string(id);
+    return key;
+}
+
+static int64_t percentile(const std::vector<int64_t> &sorted, double p) {
+    if (sorted.empty())
+        return 0;
+    return sorted[(size_t)(p * (sorted.size() - 1) + 0.5)];
+}
+
+static void print_latency_line(const char *label, std::vector<int64_t> &l, int64_t errors) {
+    std::sort(l.begin(), l.end());
+    printf("%-34s %9zu %7" PRId64 " %10.3f %10.3f %10.3f %10.3f\n", label, l.size(), errors,
+           percentile(l, 0.5) / 1000.0, percentile(l, 0.9) / 1000.0, percentile(l, 0.99) / 1000.0,
+           (l.empty() ? 0 : l.back()) / 1000.0);
+}
+
+static void bench_report(std::vector<std::unique_ptr<bench_worker>> &workers, int64_t elapsed) {
+    std::map<std::string, latency_stats> stats;
+    latency_stats all, txns, lag;
+
+    for (auto &w : workers) {
+        for (auto &i : w->stats)
+            stats[i.first].merge(i.second);
+        txns.merge(w->txns);
+        lag.latencies.insert(lag.latencies.end(), w->lag.begin(), w->lag.end());
+    }
+    for (auto &i : stats)
+        all.merge(i.second);
+
+    size_t n = all.latencies.size();
+    double secs = elapsed / 1000000.0;
+    printf("replayed %zu statements on %zu connections in %.3f seconds, %.1f statements/sec\n", n,
+           workers.size(), secs, secs > 0 ? n / secs : 0.0);
+    printf("errors %" PRId64 " (%.2f%%)\n", all.errors, n ? 100.0 * all.errors / n : 0.0);
+    if (!lag.latencies.empty()) {
+        std::sort(lag.latencies.begin(), lag.latencies.end());
+        printf("start lag behind schedule: p50 %.3fms p99 %.3fms\n", percentile(lag.latencies, 0.5) / 1000.0,
+               percentile(lag.latencies, 0.99) / 1000.0);
+    }
+    printf("\n");
+
+    printf("%-34s %9s %7s %10s %10s %10s %10s\n", "latency (ms)", "count", "errors", "p50", "p90", "p99", "max");
+    print_latency_line("all statements", all.latencies, all.errors);
+    if (!txns.latencies.empty())
+        print_latency_line("transactions", txns.latencies, txns.errors);
+    printf("\n");
+
+    /* fingerprints by total time spent */
+    std::vector<std::pair<int64_t, latency_stats *>> order;
+    for (auto &i : stats) {
+        int64_t total = 0;
+        for (auto l : i.second.latencies)
+            total += l;
+        order.push_back(std::make_pair(total, &i.second));
+    }
+    std::sort(order.begin(), order.end(),
+              [](const std::pair<int64_t, latency_stats *> &a, const std::pair<int64_t, latency_stats *> &b) {
+                  return a.first > b.first;
+              });
+    for (size_t i = 0; i < order.size() && i < (size_t)top_fingerprints; i++) {
+        std::string label = order[i].second->sql;
+        std::replace(label.begin(), label.end(), '\n', ' ');
+        if (label.size() > 34)
+            label = label.substr(0, 31) + "...";
+        print_latency_line(label.c_str(), order[i].second->latencies, order[i].second->errors);
+    }
+}
+
+/* next worker, round robin, that no session holds a transaction open on */
+static bench_worker *bench_free_worker(std::vector<std::unique_ptr<bench_worker>> &workers, size_t &next_worker) {
+    for (size_t i = 0; i < workers.size(); i++) {
+        bench_worker *w = workers[(next_worker + i) % workers.size()].get();
+        if (w->txn_owner.empty()) {
+            next_worker += i + 1;
+            return w;
+        }
+    }
+    return nullptr;
+}
+
+/* hand a session's event to its worker; returns true if this ends the
+   session's transaction and frees the worker for other sessions */
+static bool bench_dispatch(bench_worker *w, const std::string &key, bench_event &ev) {
+    const char *sql = event_sql(ev.val);
+    bool freed = false;
+
+    if (strcasecmp(sql, "begin") == 0) {
+        w->txn_owner = key;
+    } else if ((strcasecmp(sql, "commit") == 0 || strcasecmp(sql, "rollback") == 0) && w->txn_owner == key) {
+        w->txn_owner.clear();
+        freed = true;
+    }
+
+    /* don't run too far ahead of the workers */
+    int64_t now = hrtime();
+    if (ev.due - now > 100000)
+        std::this_thread::sleep_for(std::chrono::microseconds(ev.due - now - 100000));
+    bench_enqueue(w, ev);
+    return freed;
+}
+
+void bench_events(event_queue &queue) {
+    std::vector<std::unique_ptr<bench_worker>> workers;
+    std::map<std::string, bench_worker *> sessions;
+    /* sessions waiting for a worker outside any transaction, oldest first */
+    std::map<std::string, std::deque<bench_event>> held;
+    std::deque<std::string> waiting;
+    size_t next_worker = 0;
+    int64_t first_event = -1;
+    int64_t start = hrtime();
+    int64_t numevents = 0;
+
+    /* a transaction ended: give freed workers to held sessions */
+    auto release_held = [&]() {
+        bench_worker *w;
+        while (!waiting.empty() && (w = bench_free_worker(workers, next_worker)) != nullptr) {
+            std::string key = waiting.front();
+            waiting.pop_front();
+            sessions[key] = w;
+            for (auto &ev : held[key])
+                bench_dispatch(w, key, ev);
+            held.erase(key);
+        }
+    };
+
+    while (!queue.empty()) {
+        cson_value *event_val = queue.get();
+        int64_t t = 0;
+        if (!is_replayable(event_val) || event_sql(event_val) == nullptr ||
+            !get_intprop(event_val, "time", &t)) {
+            cson_free_value(event_val);
+            continue;
+        }
+
+        bench_event ev;
+        ev.val = event_val;
+        if (first_event < 0)
+            first_event = t;
+        ev.due = start + (int64_t)((t - first_event) / speed);
+
+        std::string key = session_key(event_val);
+        bench_worker *w = nullptr;
+        auto h = held.find(key);
+        if (h != held.end()) {
+            /* keep the session's statements in order behind the held ones */
+            h->second.push_back(ev);
+        } else {
+            auto s = sessions.find(key);
+            if (s != sessions.end() && (s->second->txn_owner.empty() || s->second->txn_owner == key))
+                w = s->second;
+            if (w == nullptr) {
+                if (workers.size() < (size_t)max_connections) {
+                    workers.emplace_back(new bench_worker());
+                    w = workers.back().get();
+                    w->thd = std::thread(bench_work, w);
+                } else {
+                    w = bench_free_worker(workers, next_worker);
+                }
+            }
+            if (w == nullptr) {
+                /* every connection is inside another session's transaction */
+                held[key].push_back(ev);
+                waiting.push_back(key);
+            } else {
+                sessions[key] = w;
+                if (bench_dispatch(w, key, ev))
+                    release_held();
+            }
+        }
+
+        numevents++;
+        if (maxevents && numevents >= maxevents)
+            break;
+    }
+
+    /* transactions still open at the end of the log never free a worker */
+    if (!held.empty()) {
+        size_t nheld = 0;
+        for (auto &i : held) {
+            nheld += i.second.size();
+            for (auto &ev : i.second)
+                cson_free_value(ev.val);
+        }
+        std::cerr << "Warning: " << nheld << " statements from " << held.size()
+                  << " sessions not replayed, no connection was free of other sessions' transactions" << std::endl;
+    }
+
+    for (auto &w : workers) {
+        {
+            std::lock_guard<std::mutex> l(w->lk);
+            w->done = true;
+        }
+        w->cond.notify_all();
+    }
+    for (auto &w : workers)
+        w->thd.join();
+
+    bench_report(workers, hrtime() - start);
+}
+
 int main(int argc, char **argv) {
     char *filename = nullptr;
 
@@ -1157,6 +1553,42 @@ int main(int argc, char **argv) {
         }
         else if (strcmp(argv[0], "--replay-externalauth") == 0)
             replay_externalauth = true;
+        else if (strcmp(argv[0], "--bench") == 0)
+            bench = true;
+        else if (strcmp(argv[0], "--speed") == 0) {
+            argc--;
+            argv++;
+            if (argc == 0) {
+                fprintf(stderr, "--speed expected an argument");
+                return 1;
+            }
+            char *end;
+            speed = strtod(argv[0], &end);
+            if (end == argv[0] || *end != '\0' || !(speed > 0)) {
+                fprintf(stderr, "--speed expected a number greater than 0\n");
+                return 1;
+            }
+        }
+        else if (strcmp(argv[0], "--max-connections") == 0) {
+            argc--;
+            argv++;
+            if (argc == 0) {
+                fprintf(stderr, "--max-connections expected an argument");
+                return 1;
+            }
+            max_connections = (int) strtol(argv[0], nullptr, 10);
+            if (max_connections < 1)
+                max_connections = 1;
+        }
+        else if (strcmp(argv[0], "--top") == 0) {
+            argc--;
+            argv++;
+            if (argc == 0) {
+                fprintf(stderr, "--top expected an argument");
+                return 1;
+            }
+            top_fingerprints = (int) strtol(argv[0], nullptr, 10);
+        }
         else if (strcmp(argv[0], "--stopat") == 0) {
             argc--;
             argv++;
@@ -1166,6 +1598,15 @@ int main(int argc, char **argv) {
             }
             maxevents = (int) strtol(argv[0], nullptr, 10);
         }
+        else if (strcmp(argv[0], "--tier") == 0) {
+            argc--;
+            argv++;
+            if (argc == 0) {
+                fprintf(stderr, "--tier expected an argument");
+                return 1;
+            }
+            tier = argv[0];
+        }
         else {
             fprintf(stderr, "Unknown option %s\n", argv[0]);
         }
@@ -1176,16 +1617,7 @@ int main(int argc, char **argv) {
     argc--;
     argv++;
 
-    /* TODO: tier should be an option */
-    int rc;
-    char *conf = getenv("CDB2_CONFIG");
-    if (conf) {
-        cdb2_set_comdb2db_config(conf);
-        rc = cdb2_open(&cdb2h, dbname, "default", 0);
-    } else { 
-        rc = cdb2_open(&cdb2h, dbname, "local", 0);
-    }
-
+    int rc = open_db(&cdb2h);
     if (rc) {
         std::cerr << "Error: cdb2_open() failed: " << cdb2_errstr(cdb2h) << std::endl;
         exit(EXIT_FAILURE);
@@ -1198,7 +1630,10 @@ int main(int argc, char **argv) {
         argc--;
         argv++;
     }
-    process_events(cdb2h, events);
+    if (bench)
+        bench_events(events);
+    else
+        process_events(cdb2h, events);
 
     cdb2_close(cdb2h);
     return 0;
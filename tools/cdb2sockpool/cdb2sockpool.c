@@ -117,7 +117,9 @@ static long max_fd_limit;
 static pthread_mutex_t gbl_exiting_lock = PTHREAD_MUTEX_INITIALIZER;
 static int gbl_exiting = 0;
 
-extern pthread_mutex_t sockpool_lk;
+/* Protects pooled_socket_count, dbs_info_hash and active_list.  fd_destructor
+ * can be called with a socket pool shard lock held, so this nests inside it. */
+static pthread_mutex_t pool_count_lock = PTHREAD_MUTEX_INITIALIZER;
 
 /* socket port hints, to reduce communication with portmux */
 
@@ -167,11 +169,11 @@ static int get_num_clients()
 static int get_pooled_socket_count()
 {
     int pooled_sockets;
-    Pthread_mutex_lock(&sockpool_lk);
+    Pthread_mutex_lock(&pool_count_lock);
     {
         pooled_sockets = pooled_socket_count;
     }
-    Pthread_mutex_unlock(&sockpool_lk);
+    Pthread_mutex_unlock(&pool_count_lock);
     return pooled_sockets;
 }
 
@@ -189,6 +191,7 @@ static void fd_destructor(enum socket_pool_event event, const char *typestr,
         }
     }
 
+    Pthread_mutex_lock(&pool_count_lock);
     pooled_socket_count--;
     if (dbnum > 0) {
         struct db_number_info *dbs_info;
@@ -200,6 +203,7 @@ static void fd_destructor(enum socket_pool_event event, const char *typestr,
             }
         }
     }
+    Pthread_mutex_unlock(&pool_count_lock);
 }
 
 int recvall(int fd, void *bufp, int len)
@@ -532,7 +536,7 @@ void *client_thd(void *voidarg)
              * pool it our destructor (fd_destructor) will be called and will
              * decrement the count.  Also of course light the shared memory
              * bit to indicate that we have fds available for this dbnum. */
-            Pthread_mutex_lock(&sockpool_lk);
+            Pthread_mutex_lock(&pool_count_lock);
             {
                 pooled_socket_count++;
                 if (dbnum > 0) {
@@ -549,7 +553,7 @@ void *client_thd(void *voidarg)
                     dbs_info->pool_count++;
                 }
             }
-            Pthread_mutex_unlock(&sockpool_lk);
+            Pthread_mutex_unlock(&pool_count_lock);
 
             clnt.stats.fds_donated++;
             gbl_stats.fds_donated++;
@@ -675,6 +679,10 @@ void *client_thd(void *voidarg)
                 }
             }
             UNLOCK(&gbl_port_hints_lock);
+
+            /* The client failed to use this port; pooled sockets to the
+             * same place are likely just as broken. */
+            socket_pool_evict(typestr);
         } else {
             syslog(LOG_NOTICE, "%s: bad request %d\n", prefix, (int)request);
             if (newfd != -1)
@@ -770,6 +778,7 @@ static const char *help_menu[] = {
     "stat port          - Details cached ports",
     "set <name> <value> - Change tunable",
     "closeall           - Close all pooled sockets",
+    "evict <prefix>     - Close pooled sockets matching a type string prefix",
     "purgeports         - Removes all the port hints",
     NULL};
 
@@ -788,7 +797,7 @@ static void do_stat(void)
     syslog(LOG_INFO, "---\n");
     print_all_settings();
     syslog(LOG_INFO, "---\n");
-    Pthread_mutex_lock(&sockpool_lk);
+    Pthread_mutex_lock(&pool_count_lock);
     syslog(LOG_INFO, "Currently holding sockets for %d discrete dbnums:\n",
            listc_size(&active_list));
     strbuf *stb = strbuf_new();
@@ -809,7 +818,7 @@ static void do_stat(void)
     if (count > 0)
         syslog(LOG_INFO, "%s", strbuf_buf(stb));
     strbuf_free(stb);
-    Pthread_mutex_unlock(&sockpool_lk);
+    Pthread_mutex_unlock(&pool_count_lock);
     syslog(LOG_INFO, "---\n");
     LOCK(&client_lock)
     {
@@ -926,6 +935,14 @@ static void message_trap(int ntoks, char *toks[])
         syslog(LOG_INFO, "Closing all pooled sockets\n");
         socket_pool_close_all();
 
+    } else if (strcasecmp(toks[0], "evict") == 0) {
+        if (ntoks != 2) {
+            syslog(LOG_INFO, "expected type string prefix for evict\n");
+            return;
+        }
+        syslog(LOG_INFO, "Evicting pooled sockets for '%s'\n", toks[1]);
+        socket_pool_evict(toks[1]);
+
     } else if (strcasecmp(toks[0], "purgeports") == 0) {
         syslog(LOG_INFO, "Purging all cached port hints\n");
         purge_hints();
@@ -11,6 +11,7 @@
 #include "perf.h"
 #include "averager.h"
 #include "list.h"
+#include "comdb2_atomic.h"
 #include <sys_wrap.h>
 
 #include "mem_util.h"
@@ -141,3 +142,273 @@ int time_metric_depth(struct time_metric *t) {
 void time_metric_clear(struct time_metric *t) {
     averager_clear(t->avg);
 }
+
+/* Latency histograms.  Bucket layout is log-linear (HDR style): values below
+ * LATENCY_SUB_COUNT get a bucket each, every power of two above that is split
+ * into LATENCY_SUB_COUNT linear buckets, so the relative error is bounded by
+ * 1/LATENCY_SUB_COUNT across the whole range.  Values past 2^37us (~38h) are
+ * clamped into the last bucket. */
+#define LATENCY_SUB_BITS 5
+#define LATENCY_SUB_COUNT (1 << LATENCY_SUB_BITS)
+#define LATENCY_MAX_SHIFT 31
+#define LATENCY_NBUCKETS ((LATENCY_MAX_SHIFT + 2) * LATENCY_SUB_COUNT)
+
+/* The stat thread snapshots every LATENCY_SNAP_SECS; enough snapshots are
+ * kept to cover the longest window. */
+#define LATENCY_SNAP_SECS 10
+#define LATENCY_NSNAPS (300 / LATENCY_SNAP_SECS + 1)
+
+int gbl_latency_histograms = 1;
+int gbl_latency_step_sample = 64; /* time 1 in this many sql steps */
+
+const int latency_hist_windows[] = {10, 60, 300, 0};
+const int latency_hist_nwindows =
+    sizeof(latency_hist_windows) / sizeof(latency_hist_windows[0]);
+
+struct latency_counts {
+    uint64_t count;
+    uint64_t sum;
+    uint64_t buckets[LATENCY_NBUCKETS];
+};
+
+/* Written only by the owning thread */
+struct latency_shard {
+    struct latency_counts c;
+    uint64_t max;
+    int owned;
+    struct latency_shard *next;
+};
+
+struct latency_snapshot {
+    int epoch;
+    struct latency_counts c;
+};
+
+struct latency_hist {
+    const char *name;
+    pthread_mutex_t lk;
+    struct latency_shard *shards;
+    struct latency_snapshot *snaps;
+    int nsnaps;
+    int head;
+};
+
+static struct latency_hist latency_hists[LATENCY_MAX] = {
+    [LATENCY_COMMIT] = {"commit", PTHREAD_MUTEX_INITIALIZER},
+    [LATENCY_REPL_WAIT] = {"repl_wait", PTHREAD_MUTEX_INITIALIZER},
+    [LATENCY_OSQL_SEND] = {"osql_send", PTHREAD_MUTEX_INITIALIZER},
+    [LATENCY_SQL_PREPARE] = {"sql_prepare", PTHREAD_MUTEX_INITIALIZER},
+    [LATENCY_SQL_STEP] = {"sql_step", PTHREAD_MUTEX_INITIALIZER},
+    [LATENCY_PAGE_READ] = {"page_read", PTHREAD_MUTEX_INITIALIZER},
+};
+
+static __thread struct latency_shard *latency_self[LATENCY_MAX];
+static pthread_key_t latency_key;
+static pthread_once_t latency_once = PTHREAD_ONCE_INIT;
+
+/* A departing thread's shard keeps its counts and is handed to the next
+ * thread that needs one, so memory is bounded by peak concurrency. */
+static void latency_thread_exit(void *arg)
+{
+    struct latency_shard **self = arg;
+    for (int i = 0; i < LATENCY_MAX; i++) {
+        if (self[i] == NULL)
+            continue;
+        Pthread_mutex_lock(&latency_hists[i].lk);
+        self[i]->owned = 0;
+        Pthread_mutex_unlock(&latency_hists[i].lk);
+        self[i] = NULL;
+    }
+}
+
+static void latency_init_key(void)
+{
+    Pthread_key_create(&latency_key, latency_thread_exit);
+}
+
+static struct latency_shard *latency_shard_get(enum latency_hist_id id)
+{
+    struct latency_hist *h = &latency_hists[id];
+    struct latency_shard *s;
+
+    pthread_once(&latency_once, latency_init_key);
+
+    Pthread_mutex_lock(&h->lk);
+    for (s = h->shards; s; s = s->next) {
+        if (!s->owned)
+            break;
+    }
+    if (s == NULL && (s = calloc(1, sizeof(*s))) != NULL) {
+        s->next = h->shards;
+        h->shards = s;
+    }
+    if (s)
+        s->owned = 1;
+    Pthread_mutex_unlock(&h->lk);
+
+    if (s) {
+        latency_self[id] = s;
+        pthread_setspecific(latency_key, latency_self);
+    }
+    return s;
+}
+
+static int latency_bucket(uint64_t v)
+{
+    int shift;
+    if (v < LATENCY_SUB_COUNT)
+        return (int)v;
+    shift = 63 - __builtin_clzll(v) - LATENCY_SUB_BITS;
+    if (shift > LATENCY_MAX_SHIFT)
+        return LATENCY_NBUCKETS - 1;
+    return (shift + 1) * LATENCY_SUB_COUNT +
+           (int)((v >> shift) & (LATENCY_SUB_COUNT - 1));
+}
+
+/* Highest value that maps to bucket idx */
+static uint64_t latency_bucket_value(int idx)
+{
+    int shift;
+    if (idx < LATENCY_SUB_COUNT)
+        return idx;
+    shift = idx / LATENCY_SUB_COUNT - 1;
+    return (((uint64_t)(LATENCY_SUB_COUNT + idx % LATENCY_SUB_COUNT) << shift) +
+            ((uint64_t)1 << shift) - 1);
+}
+
+void latency_hist_add(enum latency_hist_id id, uint64_t us)
+{
+    struct latency_shard *s;
+
+    if (!gbl_latency_histograms)
+        return;
+    if ((s = latency_self[id]) == NULL && (s = latency_shard_get(id)) == NULL)
+        return;
+
+    ATOMIC_ADD64(s->c.buckets[latency_bucket(us)], 1);
+    ATOMIC_ADD64(s->c.sum, us);
+    ATOMIC_ADD64(s->c.count, 1);
+    if (us > s->max)
+        s->max = us;
+}
+
+const char *latency_hist_name(enum latency_hist_id id)
+{
+    if (id < 0 || id >= LATENCY_MAX)
+        return NULL;
+    return latency_hists[id].name;
+}
+
+/* Caller holds h->lk */
+static uint64_t latency_merge(struct latency_hist *h, struct latency_counts *out)
+{
+    uint64_t max = 0;
+    memset(out, 0, sizeof(*out));
+    for (struct latency_shard *s = h->shards; s; s = s->next) {
+        out->count += ATOMIC_LOAD64(s->c.count);
+        out->sum += ATOMIC_LOAD64(s->c.sum);
+        for (int i = 0; i < LATENCY_NBUCKETS; i++)
+            out->buckets[i] += ATOMIC_LOAD64(s->c.buckets[i]);
+        if (s->max > max)
+            max = s->max;
+    }
+    return max;
+}
+
+/* Called once a second by the stat thread */
+void latency_hist_tick(void)
+{
+    static int last_snap;
+    int now = comdb2_time_epoch();
+
+    if (now - last_snap < LATENCY_SNAP_SECS)
+        return;
+    last_snap = now;
+
+    for (int i = 0; i < LATENCY_MAX; i++) {
+        struct latency_hist *h = &latency_hists[i];
+        if (h->shards == NULL)
+            continue;
+        if (h->snaps == NULL &&
+            (h->snaps = calloc(LATENCY_NSNAPS, sizeof(*h->snaps))) == NULL)
+            continue;
+        Pthread_mutex_lock(&h->lk);
+        latency_merge(h, &h->snaps[h->head].c);
+        h->snaps[h->head].epoch = now;
+        h->head = (h->head + 1) % LATENCY_NSNAPS;
+        if (h->nsnaps < LATENCY_NSNAPS)
+            h->nsnaps++;
+        Pthread_mutex_unlock(&h->lk);
+    }
+}
+
+static uint64_t latency_percentile(const struct latency_counts *c, double q)
+{
+    uint64_t rank = (uint64_t)(q * c->count + 0.999999), seen = 0;
+    if (rank == 0)
+        rank = 1;
+    for (int i = 0; i < LATENCY_NBUCKETS; i++) {
+        seen += c->buckets[i];
+        if (seen >= rank)
+            return latency_bucket_value(i);
+    }
+    return 0;
+}
+
+/* Summarize the last window_secs seconds (0 for everything since startup).
+ * Windows are measured against the snapshot at least window_secs old, so
+ * they may cover up to LATENCY_SNAP_SECS more than asked for. */
+int latency_hist_summary(enum latency_hist_id id, int window_secs,
+                         struct latency_summary *out)
+{
+    struct latency_hist *h;
+    struct latency_counts *c;
+    uint64_t max;
+    int now = comdb2_time_epoch();
+
+    if (id < 0 || id >= LATENCY_MAX)
+        return -1;
+    h = &latency_hists[id];
+    if ((c = malloc(sizeof(*c))) == NULL)
+        return -1;
+
+    Pthread_mutex_lock(&h->lk);
+    max = latency_merge(h, c);
+    if (window_secs > 0) {
+        for (int i = 1; i <= h->nsnaps; i++) {
+            struct latency_snapshot *snap =
+                &h->snaps[(h->head - i + LATENCY_NSNAPS) % LATENCY_NSNAPS];
+            if (now - snap->epoch < window_secs)
+                continue;
+            c->count -= snap->c.count;
+            c->sum -= snap->c.sum;
+            for (int j = 0; j < LATENCY_NBUCKETS; j++)
+                c->buckets[j] -= snap->c.buckets[j];
+            break;
+        }
+    }
+    Pthread_mutex_unlock(&h->lk);
+
+    memset(out, 0, sizeof(*out));
+    out->count = c->count;
+    if (c->count) {
+        out->p50 = latency_percentile(c, 0.5);
+        out->p90 = latency_percentile(c, 0.9);
+        out->p99 = latency_percentile(c, 0.99);
+        out->p999 = latency_percentile(c, 0.999);
+        out->max = latency_percentile(c, 1.0);
+        if (out->max > max)
+            out->max = max;
+        if (out->p999 > out->max)
+            out->p999 = out->max;
+        if (out->p99 > out->max)
+            out->p99 = out->max;
+        if (out->p90 > out->max)
+            out->p90 = out->max;
+        if (out->p50 > out->max)
+            out->p50 = out->max;
+        out->mean = (double)c->sum / c->count;
+    }
+    free(c);
+    return 0;
+}
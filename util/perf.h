@@ -1,6 +1,7 @@
 #ifndef INCLUDED_PERF_H
 #define INCLUDED_PERF_H
 
+#include <stdint.h>
 #include "averager.h"
 
 struct time_metric;
@@ -20,4 +21,36 @@ void time_metric_purge_old(struct time_metric *t);
 int time_metric_depth(struct time_metric *t);
 void time_metric_clear(struct time_metric *t);
 
+/* Log-linear latency histograms.  Each thread records into its own shard
+ * without locking; readers merge the shards.  Values are microseconds. */
+enum latency_hist_id {
+    LATENCY_COMMIT,
+    LATENCY_REPL_WAIT,
+    LATENCY_OSQL_SEND,
+    LATENCY_SQL_PREPARE,
+    LATENCY_SQL_STEP,
+    LATENCY_PAGE_READ,
+    LATENCY_MAX
+};
+
+struct latency_summary {
+    uint64_t count;
+    uint64_t p50;
+    uint64_t p90;
+    uint64_t p99;
+    uint64_t p999;
+    uint64_t max;
+    double mean;
+};
+
+/* Windows (in seconds) retained by latency_hist_tick; 0 means since startup */
+extern const int latency_hist_windows[];
+extern const int latency_hist_nwindows;
+
+void latency_hist_add(enum latency_hist_id id, uint64_t us);
+const char *latency_hist_name(enum latency_hist_id id);
+void latency_hist_tick(void);
+int latency_hist_summary(enum latency_hist_id id, int window_secs,
+                         struct latency_summary *out);
+
 #endif
@@ -0,0 +1,32 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#include <stddef.h>
+#include "wait_events.h"
+
+__thread struct wait_state *wait_state_self = NULL;
+
+const char *wait_event_name(int event)
+{
+    switch (event) {
+    case WAIT_EVENT_CPU: return "cpu";
+    case WAIT_EVENT_LOCK: return "lock";
+    case WAIT_EVENT_MPOOL_READ: return "mpool_read";
+    case WAIT_EVENT_LOG_FLUSH: return "log_flush";
+    case WAIT_EVENT_NET_SEND: return "net_send";
+    }
+    return "unknown";
+}